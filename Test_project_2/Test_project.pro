@@ -1,4 +1,4 @@
-QT       += core gui
+QT       += core gui concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -16,11 +16,54 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    asyncrecorder.cpp \
+    instrumentedrecorder.cpp \
     main.cpp \
-    mainwindow.cpp
+    mappedfile.cpp \
+    mainwindow.cpp \
+    maxsizebudgeter.cpp \
+    overflowwatchdog.cpp \
+    profileengine.cpp \
+    reconnectingrecorder.cpp \
+    recorderfactory.cpp \
+    recorderprotocol.cpp \
+    recorderstatuspoller.cpp \
+    recordingdatareader.cpp \
+    recordingextractor.cpp \
+    recordingtimepredictor.cpp \
+    sessionprofiles.cpp \
+    simulatedrecorder.cpp \
+    startorchestrator.cpp \
+    syncindex.cpp \
+    timeindex.cpp
 
 HEADERS += \
-    mainwindow.h
+    asyncrecorder.h \
+    instrumentedrecorder.h \
+    mainwindow.h \
+    mappedfile.h \
+    maxsizebudgeter.h \
+    overflowwatchdog.h \
+    profileengine.h \
+    reconnectingrecorder.h \
+    recorderfactory.h \
+    recorderprotocol.h \
+    recorderstatuspoller.h \
+    recordingdatareader.h \
+    recordingextractor.h \
+    recordingtimepredictor.h \
+    sessionprofiles.h \
+    simulatedrecorder.h \
+    spscqueue.h \
+    startorchestrator.h \
+    syncindex.h \
+    timeindex.h
+
+# The Unix socket client, for running on the recorder itself
+unix {
+    SOURCES += socketrecorder.cpp
+    HEADERS += socketrecorder.h
+}
 
 FORMS += \
     mainwindow.ui
@@ -35,6 +78,9 @@ else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/gec-sfpdp-recorder-api-
 else:unix: LIBS += -L$$PWD/gec-sfpdp-recorder-api-win-3.5.0/lib/ -lsfpdp-recorder-api-100
 
 INCLUDEPATH += $$PWD/gec-sfpdp-recorder-api-win-3.5.0
+# The factory header includes the interface header by its bare name
+INCLUDEPATH += $$PWD/gec-sfpdp-recorder-api-win-3.5.0/inc
+win32: LIBS += -lws2_32
 message("INCLUDEPATH=$$INCLUDEPATH")
 DEPENDPATH += $$PWD/gec-sfpdp-recorder-api-win-3.5.0
 
@@ -44,3 +90,34 @@ else:unix: LIBS += -L$$PWD/gec-sfpdp-recorder-api-win-3.5.0/lib/ -lsfpdp-recorde
 
 INCLUDEPATH += $$PWD/gec-sfpdp-recorder-api-win-3.5.0/lib/Debug
 DEPENDPATH += $$PWD/gec-sfpdp-recorder-api-win-3.5.0/lib/Debug
+
+# SSH access to the recorder, using the shared code of the gec-ssh examples
+SSH_EXAMPLES = $$PWD/gec-ssh-win-3.0.0/examples
+SSH_COMMON = $$SSH_EXAMPLES/ssh-common
+
+SOURCES += \
+    $$SSH_COMMON/authentication.cpp \
+    $$SSH_COMMON/command.cpp \
+    $$SSH_COMMON/connect_ssh.cpp \
+    $$SSH_COMMON/knownhosts.cpp \
+    $$SSH_COMMON/glob.cpp \
+    $$SSH_COMMON/GEC_SftpSessionPool.cpp \
+    $$SSH_COMMON/GEC_CapacityQuery.cpp \
+    $$SSH_EXAMPLES/ssh-catalog/GEC_RecordingCatalog.cpp \
+    $$SSH_EXAMPLES/ssh-tree/GEC_TreeScanner.cpp
+
+HEADERS += \
+    $$SSH_COMMON/ssh-common.h \
+    $$SSH_COMMON/GEC_SftpSessionPool.h \
+    $$SSH_COMMON/GEC_CapacityQuery.h \
+    $$SSH_COMMON/GEC_RecordingFormat.h \
+    $$SSH_COMMON/GEC_SfpdpLinkRate.h \
+    $$SSH_EXAMPLES/ssh-catalog/GEC_RecordingCatalog.h \
+    $$SSH_EXAMPLES/ssh-tree/GEC_TreeScanner.h
+
+INCLUDEPATH += $$SSH_COMMON $$SSH_EXAMPLES/ssh-catalog $$SSH_EXAMPLES/ssh-tree \
+    $$PWD/gec-ssh-win-3.0.0/libssh-vc140-0.7.3/include
+DEPENDPATH += $$SSH_COMMON $$SSH_EXAMPLES/ssh-catalog $$SSH_EXAMPLES/ssh-tree
+
+win32: LIBS += -L$$PWD/gec-ssh-win-3.0.0/libssh-vc140-0.7.3/lib/ -lssh
+else:unix: LIBS += -lssh
@@ -0,0 +1,111 @@
+#include "asyncrecorder.h"
+
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "inc/GE_Defines.h"
+#include "recorderfactory.h"
+
+AsyncRecorder::AsyncRecorder(const std::string &address)
+    : m_recorder(NULL)
+    , m_numRunning(0)
+    , m_isStopping(false)
+{
+    m_create = [address]() { return RecorderFactory::create(address); };
+    m_destroy = [](GEC_ISfpdpRecorder *recorder) { RecorderFactory::destroy(recorder); };
+    m_thread = std::thread(&AsyncRecorder::run, this);
+}
+
+AsyncRecorder::AsyncRecorder(CreateFunction create, DestroyFunction destroy)
+    : m_create(create)
+    , m_destroy(destroy)
+    , m_recorder(NULL)
+    , m_numRunning(0)
+    , m_isStopping(false)
+{
+    m_thread = std::thread(&AsyncRecorder::run, this);
+}
+
+AsyncRecorder::~AsyncRecorder()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+        m_queue.clear();
+    }
+    m_queueChanged.notify_all();
+    m_thread.join();
+}
+
+void AsyncRecorder::post(std::function<void(GEC_ISfpdpRecorder *)> request)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(request);
+    }
+    m_queueChanged.notify_one();
+}
+
+size_t AsyncRecorder::getNumPending()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.size() + m_numRunning;
+}
+
+void AsyncRecorder::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_queueChanged.wait(lock, [this]() { return m_isStopping || !m_queue.empty(); });
+        if (m_isStopping) {
+            break;
+        }
+
+        std::function<void(GEC_ISfpdpRecorder *)> request = m_queue.front();
+        m_queue.pop_front();
+        m_numRunning = 1;
+        lock.unlock();
+
+        if (m_recorder == NULL) {
+            m_recorder = m_create();
+        }
+        request(m_recorder);
+
+        lock.lock();
+        m_numRunning = 0;
+    }
+    lock.unlock();
+
+    if (m_recorder != NULL) {
+        m_destroy(m_recorder);
+        m_recorder = NULL;
+    }
+}
+
+std::future<int> AsyncRecorder::reset()
+{
+    return call([](GEC_ISfpdpRecorder *recorder) {
+        return (recorder != NULL) ? recorder->reset() : GE_COMMFAIL;
+    });
+}
+
+std::future<int> AsyncRecorder::startAll()
+{
+    return call([](GEC_ISfpdpRecorder *recorder) {
+        return (recorder != NULL) ? recorder->startAll() : GE_COMMFAIL;
+    });
+}
+
+std::future<int> AsyncRecorder::stopAll()
+{
+    return call([](GEC_ISfpdpRecorder *recorder) {
+        return (recorder != NULL) ? recorder->stopAll() : GE_COMMFAIL;
+    });
+}
+
+std::future<AsyncRecorder::Status> AsyncRecorder::getStatus(uint32_t id)
+{
+    return call([id](GEC_ISfpdpRecorder *recorder) {
+        Status status;
+        status.rc = (recorder != NULL) ? recorder->getStatus(id, status.numBytes, status.state) : GE_COMMFAIL;
+        return status;
+    });
+}
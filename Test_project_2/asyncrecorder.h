@@ -0,0 +1,107 @@
+#ifndef ASYNCRECORDER_H
+#define ASYNCRECORDER_H
+
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+class GEC_ISfpdpRecorder;
+
+/**
+  Runs the calls to one recorder in a thread of its own
+
+  Every GEC_ISfpdpRecorder method is a blocking round trip to the
+  recorder. Requests are queued and run one after the other on the I/O
+  thread, in the order they were made, so the caller never waits and a
+  create() is always done before the setMaxSize() queued after it.
+
+  A request is any function taking the recorder instance. Its result is
+  returned through a std::future, or passed to a completion callback
+  that is called on the I/O thread; a GUI forwards it to its own thread,
+  e.g. with QMetaObject::invokeMethod().
+
+  The instance is created on the I/O thread when the first request runs,
+  and created again before the next request if that failed. Until then
+  requests get a null pointer; the methods below return GE_COMMFAIL for
+  it. Requests still queued when the object is destroyed are dropped,
+  and their futures report a broken promise.
+*/
+class AsyncRecorder
+{
+public:
+    typedef std::function<GEC_ISfpdpRecorder *()> CreateFunction;
+    typedef std::function<void(GEC_ISfpdpRecorder *)> DestroyFunction;
+
+    struct Status
+    {
+        Status() : rc(0), numBytes(0) {}
+
+        int rc;
+        uint64_t numBytes;
+        std::string state;
+    };
+
+    /** Connects to the recorder at @p address, or simulates one; see RecorderFactory */
+    explicit AsyncRecorder(const std::string &address);
+    AsyncRecorder(CreateFunction create, DestroyFunction destroy);
+    ~AsyncRecorder();
+
+    /** Queues @p request and returns the future of its result */
+    template<typename Function>
+    std::future<typename std::result_of<Function(GEC_ISfpdpRecorder *)>::type> call(Function request)
+    {
+        typedef typename std::result_of<Function(GEC_ISfpdpRecorder *)>::type Result;
+        std::shared_ptr<std::promise<Result> > promise(new std::promise<Result>());
+        std::future<Result> future = promise->get_future();
+        post([promise, request](GEC_ISfpdpRecorder *recorder) {
+            promise->set_value(request(recorder));
+        });
+        return future;
+    }
+
+    /** Queues @p request, and calls @p done with its result on the I/O thread */
+    template<typename Function, typename Callback>
+    void call(Function request, Callback done)
+    {
+        post([request, done](GEC_ISfpdpRecorder *recorder) {
+            done(request(recorder));
+        });
+    }
+
+    /** Queues a request without a result */
+    void post(std::function<void(GEC_ISfpdpRecorder *)> request);
+
+    std::future<int> reset();
+    std::future<int> startAll();
+    std::future<int> stopAll();
+    std::future<Status> getStatus(uint32_t id);
+
+    /** Number of requests queued or running */
+    size_t getNumPending();
+
+private:
+    AsyncRecorder(const AsyncRecorder &);
+    AsyncRecorder &operator=(const AsyncRecorder &);
+
+    void run();
+
+    CreateFunction m_create;
+    DestroyFunction m_destroy;
+    GEC_ISfpdpRecorder *m_recorder;   // Only used on the I/O thread
+
+    std::mutex m_mutex;
+    std::condition_variable m_queueChanged;
+    std::deque<std::function<void(GEC_ISfpdpRecorder *)> > m_queue;
+    size_t m_numRunning;
+    bool m_isStopping;
+    std::thread m_thread;
+};
+
+#endif // ASYNCRECORDER_H
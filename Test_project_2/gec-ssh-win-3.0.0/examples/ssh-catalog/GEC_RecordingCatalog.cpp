@@ -0,0 +1,674 @@
+#include <algorithm>
+#include <atomic>
+#include <fcntl.h>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+
+#include "GEC_RecordingCatalog.h"
+#include "GEC_RecordingFormat.h"
+#include "GEC_TreeScanner.h"
+
+#define CATALOG_FILE_MAGIC    0x43434547  // "GECC"
+#define CATALOG_FILE_VERSION  2
+
+// Kept in the files field of a CatalogFileRecording, next to the GEC_RECORDING_HAS_* bits
+#define CATALOG_FILE_FINAL    (1u << 31)
+
+/*
+  Catalog file layout, all fields little endian:
+
+    CatalogFileHeader
+    CatalogFileDirectory[numDirectories]
+    CatalogFileRecording[numRecordings]
+    char[stringPoolSize]  directory paths and recording names
+*/
+struct CatalogFileHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t numDirectories;
+  uint32_t numRecordings;
+  uint64_t stringPoolSize;
+  uint32_t rootOffset;
+  uint32_t rootLength;
+};
+
+struct CatalogFileDirectory
+{
+  uint64_t modifiedTime;
+  uint32_t pathOffset;
+  uint32_t pathLength;
+};
+
+struct CatalogFileRecording
+{
+  uint32_t directoryIndex;
+  uint32_t nameOffset;
+  uint32_t nameLength;
+  uint32_t files;
+  uint64_t dataSizeInBytes;
+  uint64_t indexSizeInBytes;
+  uint64_t metaSizeInBytes;
+  uint64_t numIndexEntries;
+  uint64_t startTimeInNs;
+  uint64_t endTimeInNs;
+  uint64_t dataModifiedTime;
+};
+
+/*
+  Calls 'work' for every item index below numItems, spread over as many
+  threads as the pool has sessions. Every thread holds one session for
+  its whole run.
+*/
+static bool runOnPool(GEC_SftpSessionPool& pool, size_t numItems,
+                      std::function<bool(sftp_session, size_t)> work)
+{
+  std::atomic<size_t> iNext(0);
+  std::atomic<bool> allDone(true);
+
+  size_t numThreads = std::min(pool.getMaxSessions(), numItems);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < numThreads; ++t) {
+    threads.push_back(std::thread([&]() {
+      sftp_session sftp = pool.acquire();
+      if (sftp == NULL) {
+        allDone = false;
+        return;
+      }
+      size_t i;
+      while ((i = iNext++) < numItems) {
+        if (!work(sftp, i)) {
+          allDone = false;
+        }
+      }
+      pool.release(sftp, !ssh_is_connected(sftp->session));
+    }));
+  }
+  for (size_t t = 0; t < threads.size(); ++t) {
+    threads[t].join();
+  }
+
+  return allDone && iNext >= numItems;
+}
+
+static bool hasSuffix(const std::string& text, const std::string& suffix)
+{
+  return text.length() > suffix.length()
+    && text.compare(text.length() - suffix.length(), suffix.length(), suffix) == 0;
+}
+
+static bool isBelow(const std::string& path, const std::string& directory)
+{
+  return path == directory
+    || (path.length() > directory.length()
+        && path.compare(0, directory.length(), directory) == 0
+        && (path[directory.length()] == '/' || directory == "/"));
+}
+
+static bool readFully(sftp_file file, void* buffer, size_t count)
+{
+  return sftp_read(file, buffer, count) == static_cast<ssize_t>(count);
+}
+
+void GEC_RecordingCatalog::addFiles(const std::vector<FileInfo>& files, std::vector<GEC_Recording>& recordings)
+{
+  std::map<std::pair<std::string, std::string>, GEC_Recording> grouped;
+
+  std::vector<FileInfo>::const_iterator it;
+  for (it = files.begin(); it != files.end(); ++it) {
+    uint32_t file;
+    std::string extension;
+    if (hasSuffix(it->name, GEC_RECORDING_DATA_EXTENSION)) {
+      file = GEC_RECORDING_HAS_DATA;
+      extension = GEC_RECORDING_DATA_EXTENSION;
+    } else if (hasSuffix(it->name, GEC_RECORDING_INDEX_EXTENSION)) {
+      file = GEC_RECORDING_HAS_INDEX;
+      extension = GEC_RECORDING_INDEX_EXTENSION;
+    } else if (hasSuffix(it->name, GEC_RECORDING_META_EXTENSION)) {
+      file = GEC_RECORDING_HAS_META;
+      extension = GEC_RECORDING_META_EXTENSION;
+    } else {
+      continue;
+    }
+
+    std::string baseName = it->name.substr(0, it->name.length() - extension.length());
+    GEC_Recording& recording = grouped[std::make_pair(it->directory, baseName)];
+    recording.directory = it->directory;
+    recording.name = baseName;
+    recording.files |= file;
+    if (file == GEC_RECORDING_HAS_DATA) {
+      recording.dataSizeInBytes = it->sizeInBytes;
+      recording.dataModifiedTime = it->modifiedTime;
+    } else if (file == GEC_RECORDING_HAS_INDEX) {
+      recording.indexSizeInBytes = it->sizeInBytes;
+      recording.numIndexEntries = it->sizeInBytes / sizeof(GEC_IndexEntry);
+    } else {
+      recording.metaSizeInBytes = it->sizeInBytes;
+    }
+  }
+
+  std::map<std::pair<std::string, std::string>, GEC_Recording>::iterator itGroup;
+  for (itGroup = grouped.begin(); itGroup != grouped.end(); ++itGroup) {
+    recordings.push_back(itGroup->second);
+  }
+}
+
+bool GEC_RecordingCatalog::restatRecording(sftp_session sftp, GEC_Recording& recording, bool& hasChanged)
+{
+  hasChanged = false;
+  std::string base = recording.directory + "/" + recording.name;
+  sftp_attributes attributes = sftp_stat(sftp, (base + GEC_RECORDING_DATA_EXTENSION).c_str());
+  if (attributes == NULL) {
+    return false;
+  }
+  bool isSame = attributes->size == recording.dataSizeInBytes && attributes->mtime == recording.dataModifiedTime;
+  recording.dataSizeInBytes = attributes->size;
+  recording.dataModifiedTime = attributes->mtime;
+  sftp_attributes_free(attributes);
+  if (isSame) {
+    // A recording waiting for its first data is not final yet
+    recording.isFinal = recording.dataSizeInBytes > 0;
+    return true;
+  }
+
+  // The recorder appends to all three files together
+  hasChanged = true;
+  attributes = sftp_stat(sftp, (base + GEC_RECORDING_INDEX_EXTENSION).c_str());
+  if (attributes == NULL) {
+    return false;
+  }
+  recording.indexSizeInBytes = attributes->size;
+  recording.numIndexEntries = attributes->size / sizeof(GEC_IndexEntry);
+  sftp_attributes_free(attributes);
+  attributes = sftp_stat(sftp, (base + GEC_RECORDING_META_EXTENSION).c_str());
+  if (attributes == NULL) {
+    return false;
+  }
+  recording.metaSizeInBytes = attributes->size;
+  sftp_attributes_free(attributes);
+  return true;
+}
+
+bool GEC_RecordingCatalog::readTimeSpans(GEC_SftpSessionPool& pool, std::vector<GEC_Recording>& recordings,
+                                         std::set<std::string>& failedDirectories)
+{
+  const uint64_t minMetaSize = sizeof(GEC_MetaHeader) + sizeof(GEC_MetaRecord);
+
+  std::vector<size_t> pending;
+  for (size_t i = 0; i < recordings.size(); ++i) {
+    if ((recordings[i].files & GEC_RECORDING_HAS_META) && recordings[i].metaSizeInBytes >= minMetaSize) {
+      pending.push_back(i);
+    }
+  }
+
+  // Only the header, the first, and the last timing record are read
+  std::vector<char> read(pending.size(), 0);
+  runOnPool(pool, pending.size(), [&](sftp_session sftp, size_t i) {
+    GEC_Recording& recording = recordings[pending[i]];
+    std::string path = recording.directory + "/" + recording.name + GEC_RECORDING_META_EXTENSION;
+
+    sftp_file file = sftp_open(sftp, path.c_str(), O_RDONLY, 0);
+    if (file == NULL) {
+      return false;
+    }
+
+    GEC_MetaHeader header;
+    GEC_MetaRecord first;
+    GEC_MetaRecord last;
+    uint64_t numRecords = (recording.metaSizeInBytes - sizeof(GEC_MetaHeader)) / sizeof(GEC_MetaRecord);
+
+    // A file that is not a .meta file is read, it just has no time span
+    bool ok = readFully(file, &header, sizeof(header));
+    bool isMeta = ok && header.magic == GEC_META_MAGIC;
+    if (isMeta) {
+      ok = readFully(file, &first, sizeof(first))
+        && sftp_seek64(file, sizeof(GEC_MetaHeader) + (numRecords - 1) * sizeof(GEC_MetaRecord)) == 0
+        && readFully(file, &last, sizeof(last));
+    }
+    sftp_close(file);
+    if (!ok) {
+      return false;
+    }
+
+    if (isMeta) {
+      recording.startTimeInNs = GEC_metaTicksToTimeInNs(header, first.timerTicks);
+      recording.endTimeInNs = GEC_metaTicksToTimeInNs(header, last.timerTicks);
+    }
+    read[i] = 1;
+    return true;
+  });
+
+  // Also covers the items left over when the pool could not connect
+  bool allRead = true;
+  for (size_t i = 0; i < pending.size(); ++i) {
+    if (!read[i]) {
+      failedDirectories.insert(recordings[pending[i]].directory);
+      allRead = false;
+    }
+  }
+  return allRead;
+}
+
+int GEC_RecordingCatalog::scanTree(GEC_SftpSessionPool& pool, std::string root, std::vector<GEC_Recording>& recordings,
+                                   std::map<std::string, uint64_t>& directories)
+{
+  sftp_session sftp = pool.acquire();
+  if (sftp == NULL) {
+    return GEC_CATALOG_NETWORK_ERROR;
+  }
+  sftp_attributes attributes = sftp_stat(sftp, root.c_str());
+  pool.release(sftp, !ssh_is_connected(sftp->session));
+  if (attributes == NULL) {
+    return GEC_CATALOG_NETWORK_ERROR;
+  }
+  std::map<std::string, uint64_t> seen;
+  seen[root] = attributes->mtime;
+  sftp_attributes_free(attributes);
+
+  std::vector<FileInfo> files;
+  GEC_TreeScanner scanner(pool);
+  scanner.addInclude(std::string("*") + GEC_RECORDING_DATA_EXTENSION);
+  scanner.addInclude(std::string("*") + GEC_RECORDING_INDEX_EXTENSION);
+  scanner.addInclude(std::string("*") + GEC_RECORDING_META_EXTENSION);
+
+  int rc = scanner.scan(root, [&](const GEC_TreeEntry& entry) {
+    if (entry.isDirectory) {
+      seen[entry.path] = entry.modifiedTime;
+    } else {
+      FileInfo file;
+      file.directory = entry.path.substr(0, entry.path.length() - entry.name.length() - 1);
+      file.name = entry.name;
+      file.sizeInBytes = entry.sizeInBytes;
+      file.modifiedTime = entry.modifiedTime;
+      files.push_back(file);
+    }
+  });
+  if (rc == GEC_TREE_NETWORK_ERROR) {
+    return GEC_CATALOG_NETWORK_ERROR;
+  }
+
+  std::vector<GEC_Recording> found;
+  std::set<std::string> failed(scanner.getFailedDirectories().begin(), scanner.getFailedDirectories().end());
+  addFiles(files, found);
+  bool allRead = readTimeSpans(pool, found, failed);
+  recordings.insert(recordings.end(), found.begin(), found.end());
+
+  // A directory only gets its time once all of it was read, so revalidate() lists it again otherwise
+  std::map<std::string, uint64_t>::iterator it;
+  for (it = seen.begin(); it != seen.end(); ++it) {
+    directories[it->first] = (failed.count(it->first) != 0) ? 0 : it->second;
+  }
+
+  return (rc == GEC_TREE_OK && allRead) ? GEC_CATALOG_OK : GEC_CATALOG_INCOMPLETE;
+}
+
+int GEC_RecordingCatalog::scan(GEC_SftpSessionPool& pool, std::string root)
+{
+  while (root.length() > 1 && root[root.length() - 1] == '/') {
+    root.erase(root.length() - 1);
+  }
+
+  m_root = root;
+  m_recordings.clear();
+  m_directories.clear();
+
+  int rc = scanTree(pool, root, m_recordings, m_directories);
+  sortRecordings();
+  return rc;
+}
+
+int GEC_RecordingCatalog::listDirectory(sftp_session sftp, std::string directory, std::vector<FileInfo>& files,
+                                        std::vector<std::string>& subdirectories, uint64_t& modifiedTime)
+{
+  sftp_attributes attributes = sftp_stat(sftp, directory.c_str());
+  if (attributes == NULL) {
+    return GEC_CATALOG_NETWORK_ERROR;
+  }
+  modifiedTime = attributes->mtime;
+  sftp_attributes_free(attributes);
+
+  sftp_dir dir = sftp_opendir(sftp, directory.c_str());
+  if (dir == NULL) {
+    return GEC_CATALOG_NETWORK_ERROR;
+  }
+
+  while ((attributes = sftp_readdir(sftp, dir)) != NULL) {
+    std::string name(attributes->name);
+    if (attributes->type == SSH_FILEXFER_TYPE_DIRECTORY) {
+      if (name != "." && name != "..") {
+        subdirectories.push_back(directory + "/" + name);
+      }
+    } else if (attributes->type == SSH_FILEXFER_TYPE_REGULAR) {
+      FileInfo file;
+      file.directory = directory;
+      file.name = name;
+      file.sizeInBytes = attributes->size;
+      file.modifiedTime = attributes->mtime;
+      files.push_back(file);
+    }
+    sftp_attributes_free(attributes);
+  }
+
+  bool complete = sftp_dir_eof(dir) != 0;
+  sftp_closedir(dir);
+
+  return complete ? GEC_CATALOG_OK : GEC_CATALOG_NETWORK_ERROR;
+}
+
+int GEC_RecordingCatalog::revalidate(GEC_SftpSessionPool& pool)
+{
+  if (m_directories.empty()) {
+    return scan(pool, m_root);
+  }
+
+  std::vector<std::string> known;
+  std::vector<uint64_t> knownTimes;
+  std::map<std::string, uint64_t>::iterator itDir;
+  for (itDir = m_directories.begin(); itDir != m_directories.end(); ++itDir) {
+    known.push_back(itDir->first);
+    knownTimes.push_back(itDir->second);
+  }
+
+  std::set<std::string> withIncomplete;
+  for (size_t i = 0; i < m_recordings.size(); ++i) {
+    if (!m_recordings[i].isComplete()) {
+      withIncomplete.insert(m_recordings[i].directory);
+    }
+  }
+
+  // One stat per known directory, spread over the pool
+  enum { UNCHANGED, CHANGED, GONE, FAILED };
+  std::vector<int> states(known.size(), FAILED);
+  bool allStatted = runOnPool(pool, known.size(), [&](sftp_session sftp, size_t i) {
+    sftp_attributes attributes = sftp_stat(sftp, known[i].c_str());
+    if (attributes == NULL) {
+      if (sftp_get_error(sftp) != SSH_FX_NO_SUCH_FILE) {
+        return false;
+      }
+      states[i] = GONE;
+      return true;
+    }
+    bool changed = attributes->mtime != knownTimes[i] || withIncomplete.count(known[i]) != 0;
+    states[i] = changed ? CHANGED : UNCHANGED;
+    sftp_attributes_free(attributes);
+    return true;
+  });
+  // Directories which could not be checked keep their recordings unchanged
+  size_t numFailed = std::count(states.begin(), states.end(), static_cast<int>(FAILED));
+  if (numFailed == states.size()) {
+    return GEC_CATALOG_NETWORK_ERROR;
+  }
+
+  std::vector<std::string> gone;
+  std::vector<std::string> changed;
+  std::set<std::string> unchanged;
+  for (size_t i = 0; i < known.size(); ++i) {
+    if (states[i] == GONE) {
+      gone.push_back(known[i]);
+    } else if (states[i] == CHANGED) {
+      changed.push_back(known[i]);
+    } else if (states[i] == UNCHANGED) {
+      unchanged.insert(known[i]);
+    }
+  }
+
+  // Recordings still being written grow without changing their directory, so their files are stat'ed
+  std::vector<size_t> unfinished;
+  for (size_t i = 0; i < m_recordings.size(); ++i) {
+    if (!m_recordings[i].isFinal && unchanged.count(m_recordings[i].directory) != 0) {
+      unfinished.push_back(i);
+    }
+  }
+  std::vector<char> hasChanged(unfinished.size(), 0);
+  bool allRestatted = runOnPool(pool, unfinished.size(), [&](sftp_session sftp, size_t i) {
+    bool changedFiles = false;
+    bool ok = restatRecording(sftp, m_recordings[unfinished[i]], changedFiles);
+    hasChanged[i] = changedFiles ? 1 : 0;
+    return ok;
+  });
+  std::vector<size_t> grown;
+  std::vector<GEC_Recording> grownRecordings;
+  for (size_t i = 0; i < unfinished.size(); ++i) {
+    if (hasChanged[i]) {
+      grown.push_back(unfinished[i]);
+      grownRecordings.push_back(m_recordings[unfinished[i]]);
+    }
+  }
+  std::set<std::string> failed;
+  bool allGrownRead = readTimeSpans(pool, grownRecordings, failed);
+  for (size_t i = 0; i < grown.size(); ++i) {
+    m_recordings[grown[i]] = grownRecordings[i];
+  }
+
+  // Drop removed directories together with everything below them
+  for (size_t g = 0; g < gone.size(); ++g) {
+    for (itDir = m_directories.begin(); itDir != m_directories.end(); ) {
+      if (isBelow(itDir->first, gone[g])) {
+        m_directories.erase(itDir++);
+      } else {
+        ++itDir;
+      }
+    }
+  }
+
+  // Re-list changed directories, one level each
+  std::mutex resultMutex;
+  std::vector<FileInfo> files;
+  std::vector<std::string> newSubdirectories;
+  std::set<std::string> relisted;
+  bool allListed = runOnPool(pool, changed.size(), [&](sftp_session sftp, size_t i) {
+    std::vector<FileInfo> dirFiles;
+    std::vector<std::string> subdirectories;
+    uint64_t modifiedTime = 0;
+    if (listDirectory(sftp, changed[i], dirFiles, subdirectories, modifiedTime) != GEC_CATALOG_OK) {
+      return false;
+    }
+
+    std::unique_lock<std::mutex> lock(resultMutex);
+    files.insert(files.end(), dirFiles.begin(), dirFiles.end());
+    m_directories[changed[i]] = modifiedTime;
+    relisted.insert(changed[i]);
+    for (size_t s = 0; s < subdirectories.size(); ++s) {
+      if (m_directories.find(subdirectories[s]) == m_directories.end()) {
+        newSubdirectories.push_back(subdirectories[s]);
+      }
+    }
+    return true;
+  });
+
+  std::vector<GEC_Recording> kept;
+  for (size_t i = 0; i < m_recordings.size(); ++i) {
+    const std::string& directory = m_recordings[i].directory;
+    bool isGone = false;
+    for (size_t g = 0; g < gone.size() && !isGone; ++g) {
+      isGone = isBelow(directory, gone[g]);
+    }
+    if (!isGone && relisted.count(directory) == 0) {
+      kept.push_back(m_recordings[i]);
+    }
+  }
+
+  std::vector<GEC_Recording> found;
+  addFiles(files, found);
+  bool allRead = readTimeSpans(pool, found, failed);
+  kept.insert(kept.end(), found.begin(), found.end());
+  m_recordings.swap(kept);
+  for (std::set<std::string>::iterator it = failed.begin(); it != failed.end(); ++it) {
+    m_directories[*it] = 0;
+  }
+
+  int rc = (allStatted && allRestatted && allGrownRead && allListed && allRead) ? GEC_CATALOG_OK
+                                                                               : GEC_CATALOG_INCOMPLETE;
+  for (size_t s = 0; s < newSubdirectories.size(); ++s) {
+    int rcTree = scanTree(pool, newSubdirectories[s], m_recordings, m_directories);
+    if (rcTree != GEC_CATALOG_OK) {
+      rc = GEC_CATALOG_INCOMPLETE;
+    }
+  }
+
+  sortRecordings();
+  return rc;
+}
+
+static bool isRecordingBefore(const GEC_Recording& a, const GEC_Recording& b)
+{
+  return (a.directory != b.directory) ? a.directory < b.directory : a.name < b.name;
+}
+
+void GEC_RecordingCatalog::sortRecordings()
+{
+  std::sort(m_recordings.begin(), m_recordings.end(), isRecordingBefore);
+}
+
+int GEC_RecordingCatalog::save(std::string fileName)
+{
+  std::string strings;
+  std::map<std::string, uint32_t> directoryIndex;
+
+  CatalogFileHeader header;
+  header.magic = CATALOG_FILE_MAGIC;
+  header.version = CATALOG_FILE_VERSION;
+  header.numDirectories = static_cast<uint32_t>(m_directories.size());
+  header.numRecordings = static_cast<uint32_t>(m_recordings.size());
+  header.rootOffset = 0;
+  header.rootLength = static_cast<uint32_t>(m_root.length());
+  strings += m_root;
+
+  std::vector<CatalogFileDirectory> directories;
+  std::map<std::string, uint64_t>::iterator itDir;
+  for (itDir = m_directories.begin(); itDir != m_directories.end(); ++itDir) {
+    CatalogFileDirectory directory;
+    directory.modifiedTime = itDir->second;
+    directory.pathOffset = static_cast<uint32_t>(strings.length());
+    directory.pathLength = static_cast<uint32_t>(itDir->first.length());
+    strings += itDir->first;
+    directoryIndex[itDir->first] = static_cast<uint32_t>(directories.size());
+    directories.push_back(directory);
+  }
+
+  std::vector<CatalogFileRecording> recordings;
+  for (size_t i = 0; i < m_recordings.size(); ++i) {
+    const GEC_Recording& source = m_recordings[i];
+    std::map<std::string, uint32_t>::iterator itIndex = directoryIndex.find(source.directory);
+    if (itIndex == directoryIndex.end()) {
+      continue;
+    }
+
+    CatalogFileRecording recording;
+    recording.directoryIndex = itIndex->second;
+    recording.nameOffset = static_cast<uint32_t>(strings.length());
+    recording.nameLength = static_cast<uint32_t>(source.name.length());
+    recording.files = source.files | (source.isFinal ? CATALOG_FILE_FINAL : 0);
+    recording.dataSizeInBytes = source.dataSizeInBytes;
+    recording.indexSizeInBytes = source.indexSizeInBytes;
+    recording.metaSizeInBytes = source.metaSizeInBytes;
+    recording.numIndexEntries = source.numIndexEntries;
+    recording.startTimeInNs = source.startTimeInNs;
+    recording.endTimeInNs = source.endTimeInNs;
+    recording.dataModifiedTime = source.dataModifiedTime;
+    strings += source.name;
+    recordings.push_back(recording);
+  }
+  header.numRecordings = static_cast<uint32_t>(recordings.size());
+  header.stringPoolSize = strings.length();
+
+  FILE* file = fopen(fileName.c_str(), "wb");
+  if (file == NULL) {
+    return GEC_CATALOG_FILE_ERROR;
+  }
+
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+    && (directories.empty() || fwrite(&directories[0], sizeof(directories[0]), directories.size(), file) == directories.size())
+    && (recordings.empty() || fwrite(&recordings[0], sizeof(recordings[0]), recordings.size(), file) == recordings.size())
+    && (strings.empty() || fwrite(strings.data(), 1, strings.length(), file) == strings.length());
+  ok = (fclose(file) == 0) && ok;
+
+  return ok ? GEC_CATALOG_OK : GEC_CATALOG_FILE_ERROR;
+}
+
+int GEC_RecordingCatalog::load(std::string fileName)
+{
+  FILE* file = fopen(fileName.c_str(), "rb");
+  if (file == NULL) {
+    return GEC_CATALOG_FILE_ERROR;
+  }
+
+  // Read the whole file in one go, and decode it from memory
+  std::vector<char> buffer;
+  char chunk[65536];
+  size_t nbytes;
+  while ((nbytes = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    buffer.insert(buffer.end(), chunk, chunk + nbytes);
+  }
+  bool readError = ferror(file) != 0;
+  fclose(file);
+  if (readError) {
+    return GEC_CATALOG_FILE_ERROR;
+  }
+
+  CatalogFileHeader header;
+  if (buffer.size() < sizeof(header)) {
+    return GEC_CATALOG_FORMAT_ERROR;
+  }
+  memcpy(&header, &buffer[0], sizeof(header));
+  if (header.magic != CATALOG_FILE_MAGIC || header.version != CATALOG_FILE_VERSION) {
+    return GEC_CATALOG_FORMAT_ERROR;
+  }
+
+  uint64_t directoriesOffset = sizeof(header);
+  uint64_t recordingsOffset = directoriesOffset + uint64_t(header.numDirectories) * sizeof(CatalogFileDirectory);
+  uint64_t stringsOffset = recordingsOffset + uint64_t(header.numRecordings) * sizeof(CatalogFileRecording);
+  if (stringsOffset + header.stringPoolSize != buffer.size()) {
+    return GEC_CATALOG_FORMAT_ERROR;
+  }
+  const char* strings = &buffer[0] + stringsOffset;
+  if (uint64_t(header.rootOffset) + header.rootLength > header.stringPoolSize) {
+    return GEC_CATALOG_FORMAT_ERROR;
+  }
+
+  std::string root(strings + header.rootOffset, header.rootLength);
+  std::vector<std::string> paths;
+  std::map<std::string, uint64_t> directories;
+  for (uint32_t i = 0; i < header.numDirectories; ++i) {
+    CatalogFileDirectory directory;
+    memcpy(&directory, &buffer[0] + directoriesOffset + i * sizeof(directory), sizeof(directory));
+    if (uint64_t(directory.pathOffset) + directory.pathLength > header.stringPoolSize) {
+      return GEC_CATALOG_FORMAT_ERROR;
+    }
+    paths.push_back(std::string(strings + directory.pathOffset, directory.pathLength));
+    directories[paths.back()] = directory.modifiedTime;
+  }
+
+  std::vector<GEC_Recording> recordings(header.numRecordings);
+  for (uint32_t i = 0; i < header.numRecordings; ++i) {
+    CatalogFileRecording source;
+    memcpy(&source, &buffer[0] + recordingsOffset + i * sizeof(source), sizeof(source));
+    if (source.directoryIndex >= paths.size()
+        || uint64_t(source.nameOffset) + source.nameLength > header.stringPoolSize) {
+      return GEC_CATALOG_FORMAT_ERROR;
+    }
+
+    GEC_Recording& recording = recordings[i];
+    recording.directory = paths[source.directoryIndex];
+    recording.name.assign(strings + source.nameOffset, source.nameLength);
+    recording.files = source.files & ~CATALOG_FILE_FINAL;
+    recording.isFinal = (source.files & CATALOG_FILE_FINAL) != 0;
+    recording.dataSizeInBytes = source.dataSizeInBytes;
+    recording.indexSizeInBytes = source.indexSizeInBytes;
+    recording.metaSizeInBytes = source.metaSizeInBytes;
+    recording.numIndexEntries = source.numIndexEntries;
+    recording.startTimeInNs = source.startTimeInNs;
+    recording.endTimeInNs = source.endTimeInNs;
+    recording.dataModifiedTime = source.dataModifiedTime;
+  }
+
+  m_root = root;
+  m_directories.swap(directories);
+  m_recordings.swap(recordings);
+
+  return GEC_CATALOG_OK;
+}
@@ -0,0 +1,114 @@
+#ifndef GEC_RECORDINGCATALOG_H_
+#define GEC_RECORDINGCATALOG_H_
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "GEC_SftpSessionPool.h"
+
+#define GEC_CATALOG_OK              0
+#define GEC_CATALOG_NETWORK_ERROR   (-1)
+#define GEC_CATALOG_INCOMPLETE      (-2)
+#define GEC_CATALOG_FILE_ERROR      (-3)
+#define GEC_CATALOG_FORMAT_ERROR    (-4)
+
+#define GEC_RECORDING_HAS_DATA   (1 << 0)
+#define GEC_RECORDING_HAS_INDEX  (1 << 1)
+#define GEC_RECORDING_HAS_META   (1 << 2)
+#define GEC_RECORDING_HAS_ALL    (GEC_RECORDING_HAS_DATA | GEC_RECORDING_HAS_INDEX | GEC_RECORDING_HAS_META)
+
+/**
+  One recording, that is the .dat, .idx, and .meta files sharing a base
+  name in one directory
+*/
+struct GEC_Recording
+{
+  GEC_Recording()
+    : files(0)
+    , dataSizeInBytes(0)
+    , indexSizeInBytes(0)
+    , metaSizeInBytes(0)
+    , numIndexEntries(0)
+    , startTimeInNs(0)
+    , endTimeInNs(0)
+    , dataModifiedTime(0)
+    , isFinal(false)
+  {}
+
+  bool isComplete() const { return (files & GEC_RECORDING_HAS_ALL) == GEC_RECORDING_HAS_ALL; }
+  uint64_t getTotalSizeInBytes() const { return dataSizeInBytes + indexSizeInBytes + metaSizeInBytes; }
+
+  std::string directory;
+  std::string name;
+  uint32_t files;              // GEC_RECORDING_HAS_* bits
+  uint64_t dataSizeInBytes;
+  uint64_t indexSizeInBytes;
+  uint64_t metaSizeInBytes;
+  uint64_t numIndexEntries;
+  uint64_t startTimeInNs;      // 0 when the .meta file has no timing records
+  uint64_t endTimeInNs;
+  uint64_t dataModifiedTime;
+  bool isFinal;                // The .dat file did not change between two checks
+};
+
+/**
+  Catalog of all recordings below a root directory on a recorder
+
+  @ref scan() walks the whole tree with GEC_TreeScanner and reads the
+  first and last timing record of every .meta file. The result is kept
+  together with the modification time of every directory, and can be
+  written to a local file with @ref save().
+
+  After @ref load(), @ref revalidate() stats the known directories and
+  only lists those whose modification time has changed, or which hold an
+  incomplete recording. A directory that could not be listed, or whose
+  .meta files could not be read, is kept with a time of 0 so that it is
+  listed again.
+
+  Writing to a file does not change the time of its directory, so the
+  files of a recording that is not final are stat'ed on every
+  @ref revalidate(), and its sizes and time span are read again when its
+  .dat file has changed. A recording becomes final when its .dat file,
+  not empty, is found unchanged; one that is continued later is only
+  seen again when its directory changes, or by a new @ref scan().
+*/
+class GEC_RecordingCatalog
+{
+public:
+  int scan(GEC_SftpSessionPool& pool, std::string root);
+  int revalidate(GEC_SftpSessionPool& pool);
+
+  int load(std::string fileName);
+  int save(std::string fileName);
+
+  std::string getRoot() { return m_root; }
+  const std::vector<GEC_Recording>& getRecordings() { return m_recordings; }
+
+private:
+  struct FileInfo
+  {
+    std::string directory;
+    std::string name;
+    uint64_t sizeInBytes;
+    uint64_t modifiedTime;
+  };
+
+  void addFiles(const std::vector<FileInfo>& files, std::vector<GEC_Recording>& recordings);
+  bool restatRecording(sftp_session sftp, GEC_Recording& recording, bool& hasChanged);
+  bool readTimeSpans(GEC_SftpSessionPool& pool, std::vector<GEC_Recording>& recordings,
+                     std::set<std::string>& failedDirectories);
+  int scanTree(GEC_SftpSessionPool& pool, std::string root, std::vector<GEC_Recording>& recordings,
+               std::map<std::string, uint64_t>& directories);
+  int listDirectory(sftp_session sftp, std::string directory, std::vector<FileInfo>& files,
+                    std::vector<std::string>& subdirectories, uint64_t& modifiedTime);
+  void sortRecordings();
+
+  std::string m_root;
+  std::vector<GEC_Recording> m_recordings;
+  std::map<std::string, uint64_t> m_directories;  // Directory path and its modification time, 0 if not fully read
+};
+
+#endif /* GEC_RECORDINGCATALOG_H_ */
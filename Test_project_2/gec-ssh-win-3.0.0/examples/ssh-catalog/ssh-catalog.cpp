@@ -0,0 +1,113 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdio.h>
+
+#include "ssh-common.h"
+
+#include "GEC_RecordingCatalog.h"
+#include "GEC_SftpSessionPool.h"
+
+void printUsage()
+{
+  std::cout << "Usage: ssh-catalog <server> <path> <catalog-file> [--channels=<n>] [--rescan]" << std::endl
+            << std::endl
+            << "where: <server> is the host name or IP address to the server" << std::endl
+            << "       <path> is the full path of the server directory holding the recordings" << std::endl
+            << "       <catalog-file> is the local file the catalog is loaded from and saved to" << std::endl
+            << "       <n> is the number of SFTP sessions used in parallel (default 4)" << std::endl
+            << "       --rescan ignores a saved catalog, and scans the whole tree" << std::endl;
+}
+
+static bool hasPrefix(const std::string& text, const std::string& prefix)
+{
+  return text.compare(0, prefix.length(), prefix) == 0;
+}
+
+static std::string formatFiles(uint32_t files)
+{
+  std::string text;
+  text += (files & GEC_RECORDING_HAS_DATA) ? "d" : "-";
+  text += (files & GEC_RECORDING_HAS_INDEX) ? "i" : "-";
+  text += (files & GEC_RECORDING_HAS_META) ? "m" : "-";
+  return text;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 4) {
+    std::cout << "ERROR: Incorrect number of arguments" << std::endl
+              << std::endl;
+    printUsage();
+    return (-1);
+  }
+
+  size_t numChannels = 4;
+  bool rescan = false;
+  for (int i = 4; i < argc; ++i) {
+    std::string option(argv[i]);
+    if (hasPrefix(option, "--channels=")) {
+      numChannels = strtoul(option.substr(11).c_str(), NULL, 10);
+    } else if (option == "--rescan") {
+      rescan = true;
+    } else {
+      std::cout << "ERROR: Unknown option '" << option << "'" << std::endl
+                << std::endl;
+      printUsage();
+      return (-1);
+    }
+  }
+
+  GEC_SftpSessionPool pool(argv[1], "root", "", numChannels);
+  GEC_RecordingCatalog catalog;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  int rc;
+  bool revalidated = false;
+  if (!rescan && catalog.load(argv[3]) == GEC_CATALOG_OK && catalog.getRoot() == argv[2]) {
+    rc = catalog.revalidate(pool);
+    revalidated = true;
+  } else {
+    rc = catalog.scan(pool, argv[2]);
+  }
+
+  double elapsedInS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if (rc == GEC_CATALOG_NETWORK_ERROR) {
+    std::cout << "ERROR: Could not read " << argv[2] << " on " << argv[1] << std::endl;
+    return (-1);
+  }
+
+  const std::vector<GEC_Recording>& recordings = catalog.getRecordings();
+  uint64_t totalBytes = 0;
+  for (size_t i = 0; i < recordings.size(); ++i) {
+    const GEC_Recording& recording = recordings[i];
+    std::cout << formatFiles(recording.files) << " "
+              << std::setw(16) << std::right << recording.getTotalSizeInBytes() << " "
+              << std::setw(10) << recording.numIndexEntries << " ";
+    if (recording.endTimeInNs > recording.startTimeInNs) {
+      std::cout << std::setw(10) << std::fixed << std::setprecision(3)
+                << (recording.endTimeInNs - recording.startTimeInNs) / 1e9 << " s ";
+    } else {
+      std::cout << std::setw(12) << "- ";
+    }
+    std::cout << recording.directory << "/" << recording.name << std::endl;
+    totalBytes += recording.getTotalSizeInBytes();
+  }
+
+  std::cout << std::endl << recordings.size() << " recordings, " << totalBytes << " bytes, "
+            << (revalidated ? "revalidated" : "scanned") << " in "
+            << std::fixed << std::setprecision(2) << elapsedInS << " s" << std::endl;
+  if (rc == GEC_CATALOG_INCOMPLETE) {
+    std::cout << "WARNING: Some directories or files could not be read" << std::endl;
+  }
+
+  if (catalog.save(argv[3]) != GEC_CATALOG_OK) {
+    std::cout << "ERROR: Could not write " << argv[3] << std::endl;
+    return (-1);
+  }
+
+  return (rc == GEC_CATALOG_OK) ? 0 : 1;
+}
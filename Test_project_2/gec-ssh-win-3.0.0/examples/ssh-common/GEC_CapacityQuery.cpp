@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "GEC_CapacityQuery.h"
+
+GEC_CapacityQuery::GEC_CapacityQuery(std::string user, std::string password, size_t sessionsPerHost)
+  : m_user(user)
+  , m_password(password)
+  , m_sessionsPerHost(std::max<size_t>(sessionsPerHost, 1))
+{
+}
+
+GEC_CapacityQuery::~GEC_CapacityQuery()
+{
+  std::map<std::string, GEC_SftpSessionPool*>::iterator it;
+  for (it = m_pools.begin(); it != m_pools.end(); ++it) {
+    delete it->second;
+  }
+}
+
+void GEC_CapacityQuery::add(std::string host, std::string path)
+{
+  m_paths.push_back(std::make_pair(host, path));
+  if (m_pools.find(host) == m_pools.end()) {
+    m_pools[host] = new GEC_SftpSessionPool(host, m_user, m_password, m_sessionsPerHost);
+  }
+}
+
+int GEC_CapacityQuery::query(sftp_session sftp, std::string path, GEC_Capacity& capacity)
+{
+  if (!sftp_extension_supported(sftp, "statvfs@openssh.com", "2")) {
+    capacity.rc = GEC_CAPACITY_NOT_SUPPORTED;
+    return capacity.rc;
+  }
+
+  sftp_statvfs_t statvfs = sftp_statvfs(sftp, path.c_str());
+  if (statvfs == NULL) {
+    int error = sftp_get_error(sftp);
+    capacity.rc = (error == SSH_FX_NO_SUCH_FILE || error == SSH_FX_NO_SUCH_PATH)
+      ? GEC_CAPACITY_NOT_EXISTING : GEC_CAPACITY_NETWORK_ERROR;
+    return capacity.rc;
+  }
+
+  // Block counts are in units of the fundamental block size
+  uint64_t blockSize = (statvfs->f_frsize != 0) ? statvfs->f_frsize : statvfs->f_bsize;
+  capacity.blockSizeInBytes = blockSize;
+  capacity.totalBytes = statvfs->f_blocks * blockSize;
+  capacity.freeBytes = statvfs->f_bfree * blockSize;
+  capacity.availableBytes = statvfs->f_bavail * blockSize;
+  capacity.totalInodes = statvfs->f_files;
+  capacity.freeInodes = statvfs->f_ffree;
+  capacity.availableInodes = statvfs->f_favail;
+  capacity.fsid = statvfs->f_fsid;
+  capacity.rc = GEC_CAPACITY_OK;
+  sftp_statvfs_free(statvfs);
+
+  return capacity.rc;
+}
+
+void GEC_CapacityQuery::runHost(GEC_SftpSessionPool* pool, std::vector<GEC_Capacity*> capacities)
+{
+  std::atomic<size_t> iNext(0);
+
+  size_t numThreads = std::min(pool->getMaxSessions(), capacities.size());
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < numThreads; ++t) {
+    threads.push_back(std::thread([&]() {
+      sftp_session sftp = pool->acquire();
+      if (sftp == NULL) {
+        return;
+      }
+      size_t i;
+      while ((i = iNext++) < capacities.size()) {
+        query(sftp, capacities[i]->path, *capacities[i]);
+      }
+      pool->release(sftp, !ssh_is_connected(sftp->session));
+    }));
+  }
+  for (size_t t = 0; t < threads.size(); ++t) {
+    threads[t].join();
+  }
+}
+
+int GEC_CapacityQuery::run(std::vector<GEC_Capacity>& capacities)
+{
+  capacities.assign(m_paths.size(), GEC_Capacity());
+
+  std::map<std::string, std::vector<GEC_Capacity*> > byHost;
+  for (size_t i = 0; i < m_paths.size(); ++i) {
+    capacities[i].host = m_paths[i].first;
+    capacities[i].path = m_paths[i].second;
+    byHost[m_paths[i].first].push_back(&capacities[i]);
+  }
+
+  std::vector<std::thread> threads;
+  std::map<std::string, std::vector<GEC_Capacity*> >::iterator it;
+  for (it = byHost.begin(); it != byHost.end(); ++it) {
+    threads.push_back(std::thread(&GEC_CapacityQuery::runHost, this, m_pools[it->first], it->second));
+  }
+  for (size_t t = 0; t < threads.size(); ++t) {
+    threads[t].join();
+  }
+
+  for (size_t i = 0; i < capacities.size(); ++i) {
+    if (capacities[i].rc != GEC_CAPACITY_OK) {
+      return capacities[i].rc;
+    }
+  }
+  return GEC_CAPACITY_OK;
+}
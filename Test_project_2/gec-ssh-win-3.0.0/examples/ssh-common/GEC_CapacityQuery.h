@@ -0,0 +1,113 @@
+#ifndef GEC_CAPACITYQUERY_H_
+#define GEC_CAPACITYQUERY_H_
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "GEC_SftpSessionPool.h"
+
+#define GEC_CAPACITY_OK              0
+#define GEC_CAPACITY_NETWORK_ERROR   (-1)
+#define GEC_CAPACITY_NOT_EXISTING    (-2)
+#define GEC_CAPACITY_NOT_SUPPORTED   (-3)
+
+/**
+  Capacity of the file system holding one path on one server
+*/
+struct GEC_Capacity
+{
+  GEC_Capacity()
+    : rc(GEC_CAPACITY_NETWORK_ERROR)
+    , blockSizeInBytes(0)
+    , totalBytes(0)
+    , freeBytes(0)
+    , availableBytes(0)
+    , totalInodes(0)
+    , freeInodes(0)
+    , availableInodes(0)
+    , fsid(0)
+  {}
+
+  std::string host;
+  std::string path;
+  int rc;                     // GEC_CAPACITY_OK, or the reason the figures below are not valid
+  uint64_t blockSizeInBytes;
+  uint64_t totalBytes;
+  uint64_t freeBytes;         // Free including the blocks reserved for root
+  uint64_t availableBytes;    // Free for unprivileged users
+  uint64_t totalInodes;
+  uint64_t freeInodes;
+  uint64_t availableInodes;
+  uint64_t fsid;              // Equal for paths on the same file system of one host
+};
+
+/**
+  Batch of file system capacity queries
+
+  Each query is a single SFTP statvfs request (the OpenSSH
+  'statvfs@openssh.com' extension), so no remote process is started and
+  no command output is parsed. All paths added for one host share a pool
+  of SFTP sessions, and all hosts are queried at the same time.
+
+  A query object can be run any number of times. The session pools are
+  kept between runs, so repeated queries, e.g. for refreshing a display,
+  do not repeat the SSH handshake.
+*/
+class GEC_CapacityQuery
+{
+public:
+  GEC_CapacityQuery(std::string user, std::string password, size_t sessionsPerHost);
+  ~GEC_CapacityQuery();
+
+  /**
+    Adds a path to the batch
+
+    @param host
+    The host name or IP address of the server
+    @param path
+    Any path on the file system to query, usually its mount point
+  */
+  void add(std::string host, std::string path);
+
+  /**
+    Queries the capacity of all paths added
+
+    @param capacities
+    Receives one entry per added path, in the order the paths were added
+
+    @return
+    GEC_CAPACITY_OK if all queries succeeded, otherwise the error of the
+    first failed query. The result of every query is in its entry.
+  */
+  int run(std::vector<GEC_Capacity>& capacities);
+
+  /**
+    Queries the capacity of the file system holding one path
+
+    @param sftp
+    An open SFTP session to the server
+    @param capacity
+    Receives the figures. The host and path members are left unchanged.
+
+    @return
+    GEC_CAPACITY_OK on success
+  */
+  static int query(sftp_session sftp, std::string path, GEC_Capacity& capacity);
+
+private:
+  GEC_CapacityQuery(const GEC_CapacityQuery&);
+  GEC_CapacityQuery& operator=(const GEC_CapacityQuery&);
+
+  void runHost(GEC_SftpSessionPool* pool, std::vector<GEC_Capacity*> capacities);
+
+  std::string m_user;
+  std::string m_password;
+  size_t m_sessionsPerHost;
+
+  std::vector<std::pair<std::string, std::string> > m_paths;  // Host and path
+  std::map<std::string, GEC_SftpSessionPool*> m_pools;         // One per host
+};
+
+#endif /* GEC_CAPACITYQUERY_H_ */
@@ -0,0 +1,72 @@
+#ifndef GEC_RECORDINGFORMAT_H_
+#define GEC_RECORDINGFORMAT_H_
+
+#include <stdint.h>
+
+/*
+  Layout of the files written by a recording session
+
+  Every recording created by GEC_ISfpdpRecorder::create() consists of
+  three files with the same base name in one directory:
+
+    <name>.dat   the received 32 bit SFPDP data words, back to back
+    <name>.idx   one GEC_IndexEntry per SYNC or CRC error event
+    <name>.meta  one GEC_MetaHeader followed by one GEC_MetaRecord per
+                 timing sample taken from the HW timer
+
+  The recorder API documents what the files contain but not their binary
+  layout. The structures below are the layout the client tools assume.
+  All fields are little endian. Keep every tool that reads or writes
+  recording files on these definitions, so a layout change is made here
+  only.
+*/
+
+#define GEC_RECORDING_DATA_EXTENSION   ".dat"
+#define GEC_RECORDING_INDEX_EXTENSION  ".idx"
+#define GEC_RECORDING_META_EXTENSION   ".meta"
+
+#define GEC_RECORDING_WORD_SIZE  4
+
+#define GEC_INDEX_EVENT_SYNC       1
+#define GEC_INDEX_EVENT_CRC_ERROR  2
+
+struct GEC_IndexEntry
+{
+  uint64_t dataOffset;  // Byte offset in the .dat file where the event occurred
+  uint32_t event;       // GEC_INDEX_EVENT_SYNC or GEC_INDEX_EVENT_CRC_ERROR
+  uint32_t reserved;
+};
+
+#define GEC_META_MAGIC    0x4154454d  // "META"
+#define GEC_META_VERSION  1
+
+struct GEC_MetaHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint64_t startTimeInNs;       // Wall-clock time at timer tick 0, in ns since 1970-01-01 UTC
+  uint64_t timerFrequencyInHz;  // Rate of the HW timer the ticks are counted in
+};
+
+struct GEC_MetaRecord
+{
+  uint64_t timerTicks;  // HW timer value when the word at dataOffset was received
+  uint64_t dataOffset;  // Byte offset in the .dat file
+};
+
+static_assert(sizeof(GEC_IndexEntry) == 16, "GEC_IndexEntry must match the file layout");
+static_assert(sizeof(GEC_MetaHeader) == 24, "GEC_MetaHeader must match the file layout");
+static_assert(sizeof(GEC_MetaRecord) == 16, "GEC_MetaRecord must match the file layout");
+
+inline uint64_t GEC_metaTicksToTimeInNs(const GEC_MetaHeader& header, uint64_t timerTicks)
+{
+  if (header.timerFrequencyInHz == 0) {
+    return header.startTimeInNs;
+  }
+  uint64_t seconds = timerTicks / header.timerFrequencyInHz;
+  uint64_t remainder = timerTicks % header.timerFrequencyInHz;
+  return header.startTimeInNs + seconds * 1000000000ULL
+    + remainder * 1000000000ULL / header.timerFrequencyInHz;
+}
+
+#endif /* GEC_RECORDINGFORMAT_H_ */
@@ -0,0 +1,57 @@
+#ifndef GEC_SFPDPLINKRATE_H_
+#define GEC_SFPDPLINKRATE_H_
+
+#include <stdint.h>
+#include <string>
+
+/*
+  Serial FPDP link rates, and the data rate they deliver to the recorder
+
+  The speed indices are the values of the GEC_SFPDP_*_GBPS constants of
+  the recorder API, in the same order, so a value passed to
+  GEC_ISfpdpRecorder::setLinkSpeed() can be used here directly.
+
+  Serial FPDP uses 8b/10b line coding, so a link carries one data byte per
+  ten line bits. The data rate below is the upper bound for a fully
+  loaded link; framing takes a small part of it.
+*/
+
+#define GEC_SFPDP_MAX_PORTS  8
+
+#define GEC_SFPDP_NUM_LINK_SPEEDS  5
+
+inline uint64_t GEC_sfpdpLineRateInBitsPerSecond(int speed)
+{
+  static const uint64_t lineRates[GEC_SFPDP_NUM_LINK_SPEEDS] = {
+    1062500000ULL,  // GEC_SFPDP_1_0625_GBPS
+    2125000000ULL,  // GEC_SFPDP_2_125_GBPS
+    2500000000ULL,  // GEC_SFPDP_2_5_GBPS
+    3125000000ULL,  // GEC_SFPDP_3_125_GBPS
+    4250000000ULL   // GEC_SFPDP_4_25_GBPS
+  };
+  return (speed >= 0 && speed < GEC_SFPDP_NUM_LINK_SPEEDS) ? lineRates[speed] : 0;
+}
+
+inline uint64_t GEC_sfpdpDataRateInBytesPerSecond(int speed)
+{
+  return GEC_sfpdpLineRateInBitsPerSecond(speed) / 10;
+}
+
+/**
+  Converts a link speed given in Gbps, as in "4.25", to its speed index
+
+  @return
+  The speed index, or -1 if the text is not one of the defined speeds
+*/
+inline int GEC_sfpdpParseLinkSpeed(const std::string& gbps)
+{
+  static const char* names[GEC_SFPDP_NUM_LINK_SPEEDS] = { "1.0625", "2.125", "2.5", "3.125", "4.25" };
+  for (int speed = 0; speed < GEC_SFPDP_NUM_LINK_SPEEDS; ++speed) {
+    if (gbps == names[speed]) {
+      return speed;
+    }
+  }
+  return -1;
+}
+
+#endif /* GEC_SFPDPLINKRATE_H_ */
@@ -0,0 +1,104 @@
+#include "GEC_SftpSessionPool.h"
+
+#include "ssh-common.h"
+
+GEC_SftpSessionPool::GEC_SftpSessionPool(std::string host, std::string user, std::string password,
+                                         size_t maxSessions)
+  : m_host(host)
+  , m_user(user)
+  , m_password(password)
+  , m_maxSessions(maxSessions > 0 ? maxSessions : 1)
+  , m_numOpen(0)
+{
+  m_initialized = (acquire_ssh() == SSH_OK);
+}
+
+GEC_SftpSessionPool::~GEC_SftpSessionPool()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  std::vector<sftp_session>::iterator it;
+  for (it = m_idle.begin(); it != m_idle.end(); ++it) {
+    closeSession(*it);
+  }
+  m_idle.clear();
+  if (m_initialized) {
+    release_ssh();
+  }
+}
+
+sftp_session GEC_SftpSessionPool::acquire()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (m_idle.empty() && m_numOpen >= m_maxSessions) {
+    m_released.wait(lock);
+  }
+
+  if (!m_idle.empty()) {
+    sftp_session sftp = m_idle.back();
+    m_idle.pop_back();
+    return sftp;
+  }
+
+  // Reserve the slot before connecting, so the handshake runs unlocked
+  ++m_numOpen;
+  lock.unlock();
+
+  sftp_session sftp = openSession();
+  if (sftp == NULL) {
+    lock.lock();
+    --m_numOpen;
+    m_released.notify_one();
+  }
+  return sftp;
+}
+
+void GEC_SftpSessionPool::release(sftp_session sftp, bool broken)
+{
+  if (sftp == NULL) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (broken) {
+    --m_numOpen;
+    closeSession(sftp);
+  } else {
+    m_idle.push_back(sftp);
+  }
+  m_released.notify_one();
+}
+
+sftp_session GEC_SftpSessionPool::openSession()
+{
+  if (!m_initialized) {
+    return NULL;
+  }
+  ssh_session session = connect_ssh_noninteractive(m_host.c_str(), m_user.c_str(), m_password.c_str(), SSH_LOG_NOLOG);
+  if (session == NULL) {
+    return NULL;
+  }
+
+  sftp_session sftp = sftp_new(session);
+  if (sftp == NULL) {
+    ssh_disconnect(session);
+    ssh_free(session);
+    return NULL;
+  }
+
+  if (sftp_init(sftp) != SSH_OK) {
+    sftp_free(sftp);
+    ssh_disconnect(session);
+    ssh_free(session);
+    return NULL;
+  }
+
+  return sftp;
+}
+
+void GEC_SftpSessionPool::closeSession(sftp_session sftp)
+{
+  ssh_session session = sftp->session;
+  sftp_free(sftp);
+  ssh_disconnect(session);
+  ssh_free(session);
+}
@@ -0,0 +1,84 @@
+#ifndef GEC_SFTPSESSIONPOOL_H_
+#define GEC_SFTPSESSIONPOOL_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <libssh/libssh.h>
+#include <libssh/sftp.h>
+
+/**
+  Pool of authenticated SFTP sessions to one server
+
+  Every session in the pool has its own SSH connection. libssh does not
+  allow one SSH session to be used from several threads at the same time,
+  so a session handed out by @ref acquire() belongs to the calling thread
+  until it is given back by @ref release().
+
+  Connections are opened lazily, up to the maximum given to the
+  constructor, and are kept open until the pool is destroyed. This makes
+  repeated queries against the same server cost one SFTP round trip
+  instead of a full SSH handshake.
+
+  Sessions are opened from whichever thread calls @ref acquire(), often
+  without a console, so they connect with connect_ssh_noninteractive():
+  the server must already be a known host, and the user must have a key
+  or give the password to the constructor.
+
+  libssh is initialized, with thread callbacks, by the first pool made
+  and finalized only when the last one is destroyed (see acquire_ssh()).
+  Closing a session does not finalize libssh, since that would pull the
+  library out from under the sessions of other threads and pools.
+*/
+class GEC_SftpSessionPool
+{
+public:
+  GEC_SftpSessionPool(std::string host, std::string user, std::string password,
+                      size_t maxSessions);
+  ~GEC_SftpSessionPool();
+
+  /**
+    Returns an idle SFTP session, opening a new connection if the pool is
+    not yet full. Blocks while all sessions are in use.
+
+    @return
+    The SFTP session, or NULL if a new connection could not be established
+  */
+  sftp_session acquire();
+
+  /**
+    Returns a session obtained from @ref acquire() to the pool
+
+    @param sftp
+    The SFTP session
+    @param broken
+    true if the connection failed while in use. The session is then closed
+    instead of being reused, and the next @ref acquire() reconnects.
+  */
+  void release(sftp_session sftp, bool broken = false);
+
+  std::string getHost() { return m_host; }
+  size_t getMaxSessions() { return m_maxSessions; }
+
+private:
+  GEC_SftpSessionPool(const GEC_SftpSessionPool&);
+  GEC_SftpSessionPool& operator=(const GEC_SftpSessionPool&);
+
+  sftp_session openSession();
+  void closeSession(sftp_session sftp);
+
+  std::string m_host;
+  std::string m_user;
+  std::string m_password;
+  size_t m_maxSessions;
+
+  std::mutex m_mutex;
+  std::condition_variable m_released;
+  std::vector<sftp_session> m_idle;
+  size_t m_numOpen;
+  bool m_initialized;
+};
+
+#endif /* GEC_SFTPSESSIONPOOL_H_ */
@@ -165,3 +165,53 @@ int authenticate_console(ssh_session session, const char *password){
 
   return rc;
 }
+
+int authenticate_noninteractive(ssh_session session, const char *password){
+  int rc;
+  int method;
+
+  rc = ssh_userauth_none(session, NULL);
+  if (rc == SSH_AUTH_SUCCESS || rc == SSH_AUTH_ERROR) {
+    return rc;
+  }
+
+  method = ssh_auth_list(session);
+  if (method & SSH_AUTH_METHOD_PUBLICKEY) {
+    // An empty passphrase keeps OpenSSL from asking for one of an encrypted key
+    rc = ssh_userauth_publickey_auto(session, NULL, "");
+    if (rc == SSH_AUTH_SUCCESS || rc == SSH_AUTH_ERROR) {
+      return rc;
+    }
+  }
+
+  if (!password || *password == '\0') {
+    return SSH_AUTH_DENIED;
+  }
+
+  if (method & SSH_AUTH_METHOD_PASSWORD) {
+    rc = ssh_userauth_password(session, NULL, password);
+    if (rc == SSH_AUTH_SUCCESS || rc == SSH_AUTH_ERROR) {
+      return rc;
+    }
+  }
+
+  // Only prompts that hide the answer are taken to ask for the password
+  if (method & SSH_AUTH_METHOD_INTERACTIVE) {
+    rc = ssh_userauth_kbdint(session, NULL, NULL);
+    while (rc == SSH_AUTH_INFO) {
+      int n = ssh_userauth_kbdint_getnprompts(session);
+      for (int i = 0; i < n; i++) {
+        char echo;
+        if (ssh_userauth_kbdint_getprompt(session, i, &echo) == NULL || echo) {
+          return SSH_AUTH_DENIED;
+        }
+        if (ssh_userauth_kbdint_setanswer(session, i, password) < 0) {
+          return SSH_AUTH_ERROR;
+        }
+      }
+      rc = ssh_userauth_kbdint(session, NULL, NULL);
+    }
+  }
+
+  return rc;
+}
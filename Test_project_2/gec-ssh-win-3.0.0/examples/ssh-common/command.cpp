@@ -48,9 +48,13 @@ int issue_command(std::string host, std::string user, std::string password,
   int nbytes;
   int rc;
 
-  session = connect_ssh(host.c_str(), user.c_str(), password.c_str(), SSH_LOG_NOLOG);
+  if (acquire_ssh() != SSH_OK) {
+    return 1;
+  }
+  // Commands run from several threads at once, where prompts on the console would be mixed up
+  session = connect_ssh_noninteractive(host.c_str(), user.c_str(), password.c_str(), SSH_LOG_NOLOG);
   if (session == NULL) {
-    ssh_finalize();
+    release_ssh();
     return 1;
   }
 
@@ -58,7 +62,7 @@ int issue_command(std::string host, std::string user, std::string password,
   if (channel == NULL) {
     ssh_disconnect(session);
     ssh_free(session);
-    ssh_finalize();
+    release_ssh();
     return 1;
   }
 
@@ -86,7 +90,105 @@ int issue_command(std::string host, std::string user, std::string password,
   ssh_channel_free(channel);
   ssh_disconnect(session);
   ssh_free(session);
-  ssh_finalize();
+  release_ssh();
+
+  return 0;
+failed:
+  ssh_channel_close(channel);
+  ssh_channel_free(channel);
+  ssh_disconnect(session);
+  ssh_free(session);
+  release_ssh();
+
+  return 1;
+}
+
+static void splitStreamedLines(std::string& buffer, bool isStderr, bool flush,
+                               std::function<void(const std::string&, bool)>& onLine)
+{
+  size_t iStart = 0;
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    char c = buffer[i];
+    if (c == '\n' || c == '\r' || c == '\b') {
+      if (i > iStart) {
+        onLine(buffer.substr(iStart, i - iStart), isStderr);
+      }
+      iStart = i + 1;
+    }
+  }
+  buffer.erase(0, iStart);
+
+  if (flush && !buffer.empty()) {
+    onLine(buffer, isStderr);
+    buffer.clear();
+  }
+}
+
+int issue_command_streamed(std::string host, std::string user, std::string password,
+                           std::string command,
+                           std::function<void(const std::string& line, bool isStderr)> onLine,
+                           int& exitStatus)
+{
+  ssh_session session;
+  ssh_channel channel;
+  char charBuffer[256];
+  std::string stringBuffers[2];
+  int nbytes;
+  int rc;
+
+  if (acquire_ssh() != SSH_OK) {
+    return 1;
+  }
+  session = connect_ssh(host.c_str(), user.c_str(), password.c_str(), SSH_LOG_NOLOG);
+  if (session == NULL) {
+    release_ssh();
+    return 1;
+  }
+
+  channel = ssh_channel_new(session);
+  if (channel == NULL) {
+    ssh_disconnect(session);
+    ssh_free(session);
+    release_ssh();
+    return 1;
+  }
+
+  rc = ssh_channel_open_session(channel);
+  if (rc < 0) {
+    goto failed;
+  }
+
+  rc = ssh_channel_request_exec(channel, command.c_str());
+  if (rc < 0) {
+    goto failed;
+  }
+
+  // Alternate between both streams, so neither holds back output of the other
+  while (!ssh_channel_is_eof(channel)) {
+    for (int isStderr = 0; isStderr < 2; ++isStderr) {
+      nbytes = ssh_channel_read_timeout(channel, charBuffer, sizeof(charBuffer), isStderr, 50);
+      if (nbytes < 0) {
+        goto failed;
+      }
+      stringBuffers[isStderr].append(charBuffer, nbytes);
+      splitStreamedLines(stringBuffers[isStderr], isStderr != 0, false, onLine);
+    }
+  }
+  for (int isStderr = 0; isStderr < 2; ++isStderr) {
+    while ((nbytes = ssh_channel_read_nonblocking(channel, charBuffer, sizeof(charBuffer), isStderr)) > 0) {
+      stringBuffers[isStderr].append(charBuffer, nbytes);
+    }
+    splitStreamedLines(stringBuffers[isStderr], isStderr != 0, true, onLine);
+  }
+
+  exitStatus = ssh_channel_get_exit_status(channel);
+
+  ssh_channel_send_eof(channel);
+  ssh_channel_close(channel);
+  ssh_channel_free(channel);
+  ssh_disconnect(session);
+  ssh_free(session);
+  release_ssh();
 
   return 0;
 failed:
@@ -94,7 +196,7 @@ failed:
   ssh_channel_free(channel);
   ssh_disconnect(session);
   ssh_free(session);
-  ssh_finalize();
+  release_ssh();
 
   return 1;
 }
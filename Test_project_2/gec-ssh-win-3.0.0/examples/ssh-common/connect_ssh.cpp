@@ -21,7 +21,8 @@ clients must be made or how a client should react.
 
 #include "ssh-common.h"
 
-ssh_session connect_ssh(const char *host, const char *user, const char* password, int verbosity)
+static ssh_session connect(const char *host, const char *user, const char* password, int verbosity,
+                           bool interactive)
 {
   ssh_session session;
   int auth=0;
@@ -56,12 +57,12 @@ ssh_session connect_ssh(const char *host, const char *user, const char* password
     ssh_free(session);
     return NULL;
   }
-  if(verify_knownhost(session)<0){
+  if((interactive ? verify_knownhost(session) : verify_knownhost_noninteractive(session))<0){
     ssh_disconnect(session);
     ssh_free(session);
     return NULL;
   }
-  auth=authenticate_console(session, password);
+  auth=interactive ? authenticate_console(session, password) : authenticate_noninteractive(session, password);
   if(auth==SSH_AUTH_SUCCESS){
     return session;
   } else if(auth==SSH_AUTH_DENIED){
@@ -73,3 +74,13 @@ ssh_session connect_ssh(const char *host, const char *user, const char* password
   ssh_free(session);
   return NULL;
 }
+
+ssh_session connect_ssh(const char *host, const char *user, const char* password, int verbosity)
+{
+  return connect(host, user, password, verbosity, true);
+}
+
+ssh_session connect_ssh_noninteractive(const char *host, const char *user, const char* password, int verbosity)
+{
+  return connect(host, user, password, verbosity, false);
+}
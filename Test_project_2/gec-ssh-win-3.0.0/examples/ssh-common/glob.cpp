@@ -0,0 +1,29 @@
+#include "ssh-common.h"
+
+bool match_glob(const char* glob, const char* text, size_t textLength)
+{
+  const char* starGlob = NULL;
+  size_t starText = 0;
+  size_t t = 0;
+
+  while (t < textLength) {
+    // A '*' in the pattern is a wildcard even where the text has a literal '*'
+    if (*glob == '*') {
+      starGlob = glob++;
+      starText = t;
+    } else if (*glob != '\0' && (*glob == '?' || *glob == text[t])) {
+      ++glob;
+      ++t;
+    } else if (starGlob != NULL) {
+      glob = starGlob + 1;
+      t = ++starText;
+    } else {
+      return false;
+    }
+  }
+
+  while (*glob == '*') {
+    ++glob;
+  }
+  return *glob == '\0';
+}
@@ -0,0 +1,32 @@
+#include <mutex>
+
+#include <libssh/callbacks.h>
+
+#include "ssh-common.h"
+
+static std::mutex g_mutex;
+static unsigned int g_numUsers = 0;
+
+int acquire_ssh()
+{
+  std::lock_guard<std::mutex> lock(g_mutex);
+  if (g_numUsers == 0) {
+#ifndef _WIN32
+    // Only libssh_threads has real callbacks, and it is built with pthreads only
+    ssh_threads_set_callbacks(ssh_threads_get_pthread());
+#endif
+    if (ssh_init() != SSH_OK) {
+      return SSH_ERROR;
+    }
+  }
+  ++g_numUsers;
+  return SSH_OK;
+}
+
+void release_ssh()
+{
+  std::lock_guard<std::mutex> lock(g_mutex);
+  if (g_numUsers > 0 && --g_numUsers == 0) {
+    ssh_finalize();
+  }
+}
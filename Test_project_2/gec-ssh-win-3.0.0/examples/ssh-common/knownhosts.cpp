@@ -96,3 +96,24 @@ int verify_knownhost(ssh_session session){
   ssh_clean_pubkey_hash(&hash);
   return 0;
 }
+
+int verify_knownhost_noninteractive(ssh_session session){
+  int state;
+
+  state=ssh_is_server_known(session);
+  switch(state){
+    case SSH_SERVER_KNOWN_OK:
+      return 0;
+    case SSH_SERVER_KNOWN_CHANGED:
+    case SSH_SERVER_FOUND_OTHER:
+      fprintf(stderr,"Host key for server changed, connection will be stopped\n");
+      return -1;
+    case SSH_SERVER_FILE_NOT_FOUND:
+    case SSH_SERVER_NOT_KNOWN:
+      fprintf(stderr,"The server is unknown. Accept its host key with a console client first\n");
+      return -1;
+    default:
+      fprintf(stderr,"%s\n",ssh_get_error(session));
+      return -1;
+  }
+}
@@ -14,20 +14,57 @@ clients must be made or how a client should react.
 #define EXAMPLES_COMMON_H_
 
 #include <libssh/libssh.h>
+#include <functional>
 #include <string>
 #include <vector>
 
 #define GEC_SSH_LIB_VERSION "3.0.0"
 
+/*
+  Initializes libssh for sessions used from several threads: sets the thread callbacks
+  (pthreads; libssh has none for Windows) and calls ssh_init() for the first user.
+  ssh_finalize() is not counted by libssh and ends every session in the process, so it
+  is called only by the release_ssh() of the last user, never after a single session.
+  Returns SSH_OK, or SSH_ERROR if libssh could not be initialized.
+*/
+int acquire_ssh();
+void release_ssh();
+
 int authenticate_console(ssh_session session, const char *password);
 int authenticate_kbdint(ssh_session session, const char *password);
 int verify_knownhost(ssh_session session);
 ssh_session connect_ssh(const char *host, const char *user, const char* password, int verbosity);
+
+/*
+  Variants that never read from the console, for GUIs and worker threads: the host key
+  must already be in the known hosts file, and only the user's public keys (from the
+  agent or unencrypted key files) and the given password are tried. An unknown or
+  changed host, or a missing key and password, fails the connection instead of asking.
+*/
+int verify_knownhost_noninteractive(ssh_session session);
+int authenticate_noninteractive(ssh_session session, const char *password);
+ssh_session connect_ssh_noninteractive(const char *host, const char *user, const char* password, int verbosity);
 
 int issue_command(std::string host, std::string user, std::string password,
                   std::string command, 
                   std::vector<std::string>& output,
                   std::vector<std::string>& error);
 
+/*
+  Runs a command like issue_command, but hands every line of stdout and stderr to
+  onLine as soon as it arrives. Carriage returns and backspaces, as used by progress
+  output, also end a line. Several commands can run at the same time in different
+  threads, so the connection is made like connect_ssh_noninteractive: an unknown host
+  or a missing key fails the command instead of asking on the console.
+  Returns 0 and the exit status of the command, or 1 if the command could not be run.
+*/
+int issue_command_streamed(std::string host, std::string user, std::string password,
+                           std::string command,
+                           std::function<void(const std::string& line, bool isStderr)> onLine,
+                           int& exitStatus);
+
+/* Matches text against a pattern where '*' matches any sequence and '?' any single character */
+bool match_glob(const char* glob, const char* text, size_t textLength);
+
 
 #endif /* EXAMPLES_COMMON_H_ */
@@ -31,3 +31,19 @@ GEC_DirectoryEntry* GEC_DirectoryEntry::createFromLsOutputLine(std::string line)
   }
   return entry;
 }
+
+GEC_DirectoryEntry* GEC_DirectoryEntry::createFromSftpAttributes(sftp_attributes attributes)
+{
+  GEC_DirectoryEntry* entry = 0;
+
+  if (attributes && attributes->name) {
+    if (attributes->type == SSH_FILEXFER_TYPE_DIRECTORY || attributes->type == SSH_FILEXFER_TYPE_REGULAR) {
+      entry = new GEC_DirectoryEntry();
+      entry->m_isDirectory = attributes->type == SSH_FILEXFER_TYPE_DIRECTORY;
+      entry->m_sizeInBytes = attributes->size;
+      entry->m_modifiedTime = attributes->mtime;
+      entry->m_name = attributes->name;
+    }
+  }
+  return entry;
+}
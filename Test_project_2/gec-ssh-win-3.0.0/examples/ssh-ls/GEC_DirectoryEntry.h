@@ -4,6 +4,9 @@
 #include <stdint.h>
 #include <string>
 
+#include <libssh/libssh.h>
+#include <libssh/sftp.h>
+
 class GEC_DirectoryEntry
 {
 public:
@@ -11,18 +14,22 @@ public:
     : m_isDirectory(false)
     , m_name("")
     , m_sizeInBytes(0)
+    , m_modifiedTime(0)
   {}
 
   static GEC_DirectoryEntry* createFromLsOutputLine(std::string line);
+  static GEC_DirectoryEntry* createFromSftpAttributes(sftp_attributes attributes);
 
   bool isDirectory() { return m_isDirectory; }
   std::string getName() { return m_name; }
   uint64_t getSizeInBytes() { return m_sizeInBytes; }
+  uint64_t getModifiedTime() { return m_modifiedTime; }
 
 private:
   bool m_isDirectory;
   std::string m_name;
   uint64_t m_sizeInBytes;
+  uint64_t m_modifiedTime;
 };
 
 #endif /* GEC_DIRECTORYENTRY_H_ */
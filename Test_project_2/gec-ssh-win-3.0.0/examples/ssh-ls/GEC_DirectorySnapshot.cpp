@@ -0,0 +1,124 @@
+#include "GEC_DirectorySnapshot.h"
+
+static bool isSameEntry(GEC_DirectoryEntry& a, GEC_DirectoryEntry& b)
+{
+  return a.isDirectory() == b.isDirectory()
+    && a.getSizeInBytes() == b.getSizeInBytes()
+    && a.getModifiedTime() == b.getModifiedTime();
+}
+
+static int listDirectory(sftp_session sftp, std::string path,
+                         std::map<std::string, GEC_DirectoryEntry>& entries)
+{
+  sftp_dir dir = sftp_opendir(sftp, path.c_str());
+  if (dir == NULL) {
+    return (sftp_get_error(sftp) == SSH_FX_NO_SUCH_FILE) ? GEC_SNAPSHOT_NOT_EXISTING : GEC_SNAPSHOT_NETWORK_ERROR;
+  }
+
+  sftp_attributes attributes;
+  while ((attributes = sftp_readdir(sftp, dir)) != NULL) {
+    std::string name(attributes->name);
+    if (name != "." && name != "..") {
+      GEC_DirectoryEntry* entry = GEC_DirectoryEntry::createFromSftpAttributes(attributes);
+      if (entry) {
+        entries[name] = *entry;
+        delete entry;
+      }
+    }
+    sftp_attributes_free(attributes);
+  }
+
+  bool complete = sftp_dir_eof(dir) != 0;
+  sftp_closedir(dir);
+
+  return complete ? GEC_SNAPSHOT_OK : GEC_SNAPSHOT_NETWORK_ERROR;
+}
+
+int GEC_DirectorySnapshot::refresh(sftp_session sftp, std::string path, GEC_DirectoryDiff& diff, bool force)
+{
+  diff.added.clear();
+  diff.removed.clear();
+  diff.changed.clear();
+
+  std::map<std::string, Listing>::iterator itListing = m_listings.find(path);
+
+  sftp_attributes attributes = sftp_stat(sftp, path.c_str());
+  if (attributes == NULL) {
+    if (sftp_get_error(sftp) != SSH_FX_NO_SUCH_FILE) {
+      return GEC_SNAPSHOT_NETWORK_ERROR;
+    }
+    if (itListing != m_listings.end()) {
+      std::map<std::string, GEC_DirectoryEntry>::iterator it;
+      for (it = itListing->second.entries.begin(); it != itListing->second.entries.end(); ++it) {
+        diff.removed.push_back(it->second);
+      }
+      m_listings.erase(itListing);
+    }
+    return GEC_SNAPSHOT_NOT_EXISTING;
+  }
+  uint64_t directoryModifiedTime = attributes->mtime;
+  sftp_attributes_free(attributes);
+
+  if (itListing != m_listings.end() && !force
+      && itListing->second.verified
+      && itListing->second.directoryModifiedTime == directoryModifiedTime) {
+    return GEC_SNAPSHOT_OK;
+  }
+
+  std::map<std::string, GEC_DirectoryEntry> entries;
+  int rc = listDirectory(sftp, path, entries);
+  if (rc != GEC_SNAPSHOT_OK) {
+    return rc;
+  }
+
+  Listing& listing = m_listings[path];
+  std::map<std::string, GEC_DirectoryEntry>::iterator itOld = listing.entries.begin();
+  std::map<std::string, GEC_DirectoryEntry>::iterator itNew = entries.begin();
+
+  // Both listings are sorted by name, so one merge pass finds all differences
+  while (itOld != listing.entries.end() || itNew != entries.end()) {
+    if (itNew == entries.end() || (itOld != listing.entries.end() && itOld->first < itNew->first)) {
+      diff.removed.push_back(itOld->second);
+      ++itOld;
+    } else if (itOld == listing.entries.end() || itNew->first < itOld->first) {
+      diff.added.push_back(itNew->second);
+      ++itNew;
+    } else {
+      if (!isSameEntry(itOld->second, itNew->second)) {
+        diff.changed.push_back(itNew->second);
+      }
+      ++itOld;
+      ++itNew;
+    }
+  }
+
+  // A listing is trusted once the directory time has been seen unchanged
+  // over a full listing, see the class description
+  listing.verified = (listing.directoryModifiedTime == directoryModifiedTime) && diff.isEmpty();
+  listing.directoryModifiedTime = directoryModifiedTime;
+  listing.entries.swap(entries);
+
+  return GEC_SNAPSHOT_OK;
+}
+
+bool GEC_DirectorySnapshot::getEntries(std::string path, std::vector<GEC_DirectoryEntry>& entries)
+{
+  std::map<std::string, Listing>::iterator itListing = m_listings.find(path);
+  if (itListing == m_listings.end()) {
+    return false;
+  }
+
+  entries.clear();
+  std::map<std::string, GEC_DirectoryEntry>::iterator it;
+  for (it = itListing->second.entries.begin(); it != itListing->second.entries.end(); ++it) {
+    if (it->second.isDirectory()) {
+      entries.push_back(it->second);
+    }
+  }
+  for (it = itListing->second.entries.begin(); it != itListing->second.entries.end(); ++it) {
+    if (!it->second.isDirectory()) {
+      entries.push_back(it->second);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,102 @@
+#ifndef GEC_DIRECTORYSNAPSHOT_H_
+#define GEC_DIRECTORYSNAPSHOT_H_
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <libssh/sftp.h>
+
+#include "GEC_DirectoryEntry.h"
+
+#define GEC_SNAPSHOT_OK             0
+#define GEC_SNAPSHOT_NETWORK_ERROR  (-1)
+#define GEC_SNAPSHOT_NOT_EXISTING   (-2)
+
+struct GEC_DirectoryDiff
+{
+  bool isEmpty() { return added.empty() && removed.empty() && changed.empty(); }
+
+  std::vector<GEC_DirectoryEntry> added;
+  std::vector<GEC_DirectoryEntry> removed;
+  std::vector<GEC_DirectoryEntry> changed;
+};
+
+/**
+  Keeps the last listing of every directory it has been asked to refresh
+
+  @ref refresh() first stats the directory itself. If its modification
+  time is the same as when it was last listed, the directory has had no
+  entries added, removed or renamed, and the listing is not repeated.
+  Otherwise the directory is listed again, and the entries are compared
+  by name, size, and modification time against the stored listing.
+
+  Writing to a file inside a directory does not change the modification
+  time of the directory. A recording that is growing therefore only shows
+  up as changed when @p force is passed to @ref refresh().
+
+  Modification times only have a resolution of one second, so a
+  directory changed twice within the same second could keep its time.
+  The first refresh after a change is therefore always a full listing.
+
+  ssh-ls --watch is the only user so far. The file-browsing tab of the
+  client (cd, mkdir, mv, rmdir, Present directory) has no handlers yet;
+  when it gets them, it is meant to keep one snapshot, refresh the shown
+  directory after each command, and apply the diff to its view.
+*/
+class GEC_DirectorySnapshot
+{
+public:
+  /**
+    Brings the stored listing of @p path up to date
+
+    @param sftp
+    SFTP session to the server holding the directory
+    @param path
+    Full path of the directory on the server
+    @param diff
+    Returns the entries that were added, removed, or changed since the
+    previous refresh. On the first refresh of a path all entries are
+    returned as added.
+    @param force
+    List the directory even if its modification time is unchanged
+
+    @return GEC_SNAPSHOT_OK
+    Success
+    @return GEC_SNAPSHOT_NETWORK_ERROR
+    The directory could not be read over the SFTP session
+    @return GEC_SNAPSHOT_NOT_EXISTING
+    The directory does not exist anymore. Its stored entries are returned
+    as removed and forgotten.
+  */
+  int refresh(sftp_session sftp, std::string path, GEC_DirectoryDiff& diff, bool force = false);
+
+  /**
+    Returns the stored listing of @p path, directories first
+
+    @return
+    false if @p path has never been refreshed
+  */
+  bool getEntries(std::string path, std::vector<GEC_DirectoryEntry>& entries);
+
+  void forget(std::string path) { m_listings.erase(path); }
+  void clear() { m_listings.clear(); }
+
+private:
+  struct Listing
+  {
+    Listing()
+      : directoryModifiedTime(0)
+      , verified(false)
+    {}
+
+    uint64_t directoryModifiedTime;
+    bool verified;
+    std::map<std::string, GEC_DirectoryEntry> entries;
+  };
+
+  std::map<std::string, Listing> m_listings;
+};
+
+#endif /* GEC_DIRECTORYSNAPSHOT_H_ */
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cstring>
+
+#include "ssh-common.h"
+
+#include "GEC_DirectoryTable.h"
+
+void GEC_DirectoryTable::reserve(size_t numEntries, size_t numNameBytes)
+{
+  m_records.reserve(numEntries);
+  m_names.reserve(numNameBytes);
+}
+
+void GEC_DirectoryTable::clear()
+{
+  std::vector<Record>().swap(m_records);
+  std::vector<char>().swap(m_names);
+}
+
+void GEC_DirectoryTable::append(const char* name, size_t nameLength, bool isDirectory,
+                                uint64_t sizeInBytes, uint64_t modifiedTime)
+{
+  Record record;
+  record.sizeInBytes = sizeInBytes;
+  record.modifiedTime = modifiedTime;
+  record.nameOffset = static_cast<uint32_t>(m_names.size());
+  record.nameLength = static_cast<uint32_t>(nameLength);
+  record.isDirectory = isDirectory ? 1 : 0;
+
+  m_names.insert(m_names.end(), name, name + nameLength);
+  m_records.push_back(record);
+}
+
+static bool isSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool GEC_DirectoryTable::appendFromLsOutputLine(const std::string& line)
+{
+  // Fields: mask, links, owner, group, size, month, day, time/year, name
+  const char* p = line.c_str();
+  const char* end = p + line.length();
+  const char* field[9];
+  const char* fieldEnd[9];
+
+  for (int i = 0; i < 9; ++i) {
+    while (p < end && isSpace(*p)) {
+      ++p;
+    }
+    if (p == end) {
+      return false;
+    }
+    field[i] = p;
+    while (p < end && !isSpace(*p)) {
+      ++p;
+    }
+    fieldEnd[i] = p;
+  }
+
+  // The name is the rest of the line, so names containing spaces are kept whole
+  const char* nameEnd = end;
+  while (nameEnd > field[8] && isSpace(nameEnd[-1])) {
+    --nameEnd;
+  }
+
+  char type = field[0][0];
+  if (type != 'd' && type != '-') {
+    return false;
+  }
+
+  uint64_t sizeInBytes = 0;
+  for (const char* digit = field[4]; digit < fieldEnd[4]; ++digit) {
+    if (*digit < '0' || *digit > '9') {
+      return false;
+    }
+    sizeInBytes = sizeInBytes * 10 + (*digit - '0');
+  }
+
+  append(field[8], nameEnd - field[8], type == 'd', sizeInBytes, 0);
+  return true;
+}
+
+GEC_DirectoryTable::Indices GEC_DirectoryTable::getAllIndices() const
+{
+  Indices indices(m_records.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    indices[i] = static_cast<uint32_t>(i);
+  }
+  return indices;
+}
+
+void GEC_DirectoryTable::sortByName(Indices& indices) const
+{
+  std::sort(indices.begin(), indices.end(), [this](uint32_t a, uint32_t b) {
+    const Record& ra = m_records[a];
+    const Record& rb = m_records[b];
+    int order = memcmp(&m_names[ra.nameOffset], &m_names[rb.nameOffset], std::min(ra.nameLength, rb.nameLength));
+    return order < 0 || (order == 0 && ra.nameLength < rb.nameLength);
+  });
+}
+
+void GEC_DirectoryTable::sortBySize(Indices& indices, bool largestFirst) const
+{
+  std::stable_sort(indices.begin(), indices.end(), [this, largestFirst](uint32_t a, uint32_t b) {
+    return largestFirst ? m_records[a].sizeInBytes > m_records[b].sizeInBytes
+                        : m_records[a].sizeInBytes < m_records[b].sizeInBytes;
+  });
+}
+
+void GEC_DirectoryTable::sortDirectoriesFirst(Indices& indices) const
+{
+  std::stable_partition(indices.begin(), indices.end(), [this](uint32_t i) {
+    return m_records[i].isDirectory != 0;
+  });
+}
+
+void GEC_DirectoryTable::filterByType(Indices& indices, bool directories) const
+{
+  indices.erase(std::remove_if(indices.begin(), indices.end(), [this, directories](uint32_t i) {
+    return (m_records[i].isDirectory != 0) != directories;
+  }), indices.end());
+}
+
+void GEC_DirectoryTable::filterBySize(Indices& indices, uint64_t minSizeInBytes, uint64_t maxSizeInBytes) const
+{
+  indices.erase(std::remove_if(indices.begin(), indices.end(), [this, minSizeInBytes, maxSizeInBytes](uint32_t i) {
+    return m_records[i].sizeInBytes < minSizeInBytes || m_records[i].sizeInBytes > maxSizeInBytes;
+  }), indices.end());
+}
+
+void GEC_DirectoryTable::filterByName(Indices& indices, const std::string& glob) const
+{
+  indices.erase(std::remove_if(indices.begin(), indices.end(), [this, &glob](uint32_t i) {
+    return !match_glob(glob.c_str(), &m_names[m_records[i].nameOffset], m_records[i].nameLength);
+  }), indices.end());
+}
@@ -0,0 +1,80 @@
+#ifndef GEC_DIRECTORYTABLE_H_
+#define GEC_DIRECTORYTABLE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+  Flat table of directory entries
+
+  All entries are fixed-size records in one contiguous array, and all
+  names are stored back to back in one character pool. Records refer to
+  their name by offset and length, so appending an entry does not
+  allocate anything once the table has grown to its final size, and
+  freeing the table releases two buffers regardless of the number of
+  entries.
+
+  Sorting and filtering work on vectors of record indices, so the records
+  themselves never move. Several differently sorted or filtered views of
+  the same table can exist at the same time.
+*/
+class GEC_DirectoryTable
+{
+public:
+  typedef std::vector<uint32_t> Indices;
+
+  /**
+    Reserves room for @p numEntries entries with names of
+    @p numNameBytes characters in total
+  */
+  void reserve(size_t numEntries, size_t numNameBytes);
+  void clear();
+
+  void append(const char* name, size_t nameLength, bool isDirectory,
+              uint64_t sizeInBytes, uint64_t modifiedTime);
+
+  /**
+    Parses one line of 'ls -l' output, and appends it if it describes a
+    directory or a regular file
+
+    @return
+    true if an entry was appended
+  */
+  bool appendFromLsOutputLine(const std::string& line);
+
+  size_t size() const { return m_records.size(); }
+
+  bool isDirectory(uint32_t i) const { return m_records[i].isDirectory != 0; }
+  uint64_t getSizeInBytes(uint32_t i) const { return m_records[i].sizeInBytes; }
+  uint64_t getModifiedTime(uint32_t i) const { return m_records[i].modifiedTime; }
+  const char* getNameData(uint32_t i) const { return &m_names[m_records[i].nameOffset]; }
+  size_t getNameLength(uint32_t i) const { return m_records[i].nameLength; }
+  std::string getName(uint32_t i) const { return std::string(getNameData(i), getNameLength(i)); }
+
+  /** Returns the indices of all entries in the order they were appended */
+  Indices getAllIndices() const;
+
+  void sortByName(Indices& indices) const;
+  void sortBySize(Indices& indices, bool largestFirst) const;
+  void sortDirectoriesFirst(Indices& indices) const;
+
+  void filterByType(Indices& indices, bool directories) const;
+  void filterBySize(Indices& indices, uint64_t minSizeInBytes, uint64_t maxSizeInBytes) const;
+  void filterByName(Indices& indices, const std::string& glob) const;
+
+private:
+  struct Record
+  {
+    uint64_t sizeInBytes;
+    uint64_t modifiedTime;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint8_t isDirectory;
+  };
+
+  std::vector<Record> m_records;
+  std::vector<char> m_names;
+};
+
+#endif /* GEC_DIRECTORYTABLE_H_ */
@@ -1,25 +1,82 @@
+#include <chrono>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
 #include <stdio.h>
+#include <thread>
 
 #include "ssh-common.h"
 
 #include "GEC_DirectoryEntry.h"
+#include "GEC_DirectorySnapshot.h"
+#include "GEC_DirectoryTable.h"
+#include "GEC_SftpSessionPool.h"
 
 void printUsage()
 {
-  std::cout << "Usage: ssh-ls <server> <path>" << std::endl
+  std::cout << "Usage: ssh-ls <server> <path> [--watch=<seconds>]" << std::endl
             << std::endl
             << "where: <server> is the host name or IP address to the server" << std::endl
-            << "       <path> is the full path of the server directory that will be listed" << std::endl;
+            << "       <path> is the full path of the server directory that will be listed" << std::endl
+            << "       <seconds> is the refresh interval. When given, the directory is kept" << std::endl
+            << "                 under watch and only changes are printed" << std::endl;
+}
+
+void printEntries(const char* label, std::vector<GEC_DirectoryEntry>& entries)
+{
+  std::vector<GEC_DirectoryEntry>::iterator it;
+  for (it = entries.begin(); it != entries.end(); ++it) {
+    std::cout << label << " " << (it->isDirectory() ? "d " : "- ")
+              << std::setw(40) << std::left << it->getName() << " "
+              << std::setw(12) << std::right << it->getSizeInBytes() << " bytes" << std::endl;
+  }
+}
+
+int watchDirectory(std::string server, std::string path, unsigned int intervalInS)
+{
+  GEC_SftpSessionPool pool(server, "root", "", 1);
+  GEC_DirectorySnapshot snapshot;
+
+  for (;;) {
+    sftp_session sftp = pool.acquire();
+    if (sftp == NULL) {
+      std::cout << "ERROR: Could not open an SFTP session to " << server << std::endl;
+      return (-1);
+    }
+
+    GEC_DirectoryDiff diff;
+    int rc = snapshot.refresh(sftp, path, diff);
+    pool.release(sftp, rc == GEC_SNAPSHOT_NETWORK_ERROR);
+
+    printEntries("+", diff.added);
+    printEntries("-", diff.removed);
+    printEntries("*", diff.changed);
+    if (rc == GEC_SNAPSHOT_NOT_EXISTING) {
+      std::cout << path << " does not exist" << std::endl;
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(intervalInS));
+  }
 }
 
 int main(int argc, char* argv[]) 
 {
-  if (argc != 3) {
+  if (argc != 3 && argc != 4) {
     std::cout << "ERROR: Incorrect number of arguments" << std::endl
               << std::endl;
     printUsage();
+    return (-1);
+  }
+
+  if (argc == 4) {
+    std::string option(argv[3]);
+    if (option.compare(0, 8, "--watch=") != 0) {
+      std::cout << "ERROR: Unknown option '" << option << "'" << std::endl
+                << std::endl;
+      printUsage();
+      return (-1);
+    }
+    return watchDirectory(argv[1], argv[2], strtoul(option.substr(8).c_str(), NULL, 10));
   }
 
   std::string command = std::string("ls -l ") + std::string(argv[2]);
@@ -34,35 +91,34 @@ int main(int argc, char* argv[])
         std::cout << std::setw(3) << i << ": " << error[i] << std::endl;
       }
     } else {
-      std::vector<GEC_DirectoryEntry*> entries;
-      
-      for (unsigned int i = 1; i < output.size(); ++i) {
-        GEC_DirectoryEntry* entry = GEC_DirectoryEntry::createFromLsOutputLine(output[i]);
-        if (entry) {
-          entries.push_back(entry);
-        }
+      GEC_DirectoryTable table;
+      size_t numNameBytes = 0;
+      for (size_t i = 1; i < output.size(); ++i) {
+        numNameBytes += output[i].length();
       }
+      table.reserve(output.size(), numNameBytes);
 
-      std::vector<GEC_DirectoryEntry*>::iterator it;
-      std::cout << "Directories:" << std::endl;
-      for (it = entries.begin(); it != entries.end(); ++it) {
-        if ((*it)->isDirectory()) {
-          std::cout << std::setw(40) << std::left << (*it)->getName() << " " 
-            << std::setw(12) << std::right << (*it)->getSizeInBytes() << " bytes" << std::endl;
-        }
+      for (size_t i = 1; i < output.size(); ++i) {
+        table.appendFromLsOutputLine(output[i]);
       }
-      std::cout << std::endl << "Files:" << std::endl;
-      for (it = entries.begin(); it != entries.end(); ++it) {
-        if (!(*it)->isDirectory()) {
-          std::cout << std::setw(40) << std::left << (*it)->getName() << " " 
-            << std::setw(12) << std::right << (*it)->getSizeInBytes() << " bytes" << std::endl;
+
+      GEC_DirectoryTable::Indices indices = table.getAllIndices();
+      table.sortDirectoriesFirst(indices);
+
+      std::cout << "Directories:" << std::endl;
+      bool printingDirectories = true;
+      for (size_t i = 0; i < indices.size(); ++i) {
+        uint32_t iEntry = indices[i];
+        if (printingDirectories && !table.isDirectory(iEntry)) {
+          std::cout << std::endl << "Files:" << std::endl;
+          printingDirectories = false;
         }
+        std::cout << std::setw(40) << std::left << table.getName(iEntry) << " "
+          << std::setw(12) << std::right << table.getSizeInBytes(iEntry) << " bytes" << std::endl;
       }
-
-      for (it = entries.begin(); it != entries.end(); ++it) {
-        delete (*it);
+      if (printingDirectories) {
+        std::cout << std::endl << "Files:" << std::endl;
       }
-      entries.clear();
     }
   }
 }
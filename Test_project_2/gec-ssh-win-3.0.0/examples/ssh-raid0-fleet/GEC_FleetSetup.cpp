@@ -0,0 +1,57 @@
+#include <chrono>
+#include <thread>
+
+#include "ssh-common.h"
+
+#include "GEC_FleetSetup.h"
+
+GEC_FleetSetup::GEC_FleetSetup(std::string user, std::string password)
+  : m_user(user)
+  , m_password(password)
+{
+}
+
+void GEC_FleetSetup::runJob(GEC_FleetJob& job, LineCallback& onLine)
+{
+  for (size_t i = 0; i < job.stages.size(); ++i) {
+    GEC_FleetStage& stage = job.stages[i];
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    int rc = issue_command_streamed(job.host, m_user, m_password, stage.command,
+                                    [&](const std::string& line, bool isStderr) {
+      std::unique_lock<std::mutex> lock(m_outputMutex);
+      onLine(job, stage, line, isStderr);
+    }, stage.exitStatus);
+
+    stage.durationInS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stage.hasRun = true;
+    if (rc != 0) {
+      stage.rc = GEC_FLEET_NETWORK_ERROR;
+    } else if (stage.exitStatus != 0) {
+      stage.rc = GEC_FLEET_STAGE_FAILED;
+    }
+    if (stage.rc != GEC_FLEET_OK) {
+      break;
+    }
+  }
+}
+
+int GEC_FleetSetup::run(LineCallback onLine)
+{
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < m_jobs.size(); ++i) {
+    threads.push_back(std::thread(&GEC_FleetSetup::runJob, this, std::ref(m_jobs[i]), std::ref(onLine)));
+  }
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i].join();
+  }
+
+  for (size_t i = 0; i < m_jobs.size(); ++i) {
+    for (size_t s = 0; s < m_jobs[i].stages.size(); ++s) {
+      if (m_jobs[i].stages[s].rc != GEC_FLEET_OK) {
+        return m_jobs[i].stages[s].rc;
+      }
+    }
+  }
+  return GEC_FLEET_OK;
+}
@@ -0,0 +1,89 @@
+#ifndef GEC_FLEETSETUP_H_
+#define GEC_FLEETSETUP_H_
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define GEC_FLEET_OK              0
+#define GEC_FLEET_STAGE_FAILED    (-1)
+#define GEC_FLEET_NETWORK_ERROR   (-2)
+
+/**
+  One step of preparing an array, run as one remote command
+*/
+struct GEC_FleetStage
+{
+  GEC_FleetStage()
+    : rc(GEC_FLEET_OK)
+    , exitStatus(0)
+    , hasRun(false)
+    , durationInS(0)
+  {}
+
+  std::string name;
+  std::string command;
+  int rc;
+  int exitStatus;
+  bool hasRun;
+  double durationInS;
+};
+
+/**
+  One array on one server, and the stages that prepare it
+*/
+struct GEC_FleetJob
+{
+  std::string host;
+  std::string label;       // Prefix of the streamed output lines
+  std::vector<GEC_FleetStage> stages;
+};
+
+/**
+  Prepares several storage arrays, on one or several servers, at the same
+  time
+
+  Every job runs its stages one after the other in a thread of its own,
+  with a separate SSH connection per stage, and stops at the first stage
+  that fails. The output of all jobs is streamed to one callback while
+  the commands run, so the progress of every mkfs is visible. The total
+  time is that of the slowest job, not the sum of all jobs.
+
+  Nothing is asked on the console: a host that is not known, or without
+  an SSH key for the user, fails its job with GEC_FLEET_NETWORK_ERROR.
+*/
+class GEC_FleetSetup
+{
+public:
+  typedef std::function<void(const GEC_FleetJob& job, const GEC_FleetStage& stage,
+                             const std::string& line, bool isStderr)> LineCallback;
+
+  GEC_FleetSetup(std::string user, std::string password);
+
+  void add(const GEC_FleetJob& job) { m_jobs.push_back(job); }
+
+  /**
+    Runs all jobs
+
+    @param onLine
+    Called for every line of output, from the thread of the job. Calls
+    are serialized, so the callback needs no locking of its own.
+
+    @return
+    GEC_FLEET_OK if every stage of every job succeeded
+  */
+  int run(LineCallback onLine);
+
+  const std::vector<GEC_FleetJob>& getJobs() { return m_jobs; }
+
+private:
+  void runJob(GEC_FleetJob& job, LineCallback& onLine);
+
+  std::string m_user;
+  std::string m_password;
+  std::vector<GEC_FleetJob> m_jobs;
+  std::mutex m_outputMutex;
+};
+
+#endif /* GEC_FLEETSETUP_H_ */
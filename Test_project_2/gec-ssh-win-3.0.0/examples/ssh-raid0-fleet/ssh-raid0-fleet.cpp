@@ -0,0 +1,213 @@
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include "ssh-common.h"
+
+#include "GEC_FleetSetup.h"
+#include "GEC_RaidLayoutPlanner.h"
+
+void printUsage()
+{
+  std::cout << "Usage: ssh-raid0-fleet <job-file> [--write-size=<KiB>] [--dry-run]" << std::endl
+            << std::endl
+            << "where: <job-file> has one line per array to prepare, in the form" << std::endl
+            << "                  <server> <md-name> <mount-path> <dev-name-0> <dev-name-1> ..." << std::endl
+            << "                  Empty lines and lines starting with '#' are ignored" << std::endl
+            << "       <KiB> is the size of the blocks the recorder writes. When given, every array" << std::endl
+            << "             gets the stripe-aligned layout of ssh-raid0-plan instead of the" << std::endl
+            << "             defaults of ssh-raid0-setup" << std::endl
+            << "       --dry-run prints the commands of every array without running them" << std::endl
+            << std::endl
+            << "All arrays are prepared at the same time. ALL DATA ON THE DEVICES IS LOST." << std::endl;
+}
+
+static bool hasPrefix(const std::string& text, const std::string& prefix)
+{
+  return text.compare(0, prefix.length(), prefix) == 0;
+}
+
+/* Names a stage after the program it runs, e.g. "mkfs.ext4" */
+static std::string getStageName(const std::string& command)
+{
+  size_t iStart = command.rfind("| ");
+  iStart = (iStart == std::string::npos) ? 0 : iStart + 2;
+  std::string program = command.substr(iStart, command.find(' ', iStart) - iStart);
+  size_t iSlash = program.rfind('/');
+  return (iSlash == std::string::npos) ? program : program.substr(iSlash + 1);
+}
+
+/* Bare progress counters, as in "1234/7452", are printed at most once per second */
+static bool isProgressLine(const std::string& line)
+{
+  return !line.empty() && line.find_first_not_of("0123456789/ ") == std::string::npos;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2) {
+    std::cout << "ERROR: Incorrect number of arguments" << std::endl
+              << std::endl;
+    printUsage();
+    return (-1);
+  }
+
+  uint64_t writeSizeInBytes = 0;
+  bool dryRun = false;
+  for (int i = 2; i < argc; ++i) {
+    std::string option(argv[i]);
+    if (hasPrefix(option, "--write-size=")) {
+      writeSizeInBytes = strtoull(option.substr(13).c_str(), NULL, 10) * 1024;
+    } else if (option == "--dry-run") {
+      dryRun = true;
+    } else {
+      std::cout << "ERROR: Unknown option '" << option << "'" << std::endl
+                << std::endl;
+      printUsage();
+      return (-1);
+    }
+  }
+
+  std::ifstream jobFile(argv[1]);
+  if (!jobFile) {
+    std::cout << "ERROR: Could not open " << argv[1] << std::endl;
+    return (-1);
+  }
+
+  GEC_FleetSetup fleet("root", "");
+  std::map<std::string, int> usedOnLine;   // Every md name and device, as "<server> <name>", and its line
+  std::string line;
+  int lineNumber = 0;
+  while (std::getline(jobFile, line)) {
+    ++lineNumber;
+    std::stringstream fields(line);
+    std::string host;
+    std::string mdName;
+    std::string mountPath;
+    std::vector<std::string> devices;
+    fields >> host >> mdName >> mountPath;
+    if (host.empty() || host[0] == '#') {
+      continue;
+    }
+    std::string device;
+    while (fields >> device) {
+      devices.push_back(device);
+    }
+    if (mountPath.empty() || devices.size() < 2) {
+      std::cout << "ERROR: " << argv[1] << ":" << lineNumber << ": expected a server, an md name, a mount path,"
+                << " and at least 2 devices" << std::endl;
+      return (-1);
+    }
+    // Two jobs on one device would both wipe it, at the same time, so nothing is started
+    std::vector<std::string> names(devices);
+    names.push_back(mdName);
+    for (size_t i = 0; i < names.size(); ++i) {
+      std::map<std::string, int>::iterator itUsed = usedOnLine.find(host + " " + names[i]);
+      if (itUsed != usedOnLine.end()) {
+        std::cout << "ERROR: " << argv[1] << ":" << lineNumber << ": " << host << ":" << names[i]
+                  << " is already used on line " << itUsed->second << std::endl;
+        return (-1);
+      }
+      usedOnLine[host + " " + names[i]] = lineNumber;
+    }
+
+    std::vector<std::string> commands;
+    if (writeSizeInBytes != 0) {
+      // Reading sysfs is quick, and is done for one array after the other before any setup starts
+      std::vector<GEC_DeviceInfo> infos;
+      if (GEC_RaidLayoutPlanner::readDevices(host, "root", "", devices, infos) != GEC_PLAN_OK) {
+        std::cout << "ERROR: Could not read the devices of " << host << ":" << mdName << std::endl;
+        return (-1);
+      }
+      GEC_RaidLayout layout = GEC_RaidLayoutPlanner::plan(infos, writeSizeInBytes);
+      commands = GEC_RaidLayoutPlanner::getSetupCommands(layout, infos, mdName, mountPath);
+    } else {
+      std::stringstream create;
+      create << "echo y | /sbin/mdadm --create " << mdName << " --level=raid0 --raid-devices=" << devices.size();
+      for (size_t i = 0; i < devices.size(); ++i) {
+        create << " " << devices[i];
+      }
+      commands.push_back(create.str());
+      commands.push_back("/sbin/mkfs.ext4 -b 4096 " + mdName);
+      commands.push_back("mount " + mdName + " " + mountPath);
+    }
+
+    GEC_FleetJob job;
+    job.host = host;
+    job.label = host + ":" + mdName;
+    for (size_t i = 0; i < commands.size(); ++i) {
+      GEC_FleetStage stage;
+      stage.name = getStageName(commands[i]);
+      stage.command = commands[i];
+      job.stages.push_back(stage);
+    }
+    fleet.add(job);
+  }
+
+  if (dryRun) {
+    const std::vector<GEC_FleetJob>& jobs = fleet.getJobs();
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      std::cout << jobs[i].label << ":" << std::endl;
+      for (size_t s = 0; s < jobs[i].stages.size(); ++s) {
+        std::cout << "  " << jobs[i].stages[s].command << std::endl;
+      }
+    }
+    return 0;
+  }
+
+  std::map<std::string, std::chrono::steady_clock::time_point> lastProgress;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  int rc = fleet.run([&](const GEC_FleetJob& job, const GEC_FleetStage& stage, const std::string& text, bool isStderr) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (isProgressLine(text)) {
+      std::chrono::steady_clock::time_point& last = lastProgress[job.label];
+      if (now - last < std::chrono::seconds(1)) {
+        return;
+      }
+      last = now;
+    }
+    std::cout << "[" << std::setw(7) << std::fixed << std::setprecision(1)
+              << std::chrono::duration<double>(now - start).count() << " s] "
+              << job.label << " " << stage.name << (isStderr ? " ! " : ": ") << text << std::endl;
+  });
+
+  double elapsedInS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << std::endl << "Stage durations:" << std::endl;
+  double sumInS = 0;
+  size_t numFailed = 0;
+  const std::vector<GEC_FleetJob>& jobs = fleet.getJobs();
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    double jobInS = 0;
+    bool failed = false;
+    std::cout << "  " << std::setw(30) << std::left << jobs[i].label << std::right;
+    for (size_t s = 0; s < jobs[i].stages.size(); ++s) {
+      const GEC_FleetStage& stage = jobs[i].stages[s];
+      if (!stage.hasRun) {
+        continue;
+      }
+      std::cout << " " << stage.name << " " << std::fixed << std::setprecision(1) << stage.durationInS << " s";
+      if (stage.rc == GEC_FLEET_NETWORK_ERROR) {
+        std::cout << " (connection failed)";
+      } else if (stage.rc == GEC_FLEET_STAGE_FAILED) {
+        std::cout << " (FAILED, exit status " << stage.exitStatus << ")";
+      }
+      failed = failed || stage.rc != GEC_FLEET_OK;
+      jobInS += stage.durationInS;
+    }
+    numFailed += failed ? 1 : 0;
+    std::cout << " = " << jobInS << " s" << std::endl;
+    sumInS += jobInS;
+  }
+
+  std::cout << std::endl << jobs.size() - numFailed << " arrays prepared, " << numFailed << " failed, in "
+            << std::fixed << std::setprecision(1) << elapsedInS << " s (" << sumInS << " s one after the other)"
+            << std::endl;
+
+  return (rc == GEC_FLEET_OK) ? 0 : 1;
+}
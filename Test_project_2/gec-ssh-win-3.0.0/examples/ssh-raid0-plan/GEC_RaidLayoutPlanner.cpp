@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+#include "ssh-common.h"
+
+#include "GEC_RaidLayoutPlanner.h"
+
+#define MIN_CHUNK_SIZE  (64 * 1024)
+#define MAX_CHUNK_SIZE  (4 * 1024 * 1024)
+
+static bool isPowerOfTwo(uint64_t value)
+{
+  return value != 0 && (value & (value - 1)) == 0;
+}
+
+static std::string getBaseName(const std::string& path)
+{
+  size_t iSlash = path.rfind('/');
+  return (iSlash == std::string::npos) ? path : path.substr(iSlash + 1);
+}
+
+int GEC_RaidLayoutPlanner::readDevices(std::string host, std::string user, std::string password,
+                                       const std::vector<std::string>& devices, std::vector<GEC_DeviceInfo>& infos)
+{
+  // Partitions have no queue directory of their own, so fall back to the one of the disk
+  std::stringstream ss;
+  ss << "for d in";
+  for (size_t i = 0; i < devices.size(); ++i) {
+    ss << " " << getBaseName(devices[i]);
+  }
+  ss << "; do "
+     << "b=/sys/class/block/$d; q=$b/queue; [ -d $q ] || q=$b/../queue; "
+     << "if [ -r $q/logical_block_size ]; then "
+     << "echo GEC-DEV $d $(cat $q/logical_block_size) $(cat $q/physical_block_size) $(cat $q/minimum_io_size)"
+     << " $(cat $q/optimal_io_size) $(cat $q/rotational) $(cat $q/max_sectors_kb) $(cat $b/size); "
+     << "else echo GEC-MISSING $d; fi; done";
+
+  std::vector<std::string> output;
+  std::vector<std::string> error;
+  if (issue_command(host, user, password, ss.str(), output, error) != 0) {
+    return GEC_PLAN_NETWORK_ERROR;
+  }
+
+  infos.assign(devices.size(), GEC_DeviceInfo());
+  std::vector<bool> found(devices.size(), false);
+  for (size_t i = 0; i < output.size(); ++i) {
+    std::stringstream line(output[i]);
+    std::string tag;
+    std::string name;
+    line >> tag >> name;
+    if (tag != "GEC-DEV") {
+      continue;
+    }
+
+    for (size_t d = 0; d < devices.size(); ++d) {
+      if (getBaseName(devices[d]) != name) {
+        continue;
+      }
+      GEC_DeviceInfo& info = infos[d];
+      uint64_t maxSectorsKb = 0;
+      uint64_t numSectors = 0;
+      int rotational = 0;
+      line >> info.logicalBlockSize >> info.physicalBlockSize >> info.minimumIoSize
+           >> info.optimalIoSize >> rotational >> maxSectorsKb >> numSectors;
+      if (!line.fail()) {
+        info.name = devices[d];
+        info.isRotational = rotational != 0;
+        info.maxRequestSizeInBytes = maxSectorsKb * 1024;
+        info.sizeInBytes = numSectors * 512;  // sysfs counts 512 byte sectors regardless of the block size
+        found[d] = true;
+      }
+      break;
+    }
+  }
+
+  if (std::find(found.begin(), found.end(), false) != found.end()) {
+    return GEC_PLAN_NO_SUCH_DEVICE;
+  }
+  return GEC_PLAN_OK;
+}
+
+void GEC_RaidLayoutPlanner::getChunkLimits(const std::vector<GEC_DeviceInfo>& devices, uint64_t& minChunk,
+                                           uint64_t& maxChunk)
+{
+  // A chunk must hold whole physical blocks and fit in one request to every device
+  minChunk = MIN_CHUNK_SIZE;
+  maxChunk = MAX_CHUNK_SIZE;
+  for (size_t i = 0; i < devices.size(); ++i) {
+    minChunk = std::max(minChunk, devices[i].physicalBlockSize);
+    minChunk = std::max(minChunk, devices[i].minimumIoSize);
+    if (isPowerOfTwo(devices[i].optimalIoSize) && devices[i].optimalIoSize <= MAX_CHUNK_SIZE) {
+      minChunk = std::max(minChunk, devices[i].optimalIoSize);
+    }
+    if (devices[i].maxRequestSizeInBytes != 0) {
+      maxChunk = std::min(maxChunk, devices[i].maxRequestSizeInBytes);
+    }
+  }
+  maxChunk = std::max(maxChunk, minChunk);
+}
+
+GEC_RaidLayout GEC_RaidLayoutPlanner::plan(const std::vector<GEC_DeviceInfo>& devices, uint64_t writeSizeInBytes)
+{
+  uint64_t minChunk;
+  uint64_t maxChunk;
+  getChunkLimits(devices, minChunk, maxChunk);
+
+  // Largest power of two chunk that spreads one write over all devices
+  uint64_t perDevice = devices.empty() ? writeSizeInBytes : writeSizeInBytes / devices.size();
+  uint64_t chunk = minChunk;
+  while (chunk * 2 <= perDevice && chunk * 2 <= maxChunk) {
+    chunk *= 2;
+  }
+
+  GEC_RaidLayout layout = planWithChunkSize(devices, writeSizeInBytes, chunk);
+  if (perDevice < minChunk) {
+    std::stringstream note;
+    note << "A write of " << writeSizeInBytes / 1024 << " KiB is smaller than one chunk per device ("
+         << minChunk / 1024 << " KiB); writes of at least " << minChunk * devices.size() / 1024
+         << " KiB would use all devices at once";
+    layout.notes.push_back(note.str());
+  }
+  return layout;
+}
+
+GEC_RaidLayout GEC_RaidLayoutPlanner::planWithChunkSize(const std::vector<GEC_DeviceInfo>& devices,
+                                                        uint64_t writeSizeInBytes, uint64_t chunkSizeInBytes)
+{
+  GEC_RaidLayout layout;
+  uint64_t stripeSize = chunkSizeInBytes * devices.size();
+
+  layout.chunkSizeInBytes = chunkSizeInBytes;
+  layout.stride = chunkSizeInBytes / GEC_PLAN_FS_BLOCK_SIZE;
+  layout.stripeWidth = layout.stride * devices.size();
+  layout.isFullStripeAligned = stripeSize != 0 && writeSizeInBytes % stripeSize == 0;
+  layout.readAheadInSectors = 2 * std::max(stripeSize, writeSizeInBytes) / 512;
+
+  std::stringstream options;
+  options << "noatime,stripe=" << layout.stripeWidth;
+  layout.mountOptions = options.str();
+
+  if (!layout.isFullStripeAligned && stripeSize != 0) {
+    std::stringstream note;
+    note << "A write of " << writeSizeInBytes / 1024 << " KiB does not cover whole stripes of "
+         << stripeSize / 1024 << " KiB";
+    if (!isPowerOfTwo(devices.size())) {
+      note << "; with " << devices.size() << " devices, only write sizes that are a multiple of "
+           << stripeSize / 1024 << " KiB are aligned";
+    }
+    layout.notes.push_back(note.str());
+  }
+
+  bool anyRotational = false;
+  for (size_t i = 0; i < devices.size(); ++i) {
+    anyRotational = anyRotational || devices[i].isRotational;
+  }
+  if (anyRotational && chunkSizeInBytes < 256 * 1024) {
+    layout.notes.push_back("Rotational devices seek on every chunk boundary; chunks below 256 KiB cost throughput");
+  }
+
+  return layout;
+}
+
+std::vector<std::string> GEC_RaidLayoutPlanner::getSetupCommands(const GEC_RaidLayout& layout,
+                                                                 const std::vector<GEC_DeviceInfo>& devices,
+                                                                 std::string mdName, std::string mountPath)
+{
+  std::vector<std::string> commands;
+
+  std::stringstream create;
+  create << "echo y | /sbin/mdadm --create " << mdName << " --level=raid0 --raid-devices=" << devices.size()
+         << " --chunk=" << layout.chunkSizeInBytes / 1024;
+  for (size_t i = 0; i < devices.size(); ++i) {
+    create << " " << devices[i].name;
+  }
+  commands.push_back(create.str());
+
+  // Initialize inode tables and journal now, instead of in the background while recording
+  std::stringstream mkfs;
+  mkfs << "/sbin/mkfs.ext4 -b " << GEC_PLAN_FS_BLOCK_SIZE << " -T largefile4"
+       << " -E stride=" << layout.stride << ",stripe_width=" << layout.stripeWidth
+       << ",lazy_itable_init=0,lazy_journal_init=0 " << mdName;
+  commands.push_back(mkfs.str());
+
+  std::stringstream readAhead;
+  readAhead << "/sbin/blockdev --setra " << layout.readAheadInSectors << " " << mdName;
+  commands.push_back(readAhead.str());
+
+  commands.push_back("mkdir -p " + mountPath);
+  commands.push_back("mount -o " + layout.mountOptions + " " + mdName + " " + mountPath);
+
+  return commands;
+}
+
+std::vector<std::string> GEC_RaidLayoutPlanner::getTeardownCommands(const std::vector<GEC_DeviceInfo>& devices,
+                                                                    std::string mdName, std::string mountPath)
+{
+  std::vector<std::string> commands;
+  commands.push_back("umount " + mountPath);
+  commands.push_back("/sbin/mdadm --stop " + mdName);
+
+  std::stringstream zero;
+  zero << "/sbin/mdadm --zero-superblock";
+  for (size_t i = 0; i < devices.size(); ++i) {
+    zero << " " << devices[i].name;
+  }
+  commands.push_back(zero.str());
+
+  return commands;
+}
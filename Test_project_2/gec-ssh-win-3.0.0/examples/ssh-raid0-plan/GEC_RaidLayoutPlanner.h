@@ -0,0 +1,114 @@
+#ifndef GEC_RAIDLAYOUTPLANNER_H_
+#define GEC_RAIDLAYOUTPLANNER_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define GEC_PLAN_OK              0
+#define GEC_PLAN_NETWORK_ERROR   (-1)
+#define GEC_PLAN_NO_SUCH_DEVICE  (-2)
+
+#define GEC_PLAN_FS_BLOCK_SIZE   4096
+
+/**
+  Block device characteristics, as reported by the kernel in sysfs
+*/
+struct GEC_DeviceInfo
+{
+  GEC_DeviceInfo()
+    : logicalBlockSize(0)
+    , physicalBlockSize(0)
+    , minimumIoSize(0)
+    , optimalIoSize(0)
+    , maxRequestSizeInBytes(0)
+    , sizeInBytes(0)
+    , isRotational(false)
+  {}
+
+  std::string name;            // Device path, as in /dev/sdb
+  uint64_t logicalBlockSize;
+  uint64_t physicalBlockSize;
+  uint64_t minimumIoSize;
+  uint64_t optimalIoSize;      // 0 when the device does not report one
+  uint64_t maxRequestSizeInBytes;
+  uint64_t sizeInBytes;
+  bool isRotational;
+};
+
+/**
+  RAID0 array and ext4 file system layout, with the commands creating it
+*/
+struct GEC_RaidLayout
+{
+  GEC_RaidLayout()
+    : chunkSizeInBytes(0)
+    , stride(0)
+    , stripeWidth(0)
+    , readAheadInSectors(0)
+    , isFullStripeAligned(false)
+  {}
+
+  uint64_t chunkSizeInBytes;   // Bytes written to one device before moving on to the next
+  uint64_t stride;             // Chunk size in file system blocks
+  uint64_t stripeWidth;        // Full stripe size in file system blocks
+  uint64_t readAheadInSectors;
+  bool isFullStripeAligned;    // true if every recorder write covers whole stripes
+  std::string mountOptions;
+  std::vector<std::string> notes;
+};
+
+/**
+  Plans a stripe-aligned RAID0 array and ext4 file system for recording
+
+  The recorder writes its data file sequentially in blocks of a fixed
+  size. The layout is chosen so that every such write covers whole
+  stripes: all devices then receive one chunk of equal size per write,
+  and no device waits for a read-modify-write or a split request. The
+  file system is told the stripe geometry, so the ext4 allocator places
+  extents on stripe boundaries.
+*/
+class GEC_RaidLayoutPlanner
+{
+public:
+  /**
+    Reads the characteristics of the given devices from sysfs on the
+    server
+
+    @return
+    GEC_PLAN_OK on success
+  */
+  static int readDevices(std::string host, std::string user, std::string password,
+                         const std::vector<std::string>& devices, std::vector<GEC_DeviceInfo>& infos);
+
+  /**
+    Chooses the layout for the devices and the recorder write size
+  */
+  static GEC_RaidLayout plan(const std::vector<GEC_DeviceInfo>& devices, uint64_t writeSizeInBytes);
+
+  /**
+    Returns the smallest and the largest chunk size all devices support:
+    whole physical blocks, and no more than one request to any device
+  */
+  static void getChunkLimits(const std::vector<GEC_DeviceInfo>& devices, uint64_t& minChunk, uint64_t& maxChunk);
+
+  /**
+    Derives a layout with a given chunk size, e.g. as a benchmark candidate
+  */
+  static GEC_RaidLayout planWithChunkSize(const std::vector<GEC_DeviceInfo>& devices, uint64_t writeSizeInBytes,
+                                          uint64_t chunkSizeInBytes);
+
+  /**
+    Returns the commands creating, formatting, and mounting the array
+  */
+  static std::vector<std::string> getSetupCommands(const GEC_RaidLayout& layout, const std::vector<GEC_DeviceInfo>& devices,
+                                                   std::string mdName, std::string mountPath);
+
+  /**
+    Returns the commands unmounting and dismantling the array again
+  */
+  static std::vector<std::string> getTeardownCommands(const std::vector<GEC_DeviceInfo>& devices,
+                                                      std::string mdName, std::string mountPath);
+};
+
+#endif /* GEC_RAIDLAYOUTPLANNER_H_ */
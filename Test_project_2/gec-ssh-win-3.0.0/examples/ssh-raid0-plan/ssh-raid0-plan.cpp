@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "ssh-common.h"
+
+#include "GEC_RaidLayoutPlanner.h"
+#include "GEC_ThroughputTest.h"
+
+void printUsage()
+{
+  std::cout << "Usage: ssh-raid0-plan <server> <md-name> <mount-path> <dev-name-0> <dev-name-1> ..." << std::endl
+            << "                      [--write-size=<KiB>] [--apply] [--benchmark]" << std::endl
+            << std::endl
+            << "where: <server> is the host name or IP address to the server" << std::endl
+            << "       <md-name> is the device name to be used for the created RAID device" << std::endl
+            << "       <mount-path> is the full path where the resulting file system is mounted" << std::endl
+            << "       <dev-name-N> is the device name of a disk device to be included in the RAID" << std::endl
+            << "                    At least 2 disk device names must be specified" << std::endl
+            << "       <KiB> is the size of the blocks the recorder writes (default 4096)" << std::endl
+            << "       --apply runs the planned commands on the server" << std::endl
+            << "       --benchmark creates, tests, and removes the array once per candidate chunk size," << std::endl
+            << "                   and plans the fastest one. ALL DATA ON THE DEVICES IS LOST." << std::endl;
+}
+
+static bool hasPrefix(const std::string& text, const std::string& prefix)
+{
+  return text.compare(0, prefix.length(), prefix) == 0;
+}
+
+static std::string joinCommands(const std::vector<std::string>& commands)
+{
+  std::string joined;
+  for (size_t i = 0; i < commands.size(); ++i) {
+    joined += (i == 0) ? commands[i] : " && " + commands[i];
+  }
+  return joined;
+}
+
+static bool runCommands(std::string host, const std::vector<std::string>& commands, bool printOutput)
+{
+  std::vector<std::string> output;
+  std::vector<std::string> error;
+  // The output is merged, so a failing step shows up in order
+  if (issue_command(host, "root", "", "(" + joinCommands(commands) + ") 2>&1; echo GEC-RC $?", output, error) != 0) {
+    return false;
+  }
+
+  bool succeeded = false;
+  for (size_t i = 0; i < output.size(); ++i) {
+    if (output[i] == "GEC-RC 0") {
+      succeeded = true;
+    } else if (printOutput && !hasPrefix(output[i], "GEC-RC ")) {
+      std::cout << std::setw(3) << i << ": " << output[i] << std::endl;
+    }
+  }
+  return succeeded;
+}
+
+static void printLayout(const GEC_RaidLayout& layout)
+{
+  std::cout << "  chunk size:    " << layout.chunkSizeInBytes / 1024 << " KiB" << std::endl
+            << "  stride:        " << layout.stride << " blocks" << std::endl
+            << "  stripe width:  " << layout.stripeWidth << " blocks" << std::endl
+            << "  aligned:       " << (layout.isFullStripeAligned ? "every write covers whole stripes" : "no") << std::endl
+            << "  mount options: " << layout.mountOptions << std::endl;
+  for (size_t i = 0; i < layout.notes.size(); ++i) {
+    std::cout << "  NOTE: " << layout.notes[i] << std::endl;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  uint64_t writeSizeInBytes = 4 * 1024 * 1024;
+  bool apply = false;
+  bool benchmark = false;
+  std::vector<std::string> deviceNames;
+  for (int i = 4; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if (hasPrefix(arg, "--write-size=")) {
+      writeSizeInBytes = strtoull(arg.substr(13).c_str(), NULL, 10) * 1024;
+    } else if (arg == "--apply") {
+      apply = true;
+    } else if (arg == "--benchmark") {
+      benchmark = true;
+    } else {
+      deviceNames.push_back(arg);
+    }
+  }
+
+  if (argc < 6 || deviceNames.size() < 2 || writeSizeInBytes == 0) {
+    std::cout << "ERROR: Incorrect arguments" << std::endl
+              << std::endl;
+    printUsage();
+    return (-1);
+  }
+
+  std::string host(argv[1]);
+  std::string mdName(argv[2]);
+  std::string mountPath(argv[3]);
+
+  std::vector<GEC_DeviceInfo> devices;
+  int rc = GEC_RaidLayoutPlanner::readDevices(host, "root", "", deviceNames, devices);
+  if (rc == GEC_PLAN_NETWORK_ERROR) {
+    std::cout << "ERROR: Could not connect to " << host << std::endl;
+    return (-1);
+  } else if (rc == GEC_PLAN_NO_SUCH_DEVICE) {
+    std::cout << "ERROR: Not all devices were found in sysfs on " << host << std::endl;
+    return (-1);
+  }
+
+  std::cout << "Devices:" << std::endl;
+  for (size_t i = 0; i < devices.size(); ++i) {
+    const GEC_DeviceInfo& device = devices[i];
+    std::cout << "  " << std::setw(14) << std::left << device.name << std::right
+              << std::setw(8) << device.sizeInBytes / (1024 * 1024 * 1024) << " GiB, "
+              << (device.isRotational ? "rotational" : "solid state") << ", blocks "
+              << device.logicalBlockSize << "/" << device.physicalBlockSize << ", io min/opt "
+              << device.minimumIoSize << "/" << device.optimalIoSize << ", max request "
+              << device.maxRequestSizeInBytes / 1024 << " KiB" << std::endl;
+  }
+
+  GEC_RaidLayout layout = GEC_RaidLayoutPlanner::plan(devices, writeSizeInBytes);
+
+  if (benchmark) {
+    // The plan, its neighbours, and the mdadm default, as far as the devices support them
+    uint64_t minChunk;
+    uint64_t maxChunk;
+    GEC_RaidLayoutPlanner::getChunkLimits(devices, minChunk, maxChunk);
+    std::vector<uint64_t> chunkSizes;
+    chunkSizes.push_back(layout.chunkSizeInBytes);
+    chunkSizes.push_back(layout.chunkSizeInBytes / 2);
+    chunkSizes.push_back(layout.chunkSizeInBytes * 2);
+    chunkSizes.push_back(512 * 1024);
+
+    GEC_ThroughputTest test(host, "root", "");
+    test.setBlockSize(writeSizeInBytes);
+    test.setDuration(20);
+
+    std::vector<std::string> teardown = GEC_RaidLayoutPlanner::getTeardownCommands(devices, mdName, mountPath);
+    double bestBytesPerSecond = 0;
+    std::cout << std::endl << "Benchmark:" << std::endl;
+    for (size_t i = 0; i < chunkSizes.size(); ++i) {
+      bool isDuplicate = std::find(chunkSizes.begin(), chunkSizes.begin() + i, chunkSizes[i]) != chunkSizes.begin() + i;
+      bool isSupported = chunkSizes[i] >= minChunk && chunkSizes[i] <= maxChunk;
+      if (chunkSizes[i] < GEC_PLAN_FS_BLOCK_SIZE || !isSupported || isDuplicate) {
+        continue;
+      }
+
+      GEC_RaidLayout candidate = GEC_RaidLayoutPlanner::planWithChunkSize(devices, writeSizeInBytes, chunkSizes[i]);
+      std::cout << "  chunk " << std::setw(5) << chunkSizes[i] / 1024 << " KiB: " << std::flush;
+
+      GEC_ThroughputResult result;
+      bool created = runCommands(host, GEC_RaidLayoutPlanner::getSetupCommands(candidate, devices, mdName, mountPath), false);
+      int rcTest = created ? test.run(mountPath, result) : GEC_THROUGHPUT_TEST_FAILED;
+      runCommands(host, teardown, false);
+
+      if (rcTest != GEC_THROUGHPUT_OK) {
+        std::cout << "failed" << std::endl;
+        continue;
+      }
+      std::cout << std::fixed << std::setprecision(1)
+                << "write " << result.writeBytesPerSecond / 1e6 << " MB/s, read "
+                << result.readBytesPerSecond / 1e6 << " MB/s";
+      if (result.usedFio) {
+        std::cout << ", p99.9 write latency " << result.writeLatencyP999InUs / 1000 << " ms";
+      }
+      std::cout << std::endl;
+
+      if (result.writeBytesPerSecond > bestBytesPerSecond) {
+        bestBytesPerSecond = result.writeBytesPerSecond;
+        layout = candidate;
+      }
+    }
+  }
+
+  std::cout << std::endl << "Layout for " << devices.size() << " devices and "
+            << writeSizeInBytes / 1024 << " KiB writes:" << std::endl;
+  printLayout(layout);
+
+  std::vector<std::string> commands = GEC_RaidLayoutPlanner::getSetupCommands(layout, devices, mdName, mountPath);
+  std::cout << std::endl << "Commands:" << std::endl;
+  for (size_t i = 0; i < commands.size(); ++i) {
+    std::cout << "  " << commands[i] << std::endl;
+  }
+
+  if (apply) {
+    std::cout << std::endl << "Applying ..." << std::endl;
+    if (!runCommands(host, commands, true)) {
+      std::cout << "ERROR: Setting up the array failed" << std::endl;
+      return 1;
+    }
+    std::cout << mdName << " is mounted on " << mountPath << std::endl;
+  }
+
+  return 0;
+}
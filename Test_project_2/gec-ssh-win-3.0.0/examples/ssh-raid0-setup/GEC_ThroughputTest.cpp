@@ -0,0 +1,162 @@
+#include <cstdlib>
+#include <sstream>
+
+#include "ssh-common.h"
+
+#include "GEC_ThroughputTest.h"
+
+#define FIO_TERSE_READ_FIRST   5   // Index of the first read field in fio terse version 3 output
+#define FIO_TERSE_WRITE_FIRST  46  // Index of the first write field
+#define FIO_TERSE_BW           1   // Bandwidth in KiB/s, relative to the first field of a direction
+#define FIO_TERSE_CLAT_MAX     9   // Maximum completion latency in us
+#define FIO_TERSE_CLAT_PCT     12  // First of 20 completion latency percentiles, as "<p>%=<us>"
+#define FIO_TERSE_NUM_PCT      20
+
+GEC_ThroughputTest::GEC_ThroughputTest(std::string host, std::string user, std::string password)
+  : m_host(host)
+  , m_user(user)
+  , m_password(password)
+  , m_blockSizeInBytes(4 * 1024 * 1024)
+  , m_queueDepth(4)
+  , m_fileSizeInBytes(16ULL * 1024 * 1024 * 1024)
+  , m_durationInS(30)
+{
+}
+
+std::string GEC_ThroughputTest::buildCommand(std::string fileName)
+{
+  std::stringstream fio;
+  fio << "fio --filename='" << fileName << "' --bs=" << m_blockSizeInBytes
+      << " --size=" << m_fileSizeInBytes << " --direct=1 --ioengine=libaio --iodepth=" << m_queueDepth
+      << " --output-format=terse --terse-version=3";
+
+  std::stringstream ss;
+  ss << "export LC_ALL=C; "
+     << "if command -v fio >/dev/null 2>&1; then "
+     << "echo GEC-TOOL fio; "
+     << fio.str() << " --name=write --rw=write --time_based --runtime=" << m_durationInS
+     << " --end_fsync=1 | sed 's/^/GEC-WRITE /'; "
+     << fio.str() << " --name=read --rw=read --time_based --runtime=" << m_durationInS
+     << " | sed 's/^/GEC-READ /'; "
+     << "else "
+     << "echo GEC-TOOL dd; "
+     << "dd if=/dev/zero of='" << fileName << "' bs=" << m_blockSizeInBytes
+     << " count=" << m_fileSizeInBytes / m_blockSizeInBytes << " oflag=direct conv=fsync 2>&1"
+     << " | tail -n 1 | sed 's/^/GEC-WRITE /'; "
+     << "dd if='" << fileName << "' of=/dev/null bs=" << m_blockSizeInBytes << " iflag=direct 2>&1"
+     << " | tail -n 1 | sed 's/^/GEC-READ /'; "
+     << "fi; "
+     << "rm -f '" << fileName << "'";
+  return ss.str();
+}
+
+static std::vector<std::string> splitFields(const std::string& line, char separator)
+{
+  std::vector<std::string> fields;
+  std::stringstream ss(line);
+  std::string field;
+  while (std::getline(ss, field, separator)) {
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+bool GEC_ThroughputTest::parseFioTerse(const std::string& line, bool isWrite, GEC_ThroughputResult& result)
+{
+  std::vector<std::string> fields = splitFields(line, ';');
+  if (fields.size() < FIO_TERSE_WRITE_FIRST + FIO_TERSE_CLAT_PCT + FIO_TERSE_NUM_PCT || fields[0] != "3") {
+    return false;
+  }
+
+  size_t first = isWrite ? FIO_TERSE_WRITE_FIRST : FIO_TERSE_READ_FIRST;
+  double bytesPerSecond = atof(fields[first + FIO_TERSE_BW].c_str()) * 1024;
+  if (!isWrite) {
+    result.readBytesPerSecond = bytesPerSecond;
+    return true;
+  }
+
+  result.writeBytesPerSecond = bytesPerSecond;
+  result.writeLatencyMaxInUs = atof(fields[first + FIO_TERSE_CLAT_MAX].c_str());
+  for (size_t i = 0; i < FIO_TERSE_NUM_PCT; ++i) {
+    const std::string& percentile = fields[first + FIO_TERSE_CLAT_PCT + i];
+    size_t iEqual = percentile.find("%=");
+    if (iEqual == std::string::npos) {
+      continue;
+    }
+    double p = atof(percentile.substr(0, iEqual).c_str());
+    double latencyInUs = atof(percentile.substr(iEqual + 2).c_str());
+    if (p == 99.0) {
+      result.writeLatencyP99InUs = latencyInUs;
+    } else if (p == 99.9) {
+      result.writeLatencyP999InUs = latencyInUs;
+    }
+  }
+  return true;
+}
+
+bool GEC_ThroughputTest::parseDdSummary(const std::string& line, double& bytesPerSecond)
+{
+  // "<bytes> bytes (<size>) copied, <seconds> s, <rate>"
+  size_t iSeconds = line.find(" s,");
+  size_t iCopied = line.rfind(", ", iSeconds);
+  if (iSeconds == std::string::npos || iCopied == std::string::npos) {
+    return false;
+  }
+
+  double bytes = atof(line.c_str());
+  double seconds = atof(line.substr(iCopied + 2, iSeconds - iCopied - 2).c_str());
+  if (bytes <= 0 || seconds <= 0) {
+    return false;
+  }
+  bytesPerSecond = bytes / seconds;
+  return true;
+}
+
+int GEC_ThroughputTest::run(std::string mountPath, GEC_ThroughputResult& result)
+{
+  std::vector<std::string> output;
+  std::vector<std::string> error;
+  if (issue_command(m_host, m_user, m_password, buildCommand(mountPath + "/.gec-throughput-test"), output, error) != 0) {
+    return GEC_THROUGHPUT_NETWORK_ERROR;
+  }
+
+  result = GEC_ThroughputResult();
+  bool hasWrite = false;
+  bool hasRead = false;
+  for (size_t i = 0; i < output.size(); ++i) {
+    const std::string& line = output[i];
+    if (line == "GEC-TOOL fio") {
+      result.usedFio = true;
+    } else if (line.compare(0, 10, "GEC-WRITE ") == 0) {
+      hasWrite = result.usedFio ? parseFioTerse(line.substr(10), true, result)
+                                : parseDdSummary(line.substr(10), result.writeBytesPerSecond);
+    } else if (line.compare(0, 9, "GEC-READ ") == 0) {
+      hasRead = result.usedFio ? parseFioTerse(line.substr(9), false, result)
+                               : parseDdSummary(line.substr(9), result.readBytesPerSecond);
+    }
+  }
+
+  return (hasWrite && hasRead) ? GEC_THROUGHPUT_OK : GEC_THROUGHPUT_TEST_FAILED;
+}
+
+bool GEC_ThroughputTest::keepsUp(const GEC_ThroughputResult& result, double requiredBytesPerSecond, std::string& reason)
+{
+  std::stringstream ss;
+  if (result.writeBytesPerSecond < requiredBytesPerSecond) {
+    ss << "sustained write rate " << result.writeBytesPerSecond / 1e6 << " MB/s is below the required "
+       << requiredBytesPerSecond / 1e6 << " MB/s";
+    reason = ss.str();
+    return false;
+  }
+
+  double bufferTimeInUs = 1e6 * m_queueDepth * m_blockSizeInBytes / requiredBytesPerSecond;
+  if (result.writeLatencyMaxInUs > bufferTimeInUs) {
+    ss << "longest write took " << result.writeLatencyMaxInUs / 1000 << " ms, but " << m_queueDepth
+       << " blocks in flight only buffer " << bufferTimeInUs / 1000 << " ms at the required rate";
+    reason = ss.str();
+    return false;
+  }
+
+  reason.clear();
+  return true;
+}
@@ -0,0 +1,98 @@
+#ifndef GEC_THROUGHPUTTEST_H_
+#define GEC_THROUGHPUTTEST_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define GEC_THROUGHPUT_OK              0
+#define GEC_THROUGHPUT_NETWORK_ERROR   (-1)
+#define GEC_THROUGHPUT_TEST_FAILED     (-2)
+
+/**
+  Result of one throughput test. Latencies are those of single block
+  writes, and are 0 when the tool used does not measure them.
+*/
+struct GEC_ThroughputResult
+{
+  GEC_ThroughputResult()
+    : usedFio(false)
+    , writeBytesPerSecond(0)
+    , readBytesPerSecond(0)
+    , writeLatencyP99InUs(0)
+    , writeLatencyP999InUs(0)
+    , writeLatencyMaxInUs(0)
+  {}
+
+  bool usedFio;
+  double writeBytesPerSecond;
+  double readBytesPerSecond;
+  double writeLatencyP99InUs;
+  double writeLatencyP999InUs;
+  double writeLatencyMaxInUs;
+};
+
+/**
+  Sustained sequential write and read test of a mounted file system
+
+  The test writes a file on the remote file system with direct I/O,
+  bypassing the page cache like the recorder does, in blocks of the size
+  the recorder writes, with several blocks in flight. The file is then
+  read back the same way and deleted.
+
+  The test uses fio when it is installed on the server, which also
+  measures the latency of every write. Otherwise it falls back to dd with
+  oflag=direct, which only measures the throughput.
+*/
+class GEC_ThroughputTest
+{
+public:
+  GEC_ThroughputTest(std::string host, std::string user, std::string password);
+
+  void setBlockSize(uint64_t blockSizeInBytes) { m_blockSizeInBytes = blockSizeInBytes; }
+  void setQueueDepth(unsigned queueDepth) { m_queueDepth = queueDepth; }
+  void setFileSize(uint64_t fileSizeInBytes) { m_fileSizeInBytes = fileSizeInBytes; }
+  void setDuration(unsigned durationInS) { m_durationInS = durationInS; }
+
+  uint64_t getBlockSize() { return m_blockSizeInBytes; }
+  unsigned getQueueDepth() { return m_queueDepth; }
+
+  /**
+    Runs the test in the file system mounted at @p mountPath
+
+    @return
+    GEC_THROUGHPUT_OK on success
+  */
+  int run(std::string mountPath, GEC_ThroughputResult& result);
+
+  /**
+    Checks whether a result keeps up with the data rate of the recorder
+
+    Besides the mean write rate, the longest write must not take longer
+    than the recorder can buffer: with 'queue depth' blocks in flight, a
+    stalled write has to complete before the data arriving meanwhile
+    fills all of them.
+
+    @param reason
+    Receives the explanation when the result is insufficient
+
+    @return
+    true if the file system can record at @p requiredBytesPerSecond
+  */
+  bool keepsUp(const GEC_ThroughputResult& result, double requiredBytesPerSecond, std::string& reason);
+
+private:
+  std::string buildCommand(std::string fileName);
+  static bool parseFioTerse(const std::string& line, bool isWrite, GEC_ThroughputResult& result);
+  static bool parseDdSummary(const std::string& line, double& bytesPerSecond);
+
+  std::string m_host;
+  std::string m_user;
+  std::string m_password;
+  uint64_t m_blockSizeInBytes;
+  unsigned m_queueDepth;
+  uint64_t m_fileSizeInBytes;
+  unsigned m_durationInS;
+};
+
+#endif /* GEC_THROUGHPUTTEST_H_ */
@@ -1,32 +1,131 @@
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 
 #include "ssh-common.h"
 
+#include "GEC_SfpdpLinkRate.h"
+#include "GEC_ThroughputTest.h"
+
 void printUsage()
 {
-  std::cout << "Usage: ssh-raid0-setup <server> <md-name> <mount-path> <dev-name-0> <dev-name-1> ..." << std::endl
+  std::cout << "Usage: ssh-raid0-setup <server> <md-name> <mount-path> <dev-name-0> <dev-name-1> ... [--validate]" << std::endl
+            << "                       [--ports=<n>] [--link-speed=<gbps>] [--block-size=<KiB>] [--test-size=<MiB>]" << std::endl
 	    << std::endl
 	    << "where: <server> is the host name or IP address to the server" << std::endl
 	    << "       <md-name> is the device name to be used for the created RAID device" << std::endl
 	    << "       <mount-path> is the full path where the resulting file system is mounted" << std::endl
 	    << "       <dev-name-N> is the device name of a disk device to be included in the RAID" << std::endl
-	    << "                    At least 2 disk device names must be specified" << std::endl;
+	    << "                    At least 2 disk device names must be specified" << std::endl
+	    << "       --validate runs a sustained write and read test on the new file system, and checks" << std::endl
+	    << "                  that it keeps up with <n> Serial FPDP ports recording at <gbps>" << std::endl
+	    << "                  (default " << GEC_SFPDP_MAX_PORTS << " ports at 4.25 Gbps, in blocks of 4096 KiB)" << std::endl;
+}
+
+static bool hasPrefix(const std::string& text, const std::string& prefix)
+{
+  return text.compare(0, prefix.length(), prefix) == 0;
+}
+
+// Whether the file system mounted at mountPath is the one on mdName, under any name of the device
+static bool isMountedFrom(std::string host, std::string mdName, std::string mountPath)
+{
+  std::vector<std::string> output;
+  std::vector<std::string> error;
+  std::string command = "echo \"GEC-MOUNTED $(readlink -f \"$(findmnt -no SOURCE --mountpoint " + mountPath + ")\")\"; "
+                        "echo \"GEC-DEVICE $(readlink -f " + mdName + ")\"";
+  if (issue_command(host, "root", "", command, output, error) != 0) {
+    return false;
+  }
+  std::string mounted;
+  std::string device;
+  for (size_t i = 0; i < output.size(); ++i) {
+    if (hasPrefix(output[i], "GEC-MOUNTED ")) {
+      mounted = output[i].substr(12);
+    } else if (hasPrefix(output[i], "GEC-DEVICE ")) {
+      device = output[i].substr(11);
+    }
+  }
+  if (mounted.empty() || mounted != device) {
+    std::cout << "ERROR: " << mountPath << " is not mounted from " << mdName
+              << (mounted.empty() ? std::string(" but from nothing") : " but from " + mounted) << std::endl;
+    return false;
+  }
+  return true;
+}
+
+static int validate(std::string host, std::string mountPath, GEC_ThroughputTest& test,
+                    int numPorts, int linkSpeed)
+{
+  double requiredBytesPerSecond = double(numPorts) * GEC_sfpdpDataRateInBytesPerSecond(linkSpeed);
+
+  std::cout << "Validating " << mountPath << " on " << host << " with " << test.getBlockSize() / 1024
+            << " KiB blocks, " << test.getQueueDepth() << " in flight ..." << std::endl;
+
+  GEC_ThroughputResult result;
+  int rc = test.run(mountPath, result);
+  if (rc != GEC_THROUGHPUT_OK) {
+    std::cout << "ERROR: The throughput test could not be run" << std::endl;
+    return rc;
+  }
+
+  std::cout << std::fixed << std::setprecision(1)
+            << "  tool:      " << (result.usedFio ? "fio" : "dd (no latency figures)") << std::endl
+            << "  write:     " << result.writeBytesPerSecond / 1e6 << " MB/s" << std::endl
+            << "  read:      " << result.readBytesPerSecond / 1e6 << " MB/s" << std::endl;
+  if (result.usedFio) {
+    std::cout << "  latency:   p99 " << result.writeLatencyP99InUs / 1000 << " ms, p99.9 "
+              << result.writeLatencyP999InUs / 1000 << " ms, max " << result.writeLatencyMaxInUs / 1000
+              << " ms" << std::endl;
+  }
+  std::cout << "  required:  " << requiredBytesPerSecond / 1e6 << " MB/s for " << numPorts << " ports" << std::endl
+            << "  headroom:  " << 100.0 * (result.writeBytesPerSecond / requiredBytesPerSecond - 1.0) << " %" << std::endl;
+
+  std::string reason;
+  if (!test.keepsUp(result, requiredBytesPerSecond, reason)) {
+    std::cout << "WARNING: Recordings on this array will overflow: " << reason << std::endl;
+    return GEC_THROUGHPUT_TEST_FAILED;
+  }
+  std::cout << "The array keeps up with the recorder" << std::endl;
+  return GEC_THROUGHPUT_OK;
 }
 
 int main(int argc, char* argv[]) 
 {
-  if (argc < 6) {
-    std::cout << "ERROR: Incorrect number of arguments" << std::endl
+  std::vector<std::string> devices;
+  bool runValidation = false;
+  int numPorts = GEC_SFPDP_MAX_PORTS;
+  int linkSpeed = GEC_sfpdpParseLinkSpeed("4.25");
+  GEC_ThroughputTest test(argc > 1 ? argv[1] : "", "root", "");
+  for (int i = 4; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if (arg == "--validate") {
+      runValidation = true;
+    } else if (hasPrefix(arg, "--ports=")) {
+      numPorts = atoi(arg.substr(8).c_str());
+    } else if (hasPrefix(arg, "--link-speed=")) {
+      linkSpeed = GEC_sfpdpParseLinkSpeed(arg.substr(13));
+    } else if (hasPrefix(arg, "--block-size=")) {
+      test.setBlockSize(strtoull(arg.substr(13).c_str(), NULL, 10) * 1024);
+    } else if (hasPrefix(arg, "--test-size=")) {
+      test.setFileSize(strtoull(arg.substr(12).c_str(), NULL, 10) * 1024 * 1024);
+    } else {
+      devices.push_back(arg);
+    }
+  }
+
+  if (argc < 6 || devices.size() < 2 || numPorts <= 0 || linkSpeed < 0 || test.getBlockSize() == 0) {
+    std::cout << "ERROR: Incorrect arguments" << std::endl
     << std::endl;
     printUsage();
+    return (-1);
   }
 
   std::stringstream ss;
-  ss << "echo y | /sbin/mdadm --create " << argv[2] << " --level=raid0 --raid-devices=" << argc - 4;
-  for (int i = 4; i < argc; ++i) {
-    ss << " " << argv[i];
+  ss << "echo y | /sbin/mdadm --create " << argv[2] << " --level=raid0 --raid-devices=" << devices.size();
+  for (size_t i = 0; i < devices.size(); ++i) {
+    ss << " " << devices[i];
   }
   ss << " && ";
   ss << "/sbin/mkfs.ext4 -b 4096 " << argv[2] << " && ";
@@ -37,16 +136,31 @@ int main(int argc, char* argv[])
   std::vector<std::string> output;
   std::vector<std::string> error;
 
-  if (issue_command(argv[1], "root", "", command, output, error) == 0) {
-    if (!output.empty()) {
-      for (size_t i = 0; i < output.size(); ++i) {
-        std::cout << std::setw(3) << i << ": " << output[i] << std::endl;
-      }
-    } else if (!error.empty()) {
-      std::cout << "Command probably failed - return from 'stderr': " << std::endl;
-      for (size_t i = 0; i < error.size(); ++i) {
-        std::cout << std::setw(3) << i << ": " << error[i] << std::endl;
-      }
+  // The output is merged, so a failing step shows up in order, and the exit status is echoed last: a command
+  // that could be run says nothing yet about whether the array was made
+  if (issue_command(argv[1], "root", "", "(" + command + ") 2>&1; echo GEC-RC $?", output, error) != 0) {
+    std::cout << "ERROR: The command could not be run on " << argv[1] << std::endl;
+    return 1;
+  }
+  bool succeeded = false;
+  for (size_t i = 0; i < output.size(); ++i) {
+    if (output[i] == "GEC-RC 0") {
+      succeeded = true;
+    } else if (!hasPrefix(output[i], "GEC-RC ")) {
+      std::cout << std::setw(3) << i << ": " << output[i] << std::endl;
+    }
+  }
+  if (!succeeded) {
+    std::cout << "ERROR: Creating, formatting or mounting " << argv[2] << " failed" << std::endl;
+    return 1;
+  }
+
+  if (runValidation) {
+    // Otherwise the test would measure, and fill, whatever file system holds the mount point
+    if (!isMountedFrom(argv[1], argv[2], argv[3])) {
+      return 1;
     }
+    return (validate(argv[1], argv[3], test, numPorts, linkSpeed) == GEC_THROUGHPUT_OK) ? 0 : 1;
   }
+  return 0;
 }
@@ -4,39 +4,66 @@
 
 #include "ssh-common.h"
 
+#include "GEC_CapacityQuery.h"
+
 void printUsage()
 {
-  std::cout << "Usage: ssh-stat <server> <path>" << std::endl
+  std::cout << "Usage: ssh-stat <server>[,<server>...] <path> [<path>...]" << std::endl
 	    << std::endl
 	    << "where: <server> is the host name or IP address to the server" << std::endl
-	    << "       <path> is the full path a directory to find available space for" << std::endl;
+	    << "       <path> is the full path a directory to find available space for" << std::endl
+	    << std::endl
+	    << "All paths are queried on all servers in one batch." << std::endl;
 }
 
 int main(int argc, char* argv[]) 
 {
-  if (argc != 3) {
+  if (argc < 3) {
     std::cout << "ERROR: Incorrect number of arguments" << std::endl
 	      << std::endl;
     printUsage();
+    return (-1);
+  }
+
+  std::vector<std::string> servers;
+  std::stringstream serverList(argv[1]);
+  std::string server;
+  while (std::getline(serverList, server, ',')) {
+    if (!server.empty()) {
+      servers.push_back(server);
+    }
   }
 
-  std::string command = std::string("stat --file-system --format=\"%s %a\" ") + std::string(argv[2]);
-  std::cout << "command = " << command << std::endl;
-  std::vector<std::string> output;
-  std::vector<std::string> error;
-
-  if (issue_command(argv[1], "root", "", command, output, error) == 0) {
-    if (!output.empty()) {
-      uint64_t blockSizeInBytes = 0;
-      uint64_t numFreeBlocks = 0;
-      std::stringstream(output[0]) >> blockSizeInBytes >> numFreeBlocks;      
-      std::cout << numFreeBlocks << " free blocks a " << blockSizeInBytes << " bytes = "
-                << numFreeBlocks * blockSizeInBytes << " bytes free" << std::endl;      
-    } else if (!error.empty()) {
-      std::cout << "Command probably failed - return from 'stderr': " << std::endl;
-      for (size_t i = 0; i < error.size(); ++i) {
-        std::cout << std::setw(3) << i << ": " << error[i] << std::endl;
-      }
+  GEC_CapacityQuery query("root", "", 4);
+  for (size_t s = 0; s < servers.size(); ++s) {
+    for (int i = 2; i < argc; ++i) {
+      query.add(servers[s], argv[i]);
     }
   }
+
+  std::vector<GEC_Capacity> capacities;
+  int rc = query.run(capacities);
+  bool allValid = true;
+
+  for (size_t i = 0; i < capacities.size(); ++i) {
+    const GEC_Capacity& capacity = capacities[i];
+    std::cout << capacity.host << ":" << capacity.path << ": ";
+    if (capacity.rc == GEC_CAPACITY_OK && capacity.blockSizeInBytes == 0) {
+      std::cout << "ERROR: The server reported a block size of 0" << std::endl;
+      allValid = false;
+    } else if (capacity.rc == GEC_CAPACITY_OK) {
+      std::cout << capacity.availableBytes / capacity.blockSizeInBytes << " free blocks a "
+                << capacity.blockSizeInBytes << " bytes = "
+                << capacity.availableBytes << " of " << capacity.totalBytes << " bytes free, "
+                << capacity.availableInodes << " of " << capacity.totalInodes << " inodes free" << std::endl;
+    } else if (capacity.rc == GEC_CAPACITY_NOT_EXISTING) {
+      std::cout << "ERROR: No such path" << std::endl;
+    } else if (capacity.rc == GEC_CAPACITY_NOT_SUPPORTED) {
+      std::cout << "ERROR: The SFTP server does not support statvfs" << std::endl;
+    } else {
+      std::cout << "ERROR: Could not open an SFTP session" << std::endl;
+    }
+  }
+
+  return (rc == GEC_CAPACITY_OK && allValid) ? 0 : 1;
 }
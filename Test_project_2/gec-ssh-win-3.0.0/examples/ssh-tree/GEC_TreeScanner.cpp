@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <thread>
+
+#include "ssh-common.h"
+
+#include "GEC_TreeScanner.h"
+
+static std::string joinPath(const std::string& directory, const std::string& name)
+{
+  if (!directory.empty() && directory[directory.length() - 1] == '/') {
+    return directory + name;
+  }
+  return directory + "/" + name;
+}
+
+GEC_TreeScanner::GEC_TreeScanner(GEC_SftpSessionPool& pool)
+  : m_pool(pool)
+  , m_numBusy(0)
+  , m_numWorkers(0)
+{
+}
+
+int GEC_TreeScanner::scan(std::string root, EntryCallback callback)
+{
+  m_callback = callback;
+  m_totals.clear();
+  m_queue.clear();
+  m_numBusy = 0;
+  m_failed.clear();
+
+  while (root.length() > 1 && root[root.length() - 1] == '/') {
+    root.erase(root.length() - 1);
+  }
+
+  PendingDirectory rootDirectory;
+  rootDirectory.path = root;
+  rootDirectory.depth = 0;
+  m_queue.push_back(rootDirectory);
+
+  m_numWorkers = m_pool.getMaxSessions();
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < m_numWorkers; ++i) {
+    workers.push_back(std::thread(&GEC_TreeScanner::runWorker, this));
+  }
+  for (size_t i = 0; i < workers.size(); ++i) {
+    workers[i].join();
+  }
+
+  // Workers that could not connect have left the queue untouched
+  if (!m_queue.empty()) {
+    return GEC_TREE_NETWORK_ERROR;
+  }
+
+  computeTotals();
+
+  return m_failed.empty() ? GEC_TREE_OK : GEC_TREE_INCOMPLETE;
+}
+
+void GEC_TreeScanner::runWorker()
+{
+  sftp_session sftp = m_pool.acquire();
+  if (sftp == NULL) {
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    --m_numWorkers;
+    m_queueChanged.notify_all();
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(m_queueMutex);
+  for (;;) {
+    while (m_queue.empty() && m_numBusy > 0) {
+      m_queueChanged.wait(lock);
+    }
+    if (m_queue.empty()) {
+      break;
+    }
+
+    PendingDirectory directory = m_queue.front();
+    m_queue.pop_front();
+    ++m_numBusy;
+    lock.unlock();
+
+    bool listed = listDirectory(sftp, directory);
+
+    if (!listed && !ssh_is_connected(sftp->session)) {
+      m_pool.release(sftp, true);
+      sftp = m_pool.acquire();
+    }
+
+    lock.lock();
+    --m_numBusy;
+    if (!listed) {
+      m_failed.push_back(directory.path);
+    }
+    m_queueChanged.notify_all();
+
+    if (sftp == NULL) {
+      --m_numWorkers;
+      return;
+    }
+  }
+  lock.unlock();
+
+  m_pool.release(sftp);
+}
+
+bool GEC_TreeScanner::listDirectory(sftp_session sftp, const PendingDirectory& directory)
+{
+  sftp_dir dir = sftp_opendir(sftp, directory.path.c_str());
+  if (dir == NULL) {
+    return false;
+  }
+
+  std::vector<GEC_TreeEntry> entries;
+  std::vector<PendingDirectory> subdirectories;
+  GEC_DirectoryTotals totals;
+
+  sftp_attributes attributes;
+  while ((attributes = sftp_readdir(sftp, dir)) != NULL) {
+    std::string name(attributes->name);
+    if (name == "." || name == "..") {
+      sftp_attributes_free(attributes);
+      continue;
+    }
+
+    GEC_TreeEntry entry;
+    entry.path = joinPath(directory.path, name);
+    entry.name = name;
+    entry.isDirectory = (attributes->type == SSH_FILEXFER_TYPE_DIRECTORY);
+    entry.sizeInBytes = attributes->size;
+    entry.modifiedTime = attributes->mtime;
+    entry.depth = directory.depth + 1;
+    sftp_attributes_free(attributes);
+
+    if (isExcluded(entry.path, entry.name)) {
+      continue;
+    }
+
+    if (entry.isDirectory) {
+      PendingDirectory subdirectory;
+      subdirectory.path = entry.path;
+      subdirectory.depth = entry.depth;
+      subdirectories.push_back(subdirectory);
+    } else if (isIncluded(entry.path, entry.name)) {
+      totals.ownBytes += entry.sizeInBytes;
+      ++totals.numFiles;
+    } else {
+      continue;
+    }
+    entries.push_back(entry);
+  }
+
+  bool complete = sftp_dir_eof(dir) != 0;
+  sftp_closedir(dir);
+
+  totals.totalBytes = totals.ownBytes;
+  totals.depth = directory.depth;
+  size_t iSlash = directory.path.find_last_of('/');
+  if (directory.depth > 0 && iSlash != std::string::npos) {
+    totals.parent = (iSlash == 0) ? std::string("/") : directory.path.substr(0, iSlash);
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(m_callbackMutex);
+    m_totals[directory.path] = totals;
+    if (m_callback) {
+      for (size_t i = 0; i < entries.size(); ++i) {
+        m_callback(entries[i]);
+      }
+    }
+  }
+
+  if (!subdirectories.empty()) {
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    m_queue.insert(m_queue.end(), subdirectories.begin(), subdirectories.end());
+    m_queueChanged.notify_all();
+  }
+
+  return complete;
+}
+
+bool GEC_TreeScanner::isExcluded(const std::string& path, const std::string& name)
+{
+  for (size_t i = 0; i < m_excludes.size(); ++i) {
+    const std::string& glob = m_excludes[i];
+    if (matchesGlob(glob, glob.find('/') != std::string::npos ? path : name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool GEC_TreeScanner::isIncluded(const std::string& path, const std::string& name)
+{
+  if (m_includes.empty()) {
+    return true;
+  }
+  for (size_t i = 0; i < m_includes.size(); ++i) {
+    const std::string& glob = m_includes[i];
+    if (matchesGlob(glob, glob.find('/') != std::string::npos ? path : name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool isDeeper(const std::pair<unsigned int, std::string>& a,
+                     const std::pair<unsigned int, std::string>& b)
+{
+  return a.first > b.first;
+}
+
+void GEC_TreeScanner::computeTotals()
+{
+  // Children are folded into their parent before the parent itself is
+  // folded into the grandparent
+  std::vector<std::pair<unsigned int, std::string> > order;
+  std::map<std::string, GEC_DirectoryTotals>::iterator it;
+  for (it = m_totals.begin(); it != m_totals.end(); ++it) {
+    order.push_back(std::make_pair(it->second.depth, it->first));
+  }
+  std::stable_sort(order.begin(), order.end(), isDeeper);
+
+  for (size_t i = 0; i < order.size(); ++i) {
+    GEC_DirectoryTotals& child = m_totals[order[i].second];
+    if (child.parent.empty()) {
+      continue;
+    }
+    it = m_totals.find(child.parent);
+    if (it != m_totals.end()) {
+      it->second.totalBytes += child.totalBytes;
+      it->second.numFiles += child.numFiles;
+      it->second.numDirectories += child.numDirectories + 1;
+    }
+  }
+}
+
+bool GEC_TreeScanner::matchesGlob(const std::string& glob, const std::string& text)
+{
+  return match_glob(glob.c_str(), text.data(), text.length());
+}
@@ -0,0 +1,131 @@
+#ifndef GEC_TREESCANNER_H_
+#define GEC_TREESCANNER_H_
+
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "GEC_SftpSessionPool.h"
+
+#define GEC_TREE_OK             0
+#define GEC_TREE_NETWORK_ERROR  (-1)
+#define GEC_TREE_INCOMPLETE     (-2)
+
+struct GEC_TreeEntry
+{
+  std::string path;
+  std::string name;
+  bool isDirectory;
+  uint64_t sizeInBytes;
+  uint64_t modifiedTime;
+  unsigned int depth;
+};
+
+struct GEC_DirectoryTotals
+{
+  GEC_DirectoryTotals()
+    : ownBytes(0)
+    , totalBytes(0)
+    , numFiles(0)
+    , numDirectories(0)
+    , depth(0)
+  {}
+
+  uint64_t ownBytes;        // Files directly inside the directory
+  uint64_t totalBytes;      // Files in the whole subtree
+  uint64_t numFiles;        // Files in the whole subtree
+  uint64_t numDirectories;  // Directories in the whole subtree
+  unsigned int depth;
+  std::string parent;
+};
+
+/**
+  Recursive directory scanner working over several SFTP sessions
+
+  Directories waiting to be listed are kept in a shared work queue. One
+  worker thread per SFTP session takes a directory from the queue, lists
+  it, streams its entries to the callback, and puts its subdirectories
+  back on the queue. The scan is done when the queue is empty and no
+  worker is listing a directory.
+
+  Globs use '*' and '?' as wildcards. A glob containing '/' is matched
+  against the full path of an entry, otherwise against its name. Excluded
+  directories are not descended into. When include globs are given, only
+  files matching one of them are reported and counted in the directory
+  totals. Directories are always reported.
+
+  The callback is called from the worker threads, but never by two
+  threads at the same time.
+*/
+class GEC_TreeScanner
+{
+public:
+  typedef std::function<void(const GEC_TreeEntry&)> EntryCallback;
+
+  GEC_TreeScanner(GEC_SftpSessionPool& pool);
+
+  void addInclude(std::string glob) { m_includes.push_back(glob); }
+  void addExclude(std::string glob) { m_excludes.push_back(glob); }
+
+  /**
+    Scans the tree below @p root
+
+    @return GEC_TREE_OK
+    Success
+    @return GEC_TREE_NETWORK_ERROR
+    No SFTP session could be opened to the server
+    @return GEC_TREE_INCOMPLETE
+    One or more directories could not be listed. They are missing from the
+    totals, the rest of the tree is scanned.
+  */
+  int scan(std::string root, EntryCallback callback);
+
+  /**
+    Returns per-directory totals from the last call to @ref scan(), keyed
+    by the full path of the directory
+  */
+  const std::map<std::string, GEC_DirectoryTotals>& getDirectoryTotals() { return m_totals; }
+
+  /**
+    Returns the directories the last call to @ref scan() could not list
+    completely. Entries read from them before the failure were reported.
+  */
+  const std::vector<std::string>& getFailedDirectories() { return m_failed; }
+
+  static bool matchesGlob(const std::string& glob, const std::string& text);
+
+private:
+  struct PendingDirectory
+  {
+    std::string path;
+    unsigned int depth;
+  };
+
+  void runWorker();
+  bool listDirectory(sftp_session sftp, const PendingDirectory& directory);
+  bool isExcluded(const std::string& path, const std::string& name);
+  bool isIncluded(const std::string& path, const std::string& name);
+  void computeTotals();
+
+  GEC_SftpSessionPool& m_pool;
+  std::vector<std::string> m_includes;
+  std::vector<std::string> m_excludes;
+  EntryCallback m_callback;
+
+  std::mutex m_queueMutex;
+  std::condition_variable m_queueChanged;
+  std::deque<PendingDirectory> m_queue;
+  size_t m_numBusy;
+  size_t m_numWorkers;
+  std::vector<std::string> m_failed;
+
+  std::mutex m_callbackMutex;
+  std::map<std::string, GEC_DirectoryTotals> m_totals;
+};
+
+#endif /* GEC_TREESCANNER_H_ */
@@ -0,0 +1,97 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdio.h>
+
+#include "ssh-common.h"
+
+#include "GEC_SftpSessionPool.h"
+#include "GEC_TreeScanner.h"
+
+void printUsage()
+{
+  std::cout << "Usage: ssh-tree <server> <path> [--channels=<n>] [--include=<glob>]... [--exclude=<glob>]..." << std::endl
+            << std::endl
+            << "where: <server> is the host name or IP address to the server" << std::endl
+            << "       <path> is the full path of the server directory to scan recursively" << std::endl
+            << "       <n> is the number of SFTP sessions used in parallel (default 4)" << std::endl
+            << "       <glob> is a pattern with '*' and '?' wildcards. Patterns containing" << std::endl
+            << "              '/' match the full path, other patterns match the entry name" << std::endl;
+}
+
+static bool hasPrefix(const std::string& text, const std::string& prefix)
+{
+  return text.compare(0, prefix.length(), prefix) == 0;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3) {
+    std::cout << "ERROR: Incorrect number of arguments" << std::endl
+              << std::endl;
+    printUsage();
+    return (-1);
+  }
+
+  size_t numChannels = 4;
+  std::vector<std::string> includes;
+  std::vector<std::string> excludes;
+  for (int i = 3; i < argc; ++i) {
+    std::string option(argv[i]);
+    if (hasPrefix(option, "--channels=")) {
+      numChannels = strtoul(option.substr(11).c_str(), NULL, 10);
+    } else if (hasPrefix(option, "--include=")) {
+      includes.push_back(option.substr(10));
+    } else if (hasPrefix(option, "--exclude=")) {
+      excludes.push_back(option.substr(10));
+    } else {
+      std::cout << "ERROR: Unknown option '" << option << "'" << std::endl
+                << std::endl;
+      printUsage();
+      return (-1);
+    }
+  }
+
+  GEC_SftpSessionPool pool(argv[1], "root", "", numChannels);
+  GEC_TreeScanner scanner(pool);
+  for (size_t i = 0; i < includes.size(); ++i) {
+    scanner.addInclude(includes[i]);
+  }
+  for (size_t i = 0; i < excludes.size(); ++i) {
+    scanner.addExclude(excludes[i]);
+  }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  int rc = scanner.scan(argv[2], [](const GEC_TreeEntry& entry) {
+    std::cout << (entry.isDirectory ? "d " : "- ")
+              << std::setw(14) << std::right << entry.sizeInBytes << " "
+              << entry.path << std::endl;
+  });
+
+  double elapsedInS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if (rc == GEC_TREE_NETWORK_ERROR) {
+    std::cout << "ERROR: Could not open an SFTP session to " << argv[1] << std::endl;
+    return (-1);
+  }
+
+  std::cout << std::endl << "Directory totals:" << std::endl;
+  const std::map<std::string, GEC_DirectoryTotals>& totals = scanner.getDirectoryTotals();
+  std::map<std::string, GEC_DirectoryTotals>::const_iterator it;
+  for (it = totals.begin(); it != totals.end(); ++it) {
+    std::cout << std::setw(60) << std::left << it->first << " "
+              << std::setw(16) << std::right << it->second.totalBytes << " bytes "
+              << std::setw(8) << it->second.numFiles << " files" << std::endl;
+  }
+
+  std::cout << std::endl << totals.size() << " directories scanned in "
+            << std::fixed << std::setprecision(2) << elapsedInS << " s over "
+            << numChannels << " SFTP sessions" << std::endl;
+  if (rc == GEC_TREE_INCOMPLETE) {
+    std::cout << "WARNING: Some directories could not be listed" << std::endl;
+  }
+
+  return (rc == GEC_TREE_OK) ? 0 : 1;
+}
@@ -0,0 +1,350 @@
+#include "instrumentedrecorder.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+#include "inc/GE_Defines.h"
+
+static const uint64_t noMinimum = ~static_cast<uint64_t>(0);
+
+InstrumentedRecorder::InstrumentedRecorder(GEC_ISfpdpRecorder *recorder)
+    : m_recorder(recorder)
+    , m_isDumping(false)
+    , m_dumpIntervalInS(0)
+{
+    resetStatistics();
+}
+
+InstrumentedRecorder::~InstrumentedRecorder()
+{
+    stopDump();
+}
+
+GEC_ISfpdpRecorder *InstrumentedRecorder::unwrap(GEC_ISfpdpRecorder *recorder)
+{
+    InstrumentedRecorder *instrumented = dynamic_cast<InstrumentedRecorder *>(recorder);
+    return (instrumented != NULL) ? instrumented->getRecorder() : recorder;
+}
+
+uint64_t InstrumentedRecorder::getTimeInNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int InstrumentedRecorder::record(int method, uint64_t startInNs, int rc)
+{
+    uint64_t timeInNs = getTimeInNs() - startInNs;
+    Counters &counters = m_counters[method];
+    counters.totalTimeInNs.fetch_add(timeInNs, std::memory_order_relaxed);
+    counters.buckets[getBucket(timeInNs)].fetch_add(1, std::memory_order_relaxed);
+    counters.rcCounts[(rc >= 0 && rc < numRcs) ? rc : numRcs].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t minimum = counters.minimumInNs.load(std::memory_order_relaxed);
+    while (timeInNs < minimum
+           && !counters.minimumInNs.compare_exchange_weak(minimum, timeInNs, std::memory_order_relaxed)) {
+    }
+    uint64_t maximum = counters.maximumInNs.load(std::memory_order_relaxed);
+    while (timeInNs > maximum
+           && !counters.maximumInNs.compare_exchange_weak(maximum, timeInNs, std::memory_order_relaxed)) {
+    }
+    return rc;
+}
+
+/*
+  Buckets 0 to 3 hold 0 to 3 ns. Above, each power of two [2^k, 2^(k+1))
+  is split into four buckets by the two bits below the leading one.
+*/
+int InstrumentedRecorder::getBucket(uint64_t timeInNs)
+{
+    if (timeInNs < 4) {
+        return static_cast<int>(timeInNs);
+    }
+    int exponent = 63;
+    while ((timeInNs >> exponent) == 0) {
+        --exponent;
+    }
+    int bucket = 4 * (exponent - 1) + static_cast<int>((timeInNs >> (exponent - 2)) & 3);
+    return (bucket < numBuckets) ? bucket : numBuckets - 1;
+}
+
+uint64_t InstrumentedRecorder::getBucketStart(int bucket)
+{
+    if (bucket < 4) {
+        return static_cast<uint64_t>(bucket);
+    }
+    return static_cast<uint64_t>(4 + bucket % 4) << (bucket / 4 - 1);
+}
+
+std::vector<InstrumentedRecorder::MethodStatistics> InstrumentedRecorder::getStatistics() const
+{
+    std::vector<MethodStatistics> statistics;
+    for (int method = 1; method < RecorderProtocol::NUM_METHODS; ++method) {
+        const Counters &counters = m_counters[method];
+        uint64_t buckets[numBuckets];
+        uint64_t numCalls = 0;
+        for (int i = 0; i < numBuckets; ++i) {
+            buckets[i] = counters.buckets[i].load(std::memory_order_relaxed);
+            numCalls += buckets[i];
+        }
+        if (numCalls == 0) {
+            continue;
+        }
+
+        MethodStatistics entry;
+        entry.method = method;
+        entry.name = RecorderProtocol::getMethodName(method);
+        entry.numCalls = numCalls;
+        entry.numErrors = 0;
+        for (int rc = 0; rc <= numRcs; ++rc) {
+            uint64_t count = counters.rcCounts[rc].load(std::memory_order_relaxed);
+            if (count != 0) {
+                entry.rcCounts[(rc < numRcs) ? rc : -1] = count;
+                entry.numErrors += (rc != GE_OK) ? count : 0;
+            }
+        }
+        entry.totalTimeInS = 1e-9 * counters.totalTimeInNs.load(std::memory_order_relaxed);
+        entry.meanInUs = 1e6 * entry.totalTimeInS / numCalls;
+        entry.minimumInUs = 1e-3 * counters.minimumInNs.load(std::memory_order_relaxed);
+        entry.maximumInUs = 1e-3 * counters.maximumInNs.load(std::memory_order_relaxed);
+
+        // The middle of the bucket holding the nearest rank, within the range actually seen
+        double *percentiles[] = { &entry.p50InUs, &entry.p90InUs, &entry.p99InUs };
+        const double fractions[] = { 0.5, 0.9, 0.99 };
+        for (int p = 0; p < 3; ++p) {
+            uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fractions[p] * numCalls)));
+            uint64_t count = 0;
+            int bucket = 0;
+            while (bucket < numBuckets - 1 && count + buckets[bucket] < rank) {
+                count += buckets[bucket++];
+            }
+            double middleInUs = 0.5e-3 * (getBucketStart(bucket) + getBucketStart(bucket + 1));
+            *percentiles[p] = std::max(entry.minimumInUs, std::min(entry.maximumInUs, middleInUs));
+        }
+        statistics.push_back(entry);
+    }
+    return statistics;
+}
+
+std::string InstrumentedRecorder::format() const
+{
+    std::vector<MethodStatistics> statistics = getStatistics();
+    std::ostringstream text;
+    text << std::left << std::setw(25) << "method" << std::right << std::setw(10) << "calls" << std::setw(8)
+         << "errors" << std::setw(11) << "mean us" << std::setw(11) << "p50 us" << std::setw(11) << "p90 us"
+         << std::setw(11) << "p99 us" << std::setw(11) << "max us" << "  return codes\n";
+    text << std::fixed << std::setprecision(2);
+    for (size_t i = 0; i < statistics.size(); ++i) {
+        const MethodStatistics &entry = statistics[i];
+        text << std::left << std::setw(25) << entry.name << std::right << std::setw(10) << entry.numCalls
+             << std::setw(8) << entry.numErrors << std::setw(11) << entry.meanInUs << std::setw(11) << entry.p50InUs
+             << std::setw(11) << entry.p90InUs << std::setw(11) << entry.p99InUs << std::setw(11)
+             << entry.maximumInUs << " ";
+        std::map<int, uint64_t>::const_iterator it;
+        for (it = entry.rcCounts.begin(); it != entry.rcCounts.end(); ++it) {
+            text << ' ';
+            if (it->first < 0) {
+                text << "other";
+            } else {
+                text << it->first;
+            }
+            text << ':' << it->second;
+        }
+        text << '\n';
+    }
+    return text.str();
+}
+
+void InstrumentedRecorder::resetStatistics()
+{
+    for (int method = 0; method < RecorderProtocol::NUM_METHODS; ++method) {
+        Counters &counters = m_counters[method];
+        counters.totalTimeInNs.store(0, std::memory_order_relaxed);
+        counters.minimumInNs.store(noMinimum, std::memory_order_relaxed);
+        counters.maximumInNs.store(0, std::memory_order_relaxed);
+        for (int rc = 0; rc <= numRcs; ++rc) {
+            counters.rcCounts[rc].store(0, std::memory_order_relaxed);
+        }
+        for (int i = 0; i < numBuckets; ++i) {
+            counters.buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void InstrumentedRecorder::startDump(double intervalInS, Sink sink)
+{
+    stopDump();
+    std::lock_guard<std::mutex> lock(m_dumpMutex);
+    m_isDumping = true;
+    m_dumpIntervalInS = intervalInS;
+    m_sink = sink;
+    m_dumpThread = std::thread(&InstrumentedRecorder::dump, this);
+}
+
+void InstrumentedRecorder::stopDump()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_dumpMutex);
+        m_isDumping = false;
+    }
+    m_dumpWakeUp.notify_all();
+    if (m_dumpThread.joinable()) {
+        m_dumpThread.join();
+    }
+}
+
+void InstrumentedRecorder::dump()
+{
+    std::unique_lock<std::mutex> lock(m_dumpMutex);
+    while (m_isDumping) {
+        std::chrono::duration<double> interval(m_dumpIntervalInS);
+        if (m_dumpWakeUp.wait_for(lock, interval, [this] { return !m_isDumping; })) {
+            break;
+        }
+        Sink sink = m_sink;
+        lock.unlock();
+        std::string text = format();
+        if (sink) {
+            sink(text);
+        } else {
+            fprintf(stderr, "Recorder calls:\n%s", text.c_str());
+        }
+        lock.lock();
+    }
+}
+
+int InstrumentedRecorder::setIntChannelSyncControl(int mode)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::SET_INT_CHANNEL_SYNC_CONTROL, start,
+                  m_recorder->setIntChannelSyncControl(mode));
+}
+
+int InstrumentedRecorder::setIntChannelSync(uint32_t iDevice, int masterMask, int action)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::SET_INT_CHANNEL_SYNC, start,
+                  m_recorder->setIntChannelSync(iDevice, masterMask, action));
+}
+
+int InstrumentedRecorder::setChannelSyncOutput(uint32_t iDevice, int signal, int source)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::SET_CHANNEL_SYNC_OUTPUT, start,
+                  m_recorder->setChannelSyncOutput(iDevice, signal, source));
+}
+
+int InstrumentedRecorder::reset()
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::RESET, start, m_recorder->reset());
+}
+
+int InstrumentedRecorder::create(std::string path, std::string name, uint32_t iDevice, uint32_t iPort, uint32_t &id)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::CREATE, start, m_recorder->create(path, name, iDevice, iPort, id));
+}
+
+int InstrumentedRecorder::open(std::string path, std::string name, uint32_t iDevice, uint32_t iPort, int mode,
+                               uint32_t &id)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::OPEN, start, m_recorder->open(path, name, iDevice, iPort, mode, id));
+}
+
+int InstrumentedRecorder::destroy(uint32_t id)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::DESTROY, start, m_recorder->destroy(id));
+}
+
+int InstrumentedRecorder::setCRC(uint32_t id, bool enableCRC)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::SET_CRC, start, m_recorder->setCRC(id, enableCRC));
+}
+
+int InstrumentedRecorder::setCopyMode(uint32_t id, bool enable)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::SET_COPY_MODE, start, m_recorder->setCopyMode(id, enable));
+}
+
+int InstrumentedRecorder::setWaitForSync(uint32_t id, int mode)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::SET_WAIT_FOR_SYNC, start, m_recorder->setWaitForSync(id, mode));
+}
+
+int InstrumentedRecorder::setMaxSize(uint32_t id, uint64_t sizeInBytes)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::SET_MAX_SIZE, start, m_recorder->setMaxSize(id, sizeInBytes));
+}
+
+int InstrumentedRecorder::setLinkSpeed(uint32_t id, int speed)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::SET_LINK_SPEED, start, m_recorder->setLinkSpeed(id, speed));
+}
+
+int InstrumentedRecorder::setFlowControl(uint32_t id, bool enable)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::SET_FLOW_CONTROL, start, m_recorder->setFlowControl(id, enable));
+}
+
+int InstrumentedRecorder::setRateControl(uint32_t id, int cycleSize, uint32_t cyclePartsForTx)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::SET_RATE_CONTROL, start,
+                  m_recorder->setRateControl(id, cycleSize, cyclePartsForTx));
+}
+
+int InstrumentedRecorder::setSimplexLinkMode(uint32_t id, bool enable)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::SET_SIMPLEX_LINK_MODE, start, m_recorder->setSimplexLinkMode(id, enable));
+}
+
+int InstrumentedRecorder::setChannelSyncSource(uint32_t id, int source)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::SET_CHANNEL_SYNC_SOURCE, start, m_recorder->setChannelSyncSource(id, source));
+}
+
+int InstrumentedRecorder::setSwapping(uint32_t id, bool enable8in16, bool enable16in32)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::SET_SWAPPING, start, m_recorder->setSwapping(id, enable8in16, enable16in32));
+}
+
+int InstrumentedRecorder::getStatus(uint32_t id, uint64_t &numBytes, std::string &state)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::GET_STATUS, start, m_recorder->getStatus(id, numBytes, state));
+}
+
+int InstrumentedRecorder::checkForOverflow(uint32_t id, bool &detected, bool clear)
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::CHECK_FOR_OVERFLOW, start, m_recorder->checkForOverflow(id, detected, clear));
+}
+
+int InstrumentedRecorder::startAll()
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::START_ALL, start, m_recorder->startAll());
+}
+
+int InstrumentedRecorder::stopAll()
+{
+    uint64_t start = getTimeInNs();
+    return record(RecorderProtocol::STOP_ALL, start, m_recorder->stopAll());
+}
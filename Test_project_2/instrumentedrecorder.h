@@ -0,0 +1,137 @@
+#ifndef INSTRUMENTEDRECORDER_H
+#define INSTRUMENTEDRECORDER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "recorderprotocol.h"
+
+/**
+  GEC_ISfpdpRecorder that forwards every call to another instance, and
+  counts the calls, their latency, and their return codes per method
+
+  Methods are numbered as in RecorderProtocol::Method. Each call takes
+  two clock readings and a few relaxed atomic increments, and no lock,
+  so calls from several threads do not wait for each other or for a
+  reader of the statistics. The latency histogram has four buckets per
+  power of two of nanoseconds, so percentiles are within 13% of the
+  true value.
+
+  The statistics are read with getStatistics() or format(), and written
+  to a sink every interval by startDump(). They count from construction
+  or the last resetStatistics(), which may lose or split calls that are
+  in flight at the time.
+
+  The inner instance is not owned. RecorderFactory wraps its instances
+  in one when GEC_RECORDER_TELEMETRY is set.
+*/
+class InstrumentedRecorder : public GEC_ISfpdpRecorder
+{
+public:
+    struct MethodStatistics
+    {
+        int method;                      // RecorderProtocol::Method
+        const char *name;
+        uint64_t numCalls;
+        uint64_t numErrors;              // Calls that did not return GE_OK
+        double totalTimeInS;
+        double meanInUs;
+        double minimumInUs;
+        double maximumInUs;
+        double p50InUs;
+        double p90InUs;
+        double p99InUs;
+        std::map<int, uint64_t> rcCounts;
+    };
+
+    typedef std::function<void(const std::string &text)> Sink;
+
+    explicit InstrumentedRecorder(GEC_ISfpdpRecorder *recorder);
+    virtual ~InstrumentedRecorder();
+
+    virtual int setIntChannelSyncControl(int mode);
+    virtual int setIntChannelSync(uint32_t iDevice, int masterMask, int action);
+    virtual int setChannelSyncOutput(uint32_t iDevice, int signal, int source);
+    virtual int reset();
+    virtual int create(std::string path, std::string name, uint32_t iDevice, uint32_t iPort, uint32_t &id);
+    virtual int open(std::string path, std::string name, uint32_t iDevice, uint32_t iPort, int mode, uint32_t &id);
+    virtual int destroy(uint32_t id);
+    virtual int setCRC(uint32_t id, bool enableCRC);
+    virtual int setCopyMode(uint32_t id, bool enable);
+    virtual int setWaitForSync(uint32_t id, int mode);
+    virtual int setMaxSize(uint32_t id, uint64_t sizeInBytes);
+    virtual int setLinkSpeed(uint32_t id, int speed);
+    virtual int setFlowControl(uint32_t id, bool enable);
+    virtual int setRateControl(uint32_t id, int cycleSize, uint32_t cyclePartsForTx);
+    virtual int setSimplexLinkMode(uint32_t id, bool enable);
+    virtual int setChannelSyncSource(uint32_t id, int source);
+    virtual int setSwapping(uint32_t id, bool enable8in16, bool enable16in32);
+    virtual int getStatus(uint32_t id, uint64_t &numBytes, std::string &state);
+    virtual int checkForOverflow(uint32_t id, bool &detected, bool clear);
+    virtual int startAll();
+    virtual int stopAll();
+
+    GEC_ISfpdpRecorder *getRecorder() const { return m_recorder; }
+    /** @return The instance inside @p recorder if it is an InstrumentedRecorder, else @p recorder */
+    static GEC_ISfpdpRecorder *unwrap(GEC_ISfpdpRecorder *recorder);
+
+    /** @return The statistics of the methods called at least once, by method number */
+    std::vector<MethodStatistics> getStatistics() const;
+    /** The statistics as a table, one line per method */
+    std::string format() const;
+    void resetStatistics();
+
+    /**
+      Passes format() to @p sink every @p intervalInS from a thread of its
+      own, until stopDump(). Without a sink the table goes to stderr.
+    */
+    void startDump(double intervalInS, Sink sink = Sink());
+    void stopDump();
+
+private:
+    InstrumentedRecorder(const InstrumentedRecorder &);
+    InstrumentedRecorder &operator=(const InstrumentedRecorder &);
+
+    enum
+    {
+        numBuckets = 160,                // Up to 2^40 ns, about 18 minutes
+        numRcs = 16                      // GE_OK to GE_NOT_PERMITTED; other values are counted together
+    };
+
+    struct Counters
+    {
+        std::atomic<uint64_t> totalTimeInNs;
+        std::atomic<uint64_t> minimumInNs;
+        std::atomic<uint64_t> maximumInNs;
+        std::atomic<uint64_t> rcCounts[numRcs + 1];
+        std::atomic<uint64_t> buckets[numBuckets];
+    };
+
+    static uint64_t getTimeInNs();
+    /** Counts a call of @p method that started at @p startInNs. @return @p rc */
+    int record(int method, uint64_t startInNs, int rc);
+
+    static int getBucket(uint64_t timeInNs);
+    static uint64_t getBucketStart(int bucket);
+    void dump();
+
+    GEC_ISfpdpRecorder *m_recorder;
+    Counters m_counters[RecorderProtocol::NUM_METHODS];
+
+    std::mutex m_dumpMutex;
+    std::condition_variable m_dumpWakeUp;
+    std::thread m_dumpThread;
+    bool m_isDumping;
+    double m_dumpIntervalInS;
+    Sink m_sink;
+};
+
+#endif // INSTRUMENTEDRECORDER_H
@@ -1,18 +1,291 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "/home/sandeep/san/Test_project_2/gec-sfpdp-recorder-api-win-3.5.0/inc/GEC_ISfpdpRecorder.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+
+#include "GEC_RecordingFormat.h"
+#include "inc/GE_Defines.h"
+#include "instrumentedrecorder.h"
+#include "maxsizebudgeter.h"
+#include "recorderfactory.h"
+#include "recordingextractor.h"
+#include "simulatedrecorder.h"
+
+// Directory on the recorder where recordings are stored
+static const char *recordingPath = "/data";
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , m_recordPort(0)
 {
     ui->setupUi(this);
+
+    // The button is named "sizeofdisk" in the form, so the slot is not connected by name
+    connect(ui->sizeofdisk, &QPushButton::clicked, this, &MainWindow::on_SizeofDisk_clicked);
+    connect(&m_capacityWatcher, &QFutureWatcherBase::finished, this, &MainWindow::showDiskCapacities);
+    connect(&m_syncOpenWatcher, &QFutureWatcherBase::finished, this, &MainWindow::showSyncIndex);
+    connect(&m_syncSaveWatcher, &QFutureWatcherBase::finished, this, &MainWindow::showSyncSave);
+    connect(&m_timeOpenWatcher, &QFutureWatcherBase::finished, this, &MainWindow::showTimeIndex);
+    connect(&m_timeSaveWatcher, &QFutureWatcherBase::finished, this, &MainWindow::showTimeSave);
+    connect(&m_catalogWatcher, &QFutureWatcherBase::finished, this, &MainWindow::showCatalog);
+    connect(&m_recordCapacityWatcher, &QFutureWatcherBase::finished, this, &MainWindow::startRecordingWithCapacity);
+    connect(ui->StatusInfo, &QPushButton::clicked, this, &MainWindow::on_Statusinfo_clicked);
+
+    m_predictor.setThresholds(std::vector<double>{3600, 600, 60});
+    m_predictor.setWarningCallback([this](const RecordingTimePredictor::Warning &warning) {
+        QString what = warning.isFilesystem ? QString::fromStdString(warning.filesystem)
+                                            : QString("Channel %1").arg(m_sessionPorts[warning.id] + 1);
+        ui->plainTextEdit->appendPlainText(QString("WARNING: %1 is full in about %2 minutes")
+                                               .arg(what)
+                                               .arg(warning.secondsToFull / 60, 0, 'f', 0));
+    });
+
+    connect(&m_overflowTimer, &QTimer::timeout, this, &MainWindow::showOverflowEvents);
+    m_overflowTimer.start(100);
+
+    // The recordings of the last recorder are there at once; they are brought up to date in the background
+    QString catalogHost = QSettings("GEC", "Test_project").value("catalog/host").toString();
+    if (!catalogHost.isEmpty()) {
+        openCatalog(catalogHost);
+    }
 }
 
 MainWindow::~MainWindow()
 {
+    m_capacityWatcher.waitForFinished();
+    m_recordCapacityWatcher.waitForFinished();
+    m_catalogWatcher.waitForFinished();
+    saveCatalog();
+    if (!m_catalogHost.isEmpty()) {
+        QSettings("GEC", "Test_project").setValue("catalog/host", m_catalogHost);
+    }
+    m_overflowWatchdog.reset();
+    m_statusPoller.reset();
+    m_recorder.reset();
     delete ui;
 }
 
+AsyncRecorder *MainWindow::getRecorder()
+{
+    // The recorder is the first host of the "connected to" field, or a "sim:" or "unix:" address as a whole
+    QString host = ui->lineEdit_13->text().trimmed().section(QRegularExpression("[,\\s]+"), 0, 0);
+    if (!RecorderFactory::hasScheme(host.toStdString())) {
+        host = host.section(':', 0, 0);
+    }
+    if (host.isEmpty()) {
+        ui->plainTextEdit->appendPlainText("Enter the recorder host name or IP address");
+        return nullptr;
+    }
+
+    if (!m_recorder || host != m_recorderHost) {
+        forgetSessions();
+        m_overflowWatchdog.reset();
+        m_statusPoller.reset();
+        m_recorderHost = host;
+
+        // The watchdog shares the instance: a simulator only exists in this process, and a reconnect may give
+        // sessions other ids on the recorder, which only the instance that made them can translate. A
+        // ReconnectingRecorder makes overflow checks on a connection of their own, so they do not queue behind
+        // other calls
+        std::string address = host.toStdString();
+        std::shared_ptr<GEC_ISfpdpRecorder> shared;
+        if (RecorderFactory::isSimulated(address)) {
+            shared.reset(RecorderFactory::create(address), RecorderFactory::destroy);
+        } else {
+            ReconnectingRecorder *reconnecting = RecorderFactory::createReconnecting(address);
+            reconnecting->setListener([this](const ReconnectingRecorder::Reconnect &reconnect) {
+                QMetaObject::invokeMethod(this, [this, reconnect]() { showReconnect(reconnect); },
+                                          Qt::QueuedConnection);
+            });
+            shared.reset(reconnecting, RecorderFactory::destroy);
+            if (!RecorderFactory::hasScheme(address)) {
+                openCatalog(host);
+            }
+        }
+        AsyncRecorder::CreateFunction create = [shared]() { return shared.get(); };
+        AsyncRecorder::DestroyFunction destroy = [](GEC_ISfpdpRecorder *) {};
+        m_recorder.reset(new AsyncRecorder(create, destroy));
+        m_overflowWatchdog.reset(new OverflowWatchdog(create, destroy));
+        m_overflowWatchdog->start();
+
+        m_statusPoller.reset(new RecorderStatusPoller(m_recorder.get()));
+        m_statusPoller->setOverflowChecking(false);
+        m_statusPoller->subscribe([this](const RecorderStatusPoller::Snapshot &snapshot) {
+            QMetaObject::invokeMethod(this, [this, snapshot]() { updateStatus(snapshot); }, Qt::QueuedConnection);
+        });
+        m_statusPoller->start();
+    }
+    return m_recorder.get();
+}
+
+void MainWindow::forgetSessions()
+{
+    std::map<uint32_t, int>::const_iterator it;
+    for (it = m_sessionPorts.begin(); it != m_sessionPorts.end(); ++it) {
+        m_predictor.removeSession(it->first);
+    }
+    m_sessionPorts.clear();
+    m_overflowCounts.clear();
+    if (m_statusPoller) {
+        m_statusPoller->clearSessions();
+    }
+    if (m_overflowWatchdog) {
+        m_overflowWatchdog->clearSessions();
+    }
+    m_status = RecorderStatusPoller::Snapshot();
+}
+
+void MainWindow::updateStatus(const RecorderStatusPoller::Snapshot &snapshot)
+{
+    m_status = snapshot;
+    for (size_t i = 0; i < snapshot.sessions.size(); ++i) {
+        const RecorderStatusPoller::SessionStatus &session = snapshot.sessions[i];
+        if (m_sessionPorts.find(session.id) == m_sessionPorts.end() || session.rc != GE_OK) {
+            continue;
+        }
+        m_predictor.updateSession(session.id, session.numBytes, session.state, session.timeInS);
+    }
+}
+
+void MainWindow::showOverflowEvents()
+{
+    if (!m_overflowWatchdog) {
+        return;
+    }
+    OverflowWatchdog::Event event;
+    while (m_overflowWatchdog->popEvent(event)) {
+        std::map<uint32_t, int>::const_iterator it = m_sessionPorts.find(event.id);
+        if (it == m_sessionPorts.end()) {
+            continue;
+        }
+        ++m_overflowCounts[event.id];
+        QDateTime wallClock = QDateTime::fromMSecsSinceEpoch(event.wallClockInUs / 1000);
+        QString window = (event.previousCheckInS > 0)
+            ? QString(", within %1 ms").arg(1e3 * (event.timeInS - event.previousCheckInS), 0, 'f', 1)
+            : QString();
+        ui->plainTextEdit->appendPlainText(
+            QString("WARNING: Channel %1: overflow, data was lost, at %2%3 (%4 s monotonic%5), %6 MB, %7 MB/s")
+                .arg(it->second + 1)
+                .arg(wallClock.toString("yyyy-MM-dd hh:mm:ss.zzz"))
+                .arg(event.wallClockInUs % 1000, 3, 10, QChar('0'))
+                .arg(event.timeInS, 0, 'f', 6)
+                .arg(window)
+                .arg(event.numBytes / 1e6, 0, 'f', 1)
+                .arg(event.bytesPerSecond / 1e6, 0, 'f', 1));
+    }
+}
+
+void MainWindow::showReconnect(const ReconnectingRecorder::Reconnect &reconnect)
+{
+    if (reconnect.rc != GE_OK) {
+        ui->plainTextEdit->appendPlainText(
+            QString("ERROR: Connection to the recorder lost, %1 attempts to reconnect in %2 s failed")
+                .arg(reconnect.numAttempts)
+                .arg(reconnect.downTimeInS, 0, 'f', 1));
+        return;
+    }
+    ui->plainTextEdit->appendPlainText(
+        QString("Reconnected to the recorder after %1 s: %2 sessions kept, %3 made again, %4 lost")
+            .arg(reconnect.downTimeInS, 0, 'f', 1)
+            .arg(reconnect.numKeptSessions)
+            .arg(reconnect.numRemadeSessions)
+            .arg(reconnect.numLostSessions));
+}
+
+static QString getCatalogPath(const QString &host)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/" + host + ".catalog";
+}
+
+void MainWindow::openCatalog(const QString &host)
+{
+    // A host asked for while the catalog is being revalidated is opened when that is done
+    m_catalogNextHost = host;
+    if (m_catalogWatcher.isRunning() || host == m_catalogHost) {
+        return;
+    }
+    saveCatalog();
+    m_catalogHost = host;
+
+    QElapsedTimer timer;
+    timer.start();
+    bool isLoaded = m_catalog.load(getCatalogPath(host).toStdString()) == GEC_CATALOG_OK
+                    && m_catalog.getRoot() == recordingPath;
+    if (isLoaded) {
+        ui->plainTextEdit->appendPlainText(QString("Catalog: %1 recordings on %2 loaded in %3 ms")
+                                               .arg(m_catalog.getRecordings().size())
+                                               .arg(host)
+                                               .arg(timer.nsecsElapsed() / 1e6, 0, 'f', 1));
+    }
+
+    m_catalogPool.reset(new GEC_SftpSessionPool(host.toStdString(), "root", "", 4));
+    GEC_RecordingCatalog *catalog = &m_catalog;
+    GEC_SftpSessionPool *pool = m_catalogPool.get();
+    m_catalogTimer.start();
+    m_catalogWatcher.setFuture(QtConcurrent::run([catalog, pool, isLoaded]() {
+        return isLoaded ? catalog->revalidate(*pool) : catalog->scan(*pool, recordingPath);
+    }));
+}
+
+void MainWindow::showCatalog()
+{
+    int rc = m_catalogWatcher.result();
+    if (rc == GEC_CATALOG_NETWORK_ERROR) {
+        ui->plainTextEdit->appendPlainText(QString("Catalog: the recordings on %1 could not be listed")
+                                               .arg(m_catalogHost));
+    } else {
+        const std::vector<GEC_Recording> &recordings = m_catalog.getRecordings();
+        size_t numComplete = 0;
+        uint64_t totalBytes = 0;
+        for (size_t i = 0; i < recordings.size(); ++i) {
+            numComplete += recordings[i].isComplete() ? 1 : 0;
+            totalBytes += recordings[i].getTotalSizeInBytes();
+        }
+        ui->plainTextEdit->appendPlainText(QString("Catalog: %1 recordings (%2 complete, %3 GiB) on %4, "
+                                                   "brought up to date in %5 ms%6")
+                                               .arg(recordings.size())
+                                               .arg(numComplete)
+                                               .arg(totalBytes / (1024.0 * 1024.0 * 1024.0), 0, 'f', 2)
+                                               .arg(m_catalogHost)
+                                               .arg(m_catalogTimer.elapsed())
+                                               .arg((rc == GEC_CATALOG_OK)
+                                                        ? QString()
+                                                        : QString(", some directories could not be read")));
+    }
+    if (m_catalogNextHost != m_catalogHost) {
+        openCatalog(m_catalogNextHost);
+    }
+}
+
+void MainWindow::saveCatalog()
+{
+    if (m_catalogHost.isEmpty() || m_catalog.getRoot().empty()) {
+        return;
+    }
+    QString path = getCatalogPath(m_catalogHost);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    m_catalog.save(path.toStdString());
+}
+
+void MainWindow::appendResult(const QString &text)
+{
+    // Called on the recorder thread
+    QMetaObject::invokeMethod(this, [this, text]() {
+        ui->plainTextEdit->appendPlainText(text);
+    }, Qt::QueuedConnection);
+}
+
 
 
 
@@ -33,12 +306,53 @@ void MainWindow::on_ShutDown_clicked()
 
 void MainWindow::on_Statusinfo_clicked()
 {
-
+    AsyncRecorder *recorder = getRecorder();
+    if (recorder == nullptr) {
+        return;
+    }
+    if (m_sessionPorts.empty()) {
+        ui->plainTextEdit->appendPlainText("Status info: no recording sessions");
+        return;
+    }
+
+    std::map<uint32_t, int>::const_iterator it;
+    for (it = m_sessionPorts.begin(); it != m_sessionPorts.end(); ++it) {
+        uint32_t id = it->first;
+        int port = it->second;
+        recorder->call([id](GEC_ISfpdpRecorder *r) {
+            AsyncRecorder::Status status;
+            status.rc = (r != NULL) ? r->getStatus(id, status.numBytes, status.state) : GE_COMMFAIL;
+            return status;
+        }, [this, port](const AsyncRecorder::Status &status) {
+            if (status.rc == GE_OK) {
+                appendResult(QString("Channel %1: %2, %3 MB recorded")
+                                 .arg(port + 1)
+                                 .arg(QString::fromStdString(status.state))
+                                 .arg(status.numBytes / 1e6, 0, 'f', 1));
+            } else {
+                appendResult(QString("Channel %1: getStatus() failed with error %2").arg(port + 1).arg(status.rc));
+            }
+        });
+    }
 }
 
 void MainWindow::on_EventLog_clicked()
 {
-
+    if (!m_overflowWatchdog) {
+        ui->plainTextEdit->appendPlainText("Event log: not connected to a recorder");
+        return;
+    }
+    showOverflowEvents();
+    OverflowWatchdog::Statistics statistics = m_overflowWatchdog->getStatistics();
+    ui->plainTextEdit->appendPlainText(
+        QString("Overflow watchdog: %1 checks (%2 failed), %3 overflows (%4 not logged), "
+                "%5 late rounds, longest round %6 ms")
+            .arg(statistics.numChecks)
+            .arg(statistics.numFailedChecks)
+            .arg(statistics.numEvents)
+            .arg(statistics.numDroppedEvents)
+            .arg(statistics.numLateRounds)
+            .arg(1e3 * statistics.maximumRoundTimeInS, 0, 'f', 1));
 }
 
 void MainWindow::on_FormatRSA_clicked()
@@ -48,7 +362,18 @@ void MainWindow::on_FormatRSA_clicked()
 
 void MainWindow::on_Reset_clicked()
 {
-
+    AsyncRecorder *recorder = getRecorder();
+    if (recorder == nullptr) {
+        return;
+    }
+
+    // Reset removes all sessions
+    forgetSessions();
+    recorder->call([](GEC_ISfpdpRecorder *r) {
+        return (r != NULL) ? r->reset() : GE_COMMFAIL;
+    }, [this](int rc) {
+        appendResult((rc == GE_OK) ? QString("Recorder reset") : QString("Reset failed with error %1").arg(rc));
+    });
 }
 
 void MainWindow::on_CurrentIPAddress_clicked()
@@ -88,7 +413,578 @@ void MainWindow::on_Version_clicked()
 
 void MainWindow::on_SizeofDisk_clicked()
 {
+    if (m_capacityWatcher.isRunning()) {
+        return;
+    }
+
+    // Targets are "host" or "host:/mount/point", separated by commas or spaces
+    QString targets = ui->lineEdit_13->text().trimmed();
+    if (targets.isEmpty()) {
+        ui->plainTextEdit->appendPlainText("Size of disk: enter the recorder host name or IP address");
+        return;
+    }
+
+    if (!m_capacityQuery || targets != m_capacityTargets) {
+        m_capacityQuery.reset(new GEC_CapacityQuery("root", "", 4));
+        m_capacityTargets = targets;
+        QStringList parts = targets.split(QRegularExpression("[,\\s]+"));
+        for (int i = 0; i < parts.size(); ++i) {
+            if (parts[i].isEmpty()) {
+                continue;
+            }
+            int colon = parts[i].indexOf(':');
+            QString host = (colon < 0) ? parts[i] : parts[i].left(colon);
+            QString path = (colon < 0) ? QString("/") : parts[i].mid(colon + 1);
+            m_capacityQuery->add(host.toStdString(), path.toStdString());
+        }
+    }
+
+    ui->sizeofdisk->setEnabled(false);
+    GEC_CapacityQuery *query = m_capacityQuery.get();
+    m_capacityWatcher.setFuture(QtConcurrent::run([query]() {
+        std::vector<GEC_Capacity> capacities;
+        query->run(capacities);
+        return capacities;
+    }));
+}
 
+void MainWindow::showDiskCapacities()
+{
+    ui->sizeofdisk->setEnabled(true);
+
+    const double bytesPerGiB = 1024.0 * 1024.0 * 1024.0;
+    std::vector<GEC_Capacity> capacities = m_capacityWatcher.result();
+    m_predictor.updateFreeSpace(capacities);
+    for (size_t i = 0; i < capacities.size(); ++i) {
+        const GEC_Capacity &capacity = capacities[i];
+        QString target = QString::fromStdString(capacity.host + ":" + capacity.path);
+        if (capacity.rc == GEC_CAPACITY_OK) {
+            double usedPercent = (capacity.totalBytes == 0) ? 0.0
+                : 100.0 * (capacity.totalBytes - capacity.freeBytes) / capacity.totalBytes;
+            ui->plainTextEdit->appendPlainText(
+                QString("%1: %2 GiB free of %3 GiB (%4% used), %5 of %6 inodes free")
+                    .arg(target)
+                    .arg(capacity.availableBytes / bytesPerGiB, 0, 'f', 2)
+                    .arg(capacity.totalBytes / bytesPerGiB, 0, 'f', 2)
+                    .arg(usedPercent, 0, 'f', 1)
+                    .arg(capacity.availableInodes)
+                    .arg(capacity.totalInodes));
+        } else if (capacity.rc == GEC_CAPACITY_NOT_EXISTING) {
+            ui->plainTextEdit->appendPlainText(target + ": no such path");
+        } else if (capacity.rc == GEC_CAPACITY_NOT_SUPPORTED) {
+            ui->plainTextEdit->appendPlainText(target + ": the SFTP server does not support statvfs");
+        } else {
+            ui->plainTextEdit->appendPlainText(target + ": could not connect");
+        }
+    }
+}
+
+void MainWindow::on_Record_clicked()
+{
+    AsyncRecorder *recorder = getRecorder();
+    if (recorder == nullptr) {
+        return;
+    }
+    if (!m_sessionPorts.empty()) {
+        ui->plainTextEdit->appendPlainText("Record: already recording, stop the recording first");
+        return;
+    }
+
+    int port = ui->comboBox_2->currentText().toInt() - 1;
+    if (port < 0) {
+        ui->plainTextEdit->appendPlainText("Record: select a channel");
+        return;
+    }
+    QString prefix = ui->lineEdit_8->text().trimmed();
+    std::string name = QString("%1_ch%2").arg(prefix.isEmpty() ? QString("rec") : prefix).arg(port + 1).toStdString();
+    std::string host = m_recorderHost.toStdString();
+    if (RecorderFactory::isSimulated(host)) {
+        // A simulated recorder writes to a local directory, whose free space is known at once
+        startRecording(port, name, std::vector<GEC_Capacity>());
+        return;
+    }
+
+    // The SSH query of the free space runs here, so status and overflow polls do not wait behind it on the
+    // recorder thread
+    m_recordPort = port;
+    m_recordName = name;
+    m_recordHost = m_recorderHost;
+    ui->Record->setEnabled(false);
+    m_recordCapacityWatcher.setFuture(QtConcurrent::run([host]() {
+        GEC_CapacityQuery query("root", "", 1);
+        query.add(host, recordingPath);
+        std::vector<GEC_Capacity> capacities;
+        query.run(capacities);
+        return capacities;
+    }));
+}
+
+void MainWindow::startRecordingWithCapacity()
+{
+    ui->Record->setEnabled(true);
+    std::vector<GEC_Capacity> capacities = m_recordCapacityWatcher.result();
+    AsyncRecorder *recorder = getRecorder();
+    if (recorder == nullptr || m_recorderHost != m_recordHost) {
+        ui->plainTextEdit->appendPlainText("Record: the recorder was changed, click Record again");
+        return;
+    }
+    if (capacities.size() != 1 || capacities[0].rc == GEC_CAPACITY_NETWORK_ERROR) {
+        ui->plainTextEdit->appendPlainText(QString("Record: the free space on %1 could not be queried (is its host "
+                                                   "key known, and an SSH key for root installed?)")
+                                               .arg(m_recordHost));
+        return;
+    }
+    if (capacities[0].rc != GEC_CAPACITY_OK) {
+        QString reason = (capacities[0].rc == GEC_CAPACITY_NOT_EXISTING) ? QString("does not exist")
+                                                                         : QString("has no statvfs over SFTP");
+        ui->plainTextEdit->appendPlainText(QString("Record: %1:%2 %3")
+                                               .arg(m_recordHost).arg(recordingPath).arg(reason));
+        return;
+    }
+    startRecording(m_recordPort, m_recordName, capacities);
+}
+
+void MainWindow::startRecording(int port, const std::string &name, const std::vector<GEC_Capacity> &capacities)
+{
+    AsyncRecorder *recorder = getRecorder();
+    if (recorder == nullptr) {
+        return;
+    }
+    std::string host = m_recorderHost.toStdString();
+
+    struct Result
+    {
+        int rc;
+        uint32_t id;
+        uint64_t maxSizeInBytes;
+        GEC_Capacity capacity;
+        QString text;
+    };
+
+    // One request, so nothing else runs between creating, sizing, and starting the session
+    recorder->call([host, name, port, capacities](GEC_ISfpdpRecorder *r) -> Result {
+        Result result;
+        result.id = 0;
+        result.rc = (r != NULL) ? r->create(recordingPath, name, 0, port, result.id) : GE_COMMFAIL;
+        if (result.rc != GE_OK) {
+            result.text = QString("Record: create() failed with error %1").arg(result.rc);
+            return result;
+        }
+
+        // A simulated recorder writes to a local directory, which is queried here; a remote one was queried
+        // before
+        SimulatedRecorder *simulated = dynamic_cast<SimulatedRecorder *>(InstrumentedRecorder::unwrap(r));
+        MaxSizeBudgeter budgeter("root", "");
+        if (simulated != NULL) {
+            budgeter.addSession(result.id, "", simulated->getLocalPath(recordingPath), GEC_SFPDP_2_5_GBPS);
+            result.rc = budgeter.budget();
+        } else {
+            budgeter.addSession(result.id, host, recordingPath, GEC_SFPDP_2_5_GBPS);
+            result.rc = budgeter.budget(capacities);
+        }
+        if (result.rc == GE_COMMFAIL) {
+            r->destroy(result.id);
+            result.text = QString("Record: the free space on %1 could not be queried (is its host key known, "
+                                  "and an SSH key for root installed?)").arg(QString::fromStdString(host));
+            return result;
+        }
+        if (result.rc == GE_OK) {
+            result.rc = budgeter.applyAndStart(r);
+        }
+        if (result.rc != GE_OK) {
+            r->destroy(result.id);
+            result.text = QString("Record: starting channel %1 failed with error %2").arg(port + 1).arg(result.rc);
+            return result;
+        }
+
+        const MaxSizeBudgeter::Session &session = budgeter.getSessions().front();
+        result.maxSizeInBytes = session.maxSizeInBytes;
+        result.capacity = budgeter.getCapacities().front();
+        result.text = QString("Recording channel %1 to %2/%3.dat, at most %4 GB (%5 minutes at full link rate)")
+                          .arg(port + 1)
+                          .arg(recordingPath)
+                          .arg(QString::fromStdString(name))
+                          .arg(session.maxSizeInBytes / 1e9, 0, 'f', 1)
+                          .arg(session.secondsToFull / 60, 0, 'f', 0);
+        return result;
+    }, [this, host, port](const Result &result) {
+        QMetaObject::invokeMethod(this, [this, host, port, result]() {
+            if (result.rc == GE_OK) {
+                // Keyed by the file system, so "Size of disk" for any path on it updates the same free space
+                std::string filesystem = RecordingTimePredictor::getFilesystemKey(host, result.capacity);
+                m_sessionPorts[result.id] = port;
+                m_predictor.addSession(result.id, filesystem, result.maxSizeInBytes);
+                m_predictor.updateFreeSpace(filesystem, result.capacity.availableBytes, host + ":" + recordingPath);
+                m_statusPoller->addSession(result.id, true, result.maxSizeInBytes);
+                m_overflowWatchdog->addSession(result.id);
+            }
+            ui->plainTextEdit->appendPlainText(result.text);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::on_StopRecording_clicked()
+{
+    AsyncRecorder *recorder = getRecorder();
+    if (recorder == nullptr) {
+        return;
+    }
+
+    // Polls queued after this no longer ask for the sessions being destroyed
+    std::map<uint32_t, int> sessionPorts(m_sessionPorts);
+    forgetSessions();
+    recorder->call([sessionPorts](GEC_ISfpdpRecorder *r) -> QString {
+        if (r == NULL) {
+            return QString("Stop recording failed with error %1").arg(GE_COMMFAIL);
+        }
+        int rc = r->stopAll();
+        if (rc != GE_OK) {
+            return QString("Stop recording failed with error %1").arg(rc);
+        }
+
+        QString text("Recording stopped");
+        std::map<uint32_t, int>::const_iterator it;
+        for (it = sessionPorts.begin(); it != sessionPorts.end(); ++it) {
+            uint64_t numBytes = 0;
+            std::string state;
+            if (r->getStatus(it->first, numBytes, state) == GE_OK) {
+                text += QString("\nChannel %1: %2 MB recorded").arg(it->second + 1).arg(numBytes / 1e6, 0, 'f', 1);
+            }
+            r->destroy(it->first);
+        }
+        return text;
+    }, [this](const QString &text) {
+        appendResult(text);
+    });
+}
+
+void MainWindow::on_Channelstatus_clicked()
+{
+    // Shown from the last poll, so any number of clicks cost no round trips
+    if (m_status.sessions.empty()) {
+        ui->plainTextEdit->appendPlainText("Channel status: no recording sessions");
+        return;
+    }
+
+    for (size_t i = 0; i < m_status.sessions.size(); ++i) {
+        const RecorderStatusPoller::SessionStatus &session = m_status.sessions[i];
+        std::map<uint32_t, int>::const_iterator it = m_sessionPorts.find(session.id);
+        if (it == m_sessionPorts.end()) {
+            continue;
+        }
+        if (session.rc != GE_OK) {
+            ui->plainTextEdit->appendPlainText(QString("Channel %1: getStatus() failed with error %2")
+                                                   .arg(it->second + 1).arg(session.rc));
+            continue;
+        }
+
+        RecordingTimePredictor::Estimate estimate = m_predictor.getSessionEstimate(session.id);
+        QString remaining = (estimate.secondsToFull < 0) ? QString("-")
+            : QString("%1 min%2").arg(estimate.secondsToFull / 60, 0, 'f', 0)
+                                 .arg(estimate.isLimitedByMaxSize ? " (max size)" : "");
+        ui->plainTextEdit->appendPlainText(
+            QString("Channel %1: %2, %3 MB, %4 MB/s (%5 MB/s average), %6 overflows, full in %7")
+                .arg(it->second + 1)
+                .arg(QString::fromStdString(session.state))
+                .arg(session.numBytes / 1e6, 0, 'f', 1)
+                .arg(session.bytesPerSecond / 1e6, 0, 'f', 1)
+                .arg(session.smoothedBytesPerSecond / 1e6, 0, 'f', 1)
+                .arg(m_overflowCounts[session.id])
+                .arg(remaining));
+    }
+
+    RecorderStatusPoller::Load load = m_statusPoller->getLoad();
+    if (load.numFixedRateCalls > 0) {
+        ui->plainTextEdit->appendPlainText(QString("Status polling: %1 calls, %2% fewer than at a fixed rate")
+                                               .arg(load.numCalls)
+                                               .arg(100.0 * (1.0 - load.numCalls / load.numFixedRateCalls), 0, 'f', 0));
+    }
+}
+
+void MainWindow::on_Open_clicked()
+{
+    // The whole index is read once, off the GUI thread; every later "Desired Sync No" is an array lookup
+    QString path = ui->lineEdit_11->text().trimmed();
+    ui->comboBox_5->clear();
+    m_syncIndexPath.clear();
+    m_syncIndex.reset();
+    ui->Open->setEnabled(false);
+    ui->Save_2->setEnabled(false);
+    m_syncOpenWatcher.setFuture(QtConcurrent::run([path]() {
+        LoadedSyncIndex loaded;
+        std::shared_ptr<SyncIndex> index(new SyncIndex);
+        loaded.rc = index->load(path.toStdString());
+        loaded.path = path;
+        loaded.index = index;
+        return loaded;
+    }));
+}
+
+void MainWindow::showSyncIndex()
+{
+    ui->Open->setEnabled(true);
+    ui->Save_2->setEnabled(true);
+
+    LoadedSyncIndex loaded = m_syncOpenWatcher.result();
+    if (loaded.rc != GE_OK) {
+        ui->plainTextEdit->appendPlainText(QString("Open: %1 cannot be read, error %2")
+                                               .arg(loaded.path).arg(loaded.rc));
+        return;
+    }
+    m_syncIndex = loaded.index;
+    m_syncIndexPath = loaded.path;
+
+    // Any SYNC number, or a range "n-m", can be typed; the list only offers the first ones
+    ui->comboBox_5->setEditable(true);
+    uint64_t numSyncs = m_syncIndex->getNumSyncs();
+    uint64_t numListed = std::min<uint64_t>(numSyncs, 1000);
+    for (uint64_t i = 0; i < numListed; ++i) {
+        ui->comboBox_5->addItem(QString::number(i));
+    }
+    if (numSyncs == 0) {
+        ui->plainTextEdit->appendPlainText(QString("Open: no SYNCs, %1 CRC errors")
+                                               .arg(m_syncIndex->getNumCrcErrors()));
+        return;
+    }
+    ui->plainTextEdit->appendPlainText(QString("Open: %1 SYNCs (0 to %2), %3 CRC errors")
+                                           .arg(numSyncs)
+                                           .arg(numSyncs - 1)
+                                           .arg(m_syncIndex->getNumCrcErrors()));
+}
+
+// Writes SYNC @p firstSync to @p lastSync of the .dat file next to the index at @p indexPath; the result to show
+static QString saveSyncs(std::shared_ptr<const SyncIndex> syncIndex, const QString &indexPath, uint64_t firstSync,
+                         uint64_t lastSync, const QString &outputPath)
+{
+    std::string dataPath = RecordingDataReader::replaceExtension(indexPath.toStdString(),
+                                                                 GEC_RECORDING_DATA_EXTENSION);
+    RecordingDataReader reader;
+    int rc = reader.open(dataPath);
+    if (rc != GE_OK) {
+        return QString("Save: %1 cannot be opened, error %2").arg(QString::fromStdString(dataPath)).arg(rc);
+    }
+    uint64_t numFrames = lastSync - firstSync + 1;
+    uint64_t startOffset = 0;
+    uint64_t endOffset = 0;
+    if (!syncIndex->getRange(firstSync, numFrames, reader.getFile().getSize(), startOffset, endOffset)) {
+        return QString("Save: there is no SYNC %1").arg(firstSync);
+    }
+
+    // Writing over the recording would truncate the mapping being read
+    std::string outputFile = outputPath.toLocal8Bit().constData();
+    if (RecordingDataReader::isSameFile(outputFile, dataPath)
+        || RecordingDataReader::isSameFile(outputFile, indexPath.toStdString())) {
+        return QString("Save: %1 would overwrite the recording being read").arg(outputPath);
+    }
+    FILE *output = fopen(outputFile.c_str(), "wb");
+    if (output == NULL) {
+        return QString("Save: %1 cannot be created").arg(outputPath);
+    }
+    uint64_t firstWord = startOffset / GEC_RECORDING_WORD_SIZE;
+    rc = reader.write(firstWord, endOffset / GEC_RECORDING_WORD_SIZE - firstWord, output);
+    if (fclose(output) != 0 && rc == GE_OK) {
+        rc = GE_ERROR;
+    }
+    if (rc != GE_OK) {
+        return QString("Save: writing %1 failed with error %2").arg(outputPath).arg(rc);
+    }
+    // Fewer frames than asked for are saved at the end of the recording; getRange() found SYNC firstSync
+    if (syncIndex->getNumSyncs() > 0) {
+        lastSync = std::min(lastSync, syncIndex->getNumSyncs() - 1);
+    }
+    return QString("Save: SYNC %1 to %2, %3 bytes from offset %4, %5 CRC errors, to %6")
+        .arg(firstSync)
+        .arg(lastSync)
+        .arg(endOffset - startOffset)
+        .arg(startOffset)
+        .arg(syncIndex->countCrcErrors(firstSync, numFrames))
+        .arg(outputPath);
+}
+
+void MainWindow::on_Save_2_clicked()
+{
+    if (!m_syncIndex) {
+        ui->plainTextEdit->appendPlainText("Save: open an index file first");
+        return;
+    }
+    QStringList syncs = ui->comboBox_5->currentText().trimmed().split('-');
+    bool isFirstValid = false;
+    bool isLastValid = true;
+    uint64_t firstSync = syncs.front().trimmed().toULongLong(&isFirstValid);
+    uint64_t lastSync = (syncs.size() > 1) ? syncs.back().trimmed().toULongLong(&isLastValid) : firstSync;
+    if (!isFirstValid || !isLastValid || syncs.size() > 2 || lastSync < firstSync) {
+        ui->plainTextEdit->appendPlainText("Save: enter a SYNC number, or a range like 10-20");
+        return;
+    }
+
+    // The frames are copied off the GUI thread; the index is shared, so opening another one does not pull it away
+    std::shared_ptr<const SyncIndex> syncIndex = m_syncIndex;
+    QString indexPath = m_syncIndexPath;
+    QString outputPath = ui->lineEdit_12->text().trimmed();
+    ui->Open->setEnabled(false);
+    ui->Save_2->setEnabled(false);
+    m_syncSaveWatcher.setFuture(QtConcurrent::run([syncIndex, indexPath, firstSync, lastSync, outputPath]() {
+        return saveSyncs(syncIndex, indexPath, firstSync, lastSync, outputPath);
+    }));
+}
+
+void MainWindow::showSyncSave()
+{
+    ui->Open->setEnabled(true);
+    ui->Save_2->setEnabled(true);
+    ui->plainTextEdit->appendPlainText(m_syncSaveWatcher.result());
+}
+
+static const char *retrievalTimeFormat = "yyyy-MM-dd hh:mm:ss.zzz";
+
+static QString formatRetrievalTime(uint64_t timeInNs)
+{
+    return QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(timeInNs / 1000000)).toString(retrievalTimeFormat);
+}
+
+// A time as listed, or a number of seconds from the start of the recording
+static bool parseRetrievalTime(const QString &text, uint64_t startTimeInNs, uint64_t &timeInNs)
+{
+    QDateTime dateTime = QDateTime::fromString(text.trimmed(), retrievalTimeFormat);
+    if (dateTime.isValid()) {
+        timeInNs = static_cast<uint64_t>(dateTime.toMSecsSinceEpoch()) * 1000000;
+        return true;
+    }
+    bool isValid = false;
+    double seconds = text.trimmed().toDouble(&isValid);
+    if (!isValid || seconds < 0) {
+        return false;
+    }
+    timeInNs = startTimeInNs + static_cast<uint64_t>(seconds * 1e9);
+    return true;
+}
+
+void MainWindow::on_open_clicked()
+{
+    // Only the timing is read here, off the GUI thread; the data is mapped when a window is saved
+    QString path = ui->lineEdit_9->text().trimmed();
+    ui->comboBox_3->clear();
+    ui->comboBox_4->clear();
+    m_timeIndexPath.clear();
+    m_timeIndex.reset();
+    ui->open->setEnabled(false);
+    ui->Save->setEnabled(false);
+    m_timeOpenWatcher.setFuture(QtConcurrent::run([path]() {
+        LoadedTimeIndex loaded;
+        std::shared_ptr<TimeIndex> index(new TimeIndex);
+        loaded.rc = index->load(RecordingDataReader::replaceExtension(path.toStdString(),
+                                                                      GEC_RECORDING_META_EXTENSION));
+        if (loaded.rc == GE_OK && index->getNumRecords() == 0) {
+            loaded.rc = GE_NOT_EXISTING;
+        }
+        loaded.path = path;
+        loaded.index = index;
+        return loaded;
+    }));
+}
+
+void MainWindow::showTimeIndex()
+{
+    ui->open->setEnabled(true);
+    ui->Save->setEnabled(true);
+
+    LoadedTimeIndex loaded = m_timeOpenWatcher.result();
+    if (loaded.rc != GE_OK) {
+        std::string metaPath = RecordingDataReader::replaceExtension(loaded.path.toStdString(),
+                                                                     GEC_RECORDING_META_EXTENSION);
+        ui->plainTextEdit->appendPlainText(QString("Open: %1 cannot be read, error %2")
+                                               .arg(QString::fromStdString(metaPath)).arg(loaded.rc));
+        return;
+    }
+    m_timeIndex = loaded.index;
+    m_timeIndexPath = loaded.path;
+
+    // Any time can be typed, to the ms or in seconds from the start; the lists offer up to 1000 steps
+    uint64_t startTimeInNs = m_timeIndex->getStartTimeInNs();
+    uint64_t endTimeInNs = m_timeIndex->getEndTimeInNs();
+    uint64_t stepInNs = std::max<uint64_t>((endTimeInNs - startTimeInNs) / 1000, 1000000000ULL);
+    ui->comboBox_3->setEditable(true);
+    ui->comboBox_4->setEditable(true);
+    for (uint64_t timeInNs = startTimeInNs; timeInNs < endTimeInNs; timeInNs += stepInNs) {
+        ui->comboBox_3->addItem(formatRetrievalTime(timeInNs));
+        ui->comboBox_4->addItem(formatRetrievalTime(timeInNs + stepInNs));
+    }
+    if (ui->comboBox_4->count() == 0) {
+        ui->comboBox_3->addItem(formatRetrievalTime(startTimeInNs));
+        ui->comboBox_4->addItem(formatRetrievalTime(startTimeInNs + stepInNs));
+    }
+    ui->comboBox_4->setCurrentIndex(ui->comboBox_4->count() - 1);
+    ui->plainTextEdit->appendPlainText(QString("Open: recorded from %1 to %2, %3 timing records")
+                                           .arg(formatRetrievalTime(startTimeInNs))
+                                           .arg(formatRetrievalTime(endTimeInNs))
+                                           .arg(m_timeIndex->getNumRecords()));
+}
+
+// Cuts the recording of @p path from @p startTimeInNs to @p endTimeInNs, in whole frames; the result to show
+static QString saveTimeWindow(const QString &path, uint64_t startTimeInNs, uint64_t endTimeInNs,
+                              const QString &outputPath)
+{
+    RecordingExtractor extractor;
+    int rc = extractor.open(path.toStdString());
+    if (rc != GE_OK) {
+        return QString("Save: the recording of %1 cannot be opened, error %2").arg(path).arg(rc);
+    }
+    // Whole frames, so the extract starts with a SYNC and plays back with its signals
+    uint64_t startOffset = 0;
+    uint64_t endOffset = 0;
+    if (!extractor.getTimeIndex().getRange(startTimeInNs, endTimeInNs, true, extractor.getDataSize(), startOffset,
+                                           endOffset)) {
+        return "Save: nothing was recorded between these times";
+    }
+    extractor.alignToSyncs(startOffset, endOffset);
+
+    RecordingExtractor::Extract extract;
+    rc = extractor.extract(startOffset, endOffset, outputPath.toStdString(), extract);
+    if (rc == GE_INVALID_PARAMETER) {
+        return QString("Save: %1 would overwrite the recording being read").arg(outputPath);
+    }
+    if (rc != GE_OK) {
+        return QString("Save: writing %1 failed with error %2").arg(outputPath).arg(rc);
+    }
+    const TimeIndex &timeIndex = extractor.getTimeIndex();
+    return QString("Save: %1 to %2, %3 bytes from offset %4, to %5 with its .idx and .meta")
+        .arg(formatRetrievalTime(timeIndex.findTimeInNs(extract.startOffset)))
+        .arg(formatRetrievalTime(timeIndex.findTimeInNs(extract.endOffset)))
+        .arg(extract.endOffset - extract.startOffset)
+        .arg(extract.startOffset)
+        .arg(outputPath);
+}
+
+void MainWindow::on_Save_clicked()
+{
+    if (!m_timeIndex) {
+        ui->plainTextEdit->appendPlainText("Save: open an index file first");
+        return;
+    }
+    uint64_t startTimeInNs = 0;
+    uint64_t endTimeInNs = 0;
+    if (!parseRetrievalTime(ui->comboBox_3->currentText(), m_timeIndex->getStartTimeInNs(), startTimeInNs)
+        || !parseRetrievalTime(ui->comboBox_4->currentText(), m_timeIndex->getStartTimeInNs(), endTimeInNs)) {
+        ui->plainTextEdit->appendPlainText(QString("Save: enter times like %1, or seconds from the start")
+                                               .arg(formatRetrievalTime(m_timeIndex->getStartTimeInNs())));
+        return;
+    }
+
+    // Mapping the data and writing the extract run off the GUI thread
+    QString path = m_timeIndexPath;
+    QString outputPath = ui->lineEdit_10->text().trimmed();
+    ui->open->setEnabled(false);
+    ui->Save->setEnabled(false);
+    m_timeSaveWatcher.setFuture(QtConcurrent::run([path, startTimeInNs, endTimeInNs, outputPath]() {
+        return saveTimeWindow(path, startTimeInNs, endTimeInNs, outputPath);
+    }));
+}
+
+void MainWindow::showTimeSave()
+{
+    ui->open->setEnabled(true);
+    ui->Save->setEnabled(true);
+    ui->plainTextEdit->appendPlainText(m_timeSaveWatcher.result());
 }
 
 void MainWindow::on_ShowChannelFault_clicked()
@@ -1,7 +1,26 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include <QElapsedTimer>
+#include <QFutureWatcher>
 #include <QMainWindow>
+#include <QTimer>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "asyncrecorder.h"
+#include "GEC_CapacityQuery.h"
+#include "GEC_RecordingCatalog.h"
+#include "GEC_SftpSessionPool.h"
+#include "overflowwatchdog.h"
+#include "reconnectingrecorder.h"
+#include "recorderstatuspoller.h"
+#include "recordingdatareader.h"
+#include "recordingtimepredictor.h"
+#include "syncindex.h"
+#include "timeindex.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -106,7 +125,111 @@ private slots:
 
     void on_fontComboBox_2_currentFontChanged(const QFont &f);
 
+    void showDiskCapacities();
+
+    void on_Record_clicked();
+
+    void startRecordingWithCapacity();
+
+    void on_StopRecording_clicked();
+
+    void on_Channelstatus_clicked();
+
+    void on_Open_clicked();
+
+    void on_Save_2_clicked();
+
+    void showSyncIndex();
+
+    void showSyncSave();
+
+    void on_open_clicked();
+
+    void on_Save_clicked();
+
+    void showTimeIndex();
+
+    void showTimeSave();
+
+    void showCatalog();
+
 private:
+    AsyncRecorder *getRecorder();
+    void appendResult(const QString &text);
+    void updateStatus(const RecorderStatusPoller::Snapshot &snapshot);
+    void showOverflowEvents();
+    void showReconnect(const ReconnectingRecorder::Reconnect &reconnect);
+    void forgetSessions();
+    void startRecording(int port, const std::string &name, const std::vector<GEC_Capacity> &capacities);
+    void openCatalog(const QString &host);
+    void saveCatalog();
+
     Ui::MainWindow *ui;
+
+    // All recorder calls go through the recorder's own thread; results come back queued
+    std::unique_ptr<AsyncRecorder> m_recorder;
+    QString m_recorderHost;
+    std::map<uint32_t, int> m_sessionPorts;   // Recording sessions and their ports
+
+    // One poll of all sessions feeds every status view and the time-to-full prediction
+    std::unique_ptr<RecorderStatusPoller> m_statusPoller;
+    RecorderStatusPoller::Snapshot m_status;
+    RecordingTimePredictor m_predictor;
+
+    // Overflows are checked at a high rate on a thread of their own; the timer moves them to the event log
+    std::unique_ptr<OverflowWatchdog> m_overflowWatchdog;
+    std::map<uint32_t, uint64_t> m_overflowCounts;
+    QTimer m_overflowTimer;
+
+    // The free space for a recording is queried off the GUI thread, and off the recorder thread, before the
+    // session is made
+    int m_recordPort;
+    std::string m_recordName;
+    QString m_recordHost;
+    QFutureWatcher<std::vector<GEC_Capacity> > m_recordCapacityWatcher;
+
+    // "Size of disk" queries run off the GUI thread; the sessions are kept for the next click
+    std::unique_ptr<GEC_CapacityQuery> m_capacityQuery;
+    QString m_capacityTargets;
+    QFutureWatcher<std::vector<GEC_Capacity> > m_capacityWatcher;
+
+    // The recordings on the recorder, saved on exit and loaded again for the same host, then revalidated off
+    // the GUI thread, which only lists the directories that changed
+    GEC_RecordingCatalog m_catalog;
+    QString m_catalogHost;
+    QString m_catalogNextHost;
+    std::unique_ptr<GEC_SftpSessionPool> m_catalogPool;
+    QFutureWatcher<int> m_catalogWatcher;
+    QElapsedTimer m_catalogTimer;
+
+    // "Sync Based Retrieval": the SYNCs of the opened .idx file, whose .dat file is next to it. Reading the
+    // index and saving frames run off the GUI thread, which keeps both buttons disabled until they are done.
+    struct LoadedSyncIndex
+    {
+        LoadedSyncIndex() : rc(0) {}
+
+        int rc;
+        QString path;
+        std::shared_ptr<const SyncIndex> index;
+    };
+    std::shared_ptr<const SyncIndex> m_syncIndex;
+    QString m_syncIndexPath;
+    QFutureWatcher<LoadedSyncIndex> m_syncOpenWatcher;
+    QFutureWatcher<QString> m_syncSaveWatcher;
+
+    // "Time Based Retrieval": the timing of the opened recording, for its list of times; like the SYNCs, it is read
+    // and saved from off the GUI thread
+    struct LoadedTimeIndex
+    {
+        LoadedTimeIndex() : rc(0) {}
+
+        int rc;
+        QString path;
+        std::shared_ptr<const TimeIndex> index;
+    };
+    std::shared_ptr<const TimeIndex> m_timeIndex;
+    QString m_timeIndexPath;
+    QFutureWatcher<LoadedTimeIndex> m_timeOpenWatcher;
+    QFutureWatcher<QString> m_timeSaveWatcher;
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,269 @@
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+#include "inc/GE_Defines.h"
+
+// The default window of a 32-bit process, which leaves room in its address space for everything else
+static const uint64_t defaultWindowSize32 = 256 << 20;
+
+static uint64_t getGranularity()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+#else
+    long pageSize = sysconf(_SC_PAGESIZE);
+    return (pageSize > 0) ? static_cast<uint64_t>(pageSize) : 4096;
+#endif
+}
+
+MappedFile::MappedFile()
+    : m_size(0)
+    , m_access(NORMAL_ACCESS)
+    , m_wantsHugePages(false)
+    , m_isUsingHugePages(false)
+    , m_granularity(getGranularity())
+    , m_windowSize(0)
+    , m_hasDefaultWindowSize(true)
+#ifdef _WIN32
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(NULL)
+#else
+    , m_fd(-1)
+#endif
+    , m_window(NULL)
+    , m_windowStart(0)
+    , m_windowLength(0)
+    , m_numMappings(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+int MappedFile::open(const std::string &path)
+{
+    close();
+#ifdef _WIN32
+    DWORD flags = FILE_ATTRIBUTE_NORMAL;
+    if (m_access == SEQUENTIAL_ACCESS) {
+        flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+    } else if (m_access == RANDOM_ACCESS) {
+        flags |= FILE_FLAG_RANDOM_ACCESS;
+    }
+    // A recording may still be written while it is read
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+                              flags, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        DWORD error = GetLastError();
+        if (error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND) {
+            return GE_NOT_EXISTING;
+        }
+        return (error == ERROR_ACCESS_DENIED) ? GE_NO_ACCESS : GE_ERROR;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return GE_ERROR;
+    }
+    m_file = file;
+    m_size = static_cast<uint64_t>(size.QuadPart);
+    // A mapping of an empty file cannot be created, and is not needed
+    if (m_size > 0) {
+        m_mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (m_mapping == NULL) {
+            close();
+            return GE_ERROR;
+        }
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT || errno == ENOTDIR) {
+            return GE_NOT_EXISTING;
+        }
+        return (errno == EACCES || errno == EPERM) ? GE_NO_ACCESS : GE_ERROR;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode)) {
+        ::close(fd);
+        return GE_ERROR;
+    }
+    m_fd = fd;
+    m_size = static_cast<uint64_t>(status.st_size);
+#endif
+    m_numMappings = 0;
+    if (m_hasDefaultWindowSize) {
+        setWindowSize(0);
+    }
+    setAccess(m_access);
+    return GE_OK;
+}
+
+void MappedFile::close()
+{
+    unmapWindow();
+#ifdef _WIN32
+    if (m_mapping != NULL) {
+        CloseHandle(m_mapping);
+        m_mapping = NULL;
+    }
+    if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
+    m_size = 0;
+}
+
+bool MappedFile::isOpen() const
+{
+#ifdef _WIN32
+    return m_file != INVALID_HANDLE_VALUE;
+#else
+    return m_fd >= 0;
+#endif
+}
+
+void MappedFile::setAccess(Access access)
+{
+    m_access = access;
+#if !defined(_WIN32) && defined(POSIX_FADV_SEQUENTIAL)
+    if (m_fd >= 0) {
+        int advice = POSIX_FADV_NORMAL;
+        if (access == SEQUENTIAL_ACCESS) {
+            advice = POSIX_FADV_SEQUENTIAL;
+        } else if (access == RANDOM_ACCESS) {
+            advice = POSIX_FADV_RANDOM;
+        }
+        posix_fadvise(m_fd, 0, 0, advice);
+    }
+#endif
+    if (m_window != NULL) {
+        adviseWindow();
+    }
+}
+
+void MappedFile::setHugePages(bool enable)
+{
+    m_wantsHugePages = enable;
+    if (m_window != NULL) {
+        adviseWindow();
+    }
+}
+
+void MappedFile::setWindowSize(uint64_t sizeInBytes)
+{
+    m_hasDefaultWindowSize = (sizeInBytes == 0);
+    if (m_hasDefaultWindowSize) {
+        sizeInBytes = (sizeof(void *) >= 8) ? std::max<uint64_t>(m_size, 1) : defaultWindowSize32;
+    }
+    // At least two granules, so a window starting at the granule before an offset holds bytes after it
+    uint64_t numGranules = (sizeInBytes + m_granularity - 1) / m_granularity;
+    m_windowSize = std::max<uint64_t>(numGranules, 2) * m_granularity;
+}
+
+const uint8_t *MappedFile::map(uint64_t offset, uint64_t numBytes, uint64_t &numMapped)
+{
+    numMapped = 0;
+    if (offset >= m_size) {
+        return NULL;
+    }
+    uint64_t end = offset + std::min(numBytes, m_size - offset);
+    bool isInWindow = (m_window != NULL && offset >= m_windowStart && end <= m_windowStart + m_windowLength);
+    if (!isInWindow) {
+        // Near the end of the file the window reaches back from the end, so it holds as much of the file as it can
+        uint64_t start = offset - offset % m_granularity;
+        if (m_size - start < m_windowSize) {
+            uint64_t lastStart = (m_size > m_windowSize) ? m_size - m_windowSize : 0;
+            start = std::min(start, lastStart - lastStart % m_granularity);
+        }
+        if (!mapWindow(start)) {
+            return NULL;
+        }
+    }
+    numMapped = m_windowStart + m_windowLength - offset;
+    return m_window + (offset - m_windowStart);
+}
+
+bool MappedFile::mapWindow(uint64_t start)
+{
+    unmapWindow();
+    // The last window may be up to a granule longer, as its start is rounded down
+    uint64_t length = (m_size - start < m_windowSize + m_granularity) ? m_size - start : m_windowSize;
+#ifdef _WIN32
+    void *window = MapViewOfFile(m_mapping, FILE_MAP_READ, static_cast<DWORD>(start >> 32),
+                                 static_cast<DWORD>(start & 0xffffffff), static_cast<SIZE_T>(length));
+    if (window == NULL) {
+        return false;
+    }
+#else
+    void *window = mmap(NULL, static_cast<size_t>(length), PROT_READ, MAP_SHARED, m_fd, static_cast<off_t>(start));
+    if (window == MAP_FAILED) {
+        return false;
+    }
+#endif
+    m_window = static_cast<const uint8_t *>(window);
+    m_windowStart = start;
+    m_windowLength = length;
+    ++m_numMappings;
+    adviseWindow();
+    return true;
+}
+
+void MappedFile::unmapWindow()
+{
+    if (m_window == NULL) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(m_window);
+#else
+    munmap(const_cast<uint8_t *>(m_window), static_cast<size_t>(m_windowLength));
+#endif
+    m_window = NULL;
+    m_windowStart = 0;
+    m_windowLength = 0;
+    m_isUsingHugePages = false;
+}
+
+void MappedFile::adviseWindow()
+{
+#ifndef _WIN32
+    void *window = const_cast<uint8_t *>(m_window);
+    int advice = MADV_NORMAL;
+    if (m_access == SEQUENTIAL_ACCESS) {
+        advice = MADV_SEQUENTIAL;
+    } else if (m_access == RANDOM_ACCESS) {
+        advice = MADV_RANDOM;
+    }
+    madvise(window, static_cast<size_t>(m_windowLength), advice);
+#ifdef MADV_HUGEPAGE
+    if (m_wantsHugePages) {
+        m_isUsingHugePages = (madvise(window, static_cast<size_t>(m_windowLength), MADV_HUGEPAGE) == 0);
+    } else if (m_isUsingHugePages) {
+        madvise(window, static_cast<size_t>(m_windowLength), MADV_NOHUGEPAGE);
+        m_isUsingHugePages = false;
+    }
+#endif
+#endif
+}
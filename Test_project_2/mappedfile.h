@@ -0,0 +1,105 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <stdint.h>
+#include <string>
+
+/**
+  Read-only memory mapping of a file, through a window that is moved
+  over the file on demand
+
+  A recording may be larger than the address space of a 32-bit process,
+  and even in a 64-bit process mapping all of a multi-GB file at once
+  is not always wanted. map() returns a pointer into the current window
+  if it holds the requested bytes, and otherwise maps a new window that
+  starts at the allocation granularity boundary before them, or ends at
+  the end of the file if that is closer. By default
+  the window is the whole file in a 64-bit process and 256 MiB in a
+  32-bit one. Moving the window costs system calls and page faults, some
+  microseconds, so random access over a file larger than the window is
+  best made in offset order.
+
+  The access hint is passed to the kernel for every window, with
+  madvise() and posix_fadvise() on POSIX; on Windows it selects
+  FILE_FLAG_SEQUENTIAL_SCAN or FILE_FLAG_RANDOM_ACCESS and takes effect
+  at the next open(). Huge pages are asked for with MADV_HUGEPAGE where
+  the kernel has it; whether it accepted them is told by
+  isUsingHugePages(). Linux backs file mappings with huge pages only on
+  file systems that support it, so a refusal is not an error.
+
+  Pointers returned by map() stay valid until the next map() that moves
+  the window, or close(). An instance is not thread-safe, but any number
+  of instances may map the same file; they share the page cache.
+*/
+class MappedFile
+{
+public:
+    enum Access
+    {
+        NORMAL_ACCESS,
+        SEQUENTIAL_ACCESS,
+        RANDOM_ACCESS
+    };
+
+    MappedFile();
+    ~MappedFile();
+
+    /** @return GE_OK, GE_NOT_EXISTING, GE_NO_ACCESS, or GE_ERROR if it could not be mapped */
+    int open(const std::string &path);
+    void close();
+    bool isOpen() const;
+
+    uint64_t getSize() const { return m_size; }
+
+    void setAccess(Access access);
+    void setHugePages(bool enable);
+    /** Rounded up to the allocation granularity; 0 for the default */
+    void setWindowSize(uint64_t sizeInBytes);
+    uint64_t getWindowSize() const { return m_windowSize; }
+    bool isUsingHugePages() const { return m_isUsingHugePages; }
+
+    /**
+      Makes the bytes from @p offset on readable, moving the window if it
+      does not hold @p numBytes of them, or the rest of the file
+
+      @param numMapped Set to the number of bytes readable from the
+      returned pointer on, up to the end of the window. It is below
+      @p numBytes only at the end of the file, or if @p numBytes is more
+      than the window holds.
+      @return Pointer to the byte at @p offset, or NULL if @p offset is at
+      or past the end of the file, or the window could not be mapped
+    */
+    const uint8_t *map(uint64_t offset, uint64_t numBytes, uint64_t &numMapped);
+
+    /** Number of times a window was mapped since open() */
+    uint64_t getNumMappings() const { return m_numMappings; }
+
+private:
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+    bool mapWindow(uint64_t start);
+    void unmapWindow();
+    void adviseWindow();
+
+    uint64_t m_size;
+    Access m_access;
+    bool m_wantsHugePages;
+    bool m_isUsingHugePages;
+    uint64_t m_granularity;
+    uint64_t m_windowSize;
+    bool m_hasDefaultWindowSize;
+
+#ifdef _WIN32
+    void *m_file;                        // HANDLE
+    void *m_mapping;                     // HANDLE
+#else
+    int m_fd;
+#endif
+    const uint8_t *m_window;
+    uint64_t m_windowStart;
+    uint64_t m_windowLength;
+    uint64_t m_numMappings;
+};
+
+#endif // MAPPEDFILE_H
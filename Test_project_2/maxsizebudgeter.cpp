@@ -0,0 +1,212 @@
+#include "maxsizebudgeter.h"
+
+#include <map>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/statvfs.h>
+#endif
+
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "inc/GE_Defines.h"
+#include "GEC_SfpdpLinkRate.h"
+
+MaxSizeBudgeter::MaxSizeBudgeter(std::string user, std::string password)
+    : m_user(user)
+    , m_password(password)
+    , m_reserveInBytes(1024ULL * 1024 * 1024)
+    , m_reserveFraction(0.02)
+    , m_granularityInBytes(1024 * 1024)
+{
+}
+
+void MaxSizeBudgeter::setReserve(uint64_t reserveInBytes, double reserveFraction)
+{
+    m_reserveInBytes = reserveInBytes;
+    m_reserveFraction = (reserveFraction >= 0 && reserveFraction < 1) ? reserveFraction : 0;
+}
+
+void MaxSizeBudgeter::setGranularity(uint64_t granularityInBytes)
+{
+    // The recorder stores whole 32 bit words
+    m_granularityInBytes = (granularityInBytes < 4) ? 4 : granularityInBytes & ~3ULL;
+}
+
+void MaxSizeBudgeter::addSession(uint32_t id, const std::string &host, const std::string &path, int linkSpeed,
+                                 double weight, uint64_t limitInBytes)
+{
+    Session session;
+    session.id = id;
+    session.host = host;
+    session.path = path;
+    // Sessions use 2.5 Gbps unless told otherwise
+    session.linkSpeed = (GEC_sfpdpLineRateInBitsPerSecond(linkSpeed) != 0) ? linkSpeed : GEC_SFPDP_2_5_GBPS;
+    session.weight = (weight > 0) ? weight : 1.0;
+    session.limitInBytes = limitInBytes;
+    session.maxSizeInBytes = 0;
+    session.secondsToFull = 0;
+    m_sessions.push_back(session);
+}
+
+// Capacity of a local directory, for sessions of a simulated recorder
+static void queryLocalCapacity(const std::string &path, GEC_Capacity &capacity)
+{
+    capacity.path = path;
+#ifdef _WIN32
+    ULARGE_INTEGER available, total, free;
+    if (!GetDiskFreeSpaceExA(path.c_str(), &available, &total, &free)) {
+        capacity.rc = GEC_CAPACITY_NOT_EXISTING;
+        return;
+    }
+    capacity.totalBytes = total.QuadPart;
+    capacity.freeBytes = free.QuadPart;
+    capacity.availableBytes = available.QuadPart;
+    char volume[MAX_PATH];
+    DWORD serialNumber = 0;
+    if (GetVolumePathNameA(path.c_str(), volume, sizeof(volume))
+        && GetVolumeInformationA(volume, NULL, 0, &serialNumber, NULL, NULL, NULL, 0)) {
+        capacity.fsid = serialNumber;
+    }
+#else
+    struct statvfs stat;
+    if (statvfs(path.c_str(), &stat) != 0) {
+        capacity.rc = GEC_CAPACITY_NOT_EXISTING;
+        return;
+    }
+    capacity.blockSizeInBytes = stat.f_frsize;
+    capacity.totalBytes = static_cast<uint64_t>(stat.f_blocks) * stat.f_frsize;
+    capacity.freeBytes = static_cast<uint64_t>(stat.f_bfree) * stat.f_frsize;
+    capacity.availableBytes = static_cast<uint64_t>(stat.f_bavail) * stat.f_frsize;
+    capacity.totalInodes = stat.f_files;
+    capacity.freeInodes = stat.f_ffree;
+    capacity.availableInodes = stat.f_favail;
+    capacity.fsid = stat.f_fsid;
+#endif
+    capacity.rc = GEC_CAPACITY_OK;
+}
+
+int MaxSizeBudgeter::budget()
+{
+    GEC_CapacityQuery query(m_user, m_password, 2);
+    std::vector<size_t> remote;
+    for (size_t i = 0; i < m_sessions.size(); ++i) {
+        if (!m_sessions[i].host.empty()) {
+            query.add(m_sessions[i].host, m_sessions[i].path);
+            remote.push_back(i);
+        }
+    }
+
+    std::vector<GEC_Capacity> remoteCapacities;
+    if (!remote.empty()) {
+        query.run(remoteCapacities);
+    }
+
+    std::vector<GEC_Capacity> capacities(m_sessions.size());
+    size_t k = 0;
+    for (size_t i = 0; i < m_sessions.size(); ++i) {
+        if (m_sessions[i].host.empty()) {
+            queryLocalCapacity(m_sessions[i].path, capacities[i]);
+        } else if (k < remoteCapacities.size()) {
+            capacities[i] = remoteCapacities[k++];
+        }
+    }
+    return budget(capacities);
+}
+
+int MaxSizeBudgeter::budget(const std::vector<GEC_Capacity> &capacities)
+{
+    m_capacities = capacities;
+    if (capacities.size() != m_sessions.size()) {
+        return GE_INVALID_PARAMETER;
+    }
+
+    // Directories on one file system share its space, whatever their paths
+    std::map<std::pair<std::string, uint64_t>, std::vector<size_t> > filesystems;
+    for (size_t i = 0; i < m_sessions.size(); ++i) {
+        if (capacities[i].rc == GEC_CAPACITY_NOT_EXISTING) {
+            return GE_NOT_EXISTING;
+        } else if (capacities[i].rc != GEC_CAPACITY_OK) {
+            return GE_COMMFAIL;
+        }
+        filesystems[std::make_pair(m_sessions[i].host, capacities[i].fsid)].push_back(i);
+    }
+
+    std::map<std::pair<std::string, uint64_t>, std::vector<size_t> >::iterator it;
+    for (it = filesystems.begin(); it != filesystems.end(); ++it) {
+        budgetFilesystem(it->second, capacities[it->second.front()].availableBytes);
+    }
+
+    for (size_t i = 0; i < m_sessions.size(); ++i) {
+        if (m_sessions[i].maxSizeInBytes < m_granularityInBytes) {
+            return GE_RESOURCE_UNAVAILABLE;
+        }
+    }
+    return GE_OK;
+}
+
+void MaxSizeBudgeter::budgetFilesystem(const std::vector<size_t> &sessions, uint64_t availableBytes)
+{
+    uint64_t reserve = m_reserveInBytes + static_cast<uint64_t>(m_reserveFraction * availableBytes);
+    double remaining = (availableBytes > reserve) ? static_cast<double>(availableBytes - reserve) : 0.0;
+
+    // Sessions whose own limit is below their proportional share are settled first, and
+    // the space they leave is shared again between the others, until no limit is reached
+    std::vector<size_t> open(sessions);
+    bool limitReached = true;
+    while (limitReached && !open.empty()) {
+        limitReached = false;
+        double sumOfShares = 0;
+        for (size_t k = 0; k < open.size(); ++k) {
+            const Session &session = m_sessions[open[k]];
+            sumOfShares += session.weight * GEC_sfpdpDataRateInBytesPerSecond(session.linkSpeed);
+        }
+
+        std::vector<size_t> stillOpen;
+        for (size_t k = 0; k < open.size(); ++k) {
+            Session &session = m_sessions[open[k]];
+            double share = remaining * session.weight * GEC_sfpdpDataRateInBytesPerSecond(session.linkSpeed) / sumOfShares;
+            if (session.limitInBytes != 0 && session.limitInBytes <= share) {
+                session.maxSizeInBytes = session.limitInBytes;
+                remaining -= session.limitInBytes;
+                limitReached = true;
+            } else {
+                session.maxSizeInBytes = static_cast<uint64_t>(share);
+                stillOpen.push_back(open[k]);
+            }
+        }
+        open.swap(stillOpen);
+    }
+
+    for (size_t k = 0; k < sessions.size(); ++k) {
+        Session &session = m_sessions[sessions[k]];
+        session.maxSizeInBytes -= session.maxSizeInBytes % m_granularityInBytes;
+        session.secondsToFull = static_cast<double>(session.maxSizeInBytes)
+            / GEC_sfpdpDataRateInBytesPerSecond(session.linkSpeed);
+    }
+}
+
+int MaxSizeBudgeter::apply(GEC_ISfpdpRecorder *recorder) const
+{
+    // The budget assumes these link speeds, so they are set together with the sizes
+    for (size_t i = 0; i < m_sessions.size(); ++i) {
+        int rc = recorder->setLinkSpeed(m_sessions[i].id, m_sessions[i].linkSpeed);
+        if (rc != GE_OK) {
+            return rc;
+        }
+        rc = recorder->setMaxSize(m_sessions[i].id, m_sessions[i].maxSizeInBytes);
+        if (rc != GE_OK) {
+            return rc;
+        }
+    }
+    return GE_OK;
+}
+
+int MaxSizeBudgeter::applyAndStart(GEC_ISfpdpRecorder *recorder) const
+{
+    int rc = apply(recorder);
+    if (rc != GE_OK) {
+        return rc;
+    }
+    return recorder->startAll();
+}
@@ -0,0 +1,104 @@
+#ifndef MAXSIZEBUDGETER_H
+#define MAXSIZEBUDGETER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "GEC_CapacityQuery.h"
+
+class GEC_ISfpdpRecorder;
+
+/**
+  Splits the free space of the recorder's file systems between the
+  recording sessions about to start, and sets the maximum size of every
+  session in one batch before startAll()
+
+  Sessions on the same file system get space in proportion to their link
+  data rate times their weight. With equal weights all of them fill their
+  share at the same time, so no channel runs out early because another
+  one took the space; a weight of 2 records twice as long as a weight
+  of 1. A session with a limit of its own never gets more than that, and
+  what it leaves over goes to the others on its file system.
+
+  Only the data file is limited by setMaxSize(), so a part of the free
+  space is held back for the index and meta data files, and for anything
+  else written to the file system.
+*/
+class MaxSizeBudgeter
+{
+public:
+    struct Session
+    {
+        uint32_t id;
+        std::string host;              // Empty for a local directory, as with the simulator
+        std::string path;              // Directory given to create()
+        int linkSpeed;                 // GEC_SFPDP_*_GBPS
+        double weight;
+        uint64_t limitInBytes;         // 0 for no limit of its own
+
+        uint64_t maxSizeInBytes;       // Result of budget()
+        double secondsToFull;          // At the full data rate of the link
+    };
+
+    MaxSizeBudgeter(std::string user, std::string password);
+
+    /** Free space held back on every file system: a fixed amount plus a fraction of the rest */
+    void setReserve(uint64_t reserveInBytes, double reserveFraction);
+    /** Maximum sizes are rounded down to a multiple of this (default 1 MiB) */
+    void setGranularity(uint64_t granularityInBytes);
+
+    void addSession(uint32_t id, const std::string &host, const std::string &path, int linkSpeed,
+                    double weight = 1.0, uint64_t limitInBytes = 0);
+    void clear() { m_sessions.clear(); m_capacities.clear(); }
+
+    /**
+      Queries the free space of all file systems and computes the maximum
+      size of every session
+
+      Never asks anything on the console, so it can run on any thread: a
+      host whose key is not known yet, or which takes neither the user's
+      key nor the password, fails the query with GE_COMMFAIL.
+
+      @return GE_OK
+      Success
+      @return GE_COMMFAIL
+      A file system could not be queried
+      @return GE_NOT_EXISTING
+      The path of a session does not exist
+      @return GE_RESOURCE_UNAVAILABLE
+      A session would get less than the granularity
+    */
+    int budget();
+
+    /** Computes the maximum sizes from capacities already queried, one per session in the order added */
+    int budget(const std::vector<GEC_Capacity> &capacities);
+
+    /**
+      Sets the link speed and the maximum size of every session
+
+      The sessions must have been created and not yet started. Stops at
+      the first call that fails and returns its error.
+    */
+    int apply(GEC_ISfpdpRecorder *recorder) const;
+
+    /** Applies the budget and starts all sessions, if every setting succeeded */
+    int applyAndStart(GEC_ISfpdpRecorder *recorder) const;
+
+    const std::vector<Session> &getSessions() const { return m_sessions; }
+    const std::vector<GEC_Capacity> &getCapacities() const { return m_capacities; }
+
+private:
+    void budgetFilesystem(const std::vector<size_t> &sessions, uint64_t availableBytes);
+
+    std::string m_user;
+    std::string m_password;
+    uint64_t m_reserveInBytes;
+    double m_reserveFraction;
+    uint64_t m_granularityInBytes;
+
+    std::vector<Session> m_sessions;
+    std::vector<GEC_Capacity> m_capacities;
+};
+
+#endif // MAXSIZEBUDGETER_H
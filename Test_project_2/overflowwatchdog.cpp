@@ -0,0 +1,221 @@
+#include "overflowwatchdog.h"
+
+#include <chrono>
+
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "inc/GE_Defines.h"
+
+// Sessions that did not overflow still get a getStatus() this often, as the base of the next throughput
+static const double statusIntervalInS = 1.0;
+
+OverflowWatchdog::OverflowWatchdog(CreateFunction create, DestroyFunction destroy, double intervalInS,
+                                   size_t queueCapacity)
+    : m_create(create)
+    , m_destroy(destroy)
+    , m_intervalInS(intervalInS)
+    , m_idsVersion(0)
+    , m_isRunning(false)
+    , m_events(queueCapacity)
+    , m_numChecks(0)
+    , m_numFailedChecks(0)
+    , m_numEvents(0)
+    , m_numDroppedEvents(0)
+    , m_numLateRounds(0)
+    , m_maximumRoundTimeInNs(0)
+{
+}
+
+OverflowWatchdog::~OverflowWatchdog()
+{
+    stop();
+}
+
+double OverflowWatchdog::getTimeInS()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void OverflowWatchdog::addSession(uint32_t id)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ids.insert(id);
+        ++m_idsVersion;
+    }
+    m_wakeUp.notify_all();
+}
+
+void OverflowWatchdog::removeSession(uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ids.erase(id);
+    ++m_idsVersion;
+}
+
+void OverflowWatchdog::clearSessions()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ids.clear();
+    ++m_idsVersion;
+}
+
+void OverflowWatchdog::start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_isRunning) {
+        return;
+    }
+    m_isRunning = true;
+    m_thread = std::thread(&OverflowWatchdog::run, this);
+}
+
+void OverflowWatchdog::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isRunning = false;
+    }
+    m_wakeUp.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool OverflowWatchdog::popEvent(Event &event)
+{
+    return m_events.pop(event);
+}
+
+OverflowWatchdog::Statistics OverflowWatchdog::getStatistics() const
+{
+    Statistics statistics;
+    statistics.numChecks = m_numChecks.load(std::memory_order_relaxed);
+    statistics.numFailedChecks = m_numFailedChecks.load(std::memory_order_relaxed);
+    statistics.numEvents = m_numEvents.load(std::memory_order_relaxed);
+    statistics.numDroppedEvents = m_numDroppedEvents.load(std::memory_order_relaxed);
+    statistics.numLateRounds = m_numLateRounds.load(std::memory_order_relaxed);
+    statistics.maximumRoundTimeInS = 1e-9 * m_maximumRoundTimeInNs.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+void OverflowWatchdog::run()
+{
+    GEC_ISfpdpRecorder *recorder = NULL;
+    std::map<uint32_t, Session> sessions;
+    uint64_t idsVersion = 0;
+    std::chrono::steady_clock::time_point nextRound = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(m_intervalInS));
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_isRunning) {
+        // Without sessions the thread sleeps until there are some
+        m_wakeUp.wait(lock, [this] { return !m_isRunning || !m_ids.empty(); });
+        if (!m_isRunning) {
+            break;
+        }
+        if (idsVersion != m_idsVersion) {
+            std::map<uint32_t, Session> current;
+            std::set<uint32_t>::const_iterator it;
+            for (it = m_ids.begin(); it != m_ids.end(); ++it) {
+                std::map<uint32_t, Session>::const_iterator known = sessions.find(*it);
+                if (known != sessions.end()) {
+                    current[*it] = known->second;
+                } else {
+                    Session session;
+                    session.lastCheckInS = 0;
+                    session.lastStatusInS = 0;
+                    session.lastNumBytes = 0;
+                    current[*it] = session;
+                }
+            }
+            sessions.swap(current);
+            idsVersion = m_idsVersion;
+        }
+        lock.unlock();
+
+        if (recorder == NULL) {
+            recorder = m_create();
+        }
+        double roundStartInS = getTimeInS();
+        std::map<uint32_t, Session>::iterator it;
+        for (it = sessions.begin(); it != sessions.end(); ++it) {
+            check(recorder, it->first, it->second);
+        }
+        double roundTimeInS = getTimeInS() - roundStartInS;
+        uint64_t roundTimeInNs = static_cast<uint64_t>(roundTimeInS * 1e9);
+        if (roundTimeInNs > m_maximumRoundTimeInNs.load(std::memory_order_relaxed)) {
+            m_maximumRoundTimeInNs.store(roundTimeInNs, std::memory_order_relaxed);
+        }
+
+        // Rounds keep to a fixed schedule; one that overran, or the first after a wait, starts the next at once
+        nextRound += interval;
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (nextRound < now) {
+            if (roundTimeInS > m_intervalInS) {
+                m_numLateRounds.fetch_add(1, std::memory_order_relaxed);
+            }
+            nextRound = now;
+        }
+
+        lock.lock();
+        m_wakeUp.wait_until(lock, nextRound, [this] { return !m_isRunning; });
+    }
+    lock.unlock();
+
+    if (recorder != NULL) {
+        m_destroy(recorder);
+    }
+}
+
+void OverflowWatchdog::check(GEC_ISfpdpRecorder *recorder, uint32_t id, Session &session)
+{
+    m_numChecks.fetch_add(1, std::memory_order_relaxed);
+    if (recorder == NULL) {
+        m_numFailedChecks.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    bool detected = false;
+    double beforeInS = getTimeInS();
+    std::chrono::system_clock::time_point wallClock = std::chrono::system_clock::now();
+    int rc = recorder->checkForOverflow(id, detected, true);
+    double afterInS = getTimeInS();
+    if (rc != GE_OK) {
+        m_numFailedChecks.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Event event;
+    if (detected) {
+        event.id = id;
+        event.timeInS = (beforeInS + afterInS) / 2;
+        event.previousCheckInS = session.lastCheckInS;
+        event.wallClockInUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            wallClock.time_since_epoch()).count() + static_cast<int64_t>((afterInS - beforeInS) / 2 * 1e6);
+    }
+    session.lastCheckInS = afterInS;
+
+    if (!detected && afterInS - session.lastStatusInS < statusIntervalInS) {
+        return;
+    }
+    uint64_t numBytes = 0;
+    std::string state;
+    if (recorder->getStatus(id, numBytes, state) == GE_OK) {
+        double timeInS = getTimeInS();
+        if (session.lastStatusInS > 0 && numBytes >= session.lastNumBytes) {
+            event.bytesPerSecond = (numBytes - session.lastNumBytes) / (timeInS - session.lastStatusInS);
+        }
+        session.lastStatusInS = timeInS;
+        session.lastNumBytes = numBytes;
+        event.numBytes = numBytes;
+        event.state = state;
+    }
+
+    if (detected) {
+        m_numEvents.fetch_add(1, std::memory_order_relaxed);
+        if (!m_events.push(event)) {
+            m_numDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
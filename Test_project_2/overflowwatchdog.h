@@ -0,0 +1,127 @@
+#ifndef OVERFLOWWATCHDOG_H
+#define OVERFLOWWATCHDOG_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "spscqueue.h"
+
+class GEC_ISfpdpRecorder;
+
+/**
+  Watches recording sessions for overflows at a high rate, and stamps
+  each one with the time it was detected
+
+  checkForOverflow() only tells whether an overflow happened since the
+  state was last cleared. The watchdog calls checkForOverflow(id,
+  detected, true) for every session once per interval (10 ms by default)
+  on a thread of its own, so an overflow is known to lie between the
+  previous check and the one that detected it. Each detection is an
+  Event with both times on the monotonic clock, the wall clock time,
+  and the byte count and throughput of the session. The byte count
+  comes from a getStatus() call made right after the detection; the
+  throughput is over the time since the previous getStatus() of the
+  session, which is called at least once per second.
+
+  Events are passed through a lock-free SpscQueue: the watchdog thread
+  is the only producer, and one consumer, e.g. a GUI timer, takes them
+  with popEvent(). If the consumer falls behind and the queue is full,
+  events are dropped and counted rather than holding up the polls.
+
+  The watchdog uses its own recorder instance, made by @p create on its
+  thread, so its polls do not queue behind other requests. For a
+  recorder that is only in this process, such as a SimulatedRecorder,
+  or a ReconnectingRecorder, whose session ids only it can translate,
+  @p create may return a shared thread-safe instance and @p destroy
+  leave it alone. Overflows are cleared by every check, so the status
+  poller should not check them as well.
+*/
+class OverflowWatchdog
+{
+public:
+    typedef std::function<GEC_ISfpdpRecorder *()> CreateFunction;
+    typedef std::function<void(GEC_ISfpdpRecorder *)> DestroyFunction;
+
+    struct Event
+    {
+        Event() : id(0), timeInS(0), previousCheckInS(0), wallClockInUs(0), numBytes(0), bytesPerSecond(0) {}
+
+        uint32_t id;
+        double timeInS;                  // Monotonic, the middle of the check that detected the overflow
+        double previousCheckInS;         // Monotonic, the end of the previous check, or 0 if there was none
+        int64_t wallClockInUs;           // Microseconds since 1970 at timeInS
+        uint64_t numBytes;
+        double bytesPerSecond;
+        std::string state;
+    };
+
+    struct Statistics
+    {
+        uint64_t numChecks;
+        uint64_t numFailedChecks;        // checkForOverflow() did not return GE_OK
+        uint64_t numEvents;
+        uint64_t numDroppedEvents;       // The queue was full
+        uint64_t numLateRounds;          // Rounds that took longer than the interval
+        double maximumRoundTimeInS;
+    };
+
+    OverflowWatchdog(CreateFunction create, DestroyFunction destroy, double intervalInS = 0.01,
+                     size_t queueCapacity = 1024);
+    ~OverflowWatchdog();
+
+    void addSession(uint32_t id);
+    void removeSession(uint32_t id);
+    void clearSessions();
+
+    void start();
+    void stop();
+
+    /** Consumer side of the queue, for one thread only. @return false if there is no event */
+    bool popEvent(Event &event);
+
+    Statistics getStatistics() const;
+
+    static double getTimeInS();
+
+private:
+    OverflowWatchdog(const OverflowWatchdog &);
+    OverflowWatchdog &operator=(const OverflowWatchdog &);
+
+    struct Session
+    {
+        double lastCheckInS;
+        double lastStatusInS;
+        uint64_t lastNumBytes;
+    };
+
+    void run();
+    void check(GEC_ISfpdpRecorder *recorder, uint32_t id, Session &session);
+
+    CreateFunction m_create;
+    DestroyFunction m_destroy;
+    double m_intervalInS;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::set<uint32_t> m_ids;
+    uint64_t m_idsVersion;               // Changed with m_ids, so the thread knows to copy them
+    bool m_isRunning;
+    std::thread m_thread;
+
+    SpscQueue<Event> m_events;
+    std::atomic<uint64_t> m_numChecks;
+    std::atomic<uint64_t> m_numFailedChecks;
+    std::atomic<uint64_t> m_numEvents;
+    std::atomic<uint64_t> m_numDroppedEvents;
+    std::atomic<uint64_t> m_numLateRounds;
+    std::atomic<uint64_t> m_maximumRoundTimeInNs;
+};
+
+#endif // OVERFLOWWATCHDOG_H
@@ -0,0 +1,240 @@
+#include "profileengine.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "inc/GE_Defines.h"
+#include "instrumentedrecorder.h"
+#include "recorderprotocol.h"
+#ifndef _WIN32
+#include "socketrecorder.h"
+#endif
+
+ProfileEngine::ProfileEngine(const SessionProfiles &profiles)
+    : m_profiles(profiles)
+    , m_isPipelining(true)
+{
+}
+
+bool ProfileEngine::parseAssignment(const std::string &text, Assignment &assignment)
+{
+    size_t at = text.rfind('@');
+    size_t colon = text.rfind(':');
+    if (at == std::string::npos || colon == std::string::npos || colon < at) {
+        return false;
+    }
+    assignment.profile = text.substr(0, at);
+    assignment.iDevice = static_cast<uint32_t>(atoi(text.c_str() + at + 1));
+    assignment.iPort = static_cast<uint32_t>(atoi(text.c_str() + colon + 1));
+    char name[32];
+    snprintf(name, sizeof(name), "dev%u-port%u", assignment.iDevice, assignment.iPort);
+    assignment.name = name;
+    return !assignment.profile.empty();
+}
+
+std::vector<std::string> ProfileEngine::execute(GEC_ISfpdpRecorder *recorder, const std::vector<std::string> &requests,
+                                                Report &report)
+{
+    std::vector<std::string> responses;
+    report.numCalls += requests.size();
+#ifndef _WIN32
+    // Pipelined frames go around an InstrumentedRecorder, so they are not in its statistics
+    GEC_ISfpdpRecorder *inner = InstrumentedRecorder::unwrap(recorder);
+    SocketRecorder *socket = m_isPipelining ? dynamic_cast<SocketRecorder *>(inner) : NULL;
+    if (socket != NULL) {
+        report.isPipelined = true;
+        report.numRoundTrips += (requests.size() + SocketRecorder::pipelineWindow - 1) / SocketRecorder::pipelineWindow;
+        socket->callPipelined(requests, responses);
+        return responses;
+    }
+#endif
+    // The same frames, decoded and called on the recorder one by one
+    for (size_t i = 0; i < requests.size(); ++i) {
+        responses.push_back(RecorderProtocol::dispatch(recorder, requests[i].data(), requests[i].size()));
+    }
+    report.numRoundTrips += requests.size();
+    return responses;
+}
+
+void ProfileEngine::addSetters(const SessionProfile &profile, const Assignment &assignment, uint32_t id,
+                               std::vector<std::string> &requests, SessionResult &result) const
+{
+    SessionProfile defaults;
+    size_t numBefore = requests.size();
+    size_t numSetters = 0;
+
+    // The port's link speed is set first, as it has no per-session default
+    ++numSetters;
+    if (profile.linkSpeed >= 0) {
+        RecorderProtocol::Writer request(0, RecorderProtocol::SET_LINK_SPEED);
+        request.putU32(id);
+        request.putI32(profile.linkSpeed);
+        requests.push_back(request.finish());
+    }
+    ++numSetters;
+    if (profile.crc != defaults.crc) {
+        RecorderProtocol::Writer request(0, RecorderProtocol::SET_CRC);
+        request.putU32(id);
+        request.putBool(profile.crc);
+        requests.push_back(request.finish());
+    }
+    ++numSetters;
+    if (profile.flowControl != defaults.flowControl) {
+        RecorderProtocol::Writer request(0, RecorderProtocol::SET_FLOW_CONTROL);
+        request.putU32(id);
+        request.putBool(profile.flowControl);
+        requests.push_back(request.finish());
+    }
+    ++numSetters;
+    if (profile.syncSource != defaults.syncSource) {
+        RecorderProtocol::Writer request(0, RecorderProtocol::SET_CHANNEL_SYNC_SOURCE);
+        request.putU32(id);
+        request.putI32(profile.syncSource);
+        requests.push_back(request.finish());
+    }
+    ++numSetters;
+    if (profile.swap8in16 != defaults.swap8in16 || profile.swap16in32 != defaults.swap16in32) {
+        RecorderProtocol::Writer request(0, RecorderProtocol::SET_SWAPPING);
+        request.putU32(id);
+        request.putBool(profile.swap8in16);
+        request.putBool(profile.swap16in32);
+        requests.push_back(request.finish());
+    }
+
+    if (!profile.isPlayback) {
+        uint64_t maxSizeInBytes = (assignment.maxSizeInBytes != 0) ? assignment.maxSizeInBytes : profile.maxSizeInBytes;
+        numSetters += 3;
+        if (profile.copyMode != defaults.copyMode) {
+            RecorderProtocol::Writer request(0, RecorderProtocol::SET_COPY_MODE);
+            request.putU32(id);
+            request.putBool(profile.copyMode);
+            requests.push_back(request.finish());
+        }
+        if (profile.waitForSync != defaults.waitForSync) {
+            RecorderProtocol::Writer request(0, RecorderProtocol::SET_WAIT_FOR_SYNC);
+            request.putU32(id);
+            request.putI32(profile.waitForSync);
+            requests.push_back(request.finish());
+        }
+        if (maxSizeInBytes != 0) {
+            RecorderProtocol::Writer request(0, RecorderProtocol::SET_MAX_SIZE);
+            request.putU32(id);
+            request.putU64(maxSizeInBytes);
+            requests.push_back(request.finish());
+        }
+    } else {
+        numSetters += 2;
+        if (profile.cycleSize != defaults.cycleSize || profile.cyclePartsForTx != defaults.cyclePartsForTx) {
+            RecorderProtocol::Writer request(0, RecorderProtocol::SET_RATE_CONTROL);
+            request.putU32(id);
+            request.putI32(profile.cycleSize);
+            request.putU32(profile.cyclePartsForTx);
+            requests.push_back(request.finish());
+        }
+        if (profile.simplexLink != defaults.simplexLink) {
+            RecorderProtocol::Writer request(0, RecorderProtocol::SET_SIMPLEX_LINK_MODE);
+            request.putU32(id);
+            request.putBool(profile.simplexLink);
+            requests.push_back(request.finish());
+        }
+    }
+
+    size_t numAdded = requests.size() - numBefore;
+    result.numCalls += numAdded;
+    result.numSkipped = numSetters - numAdded;
+}
+
+int ProfileEngine::arm(GEC_ISfpdpRecorder *recorder, const std::vector<Assignment> &assignments, Report &report)
+{
+    report = Report();
+    std::vector<const SessionProfile *> profiles;
+    for (size_t i = 0; i < assignments.size(); ++i) {
+        const SessionProfile *profile = m_profiles.find(assignments[i].profile);
+        if (profile == NULL) {
+            report.rc = GE_INVALID_PARAMETER;
+            return report.rc;
+        }
+        profiles.push_back(profile);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Phase 1: every session is created or opened
+    std::vector<std::string> requests;
+    for (size_t i = 0; i < assignments.size(); ++i) {
+        const Assignment &assignment = assignments[i];
+        RecorderProtocol::Writer request(0, profiles[i]->isPlayback ? RecorderProtocol::OPEN : RecorderProtocol::CREATE);
+        request.putString(assignment.path);
+        request.putString(assignment.name);
+        request.putU32(assignment.iDevice);
+        request.putU32(assignment.iPort);
+        if (profiles[i]->isPlayback) {
+            request.putI32(profiles[i]->playbackMode);
+        }
+        requests.push_back(request.finish());
+    }
+    std::vector<std::string> responses = execute(recorder, requests, report);
+
+    // Phase 2: the setters of all sessions, with the session each belongs to
+    // Any id, 0 included, may be a session the recorder made
+    std::vector<std::string> setters;
+    std::vector<size_t> owners;
+    std::vector<bool> isCreated(assignments.size(), false);
+    for (size_t i = 0; i < assignments.size(); ++i) {
+        SessionResult result;
+        result.rc = GE_COMMFAIL;
+        result.id = 0;
+        result.failedMethod = profiles[i]->isPlayback ? RecorderProtocol::OPEN : RecorderProtocol::CREATE;
+        result.numCalls = 1;
+        result.numSkipped = 0;
+        if (i < responses.size()) {
+            RecorderProtocol::Reader response(responses[i].data(), responses[i].size());
+            result.rc = response.getMethodOrRc();
+            if (result.rc == GE_OK) {
+                result.id = response.getU32();
+                result.failedMethod = 0;
+                isCreated[i] = true;
+                addSetters(*profiles[i], assignments[i], result.id, setters, result);
+                owners.resize(setters.size(), i);
+            }
+        }
+        report.sessions.push_back(result);
+    }
+    responses = execute(recorder, setters, report);
+    for (size_t k = 0; k < setters.size(); ++k) {
+        SessionResult &result = report.sessions[owners[k]];
+        int rc = GE_COMMFAIL;
+        if (k < responses.size()) {
+            RecorderProtocol::Reader response(responses[k].data(), responses[k].size());
+            rc = response.getMethodOrRc();
+        }
+        if (rc != GE_OK && result.rc == GE_OK) {
+            RecorderProtocol::Reader request(setters[k].data(), setters[k].size());
+            result.rc = rc;
+            result.failedMethod = request.getMethodOrRc();
+        }
+    }
+
+    // Phase 3: sessions that could not be armed completely are removed again
+    std::vector<std::string> destroys;
+    for (size_t i = 0; i < report.sessions.size(); ++i) {
+        const SessionResult &result = report.sessions[i];
+        if (result.rc != GE_OK && isCreated[i]) {
+            RecorderProtocol::Writer request(0, RecorderProtocol::DESTROY);
+            request.putU32(result.id);
+            destroys.push_back(request.finish());
+        }
+        if (result.rc != GE_OK && report.rc == GE_OK) {
+            report.rc = result.rc;
+        }
+        report.numSkipped += result.numSkipped;
+    }
+    if (!destroys.empty()) {
+        execute(recorder, destroys, report);
+    }
+
+    report.armTimeInS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report.rc;
+}
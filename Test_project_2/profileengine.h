@@ -0,0 +1,98 @@
+#ifndef PROFILEENGINE_H
+#define PROFILEENGINE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "sessionprofiles.h"
+
+class GEC_ISfpdpRecorder;
+
+/**
+  Arms many sessions from their profiles in one batch
+
+  Arming a session is a create() or open() followed by up to ten
+  setters, each a blocking round trip. The engine arms all sessions
+  together, in two phases: all create() and open() calls, then all
+  setters of all sessions. Setters whose value is the default of a new
+  session are skipped.
+
+  On a SocketRecorder the calls of a phase are pipelined, so a phase
+  costs one round trip per SocketRecorder::pipelineWindow calls instead
+  of one per call. Other recorders, e.g. the vendor TCP client, get the
+  same calls one after the other.
+
+  Sessions that fail to arm are destroyed again, so afterwards every
+  session is either fully armed or gone. Nothing is started; call
+  startAll() when the batch succeeded.
+*/
+class ProfileEngine
+{
+public:
+    struct Assignment
+    {
+        Assignment() : iDevice(0), iPort(0), maxSizeInBytes(0) {}
+
+        std::string profile;
+        std::string path;                // Directory and name for create() or open()
+        std::string name;
+        uint32_t iDevice;
+        uint32_t iPort;
+        uint64_t maxSizeInBytes;         // Replaces the one of the profile if not 0, e.g. from MaxSizeBudgeter
+    };
+
+    struct SessionResult
+    {
+        int rc;                          // GE_OK, or the error of the first call that failed
+        uint32_t id;                     // Valid if rc is GE_OK
+        int failedMethod;                // RecorderProtocol::Method of the call that failed, or 0
+        size_t numCalls;
+        size_t numSkipped;               // Setters left out as their value is the default
+    };
+
+    struct Report
+    {
+        Report() : rc(0), numCalls(0), numSkipped(0), numRoundTrips(0), isPipelined(false), armTimeInS(0) {}
+
+        int rc;                          // GE_OK, or the error of the first session that failed
+        std::vector<SessionResult> sessions;   // In the order of the assignments
+        size_t numCalls;
+        size_t numSkipped;
+        size_t numRoundTrips;
+        bool isPipelined;
+        double armTimeInS;
+    };
+
+    explicit ProfileEngine(const SessionProfiles &profiles);
+
+    /**
+      Reads an assignment given as "<profile>@<device>:<port>", as on the
+      command line of the tools, and names it "dev<device>-port<port>"
+
+      @return false if @p text is not of that form
+    */
+    static bool parseAssignment(const std::string &text, Assignment &assignment);
+
+    /** Pipelining is on by default; off, every call waits for the previous one, for comparison */
+    void setPipelining(bool enable) { m_isPipelining = enable; }
+
+    /**
+      @return GE_OK if every session was armed, GE_INVALID_PARAMETER if an
+      assignment names no known profile (then no call is made), or the
+      first error of a session
+    */
+    int arm(GEC_ISfpdpRecorder *recorder, const std::vector<Assignment> &assignments, Report &report);
+
+private:
+    /** Makes the calls of one phase. @return Their responses, as many as calls were answered */
+    std::vector<std::string> execute(GEC_ISfpdpRecorder *recorder, const std::vector<std::string> &requests,
+                                     Report &report);
+    void addSetters(const SessionProfile &profile, const Assignment &assignment, uint32_t id,
+                    std::vector<std::string> &requests, SessionResult &result) const;
+
+    const SessionProfiles &m_profiles;
+    bool m_isPipelining;
+};
+
+#endif // PROFILEENGINE_H
@@ -0,0 +1,575 @@
+#include "reconnectingrecorder.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "inc/GE_Defines.h"
+
+static const double firstDelayInS = 0.1;
+static const double maximumDelayInS = 2.0;
+
+// Looked up when there is nothing to restore, to find out whether the connection works
+static const uint32_t probeId = 0xffffffff;
+
+ReconnectingRecorder::ReconnectingRecorder(CreateFunction create, DestroyFunction destroy)
+    : m_create(create)
+    , m_destroy(destroy)
+    , m_timeoutInS(10)
+    , m_recorder(NULL)
+    , m_wasConnected(false)
+    , m_isReconnecting(false)
+    , m_isClosing(false)
+    , m_nextAttemptInS(0)
+    , m_hasSyncControl(false)
+    , m_syncControl(GEC_SFPDP_AUTOMATIC_CONTROL)
+    , m_isStarted(false)
+    , m_nextId(1)
+    , m_monitor(NULL)
+    , m_nextMonitorAttemptInS(0)
+    , m_isMonitorPaused(false)
+{
+}
+
+ReconnectingRecorder::~ReconnectingRecorder()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_isClosing = true;
+    m_changed.notify_all();
+    m_changed.wait(lock, [this] { return !m_isReconnecting; });
+    if (m_recorder != NULL) {
+        m_destroy(m_recorder);
+    }
+    std::lock_guard<std::mutex> monitorLock(m_monitorMutex);
+    if (m_monitor != NULL) {
+        m_destroy(m_monitor);
+    }
+}
+
+double ReconnectingRecorder::getTimeInS()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ReconnectingRecorder::setTimeout(double timeoutInS)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_timeoutInS = timeoutInS;
+}
+
+void ReconnectingRecorder::setListener(Listener listener)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_listener = listener;
+}
+
+int ReconnectingRecorder::run(std::unique_lock<std::mutex> &lock, const Call &call)
+{
+    m_changed.wait(lock, [this] { return !m_isReconnecting; });
+    int rc = (m_recorder != NULL) ? call(m_recorder) : GE_COMMFAIL;
+    if (rc != GE_COMMFAIL || m_isClosing || getTimeInS() < m_nextAttemptInS) {
+        return rc;
+    }
+    reconnect(lock);
+    return (m_recorder != NULL) ? call(m_recorder) : GE_COMMFAIL;
+}
+
+int ReconnectingRecorder::runOnSession(uint32_t id, const SessionCall &call)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    // The session is looked up on every attempt, as a reconnect may give it another recorder id
+    return run(lock, [this, id, &call](GEC_ISfpdpRecorder *recorder) {
+        std::map<uint32_t, Session>::const_iterator it = m_sessions.find(id);
+        if (it == m_sessions.end() || it->second.isLost) {
+            return static_cast<int>(GE_INVALID_PARAMETER);
+        }
+        return call(recorder, it->second.recorderId);
+    });
+}
+
+int ReconnectingRecorder::runSetter(uint32_t id, RecorderProtocol::Method method, const SessionCall &setter)
+{
+    return runOnSession(id, [this, id, method, &setter](GEC_ISfpdpRecorder *recorder, uint32_t recorderId) {
+        int rc = setter(recorder, recorderId);
+        if (rc == GE_OK) {
+            m_sessions[id].setters[method] = setter;
+        }
+        return rc;
+    });
+}
+
+int ReconnectingRecorder::runOnMonitor(uint32_t id, const SessionCall &call)
+{
+    uint32_t recorderId = 0;
+    bool isMonitored = false;
+    {
+        std::lock_guard<std::mutex> lock(m_monitoredMutex);
+        std::map<uint32_t, Monitored>::const_iterator it = m_monitored.find(id);
+        if (!m_isMonitorPaused && it != m_monitored.end()) {
+            recorderId = it->second.recorderId;
+            isMonitored = true;
+        }
+    }
+
+    if (isMonitored) {
+        std::lock_guard<std::mutex> lock(m_monitorMutex);
+        if (m_monitor == NULL && getTimeInS() >= m_nextMonitorAttemptInS) {
+            m_monitor = m_create();
+        }
+        if (m_monitor != NULL) {
+            int rc = call(m_monitor, recorderId);
+            if (rc != GE_COMMFAIL) {
+                return rc;
+            }
+            m_destroy(m_monitor);
+            m_monitor = NULL;
+        }
+        // Reconnecting is left to the other instance, which also restores the sessions
+        m_nextMonitorAttemptInS = std::max(m_nextMonitorAttemptInS, getTimeInS() + maximumDelayInS);
+    }
+    return runOnSession(id, call);
+}
+
+void ReconnectingRecorder::updateMonitored()
+{
+    std::lock_guard<std::mutex> lock(m_monitoredMutex);
+    std::map<uint32_t, Monitored> monitored;
+    std::map<uint32_t, Session>::const_iterator it;
+    for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        if (it->second.isLost) {
+            continue;
+        }
+        std::map<uint32_t, Monitored>::const_iterator old = m_monitored.find(it->first);
+        Monitored &session = monitored[it->first];
+        session.recorderId = it->second.recorderId;
+        session.numBytes = (old != m_monitored.end() && old->second.recorderId == session.recorderId)
+                               ? old->second.numBytes
+                               : 0;
+    }
+    m_monitored.swap(monitored);
+    m_isMonitorPaused = m_isReconnecting;
+}
+
+int ReconnectingRecorder::makeSession(Session session, uint32_t &id)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    uint32_t recorderId = 0;
+    int rc = run(lock, [&session, &recorderId](GEC_ISfpdpRecorder *recorder) {
+        if (session.isPlayback) {
+            return recorder->open(session.path, session.name, session.iDevice, session.iPort, session.mode,
+                                  recorderId);
+        }
+        return recorder->create(session.path, session.name, session.iDevice, session.iPort, recorderId);
+    });
+    if (rc == GE_OK) {
+        session.recorderId = recorderId;
+        id = m_nextId++;
+        m_sessions[id] = session;
+        updateMonitored();
+    }
+    return rc;
+}
+
+void ReconnectingRecorder::reconnect(std::unique_lock<std::mutex> &lock)
+{
+    m_isReconnecting = true;
+    updateMonitored();
+    double startInS = getTimeInS();
+    if (m_recorder != NULL) {
+        m_destroy(m_recorder);
+        m_recorder = NULL;
+    }
+
+    Reconnect result;
+    double delayInS = firstDelayInS;
+    for (;;) {
+        ++result.numAttempts;
+        m_recorder = m_create();
+        if (m_recorder != NULL) {
+            Reconnect attempt;
+            if (restore(attempt) == GE_OK) {
+                result.numKeptSessions = attempt.numKeptSessions;
+                result.numRemadeSessions = attempt.numRemadeSessions;
+                result.numLostSessions = attempt.numLostSessions;
+                break;
+            }
+            m_destroy(m_recorder);
+            m_recorder = NULL;
+        }
+        if (m_isClosing || getTimeInS() + delayInS - startInS > m_timeoutInS) {
+            result.rc = GE_COMMFAIL;
+            m_nextAttemptInS = getTimeInS() + maximumDelayInS;
+            break;
+        }
+        m_changed.wait_for(lock, std::chrono::duration<double>(delayInS), [this] { return m_isClosing; });
+        delayInS = std::min(2 * delayInS, maximumDelayInS);
+    }
+    result.downTimeInS = getTimeInS() - startInS;
+
+    bool wasConnected = m_wasConnected;
+    m_wasConnected = m_wasConnected || (m_recorder != NULL);
+    m_isReconnecting = false;
+    updateMonitored();
+    m_changed.notify_all();
+
+    if (wasConnected && m_listener) {
+        Listener listener = m_listener;
+        lock.unlock();
+        listener(result);
+        lock.lock();
+    }
+}
+
+int ReconnectingRecorder::restore(Reconnect &reconnect)
+{
+    GEC_ISfpdpRecorder *recorder = m_recorder;
+    // Only GE_COMMFAIL ends the attempt; other errors were already returned to the caller the first time
+    if (m_hasSyncControl && recorder->setIntChannelSyncControl(m_syncControl) == GE_COMMFAIL) {
+        return GE_COMMFAIL;
+    }
+    std::map<std::pair<uint32_t, int>, int>::const_iterator output;
+    for (output = m_syncOutputs.begin(); output != m_syncOutputs.end(); ++output) {
+        if (recorder->setChannelSyncOutput(output->first.first, output->first.second, output->second) == GE_COMMFAIL) {
+            return GE_COMMFAIL;
+        }
+    }
+    if (m_sessions.empty()) {
+        uint64_t numBytes = 0;
+        std::string state;
+        return (recorder->getStatus(probeId, numBytes, state) == GE_COMMFAIL) ? GE_COMMFAIL : GE_OK;
+    }
+
+    // A server that restarted may have given the id of a session to one of another client, so a session is only
+    // kept if it is still ours, and all are made again once one is found not to be
+    std::map<uint32_t, int> statusRcs;
+    bool isNewServer = false;
+    std::map<uint32_t, Session>::iterator it;
+    for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        if (it->second.isLost) {
+            continue;
+        }
+        uint64_t numBytes = 0;
+        std::string state;
+        int rc = recorder->getStatus(it->second.recorderId, numBytes, state);
+        if (rc == GE_COMMFAIL) {
+            return GE_COMMFAIL;
+        }
+        if (rc == GE_OK && !isSameSession(it->first, it->second, numBytes, state)) {
+            isNewServer = true;
+        }
+        statusRcs[it->first] = rc;
+    }
+
+    for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        Session &session = it->second;
+        if (session.isLost) {
+            ++reconnect.numLostSessions;
+            continue;
+        }
+        if (statusRcs[it->first] == GE_OK && !isNewServer) {
+            ++reconnect.numKeptSessions;
+            continue;
+        }
+        int rc = remake(session);
+        if (rc == GE_COMMFAIL) {
+            return GE_COMMFAIL;
+        }
+        {
+            // The bytes seen belong to the session that was lost
+            std::lock_guard<std::mutex> lock(m_monitoredMutex);
+            m_monitored.erase(it->first);
+        }
+        if (rc == GE_OK) {
+            ++reconnect.numRemadeSessions;
+        } else {
+            session.isLost = true;
+            ++reconnect.numLostSessions;
+        }
+    }
+    if (reconnect.numRemadeSessions == 0) {
+        return GE_OK;
+    }
+
+    // The recorder lost its state, so the sessions made again are started as they were before
+    if (m_isStarted) {
+        if (recorder->startAll() == GE_COMMFAIL) {
+            return GE_COMMFAIL;
+        }
+        for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+            it->second.hasStartedSinceMade = true;
+        }
+    }
+    if (m_syncControl == GEC_SFPDP_MANUAL_CONTROL) {
+        std::map<std::pair<uint32_t, int>, int>::const_iterator master;
+        for (master = m_syncMasters.begin(); master != m_syncMasters.end(); ++master) {
+            if (master->second == GEC_SFPDP_START_CHANNEL_SYNC
+                && recorder->setIntChannelSync(master->first.first, master->first.second, master->second)
+                       == GE_COMMFAIL) {
+                return GE_COMMFAIL;
+            }
+        }
+    }
+    return GE_OK;
+}
+
+bool ReconnectingRecorder::isSameSession(uint32_t id, const Session &session, uint64_t numBytes,
+                                         const std::string &state)
+{
+    bool isPlaybackState = (state == "Playing" || state == "End of file" || state == "All data transmitted");
+    bool isRecordingState = (state == "Recording" || state == "Idle" || state == "Maxed out");
+    if (session.isPlayback ? isRecordingState : isPlaybackState) {
+        return false;
+    }
+    // A session never goes back to Ready once started, nor loses bytes
+    if (session.hasStartedSinceMade && state == "Ready") {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_monitoredMutex);
+    std::map<uint32_t, Monitored>::const_iterator it = m_monitored.find(id);
+    return it == m_monitored.end() || it->second.recorderId != session.recorderId || numBytes >= it->second.numBytes;
+}
+
+int ReconnectingRecorder::remake(Session &session)
+{
+    GEC_ISfpdpRecorder *recorder = m_recorder;
+    std::string name = session.name;
+    if (!session.isPlayback && session.hasStarted) {
+        char suffix[16];
+        snprintf(suffix, sizeof(suffix), "-%d", ++session.numRemakes);
+        name += suffix;
+    }
+
+    uint32_t recorderId = 0;
+    int rc = session.isPlayback
+                 ? recorder->open(session.path, name, session.iDevice, session.iPort, session.mode, recorderId)
+                 : recorder->create(session.path, name, session.iDevice, session.iPort, recorderId);
+    if (rc != GE_OK) {
+        return rc;
+    }
+    session.recorderId = recorderId;
+    session.hasStartedSinceMade = false;
+    std::map<int, SessionCall>::const_iterator it;
+    for (it = session.setters.begin(); it != session.setters.end(); ++it) {
+        if (it->second(recorder, recorderId) == GE_COMMFAIL) {
+            return GE_COMMFAIL;
+        }
+    }
+    return GE_OK;
+}
+
+int ReconnectingRecorder::setIntChannelSyncControl(int mode)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    int rc = run(lock, [mode](GEC_ISfpdpRecorder *recorder) { return recorder->setIntChannelSyncControl(mode); });
+    if (rc == GE_OK) {
+        m_hasSyncControl = true;
+        m_syncControl = mode;
+    }
+    return rc;
+}
+
+int ReconnectingRecorder::setIntChannelSync(uint32_t iDevice, int masterMask, int action)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    int rc = run(lock, [iDevice, masterMask, action](GEC_ISfpdpRecorder *recorder) {
+        return recorder->setIntChannelSync(iDevice, masterMask, action);
+    });
+    if (rc == GE_OK) {
+        for (int bit = 1; bit <= GEC_SFPDP_INTERNAL_CHANNEL_SYNC_MASTER_3; bit <<= 1) {
+            if ((masterMask & bit) != 0) {
+                m_syncMasters[std::make_pair(iDevice, bit)] = action;
+            }
+        }
+    }
+    return rc;
+}
+
+int ReconnectingRecorder::setChannelSyncOutput(uint32_t iDevice, int signal, int source)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    int rc = run(lock, [iDevice, signal, source](GEC_ISfpdpRecorder *recorder) {
+        return recorder->setChannelSyncOutput(iDevice, signal, source);
+    });
+    if (rc == GE_OK) {
+        m_syncOutputs[std::make_pair(iDevice, signal)] = source;
+    }
+    return rc;
+}
+
+int ReconnectingRecorder::reset()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    int rc = run(lock, [](GEC_ISfpdpRecorder *recorder) { return recorder->reset(); });
+    if (rc == GE_OK) {
+        m_sessions.clear();
+        m_syncMasters.clear();
+        m_isStarted = false;
+        updateMonitored();
+    }
+    return rc;
+}
+
+int ReconnectingRecorder::create(std::string path, std::string name, uint32_t iDevice, uint32_t iPort, uint32_t &id)
+{
+    Session session;
+    session.path = path;
+    session.name = name;
+    session.iDevice = iDevice;
+    session.iPort = iPort;
+    return makeSession(session, id);
+}
+
+int ReconnectingRecorder::open(std::string path, std::string name, uint32_t iDevice, uint32_t iPort, int mode,
+                               uint32_t &id)
+{
+    Session session;
+    session.isPlayback = true;
+    session.path = path;
+    session.name = name;
+    session.iDevice = iDevice;
+    session.iPort = iPort;
+    session.mode = mode;
+    return makeSession(session, id);
+}
+
+int ReconnectingRecorder::destroy(uint32_t id)
+{
+    int rc = runOnSession(id, [](GEC_ISfpdpRecorder *recorder, uint32_t recorderId) {
+        return recorder->destroy(recorderId);
+    });
+    if (rc == GE_OK || rc == GE_INVALID_PARAMETER) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sessions.erase(id);
+        updateMonitored();
+    }
+    return rc;
+}
+
+int ReconnectingRecorder::setCRC(uint32_t id, bool enableCRC)
+{
+    return runSetter(id, RecorderProtocol::SET_CRC, [enableCRC](GEC_ISfpdpRecorder *recorder, uint32_t recorderId) {
+        return recorder->setCRC(recorderId, enableCRC);
+    });
+}
+
+int ReconnectingRecorder::setCopyMode(uint32_t id, bool enable)
+{
+    return runSetter(id, RecorderProtocol::SET_COPY_MODE,
+                     [enable](GEC_ISfpdpRecorder *recorder, uint32_t recorderId) {
+                         return recorder->setCopyMode(recorderId, enable);
+                     });
+}
+
+int ReconnectingRecorder::setWaitForSync(uint32_t id, int mode)
+{
+    return runSetter(id, RecorderProtocol::SET_WAIT_FOR_SYNC,
+                     [mode](GEC_ISfpdpRecorder *recorder, uint32_t recorderId) {
+                         return recorder->setWaitForSync(recorderId, mode);
+                     });
+}
+
+int ReconnectingRecorder::setMaxSize(uint32_t id, uint64_t sizeInBytes)
+{
+    return runSetter(id, RecorderProtocol::SET_MAX_SIZE,
+                     [sizeInBytes](GEC_ISfpdpRecorder *recorder, uint32_t recorderId) {
+                         return recorder->setMaxSize(recorderId, sizeInBytes);
+                     });
+}
+
+int ReconnectingRecorder::setLinkSpeed(uint32_t id, int speed)
+{
+    return runSetter(id, RecorderProtocol::SET_LINK_SPEED,
+                     [speed](GEC_ISfpdpRecorder *recorder, uint32_t recorderId) {
+                         return recorder->setLinkSpeed(recorderId, speed);
+                     });
+}
+
+int ReconnectingRecorder::setFlowControl(uint32_t id, bool enable)
+{
+    return runSetter(id, RecorderProtocol::SET_FLOW_CONTROL,
+                     [enable](GEC_ISfpdpRecorder *recorder, uint32_t recorderId) {
+                         return recorder->setFlowControl(recorderId, enable);
+                     });
+}
+
+int ReconnectingRecorder::setRateControl(uint32_t id, int cycleSize, uint32_t cyclePartsForTx)
+{
+    return runSetter(id, RecorderProtocol::SET_RATE_CONTROL,
+                     [cycleSize, cyclePartsForTx](GEC_ISfpdpRecorder *recorder, uint32_t recorderId) {
+                         return recorder->setRateControl(recorderId, cycleSize, cyclePartsForTx);
+                     });
+}
+
+int ReconnectingRecorder::setSimplexLinkMode(uint32_t id, bool enable)
+{
+    return runSetter(id, RecorderProtocol::SET_SIMPLEX_LINK_MODE,
+                     [enable](GEC_ISfpdpRecorder *recorder, uint32_t recorderId) {
+                         return recorder->setSimplexLinkMode(recorderId, enable);
+                     });
+}
+
+int ReconnectingRecorder::setChannelSyncSource(uint32_t id, int source)
+{
+    return runSetter(id, RecorderProtocol::SET_CHANNEL_SYNC_SOURCE,
+                     [source](GEC_ISfpdpRecorder *recorder, uint32_t recorderId) {
+                         return recorder->setChannelSyncSource(recorderId, source);
+                     });
+}
+
+int ReconnectingRecorder::setSwapping(uint32_t id, bool enable8in16, bool enable16in32)
+{
+    return runSetter(id, RecorderProtocol::SET_SWAPPING,
+                     [enable8in16, enable16in32](GEC_ISfpdpRecorder *recorder, uint32_t recorderId) {
+                         return recorder->setSwapping(recorderId, enable8in16, enable16in32);
+                     });
+}
+
+int ReconnectingRecorder::getStatus(uint32_t id, uint64_t &numBytes, std::string &state)
+{
+    uint32_t calledId = 0;
+    int rc = runOnMonitor(id, [&numBytes, &state, &calledId](GEC_ISfpdpRecorder *recorder, uint32_t recorderId) {
+        calledId = recorderId;
+        return recorder->getStatus(recorderId, numBytes, state);
+    });
+    if (rc == GE_OK) {
+        std::lock_guard<std::mutex> lock(m_monitoredMutex);
+        std::map<uint32_t, Monitored>::iterator it = m_monitored.find(id);
+        if (it != m_monitored.end() && it->second.recorderId == calledId) {
+            it->second.numBytes = std::max(it->second.numBytes, numBytes);
+        }
+    }
+    return rc;
+}
+
+int ReconnectingRecorder::checkForOverflow(uint32_t id, bool &detected, bool clear)
+{
+    return runOnMonitor(id, [&detected, clear](GEC_ISfpdpRecorder *recorder, uint32_t recorderId) {
+        return recorder->checkForOverflow(recorderId, detected, clear);
+    });
+}
+
+int ReconnectingRecorder::startAll()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    int rc = run(lock, [](GEC_ISfpdpRecorder *recorder) { return recorder->startAll(); });
+    if (rc == GE_OK) {
+        m_isStarted = true;
+        std::map<uint32_t, Session>::iterator it;
+        for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+            it->second.hasStarted = true;
+            it->second.hasStartedSinceMade = true;
+        }
+    }
+    return rc;
+}
+
+int ReconnectingRecorder::stopAll()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    int rc = run(lock, [](GEC_ISfpdpRecorder *recorder) { return recorder->stopAll(); });
+    if (rc == GE_OK) {
+        m_isStarted = false;
+    }
+    return rc;
+}
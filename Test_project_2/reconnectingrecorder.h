@@ -0,0 +1,192 @@
+#ifndef RECONNECTINGRECORDER_H
+#define RECONNECTINGRECORDER_H
+
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "recorderprotocol.h"
+
+/**
+  GEC_ISfpdpRecorder that survives a lost connection to the recorder
+
+  When a call returns GE_COMMFAIL, the instance is destroyed and a new
+  one created, first after 0.1 s and then after twice the delay of the
+  previous attempt, up to 2 s, until one connects and the state below
+  is restored. The call is then made once more on the new instance.
+  Reconnecting gives up after 10 s by default; the call returns
+  GE_COMMFAIL, and so do further calls until the next attempt is due.
+
+  The journal holds what the application configured: the sync control
+  mode, the sync outputs and masters, every session made by create() or
+  open(), and the latest value of each of its setters. After connecting
+  again, each session is looked up with getStatus():
+
+  - If the recorder still has it, as when only the connection dropped,
+    it is kept as it is.
+  - If the recorder lost it, e.g. because its server restarted, the
+    session is made again and its setters replayed. A server that
+    restarted may already have given the id to a session of another
+    client; a session whose kind, state, or byte count cannot be that
+    of the one in the journal, e.g. Ready after startAll() or with
+    fewer bytes than getStatus() returned before, shows that the server
+    is new, and all sessions are made again. A recording that
+    was started gets a new name, <name>-<n>, so the data recorded before
+    is not overwritten; a playback starts from the beginning. When
+    sessions were made again after startAll(), startAll() is called
+    again, which leaves sessions that are still running alone.
+
+  Callers keep using the session ids this class returned, which stay
+  valid across reconnects even where the recorder's own ids change. A
+  session that could not be made again returns GE_INVALID_PARAMETER.
+
+  Calls are serialized, so one instance may be shared by several
+  threads; it should be, as another instance could not translate the
+  session ids. A call made during a reconnect waits for it to finish.
+  getStatus() and checkForOverflow(), which pollers make many times a
+  second, go to a second instance of their own instead, so they do not
+  wait behind other calls; while that one is not connected, or the
+  session is being restored, they are made like the others.
+  A call that failed with GE_COMMFAIL may or may not have reached the
+  recorder; retrying a create() may then return GE_BUSY.
+*/
+class ReconnectingRecorder : public GEC_ISfpdpRecorder
+{
+public:
+    typedef std::function<GEC_ISfpdpRecorder *()> CreateFunction;
+    typedef std::function<void(GEC_ISfpdpRecorder *)> DestroyFunction;
+
+    struct Reconnect
+    {
+        Reconnect() : rc(0), numAttempts(0), downTimeInS(0), numKeptSessions(0), numRemadeSessions(0)
+            , numLostSessions(0) {}
+
+        int rc;                          // GE_OK, or GE_COMMFAIL if reconnecting gave up
+        int numAttempts;
+        double downTimeInS;              // From the failed call to the restored state
+        int numKeptSessions;
+        int numRemadeSessions;
+        int numLostSessions;             // Could not be made again
+    };
+
+    typedef std::function<void(const Reconnect &reconnect)> Listener;
+
+    ReconnectingRecorder(CreateFunction create, DestroyFunction destroy);
+    virtual ~ReconnectingRecorder();
+
+    virtual int setIntChannelSyncControl(int mode);
+    virtual int setIntChannelSync(uint32_t iDevice, int masterMask, int action);
+    virtual int setChannelSyncOutput(uint32_t iDevice, int signal, int source);
+    virtual int reset();
+    virtual int create(std::string path, std::string name, uint32_t iDevice, uint32_t iPort, uint32_t &id);
+    virtual int open(std::string path, std::string name, uint32_t iDevice, uint32_t iPort, int mode, uint32_t &id);
+    virtual int destroy(uint32_t id);
+    virtual int setCRC(uint32_t id, bool enableCRC);
+    virtual int setCopyMode(uint32_t id, bool enable);
+    virtual int setWaitForSync(uint32_t id, int mode);
+    virtual int setMaxSize(uint32_t id, uint64_t sizeInBytes);
+    virtual int setLinkSpeed(uint32_t id, int speed);
+    virtual int setFlowControl(uint32_t id, bool enable);
+    virtual int setRateControl(uint32_t id, int cycleSize, uint32_t cyclePartsForTx);
+    virtual int setSimplexLinkMode(uint32_t id, bool enable);
+    virtual int setChannelSyncSource(uint32_t id, int source);
+    virtual int setSwapping(uint32_t id, bool enable8in16, bool enable16in32);
+    virtual int getStatus(uint32_t id, uint64_t &numBytes, std::string &state);
+    virtual int checkForOverflow(uint32_t id, bool &detected, bool clear);
+    virtual int startAll();
+    virtual int stopAll();
+
+    /** Time after which reconnecting gives up, 10 s by default */
+    void setTimeout(double timeoutInS);
+    /** Called on the thread of the failed call after every reconnect, whether it succeeded or not */
+    void setListener(Listener listener);
+
+private:
+    ReconnectingRecorder(const ReconnectingRecorder &);
+    ReconnectingRecorder &operator=(const ReconnectingRecorder &);
+
+    typedef std::function<int(GEC_ISfpdpRecorder *recorder)> Call;
+    typedef std::function<int(GEC_ISfpdpRecorder *recorder, uint32_t id)> SessionCall;
+
+    struct Session
+    {
+        Session()
+            : recorderId(0), isLost(false), hasStarted(false), hasStartedSinceMade(false), isPlayback(false), iDevice(0)
+            , iPort(0), mode(0), numRemakes(0) {}
+
+        uint32_t recorderId;
+        bool isLost;
+        bool hasStarted;                 // By a startAll(), so it may have recorded data
+        bool hasStartedSinceMade;        // The recorder's session, which is then no longer Ready
+        bool isPlayback;
+        std::string path;
+        std::string name;
+        uint32_t iDevice;
+        uint32_t iPort;
+        int mode;                        // Of open()
+        int numRemakes;
+        std::map<int, SessionCall> setters;  // By RecorderProtocol::Method, replayed in that order
+    };
+
+    static double getTimeInS();
+
+    /** Makes @p call, and reconnects and makes it again if it failed with GE_COMMFAIL */
+    int run(std::unique_lock<std::mutex> &lock, const Call &call);
+    int runOnSession(uint32_t id, const SessionCall &call);
+    int runSetter(uint32_t id, RecorderProtocol::Method method, const SessionCall &setter);
+    int makeSession(Session session, uint32_t &id);
+    /** Makes @p call on the monitor instance, or like runOnSession() if that is not possible */
+    int runOnMonitor(uint32_t id, const SessionCall &call);
+    /** Makes the monitored sessions those of the journal */
+    void updateMonitored();
+
+    void reconnect(std::unique_lock<std::mutex> &lock);
+    /** Brings a new instance to the state in the journal. @return GE_COMMFAIL if the connection failed again */
+    int restore(Reconnect &reconnect);
+    int remake(Session &session);
+    /** Tells whether the status of @p session after a reconnect can be that of the session in the journal */
+    bool isSameSession(uint32_t id, const Session &session, uint64_t numBytes, const std::string &state);
+
+    CreateFunction m_create;
+    DestroyFunction m_destroy;
+    double m_timeoutInS;
+    Listener m_listener;
+
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    GEC_ISfpdpRecorder *m_recorder;
+    bool m_wasConnected;                 // The listener is not told about the first connection
+    bool m_isReconnecting;
+    bool m_isClosing;
+    double m_nextAttemptInS;             // After a reconnect gave up
+
+    // The journal
+    bool m_hasSyncControl;
+    int m_syncControl;
+    std::map<std::pair<uint32_t, int>, int> m_syncOutputs;   // Source by device and signal
+    std::map<std::pair<uint32_t, int>, int> m_syncMasters;   // Last action by device and master bit
+    bool m_isStarted;
+    std::map<uint32_t, Session> m_sessions;
+    uint32_t m_nextId;
+
+    // The monitor instance, and the recorder ids of the sessions for it, so its calls do not take m_mutex
+    struct Monitored
+    {
+        uint32_t recorderId;
+        uint64_t numBytes;               // The most getStatus() returned
+    };
+
+    std::mutex m_monitorMutex;           // Held during a call on m_monitor
+    GEC_ISfpdpRecorder *m_monitor;
+    double m_nextMonitorAttemptInS;
+    std::mutex m_monitoredMutex;
+    bool m_isMonitorPaused;              // During a reconnect, as the recorder ids may change
+    std::map<uint32_t, Monitored> m_monitored;
+};
+
+#endif // RECONNECTINGRECORDER_H
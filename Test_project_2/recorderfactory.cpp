@@ -0,0 +1,124 @@
+#include "recorderfactory.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#endif
+
+#include <cstdlib>
+
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "inc/win/GEC_SfpdpRecorderFactory.h"
+#include "instrumentedrecorder.h"
+#include "reconnectingrecorder.h"
+#include "simulatedrecorder.h"
+#ifndef _WIN32
+#include "socketrecorder.h"
+#endif
+
+bool RecorderFactory::isSimulated(const std::string &address)
+{
+    return address.compare(0, 4, "sim:") == 0;
+}
+
+bool RecorderFactory::hasScheme(const std::string &address)
+{
+    return isSimulated(address) || address.compare(0, 5, "unix:") == 0;
+}
+
+GEC_ISfpdpRecorder *RecorderFactory::createUnixSocketBasedInstance(const std::string &path)
+{
+#ifdef _WIN32
+    (void)path;
+    return NULL;
+#else
+    return new SocketRecorder(path.empty() ? std::string(GEC_SFPDP_RECORDER_SERVER_UNIX_SOCKET_FILE) : path);
+#endif
+}
+
+GEC_ISfpdpRecorder *RecorderFactory::create(const std::string &address)
+{
+    GEC_ISfpdpRecorder *recorder = createUninstrumented(address);
+    const char *telemetry = getenv("GEC_RECORDER_TELEMETRY");
+    if (recorder == NULL || telemetry == NULL) {
+        return recorder;
+    }
+    InstrumentedRecorder *instrumented = new InstrumentedRecorder(recorder);
+    double intervalInS = atof(telemetry);
+    if (intervalInS > 0) {
+        instrumented->startDump(intervalInS);
+    }
+    return instrumented;
+}
+
+GEC_ISfpdpRecorder *RecorderFactory::createUninstrumented(const std::string &address)
+{
+    if (isSimulated(address)) {
+        SimulatedRecorder::Config config;
+        if (!SimulatedRecorder::parseAddress(address, config)) {
+            return NULL;
+        }
+        return new SimulatedRecorder(config);
+    }
+    if (address.compare(0, 5, "unix:") == 0) {
+        return createUnixSocketBasedInstance(address.substr(5));
+    }
+
+#ifdef _WIN32
+    // Every WSAStartup() is balanced by the WSACleanup() in destroy()
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        return NULL;
+    }
+    GEC_ISfpdpRecorder *recorder = GEC_SfpdpRecorderFactory::createTcpBasedInstance(address);
+    if (recorder == NULL) {
+        WSACleanup();
+    }
+    return recorder;
+#else
+    return GEC_SfpdpRecorderFactory::createTcpBasedInstance(address);
+#endif
+}
+
+ReconnectingRecorder *RecorderFactory::createReconnecting(const std::string &address)
+{
+    return new ReconnectingRecorder([address]() { return create(address); }, destroy);
+}
+
+void RecorderFactory::destroy(GEC_ISfpdpRecorder *recorder)
+{
+    if (recorder == NULL) {
+        return;
+    }
+
+    // The interface has no virtual destructor, so our own implementations are deleted by their type
+    InstrumentedRecorder *instrumented = dynamic_cast<InstrumentedRecorder *>(recorder);
+    if (instrumented != NULL) {
+        GEC_ISfpdpRecorder *inner = instrumented->getRecorder();
+        delete instrumented;
+        destroy(inner);
+        return;
+    }
+    ReconnectingRecorder *reconnecting = dynamic_cast<ReconnectingRecorder *>(recorder);
+    if (reconnecting != NULL) {
+        // It destroys its own instance
+        delete reconnecting;
+        return;
+    }
+    SimulatedRecorder *simulated = dynamic_cast<SimulatedRecorder *>(recorder);
+    if (simulated != NULL) {
+        delete simulated;
+        return;
+    }
+#ifndef _WIN32
+    SocketRecorder *socket = dynamic_cast<SocketRecorder *>(recorder);
+    if (socket != NULL) {
+        delete socket;
+        return;
+    }
+#endif
+
+    GEC_SfpdpRecorderFactory::destroyTcpBasedInstance(recorder);
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
@@ -0,0 +1,70 @@
+#ifndef RECORDERFACTORY_H
+#define RECORDERFACTORY_H
+
+#include <string>
+
+class GEC_ISfpdpRecorder;
+class ReconnectingRecorder;
+
+/**
+  Creates recorder instances from an address, so the application runs
+  against a real recorder or the simulator without other changes
+
+  An address of the form
+
+    sim:<directory>[?rate=<MB/s>&disk=<MB/s>&fifo=<MiB>]
+
+  creates a SimulatedRecorder that keeps its recordings below the local
+  <directory>; the options set the data rate of the senders, the write
+  rate of the disk, and the FIFO size (see SimulatedRecorder::parseAddress()).
+
+    unix:[<path>]
+
+  connects to a server on this machine through its Unix socket, by
+  default GEC_SFPDP_RECORDER_SERVER_UNIX_SOCKET_FILE (POSIX only). Any
+  other address is the host name or IP address of a recorder server,
+  reached over TCP.
+
+  When the environment variable GEC_RECORDER_TELEMETRY is set, every
+  instance is wrapped in an InstrumentedRecorder. If its value is a
+  number of seconds above 0, the call statistics are written to stderr
+  at that interval.
+*/
+class RecorderFactory
+{
+public:
+    static bool isSimulated(const std::string &address);
+    /** Whether @p address starts with "sim:" or "unix:" rather than being a host name */
+    static bool hasScheme(const std::string &address);
+
+    /** @return The instance, or NULL if it could not be created */
+    static GEC_ISfpdpRecorder *create(const std::string &address);
+
+    /**
+      Creates a client of the server listening on the Unix socket at @p path
+
+      The Unix socket avoids the TCP loopback stack for software running on
+      the recorder itself. The vendor library offers TCP only, so this
+      client speaks RecorderProtocol, as served by sfpdp-sim-server.
+
+      @return The instance, or NULL on Windows
+    */
+    static GEC_ISfpdpRecorder *createUnixSocketBasedInstance(const std::string &path);
+
+    /**
+      Creates a ReconnectingRecorder whose instances are made by create()
+      from @p address, so the connection is made again after it failed.
+      It connects on the first call.
+    */
+    static ReconnectingRecorder *createReconnecting(const std::string &address);
+
+    /** Destroys an instance returned by create(), createUnixSocketBasedInstance() or createReconnecting() */
+    static void destroy(GEC_ISfpdpRecorder *recorder);
+
+private:
+    RecorderFactory();
+
+    static GEC_ISfpdpRecorder *createUninstrumented(const std::string &address);
+};
+
+#endif // RECORDERFACTORY_H
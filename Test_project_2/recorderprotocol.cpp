@@ -0,0 +1,324 @@
+#include "recorderprotocol.h"
+
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "inc/GE_Defines.h"
+
+RecorderProtocol::Writer::Writer(uint32_t sequence, int32_t methodOrRc)
+{
+    m_frame.reserve(64);
+    putU32(0);
+    putU32(sequence);
+    putI32(methodOrRc);
+}
+
+void RecorderProtocol::Writer::putU32(uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) {
+        m_frame.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+void RecorderProtocol::Writer::putU64(uint64_t value)
+{
+    putU32(static_cast<uint32_t>(value));
+    putU32(static_cast<uint32_t>(value >> 32));
+}
+
+void RecorderProtocol::Writer::putBool(bool value)
+{
+    m_frame.push_back(value ? 1 : 0);
+}
+
+void RecorderProtocol::Writer::putString(const std::string &value)
+{
+    putU32(static_cast<uint32_t>(value.size()));
+    m_frame.append(value);
+}
+
+const std::string &RecorderProtocol::Writer::finish()
+{
+    uint32_t size = static_cast<uint32_t>(m_frame.size() - 4);
+    for (int i = 0; i < 4; ++i) {
+        m_frame[i] = static_cast<char>(size >> (8 * i));
+    }
+    return m_frame;
+}
+
+RecorderProtocol::Reader::Reader(const char *data, size_t size)
+    : m_data(data)
+    , m_size(size)
+    , m_offset(0)
+    , m_isValid(true)
+    , m_sequence(0)
+    , m_methodOrRc(0)
+{
+    uint32_t frameSize = getU32();
+    if (m_isValid && frameSize + 4 != size) {
+        m_isValid = false;
+    }
+    m_sequence = getU32();
+    m_methodOrRc = getI32();
+}
+
+uint32_t RecorderProtocol::Reader::getU32()
+{
+    if (m_offset + 4 > m_size) {
+        m_isValid = false;
+        return 0;
+    }
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(m_data + m_offset);
+    m_offset += 4;
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+uint64_t RecorderProtocol::Reader::getU64()
+{
+    uint64_t low = getU32();
+    uint64_t high = getU32();
+    return low | (high << 32);
+}
+
+bool RecorderProtocol::Reader::getBool()
+{
+    if (m_offset + 1 > m_size) {
+        m_isValid = false;
+        return false;
+    }
+    return m_data[m_offset++] != 0;
+}
+
+std::string RecorderProtocol::Reader::getString()
+{
+    uint32_t length = getU32();
+    if (!m_isValid || m_offset + length > m_size) {
+        m_isValid = false;
+        return std::string();
+    }
+    std::string value(m_data + m_offset, length);
+    m_offset += length;
+    return value;
+}
+
+int64_t RecorderProtocol::getFrameSize(const char *data, size_t size)
+{
+    if (size < 4) {
+        return 0;
+    }
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+    uint32_t frameSize = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    if (frameSize + 4 > maxFrameSize || frameSize + 4 < headerSize) {
+        return -1;
+    }
+    return frameSize + 4;
+}
+
+std::string RecorderProtocol::dispatch(GEC_ISfpdpRecorder *recorder, const char *request, size_t size)
+{
+    Reader in(request, size);
+    int rc = GE_INVALID_PARAMETER;
+    uint32_t id = 0;
+    uint64_t numBytes = 0;
+    std::string state;
+    bool detected = false;
+
+    // Arguments are all read before the call, so a truncated request never reaches the recorder
+    switch (in.getMethodOrRc()) {
+    case SET_INT_CHANNEL_SYNC_CONTROL: {
+        int mode = in.getI32();
+        if (in.isValid()) {
+            rc = recorder->setIntChannelSyncControl(mode);
+        }
+        break;
+    }
+    case SET_INT_CHANNEL_SYNC: {
+        uint32_t iDevice = in.getU32();
+        int masterMask = in.getI32();
+        int action = in.getI32();
+        if (in.isValid()) {
+            rc = recorder->setIntChannelSync(iDevice, masterMask, action);
+        }
+        break;
+    }
+    case SET_CHANNEL_SYNC_OUTPUT: {
+        uint32_t iDevice = in.getU32();
+        int signal = in.getI32();
+        int source = in.getI32();
+        if (in.isValid()) {
+            rc = recorder->setChannelSyncOutput(iDevice, signal, source);
+        }
+        break;
+    }
+    case RESET:
+        if (in.isValid()) {
+            rc = recorder->reset();
+        }
+        break;
+    case CREATE: {
+        std::string path = in.getString();
+        std::string name = in.getString();
+        uint32_t iDevice = in.getU32();
+        uint32_t iPort = in.getU32();
+        if (in.isValid()) {
+            rc = recorder->create(path, name, iDevice, iPort, id);
+        }
+        break;
+    }
+    case OPEN: {
+        std::string path = in.getString();
+        std::string name = in.getString();
+        uint32_t iDevice = in.getU32();
+        uint32_t iPort = in.getU32();
+        int mode = in.getI32();
+        if (in.isValid()) {
+            rc = recorder->open(path, name, iDevice, iPort, mode, id);
+        }
+        break;
+    }
+    case DESTROY:
+        id = in.getU32();
+        if (in.isValid()) {
+            rc = recorder->destroy(id);
+        }
+        break;
+    case SET_CRC:
+    case SET_COPY_MODE:
+    case SET_FLOW_CONTROL:
+    case SET_SIMPLEX_LINK_MODE: {
+        id = in.getU32();
+        bool enable = in.getBool();
+        if (!in.isValid()) {
+            break;
+        }
+        int method = in.getMethodOrRc();
+        if (method == SET_CRC) {
+            rc = recorder->setCRC(id, enable);
+        } else if (method == SET_COPY_MODE) {
+            rc = recorder->setCopyMode(id, enable);
+        } else if (method == SET_FLOW_CONTROL) {
+            rc = recorder->setFlowControl(id, enable);
+        } else {
+            rc = recorder->setSimplexLinkMode(id, enable);
+        }
+        break;
+    }
+    case SET_WAIT_FOR_SYNC:
+    case SET_LINK_SPEED:
+    case SET_CHANNEL_SYNC_SOURCE: {
+        id = in.getU32();
+        int value = in.getI32();
+        if (!in.isValid()) {
+            break;
+        }
+        int method = in.getMethodOrRc();
+        if (method == SET_WAIT_FOR_SYNC) {
+            rc = recorder->setWaitForSync(id, value);
+        } else if (method == SET_LINK_SPEED) {
+            rc = recorder->setLinkSpeed(id, value);
+        } else {
+            rc = recorder->setChannelSyncSource(id, value);
+        }
+        break;
+    }
+    case SET_MAX_SIZE: {
+        id = in.getU32();
+        uint64_t sizeInBytes = in.getU64();
+        if (in.isValid()) {
+            rc = recorder->setMaxSize(id, sizeInBytes);
+        }
+        break;
+    }
+    case SET_RATE_CONTROL: {
+        id = in.getU32();
+        int cycleSize = in.getI32();
+        uint32_t cyclePartsForTx = in.getU32();
+        if (in.isValid()) {
+            rc = recorder->setRateControl(id, cycleSize, cyclePartsForTx);
+        }
+        break;
+    }
+    case SET_SWAPPING: {
+        id = in.getU32();
+        bool enable8in16 = in.getBool();
+        bool enable16in32 = in.getBool();
+        if (in.isValid()) {
+            rc = recorder->setSwapping(id, enable8in16, enable16in32);
+        }
+        break;
+    }
+    case GET_STATUS:
+        id = in.getU32();
+        if (in.isValid()) {
+            rc = recorder->getStatus(id, numBytes, state);
+        }
+        break;
+    case CHECK_FOR_OVERFLOW: {
+        id = in.getU32();
+        bool clear = in.getBool();
+        if (in.isValid()) {
+            rc = recorder->checkForOverflow(id, detected, clear);
+        }
+        break;
+    }
+    case START_ALL:
+        if (in.isValid()) {
+            rc = recorder->startAll();
+        }
+        break;
+    case STOP_ALL:
+        if (in.isValid()) {
+            rc = recorder->stopAll();
+        }
+        break;
+    default:
+        break;
+    }
+
+    Writer out(in.getSequence(), rc);
+    if (rc == GE_OK) {
+        switch (in.getMethodOrRc()) {
+        case CREATE:
+        case OPEN:
+            out.putU32(id);
+            break;
+        case GET_STATUS:
+            out.putU64(numBytes);
+            out.putString(state);
+            break;
+        case CHECK_FOR_OVERFLOW:
+            out.putBool(detected);
+            break;
+        default:
+            break;
+        }
+    }
+    return out.finish();
+}
+
+const char *RecorderProtocol::getMethodName(int method)
+{
+    static const char *names[NUM_METHODS] = {
+        "unknown",
+        "setIntChannelSyncControl",
+        "setIntChannelSync",
+        "setChannelSyncOutput",
+        "reset",
+        "create",
+        "open",
+        "destroy",
+        "setCRC",
+        "setCopyMode",
+        "setWaitForSync",
+        "setMaxSize",
+        "setLinkSpeed",
+        "setFlowControl",
+        "setRateControl",
+        "setSimplexLinkMode",
+        "setChannelSyncSource",
+        "setSwapping",
+        "getStatus",
+        "checkForOverflow",
+        "startAll",
+        "stopAll"
+    };
+    return (method > 0 && method < NUM_METHODS) ? names[method] : names[0];
+}
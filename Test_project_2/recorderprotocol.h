@@ -0,0 +1,128 @@
+#ifndef RECORDERPROTOCOL_H
+#define RECORDERPROTOCOL_H
+
+#include <stdint.h>
+#include <string>
+
+class GEC_ISfpdpRecorder;
+
+/**
+  Wire protocol of the stand-in recorder server
+
+  The vendor server speaks a protocol of its own that is not documented,
+  so the stand-in server and its clients use this one. Every
+  GEC_ISfpdpRecorder call is one request frame and one response frame on
+  a stream socket (TCP or Unix):
+
+    request:   uint32 size | uint32 sequence | int32 method | arguments
+    response:  uint32 size | uint32 sequence | int32 rc     | results
+
+  size counts the bytes after the size field. The response repeats the
+  sequence number of its request. Integers are little endian, bools are
+  one byte, strings are a uint32 length followed by the bytes. Arguments
+  and results are the parameters of the method in declaration order;
+  results are only present when rc is GE_OK.
+
+  A client may send several requests without waiting; the server
+  answers them in order.
+*/
+class RecorderProtocol
+{
+public:
+    enum Method
+    {
+        SET_INT_CHANNEL_SYNC_CONTROL = 1,
+        SET_INT_CHANNEL_SYNC,
+        SET_CHANNEL_SYNC_OUTPUT,
+        RESET,
+        CREATE,
+        OPEN,
+        DESTROY,
+        SET_CRC,
+        SET_COPY_MODE,
+        SET_WAIT_FOR_SYNC,
+        SET_MAX_SIZE,
+        SET_LINK_SPEED,
+        SET_FLOW_CONTROL,
+        SET_RATE_CONTROL,
+        SET_SIMPLEX_LINK_MODE,
+        SET_CHANNEL_SYNC_SOURCE,
+        SET_SWAPPING,
+        GET_STATUS,
+        CHECK_FOR_OVERFLOW,
+        START_ALL,
+        STOP_ALL,
+        NUM_METHODS
+    };
+
+    static const uint32_t headerSize = 12;
+    static const uint32_t maxFrameSize = 64 * 1024;
+
+    /** Builds one frame */
+    class Writer
+    {
+    public:
+        Writer(uint32_t sequence, int32_t methodOrRc);
+
+        void putU32(uint32_t value);
+        void putI32(int32_t value) { putU32(static_cast<uint32_t>(value)); }
+        void putU64(uint64_t value);
+        void putBool(bool value);
+        void putString(const std::string &value);
+
+        /** The frame, with its size filled in */
+        const std::string &finish();
+
+    private:
+        std::string m_frame;
+    };
+
+    /** Reads the fields of one frame; any read past the end makes it invalid */
+    class Reader
+    {
+    public:
+        /** @p data points to a whole frame, starting with the size field */
+        Reader(const char *data, size_t size);
+
+        uint32_t getSequence() const { return m_sequence; }
+        int32_t getMethodOrRc() const { return m_methodOrRc; }
+        bool isValid() const { return m_isValid; }
+
+        uint32_t getU32();
+        int32_t getI32() { return static_cast<int32_t>(getU32()); }
+        uint64_t getU64();
+        bool getBool();
+        std::string getString();
+
+    private:
+        const char *m_data;
+        size_t m_size;
+        size_t m_offset;
+        bool m_isValid;
+        uint32_t m_sequence;
+        int32_t m_methodOrRc;
+    };
+
+    /**
+      Size of the first frame in @p data, once its size field is there
+
+      @return The size of the whole frame, 0 if more bytes are needed to
+      tell, or -1 if the frame exceeds maxFrameSize
+    */
+    static int64_t getFrameSize(const char *data, size_t size);
+
+    /**
+      Calls the method of one request frame on @p recorder
+
+      @return The response frame. A request that cannot be decoded gets
+      GE_INVALID_PARAMETER.
+    */
+    static std::string dispatch(GEC_ISfpdpRecorder *recorder, const char *request, size_t size);
+
+    static const char *getMethodName(int method);
+
+private:
+    RecorderProtocol();
+};
+
+#endif // RECORDERPROTOCOL_H
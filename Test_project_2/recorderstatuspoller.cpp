@@ -0,0 +1,316 @@
+#include "recorderstatuspoller.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "asyncrecorder.h"
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "inc/GE_Defines.h"
+
+// A session is polled at the shortest interval when its rate moves this much off the average
+static const double rateChangeFraction = 0.2;
+
+RecorderStatusPoller::RecorderStatusPoller(AsyncRecorder *recorder, double intervalInS, double smoothingTimeInS)
+    : m_recorder(recorder)
+    , m_smoothingTimeInS(smoothingTimeInS > 0 ? smoothingTimeInS : 1.0)
+    , m_isCheckingOverflows(true)
+    , m_nextHandle(1)
+    , m_isRunning(false)
+    , m_isPollQueued(false)
+    , m_isPollRequested(false)
+{
+    double baseInS = (intervalInS > 0) ? intervalInS : 1.0;
+    setIntervals(baseInS / 4, baseInS, baseInS * 10);
+    m_load.numCalls = 0;
+    m_load.numFixedRateCalls = 0;
+}
+
+RecorderStatusPoller::~RecorderStatusPoller()
+{
+    stop();
+}
+
+double RecorderStatusPoller::getTimeInS()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void RecorderStatusPoller::setIntervals(double minimumInS, double baseInS, double maximumInS)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_baseIntervalInS = (baseInS > 0) ? baseInS : 1.0;
+    m_minimumIntervalInS = (minimumInS > 0) ? std::min(minimumInS, m_baseIntervalInS) : m_baseIntervalInS;
+    m_maximumIntervalInS = std::max(maximumInS, m_baseIntervalInS);
+}
+
+void RecorderStatusPoller::setOverflowChecking(bool enable)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_isCheckingOverflows = enable;
+}
+
+void RecorderStatusPoller::addSession(uint32_t id, bool isRecording, uint64_t maxSizeInBytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        SessionStatus session;
+        session.id = id;
+        session.isRecording = isRecording;
+        m_sessions[id] = session;
+
+        Schedule schedule;
+        schedule.maxSizeInBytes = maxSizeInBytes;
+        schedule.nextPollInS = 0;
+        m_schedules[id] = schedule;
+    }
+    m_wakeUp.notify_all();
+}
+
+void RecorderStatusPoller::removeSession(uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sessions.erase(id);
+    m_schedules.erase(id);
+}
+
+void RecorderStatusPoller::clearSessions()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sessions.clear();
+    m_schedules.clear();
+}
+
+int RecorderStatusPoller::subscribe(Subscriber subscriber)
+{
+    std::lock_guard<std::mutex> publishLock(m_publishMutex);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_subscribers[m_nextHandle] = subscriber;
+    return m_nextHandle++;
+}
+
+void RecorderStatusPoller::unsubscribe(int handle)
+{
+    std::lock_guard<std::mutex> publishLock(m_publishMutex);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_subscribers.erase(handle);
+}
+
+void RecorderStatusPoller::start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_isRunning) {
+        return;
+    }
+    m_isRunning = true;
+    m_thread = std::thread(&RecorderStatusPoller::schedule, this);
+}
+
+void RecorderStatusPoller::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isRunning = false;
+    }
+    m_wakeUp.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    // A queued poll refers to this object
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_wakeUp.wait(lock, [this]() { return !m_isPollQueued; });
+}
+
+void RecorderStatusPoller::pollNow()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isPollRequested = true;
+    }
+    m_wakeUp.notify_all();
+}
+
+RecorderStatusPoller::Snapshot RecorderStatusPoller::getLatest()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_latest;
+}
+
+RecorderStatusPoller::Load RecorderStatusPoller::getLoad()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_load;
+}
+
+void RecorderStatusPoller::schedule()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_isRunning) {
+        double nowInS = getTimeInS();
+        double nextPollInS = nowInS + m_maximumIntervalInS;
+        std::map<uint32_t, Schedule>::const_iterator it;
+        for (it = m_schedules.begin(); it != m_schedules.end(); ++it) {
+            nextPollInS = std::min(nextPollInS, it->second.nextPollInS);
+        }
+
+        if (!m_isPollQueued && (nextPollInS <= nowInS || m_isPollRequested)) {
+            bool pollAll = m_isPollRequested;
+            m_isPollQueued = true;
+            m_isPollRequested = false;
+            m_recorder->post([this, pollAll](GEC_ISfpdpRecorder *recorder) { poll(recorder, pollAll); });
+        }
+
+        // Also woken when a poll completes, a session is added, or a poll is requested
+        double waitInS = m_isPollQueued ? m_maximumIntervalInS : std::max(nextPollInS - nowInS, 0.0);
+        m_wakeUp.wait_for(lock, std::chrono::duration<double>(waitInS));
+    }
+}
+
+double RecorderStatusPoller::getInterval(const SessionStatus &previous, const SessionStatus &sample,
+                                         uint64_t maxSizeInBytes) const
+{
+    if (sample.rc != GE_OK) {
+        return m_baseIntervalInS;
+    }
+    if (sample.state == "Ready" || sample.state == "Stopped" || sample.state == "Maxed out"
+        || sample.state == "All data transmitted") {
+        return m_maximumIntervalInS;
+    }
+
+    double interval = m_baseIntervalInS;
+    bool isFirst = (previous.timeInS == 0);
+    bool stateChanged = (previous.state != sample.state);
+    bool rateChanged = std::fabs(sample.bytesPerSecond - sample.smoothedBytesPerSecond)
+        > rateChangeFraction * sample.smoothedBytesPerSecond;
+    if (isFirst || stateChanged || rateChanged || sample.state == "End of file") {
+        interval = m_minimumIntervalInS;
+    }
+
+    // Polled when the maximum size should be reached, to see 'Maxed out' in time
+    if (maxSizeInBytes != 0 && sample.numBytes < maxSizeInBytes && sample.smoothedBytesPerSecond > 0) {
+        double secondsToMaxSize = (maxSizeInBytes - sample.numBytes) / sample.smoothedBytesPerSecond;
+        interval = std::max(std::min(interval, secondsToMaxSize), m_minimumIntervalInS);
+    }
+    return interval;
+}
+
+void RecorderStatusPoller::poll(GEC_ISfpdpRecorder *recorder, bool pollAll)
+{
+    std::vector<SessionStatus> samples;
+    std::vector<uint64_t> maxSizes;
+    bool isCheckingOverflows = true;
+    {
+        // Sessions due within half the shortest interval are polled now too
+        std::lock_guard<std::mutex> lock(m_mutex);
+        isCheckingOverflows = m_isCheckingOverflows;
+        double dueInS = getTimeInS() + m_minimumIntervalInS / 2;
+        std::map<uint32_t, SessionStatus>::const_iterator it;
+        for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+            const Schedule &schedule = m_schedules[it->first];
+            if (pollAll || schedule.nextPollInS <= dueInS) {
+                samples.push_back(it->second);
+                maxSizes.push_back(schedule.maxSizeInBytes);
+            }
+        }
+    }
+
+    uint64_t numCalls = 0;
+    double numFixedRateCalls = 0;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        SessionStatus &sample = samples[i];
+        SessionStatus previous = sample;
+        sample.overflowDetected = false;
+        if (recorder == NULL) {
+            sample.rc = GE_COMMFAIL;
+            sample.intervalInS = m_baseIntervalInS;
+            continue;
+        }
+
+        uint64_t numBytes = 0;
+        std::string state;
+        sample.rc = recorder->getStatus(sample.id, numBytes, state);
+        double timeInS = getTimeInS();
+        ++numCalls;
+
+        // A fixed-rate poller would have made one round of calls per base interval since the last poll
+        uint64_t callsPerPoll = (sample.isRecording && isCheckingOverflows) ? 2 : 1;
+        numFixedRateCalls += (previous.timeInS == 0) ? callsPerPoll
+            : callsPerPoll * (timeInS - previous.timeInS) / m_baseIntervalInS;
+
+        if (sample.rc != GE_OK) {
+            sample.intervalInS = getInterval(previous, sample, maxSizes[i]);
+            continue;
+        }
+
+        if (sample.timeInS > 0 && timeInS > sample.timeInS && numBytes >= sample.numBytes) {
+            double elapsedInS = timeInS - sample.timeInS;
+            double alpha = 1.0 - std::exp(-elapsedInS / m_smoothingTimeInS);
+            sample.bytesPerSecond = (numBytes - sample.numBytes) / elapsedInS;
+            if (sample.smoothedBytesPerSecond == 0) {
+                sample.smoothedBytesPerSecond = sample.bytesPerSecond;   // The first rate starts the average
+            } else {
+                sample.smoothedBytesPerSecond += alpha * (sample.bytesPerSecond - sample.smoothedBytesPerSecond);
+            }
+        } else {
+            // First sample, or the session was recorded again from the start
+            sample.bytesPerSecond = 0;
+            sample.smoothedBytesPerSecond = 0;
+        }
+        sample.numBytes = numBytes;
+        sample.state = state;
+        sample.timeInS = timeInS;
+
+        if (sample.isRecording && isCheckingOverflows) {
+            bool detected = false;
+            if (recorder->checkForOverflow(sample.id, detected, true) == GE_OK && detected) {
+                sample.overflowDetected = true;
+                ++sample.numOverflows;
+            }
+            ++numCalls;
+        }
+        sample.intervalInS = getInterval(previous, sample, maxSizes[i]);
+    }
+
+    std::unique_lock<std::mutex> publishLock(m_publishMutex);
+    Snapshot snapshot;
+    std::vector<Subscriber> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Sessions removed during the poll are left out
+        double nowInS = getTimeInS();
+        for (size_t i = 0; i < samples.size(); ++i) {
+            std::map<uint32_t, SessionStatus>::iterator itSession = m_sessions.find(samples[i].id);
+            if (itSession != m_sessions.end()) {
+                itSession->second = samples[i];
+                m_schedules[samples[i].id].nextPollInS = nowInS + samples[i].intervalInS;
+            }
+        }
+        // Sessions not polled this time are published with their last values, and no new overflow
+        std::map<uint32_t, SessionStatus>::iterator it;
+        for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+            snapshot.sessions.push_back(it->second);
+            it->second.overflowDetected = false;
+        }
+        m_load.numCalls += numCalls;
+        m_load.numFixedRateCalls += numFixedRateCalls;
+        snapshot.sequence = m_latest.sequence + 1;
+        snapshot.timeInS = nowInS;
+        m_latest = snapshot;
+
+        std::map<int, Subscriber>::const_iterator itSubscriber;
+        for (itSubscriber = m_subscribers.begin(); itSubscriber != m_subscribers.end(); ++itSubscriber) {
+            subscribers.push_back(itSubscriber->second);
+        }
+    }
+
+    for (size_t i = 0; i < subscribers.size(); ++i) {
+        subscribers[i](snapshot);
+    }
+    publishLock.unlock();
+
+    // Notified under the lock, as stop() may destroy the object as soon as it sees the flag
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_isPollQueued = false;
+    m_wakeUp.notify_all();
+}
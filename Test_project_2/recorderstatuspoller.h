@@ -0,0 +1,154 @@
+#ifndef RECORDERSTATUSPOLLER_H
+#define RECORDERSTATUSPOLLER_H
+
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class AsyncRecorder;
+class GEC_ISfpdpRecorder;
+
+/**
+  Polls the status of all sessions of one recorder, and publishes it to
+  any number of subscribers
+
+  Every poll is one request on the recorder's I/O thread that calls
+  getStatus(), and checkForOverflow() for recording sessions, for all
+  sessions one after the other, so any number of views cost one set of
+  round trips. A poll is skipped while the previous one is still queued
+  or running, so a slow recorder does not make requests pile up.
+
+  The byte rate of a session is derived from consecutive numBytes
+  values: the rate over the last interval, and an exponential moving
+  average of it whose time constant does not depend on the interval.
+
+  Each session has its own poll interval, chosen from its last state
+  and rate. Sessions that cannot change by themselves ('Ready',
+  'Stopped', 'Maxed out', 'All data transmitted') are polled at the
+  longest interval. Active sessions are polled at the base interval, and
+  at the shortest one after a change of state or rate, when playback has
+  reached the end of file, or when the maximum size is about to be
+  reached. Sessions that are due together are polled together.
+
+  Subscribers are called on the I/O thread, one after the other, with
+  the same snapshot, and must not subscribe or unsubscribe themselves.
+  The overflow state is cleared by every poll, so overflows are counted
+  rather than latched.
+
+  The poller must be destroyed before its AsyncRecorder; stop() waits
+  for a poll that is already queued.
+*/
+class RecorderStatusPoller
+{
+public:
+    struct SessionStatus
+    {
+        SessionStatus()
+            : id(0), rc(0), numBytes(0), isRecording(true), overflowDetected(false), numOverflows(0)
+            , bytesPerSecond(0), smoothedBytesPerSecond(0), timeInS(0), intervalInS(0) {}
+
+        uint32_t id;
+        int rc;                          // Of getStatus()
+        std::string state;
+        uint64_t numBytes;
+        bool isRecording;
+        bool overflowDetected;           // Since the previous poll
+        uint64_t numOverflows;           // Polls that detected an overflow
+        double bytesPerSecond;           // Over the last interval
+        double smoothedBytesPerSecond;
+        double timeInS;                  // Monotonic time of the sample
+        double intervalInS;              // Until the next poll
+    };
+
+    struct Snapshot
+    {
+        Snapshot() : sequence(0), timeInS(0) {}
+
+        uint64_t sequence;
+        double timeInS;
+        std::vector<SessionStatus> sessions;   // Ordered by id
+    };
+
+    struct Load
+    {
+        uint64_t numCalls;               // getStatus() and checkForOverflow() calls made
+        double numFixedRateCalls;        // Calls that polling every session at the base interval would have made
+    };
+
+    typedef std::function<void(const Snapshot &snapshot)> Subscriber;
+
+    /** Polls at @p intervalInS, between a quarter of it and ten times it */
+    RecorderStatusPoller(AsyncRecorder *recorder, double intervalInS = 1.0, double smoothingTimeInS = 10.0);
+    ~RecorderStatusPoller();
+
+    /** Sets the shortest, base, and longest poll interval; equal values poll at a fixed rate */
+    void setIntervals(double minimumInS, double baseInS, double maximumInS);
+    /** Whether polls call checkForOverflow(); off when an OverflowWatchdog clears the overflow state instead */
+    void setOverflowChecking(bool enable);
+
+    /**
+      @param maxSizeInBytes
+      The value given to setMaxSize() for a recording session, or 0. Lets
+      the session be polled right when it is about to be 'Maxed out'.
+    */
+    void addSession(uint32_t id, bool isRecording = true, uint64_t maxSizeInBytes = 0);
+    void removeSession(uint32_t id);
+    void clearSessions();
+
+    /** @return A handle for unsubscribe(), after which the subscriber is no longer called */
+    int subscribe(Subscriber subscriber);
+    void unsubscribe(int handle);
+
+    void start();
+    void stop();
+    /** Polls as soon as possible, without waiting for the interval */
+    void pollNow();
+
+    Snapshot getLatest();
+    Load getLoad();
+
+    static double getTimeInS();
+
+private:
+    RecorderStatusPoller(const RecorderStatusPoller &);
+    RecorderStatusPoller &operator=(const RecorderStatusPoller &);
+
+    struct Schedule
+    {
+        uint64_t maxSizeInBytes;
+        double nextPollInS;
+    };
+
+    void schedule();
+    void poll(GEC_ISfpdpRecorder *recorder, bool pollAll);
+    double getInterval(const SessionStatus &previous, const SessionStatus &sample, uint64_t maxSizeInBytes) const;
+
+    AsyncRecorder *m_recorder;
+    double m_minimumIntervalInS;
+    double m_baseIntervalInS;
+    double m_maximumIntervalInS;
+    double m_smoothingTimeInS;
+    bool m_isCheckingOverflows;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::map<uint32_t, SessionStatus> m_sessions;
+    std::map<uint32_t, Schedule> m_schedules;
+    std::map<int, Subscriber> m_subscribers;
+    int m_nextHandle;
+    Snapshot m_latest;
+    bool m_isRunning;
+    bool m_isPollQueued;
+    bool m_isPollRequested;
+    std::thread m_thread;
+
+    std::mutex m_publishMutex;           // Keeps subscribers from being removed while called
+    Load m_load;
+};
+
+#endif // RECORDERSTATUSPOLLER_H
@@ -0,0 +1,133 @@
+#include "recordingdatareader.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include <algorithm>
+
+#include "GEC_RecordingFormat.h"
+#include "inc/GE_Defines.h"
+
+RecordingDataReader::RecordingDataReader()
+    : m_numWords(0)
+{
+}
+
+int RecordingDataReader::open(const std::string &path)
+{
+    m_numWords = 0;
+    int rc = m_file.open(path);
+    if (rc == GE_OK) {
+        m_numWords = m_file.getSize() / GEC_RECORDING_WORD_SIZE;
+    }
+    return rc;
+}
+
+void RecordingDataReader::close()
+{
+    m_file.close();
+    m_numWords = 0;
+}
+
+int RecordingDataReader::getSpan(uint64_t firstWord, uint64_t numWords, Span &span)
+{
+    span = Span();
+    if (firstWord >= m_numWords) {
+        return GE_INVALID_PARAMETER;
+    }
+    if (numWords > m_numWords - firstWord) {
+        numWords = m_numWords - firstWord;
+    }
+    uint64_t numMapped = 0;
+    const uint8_t *bytes = m_file.map(firstWord * GEC_RECORDING_WORD_SIZE, numWords * GEC_RECORDING_WORD_SIZE,
+                                      numMapped);
+    if (bytes == NULL) {
+        return GE_ERROR;
+    }
+    // Windows start at page boundaries, so the words are aligned
+    span.words = reinterpret_cast<const uint32_t *>(bytes);
+    span.firstWord = firstWord;
+    span.numWords = std::min(numWords, numMapped / GEC_RECORDING_WORD_SIZE);
+    return GE_OK;
+}
+
+uint32_t RecordingDataReader::getWord(uint64_t offset)
+{
+    Span span;
+    return (getSpan(offset, 1, span) == GE_OK) ? span.words[0] : 0;
+}
+
+int RecordingDataReader::write(uint64_t firstWord, uint64_t numWords, FILE *file)
+{
+    if (firstWord > m_numWords || numWords > m_numWords - firstWord) {
+        return GE_INVALID_PARAMETER;
+    }
+    uint64_t end = firstWord + numWords;
+    while (firstWord < end) {
+        Span span;
+        int rc = getSpan(firstWord, end - firstWord, span);
+        if (rc != GE_OK) {
+            return rc;
+        }
+        size_t count = static_cast<size_t>(span.numWords);
+        if (fwrite(span.words, GEC_RECORDING_WORD_SIZE, count, file) != count) {
+            return GE_ERROR;
+        }
+        firstWord += span.numWords;
+    }
+    return GE_OK;
+}
+
+std::string RecordingDataReader::replaceExtension(const std::string &path, const char *extension)
+{
+    size_t dot = path.rfind('.');
+    size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return path + extension;
+    }
+    return path.substr(0, dot) + extension;
+}
+
+#ifdef _WIN32
+static bool getFileId(const std::string &path, BY_HANDLE_FILE_INFORMATION &info)
+{
+    HANDLE file = CreateFileA(path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                              OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    BOOL isValid = GetFileInformationByHandle(file, &info);
+    CloseHandle(file);
+    return isValid != FALSE;
+}
+#endif
+
+bool RecordingDataReader::isSameFile(const std::string &path1, const std::string &path2)
+{
+#ifdef _WIN32
+    BY_HANDLE_FILE_INFORMATION info1;
+    BY_HANDLE_FILE_INFORMATION info2;
+    return getFileId(path1, info1) && getFileId(path2, info2)
+           && info1.dwVolumeSerialNumber == info2.dwVolumeSerialNumber
+           && info1.nFileIndexHigh == info2.nFileIndexHigh && info1.nFileIndexLow == info2.nFileIndexLow;
+#else
+    struct stat stat1;
+    struct stat stat2;
+    return stat(path1.c_str(), &stat1) == 0 && stat(path2.c_str(), &stat2) == 0 && stat1.st_dev == stat2.st_dev
+           && stat1.st_ino == stat2.st_ino;
+#endif
+}
+
+int RecordingDataReader::replaceFile(const std::string &tempPath, const std::string &path)
+{
+#ifdef _WIN32
+    // rename() does not replace an existing file on Windows
+    BOOL isMoved = MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+    return (isMoved != FALSE) ? GE_OK : GE_ERROR;
+#else
+    return (rename(tempPath.c_str(), path.c_str()) == 0) ? GE_OK : GE_ERROR;
+#endif
+}
@@ -0,0 +1,93 @@
+#ifndef RECORDINGDATAREADER_H
+#define RECORDINGDATAREADER_H
+
+#include <stdint.h>
+#include <cstdio>
+#include <string>
+
+#include "mappedfile.h"
+
+/**
+  Random access to the 32-bit words of a recorded .dat file, without
+  copying them
+
+  The file is memory mapped by a MappedFile, and getSpan() returns a
+  pointer to the words in the mapping itself. Any word offset is
+  reached by moving the mapping window, so a file larger than the
+  address space is read the same way as a small one. Words are as the
+  recorder stored them, little endian; bytes after the last whole word
+  are ignored.
+
+  A span stays valid until the next getSpan() or getWord() that moves
+  the window, or close(). The reader is not thread-safe; threads that
+  read the same file each open a reader of their own.
+*/
+class RecordingDataReader
+{
+public:
+    struct Span
+    {
+        Span() : words(NULL), firstWord(0), numWords(0) {}
+
+        const uint32_t *words;
+        uint64_t firstWord;              // Word offset of words[0] in the file
+        uint64_t numWords;
+    };
+
+    RecordingDataReader();
+
+    /** @return GE_OK, GE_NOT_EXISTING, GE_NO_ACCESS, or GE_ERROR */
+    int open(const std::string &path);
+    void close();
+
+    uint64_t getNumWords() const { return m_numWords; }
+
+    /**
+      Maps the words from @p firstWord on
+
+      @p span holds @p numWords words, fewer at the end of the file or if
+      they do not fit into the window; read the rest with another call.
+      @return GE_OK, or GE_INVALID_PARAMETER if @p firstWord is at or
+      past the end, or GE_ERROR if the window could not be mapped
+    */
+    int getSpan(uint64_t firstWord, uint64_t numWords, Span &span);
+    /** @return The word at @p offset, or 0 past the end */
+    uint32_t getWord(uint64_t offset);
+
+    /**
+      Writes @p numWords words from @p firstWord on to @p file, straight
+      from the mapping
+
+      @return GE_OK, GE_INVALID_PARAMETER if the words are not all in the
+      file, or GE_ERROR if mapping or writing failed
+    */
+    int write(uint64_t firstWord, uint64_t numWords, FILE *file);
+
+    /** @p path with its extension replaced by @p extension, e.g. the .idx file of a .dat file */
+    static std::string replaceExtension(const std::string &path, const char *extension);
+    /**
+      Whether @p path1 and @p path2 are the same file, however they are
+      spelled: the device and inode, or on Windows the volume and file
+      index, are compared. False if either does not exist.
+    */
+    static bool isSameFile(const std::string &path1, const std::string &path2);
+    /**
+      Moves the file at @p tempPath over @p path, replacing it, to finish
+      a file written under a temporary name
+
+      @return GE_OK, or GE_ERROR if it could not be moved
+    */
+    static int replaceFile(const std::string &tempPath, const std::string &path);
+
+    /** The mapping, e.g. to set its access hint or window size */
+    MappedFile &getFile() { return m_file; }
+
+private:
+    RecordingDataReader(const RecordingDataReader &);
+    RecordingDataReader &operator=(const RecordingDataReader &);
+
+    MappedFile m_file;
+    uint64_t m_numWords;
+};
+
+#endif // RECORDINGDATAREADER_H
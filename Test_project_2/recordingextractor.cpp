@@ -0,0 +1,114 @@
+#include "recordingextractor.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "GEC_RecordingFormat.h"
+#include "inc/GE_Defines.h"
+
+RecordingExtractor::RecordingExtractor()
+{
+}
+
+int RecordingExtractor::open(const std::string &path)
+{
+    close();
+    std::string dataPath = RecordingDataReader::replaceExtension(path, GEC_RECORDING_DATA_EXTENSION);
+    int rc = m_reader.open(dataPath);
+    if (rc == GE_OK) {
+        rc = m_syncIndex.load(RecordingDataReader::replaceExtension(path, GEC_RECORDING_INDEX_EXTENSION));
+    }
+    if (rc == GE_OK) {
+        rc = m_timeIndex.load(RecordingDataReader::replaceExtension(path, GEC_RECORDING_META_EXTENSION));
+    }
+    if (rc != GE_OK) {
+        close();
+        return rc;
+    }
+    m_dataPath = dataPath;
+    return GE_OK;
+}
+
+void RecordingExtractor::close()
+{
+    m_reader.close();
+    m_syncIndex.clear();
+    m_timeIndex.clear();
+    m_dataPath.clear();
+}
+
+uint64_t RecordingExtractor::getDataSize() const
+{
+    return m_reader.getNumWords() * GEC_RECORDING_WORD_SIZE;
+}
+
+void RecordingExtractor::alignToSyncs(uint64_t &startOffset, uint64_t &endOffset) const
+{
+    uint64_t syncNumber = 0;
+    if (m_syncIndex.findSyncAt(startOffset, syncNumber)) {
+        m_syncIndex.findSync(syncNumber, startOffset);
+    }
+    if (endOffset > 0 && m_syncIndex.findSyncAt(endOffset - 1, syncNumber)
+        && !m_syncIndex.findSync(syncNumber + 1, endOffset)) {
+        endOffset = getDataSize();
+    }
+}
+
+int RecordingExtractor::extract(uint64_t startOffset, uint64_t endOffset, const std::string &path,
+                                Extract &extract)
+{
+    extract = Extract();
+    startOffset -= startOffset % GEC_RECORDING_WORD_SIZE;
+    endOffset = std::min(endOffset, getDataSize());
+    endOffset -= endOffset % GEC_RECORDING_WORD_SIZE;
+    if (m_dataPath.empty() || startOffset >= endOffset) {
+        return GE_INVALID_PARAMETER;
+    }
+    extract.startOffset = startOffset;
+    extract.endOffset = endOffset;
+
+    std::string dataPath = RecordingDataReader::replaceExtension(path, GEC_RECORDING_DATA_EXTENSION);
+    std::string indexPath = RecordingDataReader::replaceExtension(path, GEC_RECORDING_INDEX_EXTENSION);
+    std::string metaPath = RecordingDataReader::replaceExtension(path, GEC_RECORDING_META_EXTENSION);
+    // Writing over the source would truncate the mapping being read; "./a.dat" or a link is the same file as "a.dat"
+    const char *extensions[] = {GEC_RECORDING_DATA_EXTENSION, GEC_RECORDING_INDEX_EXTENSION,
+                                GEC_RECORDING_META_EXTENSION};
+    const std::string *outputPaths[] = {&dataPath, &indexPath, &metaPath};
+    for (size_t i = 0; i < sizeof(extensions) / sizeof(extensions[0]); ++i) {
+        std::string sourcePath = RecordingDataReader::replaceExtension(m_dataPath, extensions[i]);
+        for (size_t j = 0; j < sizeof(outputPaths) / sizeof(outputPaths[0]); ++j) {
+            if (RecordingDataReader::isSameFile(*outputPaths[j], sourcePath)) {
+                return GE_INVALID_PARAMETER;
+            }
+        }
+    }
+    FILE *dataFile = fopen(dataPath.c_str(), "wb");
+    FILE *indexFile = fopen(indexPath.c_str(), "wb");
+    FILE *metaFile = fopen(metaPath.c_str(), "wb");
+    int rc = (dataFile != NULL && indexFile != NULL && metaFile != NULL) ? GE_OK : GE_NO_ACCESS;
+
+    if (rc == GE_OK) {
+        uint64_t firstWord = startOffset / GEC_RECORDING_WORD_SIZE;
+        rc = m_reader.write(firstWord, endOffset / GEC_RECORDING_WORD_SIZE - firstWord, dataFile);
+    }
+    if (rc == GE_OK) {
+        rc = m_syncIndex.write(startOffset, endOffset, indexFile, extract.numIndexEntries);
+    }
+    if (rc == GE_OK) {
+        rc = m_timeIndex.write(startOffset, endOffset, metaFile, extract.numMetaRecords);
+    }
+
+    FILE *files[] = {dataFile, indexFile, metaFile};
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i) {
+        if (files[i] != NULL && fclose(files[i]) != 0 && rc == GE_OK) {
+            rc = GE_ERROR;
+        }
+    }
+    // A partial recording is not left behind to be mistaken for a good one
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]) && rc != GE_OK; ++i) {
+        if (files[i] != NULL) {
+            remove(outputPaths[i]->c_str());
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,82 @@
+#ifndef RECORDINGEXTRACTOR_H
+#define RECORDINGEXTRACTOR_H
+
+#include <stdint.h>
+#include <string>
+
+#include "recordingdatareader.h"
+#include "syncindex.h"
+#include "timeindex.h"
+
+/**
+  Cuts a byte range out of a recording as a recording of its own
+
+  open() maps the .dat file and loads the .idx and .meta files of a
+  recording. extract() writes the bytes of the range, straight from the
+  mapping, to a new .dat file, together with an .idx file of the SYNC
+  and CRC error events in the range and a .meta file of its timing,
+  their offsets moved to the start of the range. The result can be
+  played back like any recording, with its original timing, and nothing
+  outside the range is read.
+
+  A range chosen by time, through getTimeIndex(), usually starts in the
+  middle of a frame; alignToSyncs() widens it to whole frames so the
+  extract starts with a SYNC.
+*/
+class RecordingExtractor
+{
+public:
+    struct Extract
+    {
+        Extract() : startOffset(0), endOffset(0), numIndexEntries(0), numMetaRecords(0) {}
+
+        uint64_t startOffset;                // Byte range in the source recording
+        uint64_t endOffset;
+        uint64_t numIndexEntries;
+        uint64_t numMetaRecords;
+    };
+
+    RecordingExtractor();
+
+    /**
+      Opens the recording that @p path, its .dat, .idx, or .meta file,
+      belongs to
+
+      @return GE_OK, or the error of the file that could not be read:
+      GE_NOT_EXISTING, GE_NO_ACCESS, or GE_ERROR
+    */
+    int open(const std::string &path);
+    void close();
+
+    /** Path of the source .dat file */
+    const std::string &getDataPath() const { return m_dataPath; }
+    uint64_t getDataSize() const;
+    const SyncIndex &getSyncIndex() const { return m_syncIndex; }
+    const TimeIndex &getTimeIndex() const { return m_timeIndex; }
+
+    /** Moves @p startOffset back and @p endOffset on to the nearest SYNCs, or the end of the data */
+    void alignToSyncs(uint64_t &startOffset, uint64_t &endOffset) const;
+
+    /**
+      Writes the bytes from @p startOffset to @p endOffset, rounded down
+      to whole words, as a recording with the .dat file @p path; the .idx
+      and .meta files get the same base name
+
+      @return GE_OK, GE_INVALID_PARAMETER if the range is empty or not in
+      the recording or any of the three files would be the source file,
+      by any path, GE_NO_ACCESS if a file could not be created, or
+      GE_ERROR if writing failed
+    */
+    int extract(uint64_t startOffset, uint64_t endOffset, const std::string &path, Extract &extract);
+
+private:
+    RecordingExtractor(const RecordingExtractor &);
+    RecordingExtractor &operator=(const RecordingExtractor &);
+
+    std::string m_dataPath;
+    RecordingDataReader m_reader;
+    SyncIndex m_syncIndex;
+    TimeIndex m_timeIndex;
+};
+
+#endif // RECORDINGEXTRACTOR_H
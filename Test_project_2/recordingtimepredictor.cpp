@@ -0,0 +1,234 @@
+#include "recordingtimepredictor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+
+// A warning is rearmed once the remaining time is this much above its threshold again
+static const double rearmFactor = 1.1;
+
+RecordingTimePredictor::RecordingTimePredictor(double smoothingTimeInS)
+    : m_smoothingTimeInS(smoothingTimeInS > 0 ? smoothingTimeInS : 1.0)
+{
+}
+
+void RecordingTimePredictor::setThresholds(std::vector<double> thresholdsInS)
+{
+    std::sort(thresholdsInS.begin(), thresholdsInS.end(), std::greater<double>());
+    m_thresholdsInS = thresholdsInS;
+}
+
+void RecordingTimePredictor::addSession(uint32_t id, const std::string &filesystem, uint64_t maxSizeInBytes)
+{
+    Session session;
+    session.filesystem = filesystem;
+    session.maxSizeInBytes = maxSizeInBytes;
+    session.numBytes = 0;
+    session.numBytesAtFreeSpaceUpdate = 0;
+    session.lastTimeInS = 0;
+    session.bytesPerSecond = 0;
+    session.hasSample = false;
+    session.isActive = false;
+    session.numWarned = 0;
+    m_sessions[id] = session;
+    m_filesystems[filesystem];
+}
+
+void RecordingTimePredictor::removeSession(uint32_t id)
+{
+    m_sessions.erase(id);
+}
+
+void RecordingTimePredictor::updateSession(uint32_t id, uint64_t numBytes, const std::string &state, double timeInS)
+{
+    std::map<uint32_t, Session>::iterator it = m_sessions.find(id);
+    if (it == m_sessions.end()) {
+        return;
+    }
+
+    Session &session = it->second;
+    session.isActive = (state == "Recording" || state == "Idle");
+
+    if (!session.hasSample) {
+        session.numBytesAtFreeSpaceUpdate = numBytes;
+        session.hasSample = true;
+    } else if (timeInS > session.lastTimeInS && numBytes >= session.numBytes) {
+        // Weighting by elapsed time keeps the time constant independent of the poll interval
+        double elapsedInS = timeInS - session.lastTimeInS;
+        double rate = (numBytes - session.numBytes) / elapsedInS;
+        double alpha = 1.0 - std::exp(-elapsedInS / m_smoothingTimeInS);
+        session.bytesPerSecond += alpha * (rate - session.bytesPerSecond);
+    }
+    if (!session.isActive) {
+        session.bytesPerSecond = 0;
+    }
+    if (numBytes < session.numBytesAtFreeSpaceUpdate) {
+        session.numBytesAtFreeSpaceUpdate = numBytes;   // Recording restarted
+    }
+
+    session.numBytes = numBytes;
+    session.lastTimeInS = timeInS;
+
+    checkThresholds(session.filesystem);
+}
+
+std::string RecordingTimePredictor::getFilesystemKey(const std::string &host, const GEC_Capacity &capacity)
+{
+    if (capacity.fsid == 0) {
+        return host + ":" + capacity.path;
+    }
+    char fsid[32];
+    snprintf(fsid, sizeof(fsid), "%llx", static_cast<unsigned long long>(capacity.fsid));
+    return host + " fsid " + fsid;
+}
+
+void RecordingTimePredictor::updateFreeSpace(const std::string &filesystem, uint64_t availableBytes,
+                                             const std::string &name)
+{
+    Filesystem &entry = m_filesystems[filesystem];
+    if (entry.name.empty()) {
+        entry.name = name;
+    }
+    entry.availableBytes = availableBytes;
+    entry.hasFreeSpace = true;
+
+    std::map<uint32_t, Session>::iterator it;
+    for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        if (it->second.filesystem == filesystem) {
+            it->second.numBytesAtFreeSpaceUpdate = it->second.numBytes;
+        }
+    }
+
+    checkThresholds(filesystem);
+}
+
+void RecordingTimePredictor::updateFreeSpace(const std::vector<GEC_Capacity> &capacities)
+{
+    for (size_t i = 0; i < capacities.size(); ++i) {
+        if (capacities[i].rc == GEC_CAPACITY_OK) {
+            updateFreeSpace(getFilesystemKey(capacities[i].host, capacities[i]), capacities[i].availableBytes,
+                            capacities[i].host + ":" + capacities[i].path);
+        }
+    }
+}
+
+double RecordingTimePredictor::getFilesystemRate(const std::string &filesystem) const
+{
+    double bytesPerSecond = 0;
+    std::map<uint32_t, Session>::const_iterator it;
+    for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        if (it->second.filesystem == filesystem) {
+            bytesPerSecond += it->second.bytesPerSecond;
+        }
+    }
+    return bytesPerSecond;
+}
+
+uint64_t RecordingTimePredictor::getAvailableBytes(const std::string &filesystem) const
+{
+    std::map<std::string, Filesystem>::const_iterator itFs = m_filesystems.find(filesystem);
+    if (itFs == m_filesystems.end()) {
+        return 0;
+    }
+
+    uint64_t writtenSinceUpdate = 0;
+    std::map<uint32_t, Session>::const_iterator it;
+    for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        if (it->second.filesystem == filesystem) {
+            writtenSinceUpdate += it->second.numBytes - it->second.numBytesAtFreeSpaceUpdate;
+        }
+    }
+    uint64_t available = itFs->second.availableBytes;
+    return (writtenSinceUpdate < available) ? available - writtenSinceUpdate : 0;
+}
+
+RecordingTimePredictor::Estimate RecordingTimePredictor::getFilesystemEstimate(const std::string &filesystem) const
+{
+    Estimate estimate;
+    std::map<std::string, Filesystem>::const_iterator it = m_filesystems.find(filesystem);
+    if (it == m_filesystems.end() || !it->second.hasFreeSpace) {
+        return estimate;
+    }
+
+    estimate.bytesPerSecond = getFilesystemRate(filesystem);
+    if (estimate.bytesPerSecond > 0) {
+        estimate.secondsToFull = getAvailableBytes(filesystem) / estimate.bytesPerSecond;
+    }
+    return estimate;
+}
+
+RecordingTimePredictor::Estimate RecordingTimePredictor::getSessionEstimate(uint32_t id) const
+{
+    Estimate estimate;
+    std::map<uint32_t, Session>::const_iterator it = m_sessions.find(id);
+    if (it == m_sessions.end()) {
+        return estimate;
+    }
+
+    const Session &session = it->second;
+    estimate = getFilesystemEstimate(session.filesystem);
+    estimate.bytesPerSecond = session.bytesPerSecond;
+    if (session.maxSizeInBytes != 0 && session.bytesPerSecond > 0) {
+        uint64_t remaining = (session.numBytes < session.maxSizeInBytes) ? session.maxSizeInBytes - session.numBytes : 0;
+        double secondsToMaxSize = remaining / session.bytesPerSecond;
+        if (estimate.secondsToFull < 0 || secondsToMaxSize < estimate.secondsToFull) {
+            estimate.secondsToFull = secondsToMaxSize;
+            estimate.isLimitedByMaxSize = true;
+        }
+    }
+    if (session.bytesPerSecond <= 0) {
+        estimate.secondsToFull = -1;
+    }
+    return estimate;
+}
+
+void RecordingTimePredictor::checkThreshold(size_t &numWarned, double secondsToFull, Warning &warning)
+{
+    size_t numBelow = 0;
+    if (secondsToFull >= 0) {
+        while (numBelow < m_thresholdsInS.size() && secondsToFull < m_thresholdsInS[numBelow]) {
+            ++numBelow;
+        }
+    }
+
+    if (numBelow > numWarned) {
+        numWarned = numBelow;
+        warning.thresholdInS = m_thresholdsInS[numBelow - 1];
+        warning.secondsToFull = secondsToFull;
+        if (m_warningCallback) {
+            m_warningCallback(warning);
+        }
+        return;
+    }
+
+    while (numWarned > 0 && (secondsToFull < 0 || secondsToFull > rearmFactor * m_thresholdsInS[numWarned - 1])) {
+        --numWarned;
+    }
+}
+
+void RecordingTimePredictor::checkThresholds(const std::string &filesystem)
+{
+    if (m_thresholdsInS.empty()) {
+        return;
+    }
+
+    Warning warning;
+    warning.isFilesystem = true;
+    const std::string &name = m_filesystems[filesystem].name;
+    warning.filesystem = name.empty() ? filesystem : name;
+    warning.id = 0;
+    checkThreshold(m_filesystems[filesystem].numWarned, getFilesystemEstimate(filesystem).secondsToFull, warning);
+
+    // Sessions limited by the file system are covered by its warning
+    std::map<uint32_t, Session>::iterator it;
+    for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        if (it->second.filesystem != filesystem) {
+            continue;
+        }
+        Estimate estimate = getSessionEstimate(it->first);
+        warning.isFilesystem = false;
+        warning.id = it->first;
+        checkThreshold(it->second.numWarned, estimate.isLimitedByMaxSize ? estimate.secondsToFull : -1, warning);
+    }
+}
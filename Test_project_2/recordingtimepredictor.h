@@ -0,0 +1,132 @@
+#ifndef RECORDINGTIMEPREDICTOR_H
+#define RECORDINGTIMEPREDICTOR_H
+
+#include <stdint.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "GEC_CapacityQuery.h"
+
+/**
+  Predicts how long recording can go on before the disk, or the
+  setMaxSize() budget of a session, is full
+
+  The byte rate of every session is derived from consecutive numBytes
+  values returned by GEC_ISfpdpRecorder::getStatus(), and smoothed with
+  an exponential moving average whose time constant does not depend on
+  the sampling interval. Free space comes from statvfs (see
+  GEC_CapacityQuery) and is expensive to query, so between two queries
+  it is reduced by the bytes the sessions on that file system have
+  recorded since.
+
+  All sessions on one file system fill it together, so they all share
+  the remaining time of that file system, unless their own maximum size
+  is reached first. File systems are told apart by the fsid statvfs
+  returns, as MaxSizeBudgeter does, so "/data" and "/" of one host are
+  the same file system when they are on one disk.
+
+  A warning is raised once whenever a remaining time falls below one of
+  the configured thresholds, and rearmed when it rises above the
+  threshold again. The class is not thread-safe; it is meant to be fed
+  from one thread, e.g. the status poller.
+*/
+class RecordingTimePredictor
+{
+public:
+    struct Estimate
+    {
+        Estimate() : bytesPerSecond(0), secondsToFull(-1), isLimitedByMaxSize(false) {}
+
+        double bytesPerSecond;     // Smoothed recording rate
+        double secondsToFull;      // -1 while nothing is being recorded
+        bool isLimitedByMaxSize;   // true if the session's maximum size is reached before the disk is full
+    };
+
+    struct Warning
+    {
+        bool isFilesystem;         // false for a session
+        std::string filesystem;    // "<host>:<path>" of the first path the free space was known for
+        uint32_t id;               // Session id, when isFilesystem is false
+        double thresholdInS;
+        double secondsToFull;
+    };
+
+    typedef std::function<void(const Warning &warning)> WarningCallback;
+
+    explicit RecordingTimePredictor(double smoothingTimeInS = 30.0);
+
+    /** Sets the remaining times that raise a warning, e.g. 1 hour, 10 minutes, and 1 minute */
+    void setThresholds(std::vector<double> thresholdsInS);
+    void setWarningCallback(WarningCallback callback) { m_warningCallback = callback; }
+
+    /**
+      Adds a session recording to a file system
+
+      @param filesystem
+      Key of the file system, from getFilesystemKey()
+      @param maxSizeInBytes
+      The value given to setMaxSize() for the session, or 0 if it has none
+    */
+    void addSession(uint32_t id, const std::string &filesystem, uint64_t maxSizeInBytes = 0);
+    void removeSession(uint32_t id);
+
+    /** Feeds one getStatus() result; @p timeInS is monotonic time */
+    void updateSession(uint32_t id, uint64_t numBytes, const std::string &state, double timeInS);
+
+    /**
+      Feeds the free space of one file system, available to unprivileged
+      users; @p name is shown in its warnings
+    */
+    void updateFreeSpace(const std::string &filesystem, uint64_t availableBytes, const std::string &name);
+    void updateFreeSpace(const std::vector<GEC_Capacity> &capacities);
+
+    Estimate getSessionEstimate(uint32_t id) const;
+    Estimate getFilesystemEstimate(const std::string &filesystem) const;
+
+    /**
+      Key of the file system that @p capacity was queried on, of the
+      recorder @p host, which may differ from the host of the query for
+      a simulated recorder. Paths without an fsid are keyed by the path.
+    */
+    static std::string getFilesystemKey(const std::string &host, const GEC_Capacity &capacity);
+
+private:
+    struct Session
+    {
+        std::string filesystem;
+        uint64_t maxSizeInBytes;
+        uint64_t numBytes;
+        uint64_t numBytesAtFreeSpaceUpdate;
+        double lastTimeInS;
+        double bytesPerSecond;
+        bool hasSample;
+        bool isActive;
+        size_t numWarned;          // Number of thresholds already warned about
+    };
+
+    struct Filesystem
+    {
+        Filesystem() : availableBytes(0), hasFreeSpace(false), numWarned(0) {}
+
+        std::string name;
+        uint64_t availableBytes;
+        bool hasFreeSpace;
+        size_t numWarned;
+    };
+
+    double getFilesystemRate(const std::string &filesystem) const;
+    uint64_t getAvailableBytes(const std::string &filesystem) const;
+    void checkThresholds(const std::string &filesystem);
+    void checkThreshold(size_t &numWarned, double secondsToFull, Warning &warning);
+
+    double m_smoothingTimeInS;
+    std::vector<double> m_thresholdsInS;   // Descending
+    WarningCallback m_warningCallback;
+
+    std::map<uint32_t, Session> m_sessions;
+    std::map<std::string, Filesystem> m_filesystems;
+};
+
+#endif // RECORDINGTIMEPREDICTOR_H
@@ -0,0 +1,249 @@
+#include "sessionprofiles.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "inc/GE_Defines.h"
+#include "GEC_SfpdpLinkRate.h"
+
+SessionProfile::SessionProfile()
+    : isPlayback(false)
+    , playbackMode(GEC_SFPDP_PLAYBACK_WITHOUT_SIGNALS)
+    , crc(false)
+    , copyMode(false)
+    , waitForSync(GEC_SFPDP_WAIT_FOR_ANY_SYNC)
+    , maxSizeInBytes(0)
+    , linkSpeed(-1)
+    , flowControl(true)
+    , cycleSize(GEC_SFPDP_16M_WORDS_CYCLE)
+    , cyclePartsForTx(64)
+    , simplexLink(false)
+    , syncSource(GEC_SFPDP_INTERNAL_CHANNEL_SYNC_MASTER_0)
+    , swap8in16(false)
+    , swap16in32(false)
+{
+}
+
+static std::string trim(const std::string &text)
+{
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) {
+        return std::string();
+    }
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+static bool parseBool(const std::string &value, bool &result)
+{
+    if (value == "on" || value == "true" || value == "yes" || value == "1") {
+        result = true;
+    } else if (value == "off" || value == "false" || value == "no" || value == "0") {
+        result = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/** A number with an optional K, M, G, or T suffix, as a power of 1024 */
+static bool parseSize(const std::string &value, uint64_t &result)
+{
+    char *end = NULL;
+    double number = strtod(value.c_str(), &end);
+    if (end == value.c_str() || number < 0) {
+        return false;
+    }
+    std::string suffix = trim(end);
+    double multiplier = 1;
+    if (suffix == "K") {
+        multiplier = 1024.0;
+    } else if (suffix == "M") {
+        multiplier = 1024.0 * 1024;
+    } else if (suffix == "G") {
+        multiplier = 1024.0 * 1024 * 1024;
+    } else if (suffix == "T") {
+        multiplier = 1024.0 * 1024 * 1024 * 1024;
+    } else if (!suffix.empty()) {
+        return false;
+    }
+    result = static_cast<uint64_t>(number * multiplier);
+    return true;
+}
+
+int SessionProfiles::load(const std::string &path)
+{
+    std::ifstream file(path.c_str());
+    if (!file) {
+        m_error = "cannot read " + path;
+        return GE_NOT_EXISTING;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    return parse(text.str());
+}
+
+int SessionProfiles::parse(const std::string &text)
+{
+    std::map<std::string, SessionProfile> profiles;
+    std::map<std::string, int> sectionLines;
+    SessionProfile *profile = NULL;
+    bool hasSettings = false;
+    std::istringstream lines(text);
+    std::string line;
+    int lineNumber = 0;
+    m_error.clear();
+
+    while (std::getline(lines, line)) {
+        ++lineNumber;
+        std::ostringstream where;
+        where << "line " << lineNumber << ": ";
+
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        if (line[0] == '[') {
+            if (line[line.size() - 1] != ']') {
+                m_error = where.str() + "unterminated section name";
+                return GE_INVALID_PARAMETER;
+            }
+            std::string name = trim(line.substr(1, line.size() - 2));
+            if (name.empty() || profiles.count(name) != 0) {
+                m_error = where.str() + (name.empty() ? "empty profile name" : "profile defined twice: " + name);
+                return GE_INVALID_PARAMETER;
+            }
+            profile = &profiles[name];
+            profile->name = name;
+            sectionLines[name] = lineNumber;
+            hasSettings = false;
+            continue;
+        }
+
+        size_t equals = line.find('=');
+        if (profile == NULL || equals == std::string::npos) {
+            m_error = where.str() + (profile == NULL ? "setting outside of a profile" : "expected <key> = <value>");
+            return GE_INVALID_PARAMETER;
+        }
+        std::string key = trim(line.substr(0, equals));
+        std::string value = trim(line.substr(equals + 1));
+
+        if (key == "base") {
+            std::map<std::string, SessionProfile>::const_iterator base = profiles.find(value);
+            if (hasSettings || base == profiles.end() || base->first == profile->name) {
+                m_error = where.str() + (hasSettings ? "base must be the first setting"
+                                                     : "base is not a profile defined before: " + value);
+                return GE_INVALID_PARAMETER;
+            }
+            std::string name = profile->name;
+            *profile = base->second;
+            profile->name = name;
+        } else if (setValue(*profile, key, value) != GE_OK) {
+            m_error = where.str() + "invalid " + key + ": " + value;
+            return GE_INVALID_PARAMETER;
+        }
+        hasSettings = true;
+    }
+
+    // Settings for the other kind of session would make the recorder return GE_NOT_PERMITTED
+    SessionProfile defaults;
+    std::map<std::string, SessionProfile>::const_iterator it;
+    for (it = profiles.begin(); it != profiles.end(); ++it) {
+        const SessionProfile &p = it->second;
+        bool isValid = p.isPlayback
+            ? (p.copyMode == defaults.copyMode && p.waitForSync == defaults.waitForSync && p.maxSizeInBytes == 0)
+            : (p.cycleSize == defaults.cycleSize && p.cyclePartsForTx == defaults.cyclePartsForTx
+               && p.simplexLink == defaults.simplexLink);
+        if (!isValid) {
+            std::ostringstream error;
+            error << "line " << sectionLines[it->first] << ": profile " << it->first
+                  << (p.isPlayback ? " sets copyMode, waitForSync, or maxSize for playback"
+                                   : " sets rateControl or simplexLink for recording");
+            m_error = error.str();
+            return GE_INVALID_PARAMETER;
+        }
+    }
+
+    m_profiles.swap(profiles);
+    return GE_OK;
+}
+
+int SessionProfiles::setValue(SessionProfile &profile, const std::string &key, const std::string &value)
+{
+    bool isValid = true;
+    if (key == "mode") {
+        profile.isPlayback = (value != "record");
+        if (value == "playback") {
+            profile.playbackMode = GEC_SFPDP_PLAYBACK_WITHOUT_SIGNALS;
+        } else if (value == "playback-untimed") {
+            profile.playbackMode = GEC_SFPDP_PLAYBACK_WITH_UNTIMED_SIGNALS;
+        } else if (value == "playback-timed") {
+            profile.playbackMode = GEC_SFPDP_PLAYBACK_WITH_TIMED_SIGNALS;
+        } else {
+            isValid = (value == "record");
+        }
+    } else if (key == "crc") {
+        isValid = parseBool(value, profile.crc);
+    } else if (key == "copyMode") {
+        isValid = parseBool(value, profile.copyMode);
+    } else if (key == "waitForSync") {
+        isValid = (value == "any" || value == "none");
+        profile.waitForSync = (value == "none") ? GEC_SFPDP_NO_WAIT_FOR_SYNC : GEC_SFPDP_WAIT_FOR_ANY_SYNC;
+    } else if (key == "maxSize") {
+        isValid = parseSize(value, profile.maxSizeInBytes);
+    } else if (key == "linkSpeed") {
+        profile.linkSpeed = GEC_sfpdpParseLinkSpeed(value);
+        isValid = (profile.linkSpeed >= 0);
+    } else if (key == "flowControl") {
+        isValid = parseBool(value, profile.flowControl);
+    } else if (key == "rateControl") {
+        static const char *cycles[] = { "512", "16K", "512K", "16M" };
+        size_t slash = value.find('/');
+        std::string cycle = trim(value.substr(0, slash));
+        long parts = (slash == std::string::npos) ? 0 : strtol(value.c_str() + slash + 1, NULL, 10);
+        isValid = false;
+        for (int i = 0; i < 4; ++i) {
+            if (cycle == cycles[i] && parts >= 1 && parts <= 64) {
+                profile.cycleSize = GEC_SFPDP_512_WORDS_CYCLE + i;
+                profile.cyclePartsForTx = static_cast<uint32_t>(parts);
+                isValid = true;
+            }
+        }
+    } else if (key == "simplexLink") {
+        isValid = parseBool(value, profile.simplexLink);
+    } else if (key == "syncSource") {
+        static const char *sources[] = { "master0", "master1", "master2", "master3", "ext0", "ext1", "ext2", "ext3" };
+        isValid = false;
+        for (int i = 0; i < 8; ++i) {
+            if (value == sources[i]) {
+                profile.syncSource = 1 << i;
+                isValid = true;
+            }
+        }
+    } else if (key == "swap8in16") {
+        isValid = parseBool(value, profile.swap8in16);
+    } else if (key == "swap16in32") {
+        isValid = parseBool(value, profile.swap16in32);
+    } else {
+        isValid = false;
+    }
+    return isValid ? GE_OK : GE_INVALID_PARAMETER;
+}
+
+const SessionProfile *SessionProfiles::find(const std::string &name) const
+{
+    std::map<std::string, SessionProfile>::const_iterator it = m_profiles.find(name);
+    return (it == m_profiles.end()) ? NULL : &it->second;
+}
+
+std::vector<std::string> SessionProfiles::getNames() const
+{
+    std::vector<std::string> names;
+    std::map<std::string, SessionProfile>::const_iterator it;
+    for (it = m_profiles.begin(); it != m_profiles.end(); ++it) {
+        names.push_back(it->first);
+    }
+    return names;
+}
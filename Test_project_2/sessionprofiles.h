@@ -0,0 +1,98 @@
+#ifndef SESSIONPROFILES_H
+#define SESSIONPROFILES_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+  Settings of a recording or playback session, given once by name rather
+  than call by call
+
+  Every field starts at the default the recorder documents for a new
+  session, so a profile only differs from a new session where it says
+  so. Link speed and maximum size have no per-session default: the link
+  speed belongs to the port and stays as the last session set it, and a
+  session without a maximum size records until the disk is full. They
+  are only set when the profile names them.
+*/
+struct SessionProfile
+{
+    SessionProfile();
+
+    std::string name;
+    bool isPlayback;
+    int playbackMode;                    // GEC_SFPDP_PLAYBACK_*, for playback profiles
+
+    bool crc;
+    bool copyMode;                       // Recording only
+    int waitForSync;                     // Recording only
+    uint64_t maxSizeInBytes;             // Recording only; 0 to leave unset
+    int linkSpeed;                       // GEC_SFPDP_*_GBPS, or -1 to leave unset
+    bool flowControl;
+    int cycleSize;                       // Playback only
+    uint32_t cyclePartsForTx;            // Playback only
+    bool simplexLink;                    // Playback only
+    int syncSource;
+    bool swap8in16;
+    bool swap16in32;
+};
+
+/**
+  Named session profiles, read from a text file
+
+  Each profile is a section; keys not given keep their defaults:
+
+    # Raw 4.25 Gbps capture, byte-swapped to little endian
+    [raw-4g25]
+    mode = record               # record, playback, playback-untimed, playback-timed
+    crc = on
+    copyMode = off
+    waitForSync = any           # any or none
+    maxSize = 500G              # bytes, with an optional K, M, G, or T suffix (powers of 1024)
+    linkSpeed = 4.25            # 1.0625, 2.125, 2.5, 3.125, or 4.25
+    flowControl = on
+    rateControl = 16M/64        # cycle of 512, 16K, 512K, or 16M words / parts of 64 (playback)
+    simplexLink = off           # playback
+    syncSource = master0        # master0..master3 or ext0..ext3
+    swap8in16 = on
+    swap16in32 = on
+
+  A profile may start from another one with "base = <name>", given
+  first in its section. Settings that do not apply to the kind of
+  session, such as rateControl in a recording profile, are errors.
+*/
+class SessionProfiles
+{
+public:
+    /**
+      Replaces the profiles by those in the file at @p path
+
+      @return GE_OK
+      Success
+      @return GE_NOT_EXISTING
+      The file cannot be read
+      @return GE_INVALID_PARAMETER
+      The file has an error; see getError()
+    */
+    int load(const std::string &path);
+
+    /** Like load(), from the text of a profile file */
+    int parse(const std::string &text);
+
+    /** @return The profile, or NULL if there is none of that name */
+    const SessionProfile *find(const std::string &name) const;
+    std::vector<std::string> getNames() const;
+
+    /** Line number and reason of the last error of load() or parse() */
+    const std::string &getError() const { return m_error; }
+
+private:
+    int setValue(SessionProfile &profile, const std::string &key, const std::string &value);
+
+    std::map<std::string, SessionProfile> m_profiles;
+    std::string m_error;
+};
+
+#endif // SESSIONPROFILES_H
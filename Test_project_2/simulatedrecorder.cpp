@@ -0,0 +1,936 @@
+#include "simulatedrecorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#include "inc/GE_Defines.h"
+#include "GEC_RecordingFormat.h"
+#include "GEC_SfpdpLinkRate.h"
+
+// The HW timers count the 5 MHz channel sync clock
+static const uint64_t timerFrequencyInHz = 5000000;
+
+static const int numSyncMasters = 4;
+
+static double getTimeInS()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t getFileSize(FILE *file)
+{
+#ifdef _WIN32
+    _fseeki64(file, 0, SEEK_END);
+    int64_t size = _ftelli64(file);
+    _fseeki64(file, 0, SEEK_SET);
+#else
+    fseeko(file, 0, SEEK_END);
+    int64_t size = ftello(file);
+    fseeko(file, 0, SEEK_SET);
+#endif
+    return (size > 0) ? static_cast<uint64_t>(size) : 0;
+}
+
+static void makeDirectories(const std::string &path)
+{
+    for (size_t i = 1; i <= path.size(); ++i) {
+        if (i == path.size() || path[i] == '/' || path[i] == '\\') {
+#ifdef _WIN32
+            _mkdir(path.substr(0, i).c_str());
+#else
+            mkdir(path.substr(0, i).c_str(), 0755);
+#endif
+        }
+    }
+}
+
+static bool isSyncSource(int source)
+{
+    for (int bit = 0; bit < 8; ++bit) {
+        if (source == (1 << bit)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int getMasterIndex(int source)
+{
+    for (int i = 0; i < numSyncMasters; ++i) {
+        if (source == (1 << i)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+SimulatedRecorder::Config::Config()
+    : sourceBytesPerSecond(10e6)
+    , sourceOnInS(0)
+    , sourceOffInS(0)
+    , diskBytesPerSecond(0)
+    , fifoSizeInBytes(8 * 1024 * 1024)
+    , syncIntervalInBytes(64 * 1024)
+    , crcErrorProbability(0)
+    , idleTimeoutInS(5)
+    , stepInS(0.01)
+    , numDevices(1)
+    , numPorts(GEC_SFPDP_MAX_PORTS)
+{
+}
+
+bool SimulatedRecorder::parseAddress(const std::string &address, Config &config)
+{
+    if (address.compare(0, 4, "sim:") != 0) {
+        return false;
+    }
+    std::string rest = address.substr(4);
+    size_t query = rest.find('?');
+    config.rootDirectory = rest.substr(0, query);
+    if (query == std::string::npos) {
+        return true;
+    }
+
+    std::istringstream options(rest.substr(query + 1));
+    std::string option;
+    while (std::getline(options, option, '&')) {
+        size_t equals = option.find('=');
+        if (equals == std::string::npos) {
+            return false;
+        }
+        std::string key = option.substr(0, equals);
+        char *end = NULL;
+        double value = strtod(option.c_str() + equals + 1, &end);
+        if (end == option.c_str() + equals + 1 || *end != '\0' || value < 0) {
+            return false;
+        }
+
+        if (key == "rate") {
+            config.sourceBytesPerSecond = value * 1e6;
+        } else if (key == "disk") {
+            config.diskBytesPerSecond = value * 1e6;
+        } else if (key == "fifo") {
+            config.fifoSizeInBytes = static_cast<uint64_t>(value * 1024 * 1024);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+SimulatedRecorder::SimulatedRecorder(const Config &config)
+    : m_config(config)
+    , m_ports(config.numDevices * config.numPorts)
+    , m_nextId(1)
+    , m_intChannelSyncControl(GEC_SFPDP_AUTOMATIC_CONTROL)
+    , m_startInS(0)
+    , m_isStopping(false)
+{
+    m_config.syncIntervalInBytes = std::max<uint64_t>(m_config.syncIntervalInBytes & ~3ULL, GEC_RECORDING_WORD_SIZE);
+    m_config.stepInS = std::max(m_config.stepInS, 0.001);
+    for (int i = 0; i < numSyncMasters; ++i) {
+        m_masterStartInS[i] = -1;
+        m_masterRunInS[i] = 0;
+    }
+    m_thread = std::thread(&SimulatedRecorder::run, this);
+}
+
+SimulatedRecorder::~SimulatedRecorder()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+    }
+    m_wakeUp.notify_all();
+    m_thread.join();
+
+    std::map<uint32_t, Session>::iterator it;
+    for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        closeFiles(it->second);
+    }
+}
+
+std::string SimulatedRecorder::getLocalPath(const std::string &path) const
+{
+    return m_config.rootDirectory + path;
+}
+
+void SimulatedRecorder::setSourceActive(uint32_t iDevice, uint32_t iPort, bool isActive)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (iDevice < m_config.numDevices && iPort < m_config.numPorts) {
+        m_ports[iDevice * m_config.numPorts + iPort].isSourceActive = isActive;
+    }
+}
+
+SimulatedRecorder::Session *SimulatedRecorder::findSession(uint32_t id)
+{
+    std::map<uint32_t, Session>::iterator it = m_sessions.find(id);
+    return (it == m_sessions.end()) ? NULL : &it->second;
+}
+
+bool SimulatedRecorder::isAnyActive() const
+{
+    std::map<uint32_t, Session>::const_iterator it;
+    for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        if (it->second.state == ACTIVE || it->second.state == END_OF_FILE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SimulatedRecorder::isPortUsed(uint32_t port, bool isRecording, uint32_t exceptId) const
+{
+    std::map<uint32_t, Session>::const_iterator it;
+    for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        if (it->first != exceptId && it->second.port == port && it->second.isRecording == isRecording) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SimulatedRecorder::closeFiles(Session &session)
+{
+    FILE *files[3] = { session.dataFile, session.indexFile, session.metaFile };
+    for (int i = 0; i < 3; ++i) {
+        if (files[i] != NULL) {
+            fclose(files[i]);
+        }
+    }
+    session.dataFile = NULL;
+    session.indexFile = NULL;
+    session.metaFile = NULL;
+}
+
+int SimulatedRecorder::setIntChannelSyncControl(int mode)
+{
+    if (mode != GEC_SFPDP_AUTOMATIC_CONTROL && mode != GEC_SFPDP_MANUAL_CONTROL) {
+        return GE_INVALID_PARAMETER;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_intChannelSyncControl = mode;
+    return GE_OK;
+}
+
+int SimulatedRecorder::setIntChannelSync(uint32_t iDevice, int masterMask, int action)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (iDevice >= m_config.numDevices) {
+        return GE_NOT_EXISTING;
+    }
+    if (masterMask == 0 || (masterMask & ~((1 << numSyncMasters) - 1)) != 0) {
+        return GE_INVALID_PARAMETER;
+    }
+    if (action != GEC_SFPDP_START_CHANNEL_SYNC && action != GEC_SFPDP_PAUSE_CHANNEL_SYNC
+        && action != GEC_SFPDP_STOP_CHANNEL_SYNC) {
+        return GE_INVALID_PARAMETER;
+    }
+    if (m_intChannelSyncControl != GEC_SFPDP_MANUAL_CONTROL) {
+        return GE_NOT_PERMITTED;
+    }
+
+    double nowInS = getTimeInS();
+    for (int i = 0; i < numSyncMasters; ++i) {
+        if ((masterMask & (1 << i)) == 0) {
+            continue;
+        }
+        bool isRunning = (m_masterStartInS[i] >= 0);
+        if (action == GEC_SFPDP_START_CHANNEL_SYNC && !isRunning) {
+            m_masterStartInS[i] = nowInS;
+        } else if (action == GEC_SFPDP_PAUSE_CHANNEL_SYNC && isRunning) {
+            m_masterRunInS[i] += nowInS - m_masterStartInS[i];
+            m_masterStartInS[i] = -1;
+        } else if (action == GEC_SFPDP_STOP_CHANNEL_SYNC) {
+            m_masterRunInS[i] = 0;
+            m_masterStartInS[i] = -1;
+        }
+    }
+    return GE_OK;
+}
+
+int SimulatedRecorder::setChannelSyncOutput(uint32_t iDevice, int signal, int source)
+{
+    if (iDevice >= m_config.numDevices) {
+        return GE_NOT_EXISTING;
+    }
+    if (signal < GEC_SFPDP_EXTERNAL_CHANNEL_SYNC_EXT0 || signal > GEC_SFPDP_EXTERNAL_CHANNEL_SYNC_EXT3
+        || !isSyncSource(signal) || !isSyncSource(source)) {
+        return GE_INVALID_PARAMETER;
+    }
+    // The simulated recorder has no external connectors
+    return GE_NOT_PERMITTED;
+}
+
+int SimulatedRecorder::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<uint32_t, Session>::iterator it;
+    for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        closeFiles(it->second);
+    }
+    m_sessions.clear();
+    for (int i = 0; i < numSyncMasters; ++i) {
+        m_masterStartInS[i] = -1;
+        m_masterRunInS[i] = 0;
+    }
+    return GE_OK;
+}
+
+int SimulatedRecorder::create(std::string path, std::string name, uint32_t iDevice, uint32_t iPort, uint32_t &id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (iDevice >= m_config.numDevices || iPort >= m_config.numPorts) {
+        return GE_NOT_EXISTING;
+    }
+    uint32_t port = iDevice * m_config.numPorts + iPort;
+    std::string fullName = path + "/" + name;
+    std::map<uint32_t, Session>::const_iterator it;
+    for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        if (it->second.isRecording && it->second.path == fullName) {
+            return GE_FILE_IN_USE;
+        }
+    }
+    if (isPortUsed(port, true, 0)) {
+        return GE_BUSY;
+    }
+
+    std::string localDirectory = getLocalPath(path);
+    makeDirectories(localDirectory);
+    std::string localName = localDirectory + "/" + name;
+
+    Session session;
+    session.isRecording = true;
+    session.path = fullName;
+    session.port = port;
+    session.state = READY;
+    session.numBytes = 0;
+    session.crc = false;
+    session.copyMode = false;
+    session.waitForSync = true;
+    session.flowControl = true;
+    session.simplexLink = false;
+    session.swap8in16 = false;
+    session.swap16in32 = false;
+    session.maxSizeInBytes = 0;
+    session.playbackMode = GEC_SFPDP_PLAYBACK_WITHOUT_SIGNALS;
+    session.cycleSize = GEC_SFPDP_16M_WORDS_CYCLE;
+    session.cyclePartsForTx = 64;
+    session.syncSource = GEC_SFPDP_INTERNAL_CHANNEL_SYNC_MASTER_0;
+    session.dataFile = fopen((localName + GEC_RECORDING_DATA_EXTENSION).c_str(), "wb");
+    session.indexFile = fopen((localName + GEC_RECORDING_INDEX_EXTENSION).c_str(), "wb");
+    session.metaFile = fopen((localName + GEC_RECORDING_META_EXTENSION).c_str(), "wb");
+    session.backlogInBytes = 0;
+    session.sourceOffset = 0;
+    session.nextWord = 0;
+    session.nextSyncOffset = 0;
+    session.overflowDetected = false;
+    session.isSynchronized = false;
+    session.lastDataInS = 0;
+    session.random.seed(port + 1);
+    session.fileSize = 0;
+    session.readOffset = 0;
+    session.creditInBytes = 0;
+    if (session.dataFile == NULL || session.indexFile == NULL || session.metaFile == NULL) {
+        closeFiles(session);
+        return GE_NO_ACCESS;
+    }
+
+    id = m_nextId++;
+    m_sessions[id] = session;
+    return GE_OK;
+}
+
+int SimulatedRecorder::open(std::string path, std::string name, uint32_t iDevice, uint32_t iPort, int mode, uint32_t &id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (mode != GEC_SFPDP_PLAYBACK_WITHOUT_SIGNALS && mode != GEC_SFPDP_PLAYBACK_WITH_UNTIMED_SIGNALS
+        && mode != GEC_SFPDP_PLAYBACK_WITH_TIMED_SIGNALS) {
+        return GE_INVALID_PARAMETER;
+    }
+    if (iDevice >= m_config.numDevices || iPort >= m_config.numPorts) {
+        return GE_NOT_EXISTING;
+    }
+    uint32_t port = iDevice * m_config.numPorts + iPort;
+    std::string fullName = path + "/" + name;
+    std::map<uint32_t, Session>::const_iterator it;
+    for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        if (it->second.isRecording && it->second.path == fullName) {
+            return GE_FILE_IN_USE;
+        }
+        // Copy mode transmits on the port, so it excludes playback
+        if (it->second.port == port && (!it->second.isRecording || it->second.copyMode)) {
+            return GE_BUSY;
+        }
+    }
+
+    std::string localName = getLocalPath(path) + "/" + name;
+
+    Session session;
+    session.isRecording = false;
+    session.path = fullName;
+    session.port = port;
+    session.state = READY;
+    session.numBytes = 0;
+    session.crc = false;
+    session.copyMode = false;
+    session.waitForSync = false;
+    session.flowControl = true;
+    session.simplexLink = false;
+    session.swap8in16 = false;
+    session.swap16in32 = false;
+    session.maxSizeInBytes = 0;
+    session.playbackMode = mode;
+    session.cycleSize = GEC_SFPDP_16M_WORDS_CYCLE;
+    session.cyclePartsForTx = 64;
+    session.syncSource = GEC_SFPDP_INTERNAL_CHANNEL_SYNC_MASTER_0;
+    session.dataFile = fopen((localName + GEC_RECORDING_DATA_EXTENSION).c_str(), "rb");
+    session.indexFile = NULL;
+    session.metaFile = NULL;
+    session.backlogInBytes = 0;
+    session.sourceOffset = 0;
+    session.nextWord = 0;
+    session.nextSyncOffset = 0;
+    session.overflowDetected = false;
+    session.isSynchronized = true;
+    session.lastDataInS = 0;
+    session.fileSize = 0;
+    session.readOffset = 0;
+    session.creditInBytes = 0;
+    if (session.dataFile == NULL) {
+        return GE_NO_ACCESS;
+    }
+    session.fileSize = getFileSize(session.dataFile);
+
+    // Signals are regenerated from the meta data file
+    if (mode != GEC_SFPDP_PLAYBACK_WITHOUT_SIGNALS) {
+        FILE *metaFile = fopen((localName + GEC_RECORDING_META_EXTENSION).c_str(), "rb");
+        GEC_MetaHeader header;
+        if (metaFile == NULL || fread(&header, sizeof(header), 1, metaFile) != 1 || header.magic != GEC_META_MAGIC) {
+            if (metaFile != NULL) {
+                fclose(metaFile);
+            }
+            closeFiles(session);
+            return GE_NO_ACCESS;
+        }
+        // Ticks are converted to seconds since the first record
+        double frequency = (header.timerFrequencyInHz != 0) ? static_cast<double>(header.timerFrequencyInHz) : 1.0;
+        GEC_MetaRecord record;
+        uint64_t firstTicks = 0;
+        while (fread(&record, sizeof(record), 1, metaFile) == 1) {
+            if (session.timing.empty()) {
+                firstTicks = record.timerTicks;
+            }
+            session.timing.push_back(std::make_pair((record.timerTicks - firstTicks) / frequency, record.dataOffset));
+        }
+        fclose(metaFile);
+    }
+
+    id = m_nextId++;
+    m_sessions[id] = session;
+    return GE_OK;
+}
+
+int SimulatedRecorder::destroy(uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Session *session = findSession(id);
+    if (session == NULL) {
+        return GE_INVALID_PARAMETER;
+    }
+    closeFiles(*session);
+    m_sessions.erase(id);
+    return GE_OK;
+}
+
+int SimulatedRecorder::setCRC(uint32_t id, bool enableCRC)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Session *session = findSession(id);
+    if (session == NULL) {
+        return GE_INVALID_PARAMETER;
+    }
+    if (session->state == READY) {
+        session->crc = enableCRC;
+    }
+    return GE_OK;
+}
+
+int SimulatedRecorder::setCopyMode(uint32_t id, bool enable)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Session *session = findSession(id);
+    if (session == NULL) {
+        return GE_INVALID_PARAMETER;
+    }
+    if (!session->isRecording || (enable && isPortUsed(session->port, false, id))) {
+        return GE_NOT_PERMITTED;
+    }
+    session->copyMode = enable;
+    return GE_OK;
+}
+
+int SimulatedRecorder::setWaitForSync(uint32_t id, int mode)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Session *session = findSession(id);
+    if (session == NULL || (mode != GEC_SFPDP_NO_WAIT_FOR_SYNC && mode != GEC_SFPDP_WAIT_FOR_ANY_SYNC)) {
+        return GE_INVALID_PARAMETER;
+    }
+    if (!session->isRecording) {
+        return GE_NOT_PERMITTED;
+    }
+    if (session->state == READY) {
+        session->waitForSync = (mode == GEC_SFPDP_WAIT_FOR_ANY_SYNC);
+    }
+    return GE_OK;
+}
+
+int SimulatedRecorder::setMaxSize(uint32_t id, uint64_t sizeInBytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Session *session = findSession(id);
+    if (session == NULL || !session->isRecording) {
+        return GE_INVALID_PARAMETER;
+    }
+    session->maxSizeInBytes = sizeInBytes;
+    return GE_OK;
+}
+
+int SimulatedRecorder::setLinkSpeed(uint32_t id, int speed)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Session *session = findSession(id);
+    if (session == NULL || GEC_sfpdpLineRateInBitsPerSecond(speed) == 0) {
+        return GE_INVALID_PARAMETER;
+    }
+    if (session->state != READY) {
+        return GE_NOT_PERMITTED;
+    }
+    // Transmit and receive on a port share the link speed
+    m_ports[session->port].linkSpeed = speed;
+    return GE_OK;
+}
+
+int SimulatedRecorder::setFlowControl(uint32_t id, bool enable)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Session *session = findSession(id);
+    if (session == NULL) {
+        return GE_INVALID_PARAMETER;
+    }
+    if (session->state == READY) {
+        session->flowControl = enable;
+    }
+    return GE_OK;
+}
+
+int SimulatedRecorder::setRateControl(uint32_t id, int cycleSize, uint32_t cyclePartsForTx)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Session *session = findSession(id);
+    if (session == NULL || cycleSize < GEC_SFPDP_512_WORDS_CYCLE || cycleSize > GEC_SFPDP_16M_WORDS_CYCLE
+        || cyclePartsForTx < 1 || cyclePartsForTx > 64) {
+        return GE_INVALID_PARAMETER;
+    }
+    if (session->isRecording) {
+        return GE_NOT_PERMITTED;
+    }
+    if (session->state == READY) {
+        session->cycleSize = cycleSize;
+        session->cyclePartsForTx = cyclePartsForTx;
+    }
+    return GE_OK;
+}
+
+int SimulatedRecorder::setSimplexLinkMode(uint32_t id, bool enable)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Session *session = findSession(id);
+    if (session == NULL) {
+        return GE_INVALID_PARAMETER;
+    }
+    if (session->isRecording) {
+        return GE_NOT_PERMITTED;
+    }
+    if (session->state == READY) {
+        session->simplexLink = enable;
+    }
+    return GE_OK;
+}
+
+int SimulatedRecorder::setChannelSyncSource(uint32_t id, int source)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Session *session = findSession(id);
+    if (session == NULL || !isSyncSource(source)) {
+        return GE_INVALID_PARAMETER;
+    }
+    // No external inputs, and only master 0 unless the masters are controlled manually
+    int master = getMasterIndex(source);
+    if (master < 0 || (master > 0 && m_intChannelSyncControl == GEC_SFPDP_AUTOMATIC_CONTROL)) {
+        return GE_NOT_PERMITTED;
+    }
+    session->syncSource = source;
+    return GE_OK;
+}
+
+int SimulatedRecorder::setSwapping(uint32_t id, bool enable8in16, bool enable16in32)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Session *session = findSession(id);
+    if (session == NULL) {
+        return GE_INVALID_PARAMETER;
+    }
+    session->swap8in16 = enable8in16;
+    session->swap16in32 = enable16in32;
+    return GE_OK;
+}
+
+int SimulatedRecorder::getStatus(uint32_t id, uint64_t &numBytes, std::string &state)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Session *session = findSession(id);
+    if (session == NULL) {
+        return GE_INVALID_PARAMETER;
+    }
+
+    numBytes = session->numBytes;
+    switch (session->state) {
+    case READY:
+        state = "Ready";
+        break;
+    case ACTIVE:
+        if (!session->isRecording) {
+            state = "Playing";
+        } else {
+            state = (getTimeInS() - session->lastDataInS > m_config.idleTimeoutInS) ? "Idle" : "Recording";
+        }
+        break;
+    case MAXED_OUT:
+        state = "Maxed out";
+        break;
+    case END_OF_FILE:
+        state = "End of file";
+        break;
+    case ALL_TRANSMITTED:
+        state = "All data transmitted";
+        break;
+    case STOPPED:
+        state = "Stopped";
+        break;
+    }
+    return GE_OK;
+}
+
+int SimulatedRecorder::checkForOverflow(uint32_t id, bool &detected, bool clear)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Session *session = findSession(id);
+    if (session == NULL || !session->isRecording) {
+        return GE_INVALID_PARAMETER;
+    }
+    detected = session->overflowDetected;
+    if (clear) {
+        session->overflowDetected = false;
+    }
+    return GE_OK;
+}
+
+int SimulatedRecorder::startAll()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        double nowInS = getTimeInS();
+        m_startInS = nowInS;
+        if (m_intChannelSyncControl == GEC_SFPDP_AUTOMATIC_CONTROL) {
+            m_masterStartInS[0] = nowInS;
+            m_masterRunInS[0] = 0;
+        }
+
+        std::map<uint32_t, Session>::iterator it;
+        for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+            Session &session = it->second;
+            if (session.state != READY) {
+                continue;
+            }
+            session.state = ACTIVE;
+            session.numBytes = 0;
+            session.lastDataInS = nowInS;
+            if (session.isRecording) {
+                session.backlogInBytes = 0;
+                session.sourceOffset = 0;
+                session.overflowDetected = false;
+                session.isSynchronized = false;
+
+                // Wall-clock time at timer tick 0
+                uint64_t wallClockInNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+                uint64_t ticks = getTimerTicks(session, nowInS);
+                GEC_MetaHeader header;
+                header.magic = GEC_META_MAGIC;
+                header.version = GEC_META_VERSION;
+                header.startTimeInNs = wallClockInNs - ticks * 1000000000ULL / timerFrequencyInHz;
+                header.timerFrequencyInHz = timerFrequencyInHz;
+                fwrite(&header, sizeof(header), 1, session.metaFile);
+            } else {
+                session.readOffset = 0;
+                session.creditInBytes = 0;
+            }
+        }
+    }
+    m_wakeUp.notify_all();
+    return GE_OK;
+}
+
+int SimulatedRecorder::stopAll()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<uint32_t, Session>::iterator it;
+    for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        Session &session = it->second;
+        if (session.state == READY) {
+            continue;
+        }
+        session.state = STOPPED;
+        if (session.isRecording) {
+            fflush(session.dataFile);
+            fflush(session.indexFile);
+            fflush(session.metaFile);
+        }
+    }
+    if (m_intChannelSyncControl == GEC_SFPDP_AUTOMATIC_CONTROL) {
+        m_masterStartInS[0] = -1;
+    }
+    return GE_OK;
+}
+
+uint64_t SimulatedRecorder::getTimerTicks(const Session &session, double nowInS) const
+{
+    int master = std::max(getMasterIndex(session.syncSource), 0);
+    double runInS = m_masterRunInS[master];
+    if (m_masterStartInS[master] >= 0) {
+        runInS += nowInS - m_masterStartInS[master];
+    }
+    return static_cast<uint64_t>(runInS * timerFrequencyInHz);
+}
+
+double SimulatedRecorder::getSourceRate(const Session &session, double nowInS) const
+{
+    const Port &port = m_ports[session.port];
+    if (!port.isSourceActive) {
+        return 0;
+    }
+    if (m_config.sourceOnInS > 0 && m_config.sourceOffInS > 0) {
+        double phaseInS = std::fmod(nowInS - m_startInS, m_config.sourceOnInS + m_config.sourceOffInS);
+        if (phaseInS >= m_config.sourceOnInS) {
+            return 0;
+        }
+    }
+    return std::min(m_config.sourceBytesPerSecond, static_cast<double>(GEC_sfpdpDataRateInBytesPerSecond(port.linkSpeed)));
+}
+
+void SimulatedRecorder::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    double lastStepInS = getTimeInS();
+    while (!m_isStopping) {
+        if (!isAnyActive()) {
+            m_wakeUp.wait(lock, [this]() { return m_isStopping || isAnyActive(); });
+            lastStepInS = getTimeInS();
+            continue;
+        }
+
+        m_wakeUp.wait_for(lock, std::chrono::duration<double>(m_config.stepInS));
+        double nowInS = getTimeInS();
+        // A late step catches up, but not with more than a second of data at once
+        step(nowInS, std::min(nowInS - lastStepInS, 1.0));
+        lastStepInS = nowInS;
+    }
+}
+
+void SimulatedRecorder::step(double nowInS, double elapsedInS)
+{
+    size_t numRecording = 0;
+    std::map<uint32_t, Session>::iterator it;
+    for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        if (it->second.isRecording && it->second.state == ACTIVE) {
+            ++numRecording;
+        }
+    }
+    // The disk is shared evenly; a negative share means no limit
+    double diskBytes = (m_config.diskBytesPerSecond > 0 && numRecording > 0)
+        ? m_config.diskBytesPerSecond * elapsedInS / numRecording : -1;
+
+    for (it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        Session &session = it->second;
+        if (session.isRecording && session.state == ACTIVE) {
+            stepRecording(session, nowInS, elapsedInS, diskBytes);
+        } else if (!session.isRecording && (session.state == ACTIVE || session.state == END_OF_FILE)) {
+            stepPlayback(session, nowInS, elapsedInS);
+        }
+    }
+}
+
+void SimulatedRecorder::stepRecording(Session &session, double nowInS, double elapsedInS, double diskBytes)
+{
+    double writable = (diskBytes < 0) ? 1e300 : diskBytes;
+    double arriving = getSourceRate(session, nowInS) * elapsedInS;
+    if (session.flowControl) {
+        // STOP is sent before the FIFO overflows
+        arriving = std::min(arriving, std::max(0.0, m_config.fifoSizeInBytes + writable - session.backlogInBytes));
+    }
+    if (arriving >= GEC_RECORDING_WORD_SIZE) {
+        session.lastDataInS = nowInS;
+    }
+
+    uint64_t numWords = static_cast<uint64_t>(arriving / GEC_RECORDING_WORD_SIZE);
+    uint64_t numArriving = numWords * GEC_RECORDING_WORD_SIZE;
+    if (!session.isSynchronized && numArriving > 0) {
+        // The source sends a SYNC in the middle of every interval after the start
+        uint64_t interval = m_config.syncIntervalInBytes;
+        uint64_t toSync = (interval / 2 + interval - session.sourceOffset % interval) % interval;
+        toSync -= toSync % GEC_RECORDING_WORD_SIZE;
+        if (session.waitForSync) {
+            // Data before the first SYNC is discarded
+            uint64_t discarded = std::min(toSync, numArriving);
+            session.sourceOffset += discarded;
+            session.nextWord += static_cast<uint32_t>(discarded / GEC_RECORDING_WORD_SIZE);
+            numArriving -= discarded;
+            session.isSynchronized = (discarded == toSync);
+            session.nextSyncOffset = 0;
+        } else {
+            session.isSynchronized = true;
+            session.nextSyncOffset = toSync;
+        }
+    }
+    session.sourceOffset += numArriving;
+    session.backlogInBytes += numArriving;
+
+    double written = std::min(session.backlogInBytes, writable);
+    uint64_t numWritten = static_cast<uint64_t>(written / GEC_RECORDING_WORD_SIZE) * GEC_RECORDING_WORD_SIZE;
+    session.backlogInBytes -= numWritten;
+
+    if (!session.flowControl && session.backlogInBytes > m_config.fifoSizeInBytes) {
+        uint64_t dropped = static_cast<uint64_t>(session.backlogInBytes - m_config.fifoSizeInBytes);
+        dropped -= dropped % GEC_RECORDING_WORD_SIZE;
+        session.backlogInBytes -= dropped;
+        session.nextWord += static_cast<uint32_t>(dropped / GEC_RECORDING_WORD_SIZE);
+        session.overflowDetected = true;
+    }
+
+    if (session.maxSizeInBytes != 0 && session.numBytes + numWritten >= session.maxSizeInBytes) {
+        // setMaxSize() may have set a limit below what is already written
+        numWritten = (session.numBytes < session.maxSizeInBytes) ? session.maxSizeInBytes - session.numBytes : 0;
+        numWritten -= numWritten % GEC_RECORDING_WORD_SIZE;
+        writeData(session, numWritten, nowInS);
+        session.state = MAXED_OUT;
+        session.backlogInBytes = 0;
+        fflush(session.dataFile);
+        fflush(session.indexFile);
+        fflush(session.metaFile);
+        return;
+    }
+    writeData(session, numWritten, nowInS);
+}
+
+void SimulatedRecorder::writeData(Session &session, uint64_t numBytes, double nowInS)
+{
+    if (numBytes == 0) {
+        return;
+    }
+
+    GEC_MetaRecord record;
+    record.timerTicks = getTimerTicks(session, nowInS);
+    record.dataOffset = session.numBytes;
+    fwrite(&record, sizeof(record), 1, session.metaFile);
+
+    uint64_t endOffset = session.numBytes + numBytes;
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    while (session.nextSyncOffset < endOffset) {
+        GEC_IndexEntry entry;
+        entry.dataOffset = session.nextSyncOffset;
+        entry.event = GEC_INDEX_EVENT_SYNC;
+        entry.reserved = 0;
+        fwrite(&entry, sizeof(entry), 1, session.indexFile);
+        if (session.crc && uniform(session.random) < m_config.crcErrorProbability) {
+            entry.event = GEC_INDEX_EVENT_CRC_ERROR;
+            fwrite(&entry, sizeof(entry), 1, session.indexFile);
+        }
+        session.nextSyncOffset += m_config.syncIntervalInBytes;
+    }
+
+    uint32_t portTag = (session.port & 0xF) << 28;
+    uint32_t buffer[16384];
+    uint64_t numWords = numBytes / GEC_RECORDING_WORD_SIZE;
+    while (numWords > 0) {
+        size_t count = static_cast<size_t>(std::min<uint64_t>(numWords, sizeof(buffer) / sizeof(buffer[0])));
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t word = portTag | (session.nextWord++ & 0x0FFFFFFF);
+            if (session.swap8in16) {
+                word = ((word & 0x00FF00FF) << 8) | ((word >> 8) & 0x00FF00FF);
+            }
+            if (session.swap16in32) {
+                word = (word << 16) | (word >> 16);
+            }
+            buffer[i] = word;
+        }
+        fwrite(buffer, sizeof(buffer[0]), count, session.dataFile);
+        numWords -= count;
+    }
+    session.numBytes = endOffset;
+}
+
+void SimulatedRecorder::stepPlayback(Session &session, double nowInS, double elapsedInS)
+{
+    // Rate control lets the link send during a part of every cycle
+    double linkRate = static_cast<double>(GEC_sfpdpDataRateInBytesPerSecond(m_ports[session.port].linkSpeed))
+        * session.cyclePartsForTx / 64.0;
+    session.creditInBytes += linkRate * elapsedInS;
+    uint64_t target = session.fileSize;
+
+    // Timed playback sends no data before the time it was received
+    if (session.playbackMode == GEC_SFPDP_PLAYBACK_WITH_TIMED_SIGNALS && !session.timing.empty()) {
+        double playedInS = nowInS - m_startInS;
+        std::vector<std::pair<double, uint64_t> >::const_iterator it = std::upper_bound(
+            session.timing.begin(), session.timing.end(), std::make_pair(playedInS, UINT64_MAX));
+        target = (it == session.timing.end()) ? session.fileSize : it->second;
+    }
+
+    uint64_t sendable = (target > session.numBytes) ? target - session.numBytes : 0;
+    uint64_t sent = std::min<uint64_t>(sendable, static_cast<uint64_t>(session.creditInBytes));
+    sent -= sent % GEC_RECORDING_WORD_SIZE;
+    session.creditInBytes = std::min(session.creditInBytes - sent, linkRate * m_config.stepInS);
+    session.numBytes += sent;
+
+    // The transmit FIFO is kept full from the file
+    uint64_t readTarget = std::min(session.fileSize, session.numBytes + m_config.fifoSizeInBytes);
+    char buffer[65536];
+    while (session.readOffset < readTarget) {
+        size_t count = static_cast<size_t>(std::min<uint64_t>(readTarget - session.readOffset, sizeof(buffer)));
+        size_t numRead = fread(buffer, 1, count, session.dataFile);
+        if (numRead == 0) {
+            session.fileSize = session.readOffset;   // Truncated while playing
+            break;
+        }
+        session.readOffset += numRead;
+    }
+
+    if (session.numBytes >= session.fileSize) {
+        session.numBytes = session.fileSize;
+        session.state = ALL_TRANSMITTED;
+    } else if (session.readOffset >= session.fileSize) {
+        session.state = END_OF_FILE;
+    }
+}
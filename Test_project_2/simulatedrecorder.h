@@ -0,0 +1,185 @@
+#ifndef SIMULATEDRECORDER_H
+#define SIMULATEDRECORDER_H
+
+#include <stdint.h>
+#include <cstdio>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "inc/GEC_ISfpdpRecorder.h"
+
+/**
+  Software model of an SFPDP recorder, implementing GEC_ISfpdpRecorder
+  without any hardware
+
+  Recording sessions receive a synthetic data stream on their port and
+  write real .dat, .idx, and .meta files in the layout of
+  GEC_RecordingFormat.h. Playback sessions read a recording back and
+  "transmit" it. A worker thread advances all active sessions in small
+  time steps, so numBytes and the state strings evolve like on a real
+  recorder:
+
+  - The source sends at the configured rate, capped by the link data
+    rate of the port. With a source duty cycle, sessions go 'Idle' when
+    no data arrived for the idle timeout.
+  - Received data goes through a FIFO to the disk, which may be given a
+    limited write rate shared by all sessions. Without flow control an
+    overflowing FIFO loses data and raises the overflow state; with flow
+    control the source is held back instead.
+  - setMaxSize(), wait for SYNC, CRC errors, swapping, link speeds per
+    port, rate control and timed playback are modelled as documented in
+    GEC_ISfpdpRecorder.h.
+
+  The synthetic data words are ((port << 28) | word counter), so a
+  recording can be checked word by word. All methods are thread-safe.
+*/
+class SimulatedRecorder : public GEC_ISfpdpRecorder
+{
+public:
+    struct Config
+    {
+        Config();
+
+        std::string rootDirectory;        // Prefixed to every path given to create() and open()
+        double sourceBytesPerSecond;      // Data rate of the sender on every port
+        double sourceOnInS;               // Duty cycle of the sender; 0 sends continuously
+        double sourceOffInS;
+        double diskBytesPerSecond;        // Write rate shared by all sessions; 0 for no limit
+        uint64_t fifoSizeInBytes;         // Receive and transmit FIFO of every port
+        uint64_t syncIntervalInBytes;     // Distance between SYNCs in the received data
+        double crcErrorProbability;       // Per SYNC frame, when CRC handling is enabled
+        double idleTimeoutInS;
+        double stepInS;                   // Time step of the model
+        uint32_t numDevices;
+        uint32_t numPorts;
+    };
+
+    /**
+      Reads a configuration from an address of the form
+      sim:<directory>[?rate=<MB/s>&disk=<MB/s>&fifo=<MiB>]
+
+      @return false if the address is not of this form
+    */
+    static bool parseAddress(const std::string &address, Config &config);
+
+    explicit SimulatedRecorder(const Config &config = Config());
+    virtual ~SimulatedRecorder();
+
+    virtual int setIntChannelSyncControl(int mode);
+    virtual int setIntChannelSync(uint32_t iDevice, int masterMask, int action);
+    virtual int setChannelSyncOutput(uint32_t iDevice, int signal, int source);
+    virtual int reset();
+    virtual int create(std::string path, std::string name, uint32_t iDevice, uint32_t iPort, uint32_t &id);
+    virtual int open(std::string path, std::string name, uint32_t iDevice, uint32_t iPort, int mode, uint32_t &id);
+    virtual int destroy(uint32_t id);
+    virtual int setCRC(uint32_t id, bool enableCRC);
+    virtual int setCopyMode(uint32_t id, bool enable);
+    virtual int setWaitForSync(uint32_t id, int mode);
+    virtual int setMaxSize(uint32_t id, uint64_t sizeInBytes);
+    virtual int setLinkSpeed(uint32_t id, int speed);
+    virtual int setFlowControl(uint32_t id, bool enable);
+    virtual int setRateControl(uint32_t id, int cycleSize, uint32_t cyclePartsForTx);
+    virtual int setSimplexLinkMode(uint32_t id, bool enable);
+    virtual int setChannelSyncSource(uint32_t id, int source);
+    virtual int setSwapping(uint32_t id, bool enable8in16, bool enable16in32);
+    virtual int getStatus(uint32_t id, uint64_t &numBytes, std::string &state);
+    virtual int checkForOverflow(uint32_t id, bool &detected, bool clear);
+    virtual int startAll();
+    virtual int stopAll();
+
+    /** Switches the sender on a port on or off, e.g. to make a session go 'Idle' */
+    void setSourceActive(uint32_t iDevice, uint32_t iPort, bool isActive);
+
+    /** The local directory that stands for a recorder directory */
+    std::string getLocalPath(const std::string &path) const;
+
+private:
+    SimulatedRecorder(const SimulatedRecorder &);
+    SimulatedRecorder &operator=(const SimulatedRecorder &);
+
+    enum State { READY, ACTIVE, MAXED_OUT, END_OF_FILE, ALL_TRANSMITTED, STOPPED };
+
+    struct Session
+    {
+        bool isRecording;
+        std::string path;                 // Directory and base name, as given by the client
+        uint32_t port;                    // Device and port, as one index
+        State state;
+        uint64_t numBytes;
+
+        bool crc;
+        bool copyMode;
+        bool waitForSync;
+        bool flowControl;
+        bool simplexLink;
+        bool swap8in16;
+        bool swap16in32;
+        uint64_t maxSizeInBytes;
+        int playbackMode;
+        int cycleSize;
+        uint32_t cyclePartsForTx;
+        int syncSource;
+
+        FILE *dataFile;                   // Written when recording, read when playing back
+        FILE *indexFile;
+        FILE *metaFile;
+
+        // Recording
+        double backlogInBytes;            // Received, not yet written
+        uint64_t sourceOffset;            // Bytes sent by the source since the start
+        uint32_t nextWord;                // Counter of the next word the source sends
+        uint64_t nextSyncOffset;          // Offset in the data file of the next SYNC
+        bool overflowDetected;
+        bool isSynchronized;
+        double lastDataInS;
+        std::minstd_rand random;          // Decides which frames have CRC errors
+
+        // Playback
+        uint64_t fileSize;
+        uint64_t readOffset;
+        double creditInBytes;             // Bytes the link may send, but were not sent yet
+        std::vector<std::pair<double, uint64_t> > timing;   // Time since the first record, and data offset
+    };
+
+    struct Port
+    {
+        Port() : linkSpeed(GEC_SFPDP_2_5_GBPS), isSourceActive(true) {}
+
+        int linkSpeed;
+        bool isSourceActive;
+    };
+
+    Session *findSession(uint32_t id);
+    bool isAnyActive() const;
+    bool isPortUsed(uint32_t port, bool isRecording, uint32_t exceptId) const;
+    double getSourceRate(const Session &session, double nowInS) const;
+    uint64_t getTimerTicks(const Session &session, double nowInS) const;
+    void run();
+    void step(double nowInS, double elapsedInS);
+    void stepRecording(Session &session, double nowInS, double elapsedInS, double diskBytes);
+    void stepPlayback(Session &session, double nowInS, double elapsedInS);
+    void writeData(Session &session, uint64_t numBytes, double nowInS);
+    void closeFiles(Session &session);
+
+    Config m_config;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::map<uint32_t, Session> m_sessions;
+    std::vector<Port> m_ports;
+    uint32_t m_nextId;
+
+    int m_intChannelSyncControl;
+    double m_masterStartInS[4];           // When each internal master was started, or < 0
+    double m_masterRunInS[4];             // Running time of each internal master before it was paused
+    double m_startInS;                    // Of the last startAll()
+
+    bool m_isStopping;
+    std::thread m_thread;
+};
+
+#endif // SIMULATEDRECORDER_H
@@ -0,0 +1,400 @@
+#include "socketrecorder.h"
+
+#include <algorithm>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "inc/GE_Defines.h"
+
+const size_t SocketRecorder::pipelineWindow;
+
+SocketRecorder::SocketRecorder(const std::string &path)
+    : m_path(path)
+    , m_port(0)
+    , m_fd(-1)
+    , m_sequence(0)
+{
+}
+
+SocketRecorder::SocketRecorder(const std::string &host, uint16_t port)
+    : m_host(host)
+    , m_port(port)
+    , m_fd(-1)
+    , m_sequence(0)
+{
+}
+
+SocketRecorder::~SocketRecorder()
+{
+    disconnect();
+}
+
+int SocketRecorder::connect()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return connectLocked();
+}
+
+int SocketRecorder::connectLocked()
+{
+    if (m_fd >= 0) {
+        return GE_OK;
+    }
+
+    if (!m_path.empty()) {
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (m_path.size() >= sizeof(address.sun_path)) {
+            return GE_COMMFAIL;
+        }
+        strcpy(address.sun_path, m_path.c_str());
+        m_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (m_fd >= 0 && ::connect(m_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+            disconnect();
+        }
+        return (m_fd >= 0) ? GE_OK : GE_COMMFAIL;
+    }
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *addresses = NULL;
+    std::string port = std::to_string(m_port);
+    if (getaddrinfo(m_host.c_str(), port.c_str(), &hints, &addresses) != 0) {
+        return GE_COMMFAIL;
+    }
+    for (addrinfo *address = addresses; address != NULL && m_fd < 0; address = address->ai_next) {
+        m_fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+        if (m_fd >= 0 && ::connect(m_fd, address->ai_addr, address->ai_addrlen) != 0) {
+            disconnect();
+        }
+    }
+    freeaddrinfo(addresses);
+    if (m_fd < 0) {
+        return GE_COMMFAIL;
+    }
+
+    // A request is one small frame; Nagle would hold it back until the previous response is acknowledged
+    int on = 1;
+    setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    return GE_OK;
+}
+
+void SocketRecorder::disconnect()
+{
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+    m_input.clear();
+}
+
+int SocketRecorder::sendAll(const std::string &data)
+{
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t numSent = send(m_fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+        if (numSent <= 0) {
+            disconnect();
+            return GE_COMMFAIL;
+        }
+        offset += numSent;
+    }
+    return GE_OK;
+}
+
+int SocketRecorder::receiveFrame()
+{
+    char buffer[4096];
+    for (;;) {
+        int64_t frameSize = RecorderProtocol::getFrameSize(m_input.data(), m_input.size());
+        if (frameSize < 0) {
+            disconnect();
+            return GE_COMMFAIL;
+        }
+        if (frameSize > 0 && m_input.size() >= static_cast<size_t>(frameSize)) {
+            m_response.assign(m_input, 0, static_cast<size_t>(frameSize));
+            m_input.erase(0, static_cast<size_t>(frameSize));
+            return GE_OK;
+        }
+        ssize_t numRead = recv(m_fd, buffer, sizeof(buffer), 0);
+        if (numRead <= 0) {
+            disconnect();
+            return GE_COMMFAIL;
+        }
+        m_input.append(buffer, numRead);
+    }
+}
+
+int SocketRecorder::call(RecorderProtocol::Writer &request)
+{
+    if (connectLocked() != GE_OK || sendAll(request.finish()) != GE_OK || receiveFrame() != GE_OK) {
+        return GE_COMMFAIL;
+    }
+
+    // Responses come in the order of the requests, so any other sequence number is an error
+    RecorderProtocol::Reader response(m_response.data(), m_response.size());
+    if (!response.isValid() || response.getSequence() != m_sequence) {
+        disconnect();
+        return GE_COMMFAIL;
+    }
+    return response.getMethodOrRc();
+}
+
+int SocketRecorder::callPipelined(const std::vector<std::string> &requests, std::vector<std::string> &responses)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    responses.clear();
+    if (connectLocked() != GE_OK) {
+        return GE_COMMFAIL;
+    }
+
+    for (size_t first = 0; first < requests.size(); first += pipelineWindow) {
+        size_t last = std::min(first + pipelineWindow, requests.size());
+        uint32_t firstSequence = m_sequence + 1;
+        std::string window;
+        for (size_t i = first; i < last; ++i) {
+            // The sequence number is the second field of every frame
+            std::string frame = requests[i];
+            uint32_t sequence = ++m_sequence;
+            for (int b = 0; b < 4 && frame.size() >= 8; ++b) {
+                frame[4 + b] = static_cast<char>(sequence >> (8 * b));
+            }
+            window += frame;
+        }
+        if (sendAll(window) != GE_OK) {
+            return GE_COMMFAIL;
+        }
+
+        for (size_t i = first; i < last; ++i) {
+            if (receiveFrame() != GE_OK) {
+                return GE_COMMFAIL;
+            }
+            RecorderProtocol::Reader response(m_response.data(), m_response.size());
+            if (!response.isValid() || response.getSequence() != firstSequence + (i - first)) {
+                disconnect();
+                return GE_COMMFAIL;
+            }
+            responses.push_back(m_response);
+        }
+    }
+    return GE_OK;
+}
+
+int SocketRecorder::setIntChannelSyncControl(int mode)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::SET_INT_CHANNEL_SYNC_CONTROL);
+    request.putI32(mode);
+    return call(request);
+}
+
+int SocketRecorder::setIntChannelSync(uint32_t iDevice, int masterMask, int action)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::SET_INT_CHANNEL_SYNC);
+    request.putU32(iDevice);
+    request.putI32(masterMask);
+    request.putI32(action);
+    return call(request);
+}
+
+int SocketRecorder::setChannelSyncOutput(uint32_t iDevice, int signal, int source)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::SET_CHANNEL_SYNC_OUTPUT);
+    request.putU32(iDevice);
+    request.putI32(signal);
+    request.putI32(source);
+    return call(request);
+}
+
+int SocketRecorder::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::RESET);
+    return call(request);
+}
+
+int SocketRecorder::create(std::string path, std::string name, uint32_t iDevice, uint32_t iPort, uint32_t &id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::CREATE);
+    request.putString(path);
+    request.putString(name);
+    request.putU32(iDevice);
+    request.putU32(iPort);
+    int rc = call(request);
+    if (rc == GE_OK) {
+        RecorderProtocol::Reader response(m_response.data(), m_response.size());
+        id = response.getU32();
+    }
+    return rc;
+}
+
+int SocketRecorder::open(std::string path, std::string name, uint32_t iDevice, uint32_t iPort, int mode, uint32_t &id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::OPEN);
+    request.putString(path);
+    request.putString(name);
+    request.putU32(iDevice);
+    request.putU32(iPort);
+    request.putI32(mode);
+    int rc = call(request);
+    if (rc == GE_OK) {
+        RecorderProtocol::Reader response(m_response.data(), m_response.size());
+        id = response.getU32();
+    }
+    return rc;
+}
+
+int SocketRecorder::destroy(uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::DESTROY);
+    request.putU32(id);
+    return call(request);
+}
+
+int SocketRecorder::setCRC(uint32_t id, bool enableCRC)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::SET_CRC);
+    request.putU32(id);
+    request.putBool(enableCRC);
+    return call(request);
+}
+
+int SocketRecorder::setCopyMode(uint32_t id, bool enable)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::SET_COPY_MODE);
+    request.putU32(id);
+    request.putBool(enable);
+    return call(request);
+}
+
+int SocketRecorder::setWaitForSync(uint32_t id, int mode)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::SET_WAIT_FOR_SYNC);
+    request.putU32(id);
+    request.putI32(mode);
+    return call(request);
+}
+
+int SocketRecorder::setMaxSize(uint32_t id, uint64_t sizeInBytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::SET_MAX_SIZE);
+    request.putU32(id);
+    request.putU64(sizeInBytes);
+    return call(request);
+}
+
+int SocketRecorder::setLinkSpeed(uint32_t id, int speed)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::SET_LINK_SPEED);
+    request.putU32(id);
+    request.putI32(speed);
+    return call(request);
+}
+
+int SocketRecorder::setFlowControl(uint32_t id, bool enable)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::SET_FLOW_CONTROL);
+    request.putU32(id);
+    request.putBool(enable);
+    return call(request);
+}
+
+int SocketRecorder::setRateControl(uint32_t id, int cycleSize, uint32_t cyclePartsForTx)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::SET_RATE_CONTROL);
+    request.putU32(id);
+    request.putI32(cycleSize);
+    request.putU32(cyclePartsForTx);
+    return call(request);
+}
+
+int SocketRecorder::setSimplexLinkMode(uint32_t id, bool enable)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::SET_SIMPLEX_LINK_MODE);
+    request.putU32(id);
+    request.putBool(enable);
+    return call(request);
+}
+
+int SocketRecorder::setChannelSyncSource(uint32_t id, int source)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::SET_CHANNEL_SYNC_SOURCE);
+    request.putU32(id);
+    request.putI32(source);
+    return call(request);
+}
+
+int SocketRecorder::setSwapping(uint32_t id, bool enable8in16, bool enable16in32)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::SET_SWAPPING);
+    request.putU32(id);
+    request.putBool(enable8in16);
+    request.putBool(enable16in32);
+    return call(request);
+}
+
+int SocketRecorder::getStatus(uint32_t id, uint64_t &numBytes, std::string &state)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::GET_STATUS);
+    request.putU32(id);
+    int rc = call(request);
+    if (rc == GE_OK) {
+        RecorderProtocol::Reader response(m_response.data(), m_response.size());
+        numBytes = response.getU64();
+        state = response.getString();
+    }
+    return rc;
+}
+
+int SocketRecorder::checkForOverflow(uint32_t id, bool &detected, bool clear)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::CHECK_FOR_OVERFLOW);
+    request.putU32(id);
+    request.putBool(clear);
+    int rc = call(request);
+    if (rc == GE_OK) {
+        RecorderProtocol::Reader response(m_response.data(), m_response.size());
+        detected = response.getBool();
+    }
+    return rc;
+}
+
+int SocketRecorder::startAll()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::START_ALL);
+    return call(request);
+}
+
+int SocketRecorder::stopAll()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecorderProtocol::Writer request(++m_sequence, RecorderProtocol::STOP_ALL);
+    return call(request);
+}
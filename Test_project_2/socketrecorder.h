@@ -0,0 +1,97 @@
+#ifndef SOCKETRECORDER_H
+#define SOCKETRECORDER_H
+
+#include <stdint.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "recorderprotocol.h"
+
+/**
+  GEC_ISfpdpRecorder client of a server speaking RecorderProtocol, over a
+  Unix socket or TCP
+
+  Software running on the recorder itself reaches the server through the
+  Unix socket, without the TCP loopback stack. TCP is there for
+  comparison and for remote clients of the stand-in server.
+
+  Each call is one blocking round trip. The connection is made by the
+  first call and made again by the call after one that lost it; calls
+  that cannot reach the server return GE_COMMFAIL. Calls from several
+  threads are serialized. POSIX only.
+*/
+class SocketRecorder : public GEC_ISfpdpRecorder
+{
+public:
+    /** Connects to the Unix socket at @p path */
+    explicit SocketRecorder(const std::string &path);
+    /** Connects over TCP */
+    SocketRecorder(const std::string &host, uint16_t port);
+    virtual ~SocketRecorder();
+
+    virtual int setIntChannelSyncControl(int mode);
+    virtual int setIntChannelSync(uint32_t iDevice, int masterMask, int action);
+    virtual int setChannelSyncOutput(uint32_t iDevice, int signal, int source);
+    virtual int reset();
+    virtual int create(std::string path, std::string name, uint32_t iDevice, uint32_t iPort, uint32_t &id);
+    virtual int open(std::string path, std::string name, uint32_t iDevice, uint32_t iPort, int mode, uint32_t &id);
+    virtual int destroy(uint32_t id);
+    virtual int setCRC(uint32_t id, bool enableCRC);
+    virtual int setCopyMode(uint32_t id, bool enable);
+    virtual int setWaitForSync(uint32_t id, int mode);
+    virtual int setMaxSize(uint32_t id, uint64_t sizeInBytes);
+    virtual int setLinkSpeed(uint32_t id, int speed);
+    virtual int setFlowControl(uint32_t id, bool enable);
+    virtual int setRateControl(uint32_t id, int cycleSize, uint32_t cyclePartsForTx);
+    virtual int setSimplexLinkMode(uint32_t id, bool enable);
+    virtual int setChannelSyncSource(uint32_t id, int source);
+    virtual int setSwapping(uint32_t id, bool enable8in16, bool enable16in32);
+    virtual int getStatus(uint32_t id, uint64_t &numBytes, std::string &state);
+    virtual int checkForOverflow(uint32_t id, bool &detected, bool clear);
+    virtual int startAll();
+    virtual int stopAll();
+
+    /** Connects now rather than on the first call. @return GE_OK or GE_COMMFAIL */
+    int connect();
+
+    /**
+      Sends RecorderProtocol request frames without waiting for each
+      response, and returns the responses in the same order
+
+      The requests are sent in windows of pipelineWindow requests, so a
+      batch costs one round trip per window instead of one per call. The
+      sequence numbers of the requests are replaced.
+
+      @return GE_OK, or GE_COMMFAIL if the connection failed; then
+      @p responses holds the responses received before
+    */
+    int callPipelined(const std::vector<std::string> &requests, std::vector<std::string> &responses);
+
+    static const size_t pipelineWindow = 64;
+
+private:
+    SocketRecorder(const SocketRecorder &);
+    SocketRecorder &operator=(const SocketRecorder &);
+
+    /** Sends @p request and leaves the response frame in m_response. @return Its rc */
+    int call(RecorderProtocol::Writer &request);
+    int connectLocked();
+    int sendAll(const std::string &data);
+    /** Reads until m_input holds a whole frame, and moves it to m_response */
+    int receiveFrame();
+    void disconnect();
+
+    std::string m_path;                  // Unix socket, or empty for TCP
+    std::string m_host;
+    uint16_t m_port;
+
+    std::mutex m_mutex;
+    int m_fd;
+    uint32_t m_sequence;
+    std::string m_input;                 // Received, not yet taken as a response
+    std::string m_response;              // Of the last call
+};
+
+#endif // SOCKETRECORDER_H
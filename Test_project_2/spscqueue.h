@@ -0,0 +1,82 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+
+/**
+  Bounded queue for one producer thread and one consumer thread, without
+  locks
+
+  The slots are a ring of a power of two in size, allocated once. The
+  producer only writes the tail index and the consumer only the head
+  index, each published with release and read with acquire ordering, so
+  neither ever waits for the other. push() fails when the queue is full
+  rather than blocking the producer.
+
+  Items are copied into and out of their slots; T must be default
+  constructible and copy assignable.
+*/
+template<typename T>
+class SpscQueue
+{
+public:
+    /** Holds at least @p capacity items */
+    explicit SpscQueue(size_t capacity)
+        : m_head(0)
+        , m_tail(0)
+    {
+        size_t size = 2;
+        while (size < capacity + 1) {
+            size *= 2;
+        }
+        m_slots.resize(size);
+        m_mask = size - 1;
+    }
+
+    /** Producer only. @return false if the queue is full */
+    bool push(const T &item)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t next = (tail + 1) & m_mask;
+        if (next == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        m_slots[tail] = item;
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer only. @return false if the queue is empty */
+    bool pop(T &item)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = m_slots[head];
+        m_head.store((head + 1) & m_mask, std::memory_order_release);
+        return true;
+    }
+
+    /** Either thread; only a snapshot while the other one is running */
+    bool isEmpty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    SpscQueue(const SpscQueue &);
+    SpscQueue &operator=(const SpscQueue &);
+
+    std::vector<T> m_slots;
+    size_t m_mask;
+    // Padded apart, so the two threads do not invalidate each other's cache line with every item
+    char m_padding1[64];
+    std::atomic<size_t> m_head;
+    char m_padding2[64];
+    std::atomic<size_t> m_tail;
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,264 @@
+#include "startorchestrator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <set>
+#include <thread>
+
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "inc/GE_Defines.h"
+
+static double getTimeInS()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/** Runs @p function for every index on a thread of its own, and waits for all of them */
+static void runConcurrently(size_t count, const std::function<void(size_t)> &function)
+{
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < count; ++i) {
+        threads.push_back(std::thread(function, i));
+    }
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+}
+
+/**
+  Lets waiting threads go at the same moment
+
+  The threads spin rather than sleep on a condition variable, as waking
+  sleeping threads one by one would add the scheduler's latency for
+  each of them to the skew. They yield while spinning, so more threads
+  than cores still make progress.
+*/
+class StartBarrier
+{
+public:
+    StartBarrier() : m_numArrived(0), m_isOpen(false) {}
+
+    void arriveAndWait()
+    {
+        m_numArrived.fetch_add(1, std::memory_order_acq_rel);
+        while (!m_isOpen.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    /** Waits until @p count threads arrived, and lets them go */
+    void open(size_t count)
+    {
+        while (m_numArrived.load(std::memory_order_acquire) < count) {
+            std::this_thread::yield();
+        }
+        m_isOpen.store(true, std::memory_order_release);
+    }
+
+private:
+    std::atomic<size_t> m_numArrived;
+    std::atomic<bool> m_isOpen;
+};
+
+static std::set<uint32_t> getDevices(const std::vector<ProfileEngine::Assignment> &assignments)
+{
+    std::set<uint32_t> devices;
+    for (size_t i = 0; i < assignments.size(); ++i) {
+        devices.insert(assignments[i].iDevice);
+    }
+    return devices;
+}
+
+StartOrchestrator::StartOrchestrator(const SessionProfiles &profiles)
+    : m_profiles(profiles)
+    , m_isManualSync(false)
+    , m_masterMask(GEC_SFPDP_INTERNAL_CHANNEL_SYNC_MASTER_0)
+    , m_isConcurrent(true)
+    , m_numWarmUpCalls(5)
+{
+}
+
+void StartOrchestrator::addRecorder(const std::string &name, GEC_ISfpdpRecorder *recorder,
+                                    const std::vector<ProfileEngine::Assignment> &assignments)
+{
+    RecorderResult result;
+    result.name = name;
+    result.recorder = recorder;
+    result.assignments = assignments;
+    m_recorders.push_back(result);
+}
+
+void StartOrchestrator::setManualSync(bool enable, int masterMask)
+{
+    m_isManualSync = enable;
+    m_masterMask = masterMask;
+}
+
+int StartOrchestrator::arm(Report &report)
+{
+    report = Report();
+    report.isConcurrent = m_isConcurrent;
+    report.isManualSync = m_isManualSync;
+
+    runConcurrently(m_recorders.size(), [this](size_t i) {
+        RecorderResult &result = m_recorders[i];
+        // Before the sessions, as a recorder only lets them take SYNC from a master under manual control
+        int mode = m_isManualSync ? GEC_SFPDP_MANUAL_CONTROL : GEC_SFPDP_AUTOMATIC_CONTROL;
+        result.rc = result.recorder->setIntChannelSyncControl(mode);
+        if (result.rc == GE_OK) {
+            ProfileEngine engine(m_profiles);
+            result.rc = engine.arm(result.recorder, result.assignments, result.arm);
+        }
+    });
+
+    for (size_t i = 0; i < m_recorders.size() && report.rc == GE_OK; ++i) {
+        report.rc = m_recorders[i].rc;
+    }
+    // All or nothing: a recorder that armed is no use if another one did not
+    if (report.rc != GE_OK) {
+        runConcurrently(m_recorders.size(), [this](size_t i) {
+            disarm(m_recorders[i]);
+            if (m_isManualSync) {
+                m_recorders[i].recorder->setIntChannelSyncControl(GEC_SFPDP_AUTOMATIC_CONTROL);
+            }
+        });
+    }
+    report.recorders = m_recorders;
+    return report.rc;
+}
+
+int StartOrchestrator::start(Report &report)
+{
+    report.isConcurrent = m_isConcurrent;
+    report.isManualSync = m_isManualSync;
+    StartBarrier startBarrier;
+    StartBarrier syncBarrier;
+    std::atomic<size_t> turn(0);
+    std::atomic<size_t> numStarted(0);
+
+    std::thread releaser([&]() {
+        startBarrier.open(m_recorders.size());
+        if (m_isManualSync) {
+            while (numStarted.load(std::memory_order_acquire) < m_recorders.size()) {
+                std::this_thread::yield();
+            }
+            syncBarrier.open(m_recorders.size());
+        }
+    });
+
+    runConcurrently(m_recorders.size(), [&](size_t i) {
+        RecorderResult &result = m_recorders[i];
+        GEC_ISfpdpRecorder *recorder = result.recorder;
+        result.syncRc = GE_OK;
+
+        // Warm-up calls open the connection, and fill caches on both ends
+        uint32_t id = result.arm.sessions.empty() ? 0 : result.arm.sessions.front().id;
+        std::vector<double> roundTripsInUs;
+        for (int k = 0; k < m_numWarmUpCalls; ++k) {
+            uint64_t numBytes = 0;
+            std::string state;
+            double beforeInS = getTimeInS();
+            recorder->getStatus(id, numBytes, state);
+            roundTripsInUs.push_back(1e6 * (getTimeInS() - beforeInS));
+        }
+        if (!roundTripsInUs.empty()) {
+            std::sort(roundTripsInUs.begin(), roundTripsInUs.end());
+            result.roundTripInUs = roundTripsInUs[roundTripsInUs.size() / 2];
+        }
+
+        startBarrier.arriveAndWait();
+        if (!m_isConcurrent) {
+            while (turn.load(std::memory_order_acquire) != i) {
+                std::this_thread::yield();
+            }
+        }
+        result.sendInS = getTimeInS();
+        result.rc = recorder->startAll();
+        result.returnInS = getTimeInS();
+        result.startInS = result.sendInS + result.roundTripInUs / 2e6;
+        turn.store(i + 1, std::memory_order_release);
+        numStarted.fetch_add(1, std::memory_order_acq_rel);
+
+        if (m_isManualSync) {
+            syncBarrier.arriveAndWait();
+            std::set<uint32_t> devices = getDevices(result.assignments);
+            result.syncSendInS = getTimeInS();
+            result.syncInS = result.syncSendInS + result.roundTripInUs / 2e6;
+            std::set<uint32_t>::const_iterator it;
+            for (it = devices.begin(); it != devices.end() && result.syncRc == GE_OK; ++it) {
+                result.syncRc = recorder->setIntChannelSync(*it, m_masterMask, GEC_SFPDP_START_CHANNEL_SYNC);
+            }
+        }
+    });
+    releaser.join();
+
+    report.rc = GE_OK;
+    for (size_t i = 0; i < m_recorders.size() && report.rc == GE_OK; ++i) {
+        report.rc = (m_recorders[i].rc != GE_OK) ? m_recorders[i].rc : m_recorders[i].syncRc;
+    }
+    report.recorders = m_recorders;
+    computeSkews(report);
+    return report.rc;
+}
+
+int StartOrchestrator::stop(Report &report)
+{
+    std::vector<int> rcs(m_recorders.size(), GE_OK);
+    runConcurrently(m_recorders.size(), [this, &rcs](size_t i) {
+        RecorderResult &result = m_recorders[i];
+        rcs[i] = result.recorder->stopAll();
+        if (m_isManualSync) {
+            std::set<uint32_t> devices = getDevices(result.assignments);
+            std::set<uint32_t>::const_iterator it;
+            for (it = devices.begin(); it != devices.end(); ++it) {
+                result.recorder->setIntChannelSync(*it, m_masterMask, GEC_SFPDP_STOP_CHANNEL_SYNC);
+            }
+            result.recorder->setIntChannelSyncControl(GEC_SFPDP_AUTOMATIC_CONTROL);
+        }
+        disarm(result);
+    });
+
+    report.rc = GE_OK;
+    for (size_t i = 0; i < rcs.size() && report.rc == GE_OK; ++i) {
+        report.rc = rcs[i];
+    }
+    report.recorders = m_recorders;
+    return report.rc;
+}
+
+void StartOrchestrator::disarm(RecorderResult &result)
+{
+    for (size_t i = 0; i < result.arm.sessions.size(); ++i) {
+        ProfileEngine::SessionResult &session = result.arm.sessions[i];
+        if (session.rc == GE_OK) {
+            result.recorder->destroy(session.id);
+            session.rc = GE_NOT_EXISTING;
+        }
+    }
+}
+
+void StartOrchestrator::computeSkews(Report &report)
+{
+    if (report.recorders.empty()) {
+        return;
+    }
+    const RecorderResult &first = report.recorders.front();
+    double minimumSendInS = first.sendInS, maximumSendInS = first.sendInS;
+    double minimumStartInS = first.startInS, maximumStartInS = first.startInS;
+    double minimumSyncInS = first.syncInS, maximumSyncInS = first.syncInS;
+    for (size_t i = 0; i < report.recorders.size(); ++i) {
+        const RecorderResult &result = report.recorders[i];
+        minimumSendInS = std::min(minimumSendInS, result.sendInS);
+        maximumSendInS = std::max(maximumSendInS, result.sendInS);
+        minimumStartInS = std::min(minimumStartInS, result.startInS);
+        maximumStartInS = std::max(maximumStartInS, result.startInS);
+        minimumSyncInS = std::min(minimumSyncInS, result.syncInS);
+        maximumSyncInS = std::max(maximumSyncInS, result.syncInS);
+        report.longestCallInUs = std::max(report.longestCallInUs, 1e6 * (result.returnInS - result.sendInS));
+    }
+    report.releaseSkewInUs = 1e6 * (maximumSendInS - minimumSendInS);
+    report.startSkewInUs = 1e6 * (maximumStartInS - minimumStartInS);
+    report.syncSkewInUs = report.isManualSync ? 1e6 * (maximumSyncInS - minimumSyncInS) : 0;
+}
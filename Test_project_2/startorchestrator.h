@@ -0,0 +1,119 @@
+#ifndef STARTORCHESTRATOR_H
+#define STARTORCHESTRATOR_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "profileengine.h"
+
+class GEC_ISfpdpRecorder;
+
+/**
+  Starts the sessions of several recorders at the same moment, and
+  measures how far apart the starts were
+
+  Calling startAll() on one recorder after the other starts the last
+  one several round trips after the first. The orchestrator starts them
+  in three steps:
+
+  - arm(): all sessions of all recorders are armed from their profiles
+    by a ProfileEngine, one thread per recorder. If one recorder fails,
+    the sessions armed on the others are destroyed again.
+  - start(): each thread first makes a few getStatus() calls, which
+    open the connection and warm it, and gives the round trip time.
+    The threads then wait at a barrier that releases them all at once,
+    and each calls startAll() on its recorder.
+  - Optionally, the internal channel sync masters are under manual
+    control (setIntChannelSyncControl()). Then startAll() only arms the
+    sessions, which wait for the first SYNC, and a second barrier
+    starts the masters of all recorders with setIntChannelSync(). The
+    recordings start at the first SYNC, so this lines them up even if
+    the startAll() calls were not simultaneous.
+
+  Each recorder is assumed to act on a call half a warm round trip after
+  it was sent. The start skew is the spread of these estimated times
+  across recorders; the release skew is the spread of the send times,
+  i.e. the part the barrier is responsible for. The estimate cannot see
+  differences in how fast the recorders process the call.
+
+  The recorder instances must stay valid and must not be used by other
+  threads until start() returns.
+*/
+class StartOrchestrator
+{
+public:
+    struct RecorderResult
+    {
+        RecorderResult()
+            : recorder(NULL), rc(0), roundTripInUs(0), sendInS(0), returnInS(0), startInS(0)
+            , syncRc(0), syncSendInS(0), syncInS(0) {}
+
+        std::string name;
+        GEC_ISfpdpRecorder *recorder;
+        std::vector<ProfileEngine::Assignment> assignments;
+        ProfileEngine::Report arm;
+        int rc;                          // Of arming, setIntChannelSyncControl(), or startAll()
+        double roundTripInUs;            // Median of the warm-up calls
+        double sendInS;                  // Monotonic time startAll() was called
+        double returnInS;
+        double startInS;                 // Estimated time the recorder started
+        int syncRc;                      // Of setIntChannelSync(), with manual sync
+        double syncSendInS;
+        double syncInS;                  // Estimated time the sync masters started
+    };
+
+    struct Report
+    {
+        Report() : rc(0), isConcurrent(true), isManualSync(false), releaseSkewInUs(0), startSkewInUs(0)
+            , syncSkewInUs(0), longestCallInUs(0) {}
+
+        int rc;                          // GE_OK, or the first error of a recorder
+        bool isConcurrent;
+        bool isManualSync;
+        double releaseSkewInUs;          // Spread of the startAll() send times
+        double startSkewInUs;            // Spread of the estimated start times
+        double syncSkewInUs;             // Spread of the estimated sync master start times
+        double longestCallInUs;          // Of the startAll() calls
+        std::vector<RecorderResult> recorders;
+    };
+
+    explicit StartOrchestrator(const SessionProfiles &profiles);
+
+    /** Adds a recorder and the sessions to arm on it. @p recorder is not owned */
+    void addRecorder(const std::string &name, GEC_ISfpdpRecorder *recorder,
+                     const std::vector<ProfileEngine::Assignment> &assignments);
+
+    /**
+      Starts the internal sync masters in @p masterMask of every device
+      used, from a barrier after all recorders were started. The
+      profiles should wait for SYNC and take it from these masters.
+    */
+    void setManualSync(bool enable, int masterMask);
+    /** Without concurrency, startAll() is called on one recorder after the other, for comparison */
+    void setConcurrent(bool enable) { m_isConcurrent = enable; }
+    void setNumWarmUpCalls(int numCalls) { m_numWarmUpCalls = numCalls; }
+
+    /** @return GE_OK, or the first error; then no sessions are left on any recorder */
+    int arm(Report &report);
+    /** Call after arm() succeeded. @return GE_OK, or the first error of a recorder */
+    int start(Report &report);
+    /** Stops all recorders concurrently, and destroys the sessions armed on them */
+    int stop(Report &report);
+
+private:
+    StartOrchestrator(const StartOrchestrator &);
+    StartOrchestrator &operator=(const StartOrchestrator &);
+
+    void disarm(RecorderResult &result);
+    static void computeSkews(Report &report);
+
+    const SessionProfiles &m_profiles;
+    std::vector<RecorderResult> m_recorders;
+    bool m_isManualSync;
+    int m_masterMask;
+    bool m_isConcurrent;
+    int m_numWarmUpCalls;
+};
+
+#endif // STARTORCHESTRATOR_H
@@ -0,0 +1,143 @@
+#include "syncindex.h"
+
+#include <algorithm>
+
+#include "GEC_RecordingFormat.h"
+#include "inc/GE_Defines.h"
+#include "mappedfile.h"
+
+SyncIndex::SyncIndex()
+{
+}
+
+int SyncIndex::load(const std::string &path)
+{
+    clear();
+    MappedFile file;
+    file.setAccess(MappedFile::SEQUENTIAL_ACCESS);
+    int rc = file.open(path);
+    if (rc != GE_OK) {
+        return rc;
+    }
+
+    uint64_t numEntries = file.getSize() / sizeof(GEC_IndexEntry);
+    m_syncOffsets.reserve(static_cast<size_t>(numEntries));
+    uint64_t offset = 0;
+    uint64_t end = numEntries * sizeof(GEC_IndexEntry);
+    while (offset < end) {
+        uint64_t numMapped = 0;
+        const uint8_t *bytes = file.map(offset, end - offset, numMapped);
+        if (bytes == NULL) {
+            clear();
+            return GE_ERROR;
+        }
+        // Windows start at page boundaries, so the entries are aligned
+        const GEC_IndexEntry *entries = reinterpret_cast<const GEC_IndexEntry *>(bytes);
+        uint64_t count = std::min(numMapped, end - offset) / sizeof(GEC_IndexEntry);
+        for (uint64_t i = 0; i < count; ++i) {
+            if (entries[i].event == GEC_INDEX_EVENT_SYNC) {
+                m_syncOffsets.push_back(entries[i].dataOffset);
+            } else if (entries[i].event == GEC_INDEX_EVENT_CRC_ERROR) {
+                m_crcErrorOffsets.push_back(entries[i].dataOffset);
+            }
+        }
+        offset += count * sizeof(GEC_IndexEntry);
+    }
+
+    // The recorder writes the events in order, so this only costs a pass over them
+    if (!std::is_sorted(m_syncOffsets.begin(), m_syncOffsets.end())) {
+        std::sort(m_syncOffsets.begin(), m_syncOffsets.end());
+    }
+    if (!std::is_sorted(m_crcErrorOffsets.begin(), m_crcErrorOffsets.end())) {
+        std::sort(m_crcErrorOffsets.begin(), m_crcErrorOffsets.end());
+    }
+    m_syncOffsets.shrink_to_fit();
+    return GE_OK;
+}
+
+void SyncIndex::clear()
+{
+    std::vector<uint64_t>().swap(m_syncOffsets);
+    std::vector<uint64_t>().swap(m_crcErrorOffsets);
+}
+
+bool SyncIndex::findSync(uint64_t syncNumber, uint64_t &dataOffset) const
+{
+    if (syncNumber >= m_syncOffsets.size()) {
+        return false;
+    }
+    dataOffset = m_syncOffsets[static_cast<size_t>(syncNumber)];
+    return true;
+}
+
+bool SyncIndex::findSyncAt(uint64_t dataOffset, uint64_t &syncNumber) const
+{
+    std::vector<uint64_t>::const_iterator it = std::upper_bound(m_syncOffsets.begin(), m_syncOffsets.end(),
+                                                                dataOffset);
+    if (it == m_syncOffsets.begin()) {
+        return false;
+    }
+    syncNumber = static_cast<uint64_t>(it - m_syncOffsets.begin()) - 1;
+    return true;
+}
+
+bool SyncIndex::getRange(uint64_t firstSync, uint64_t numFrames, uint64_t dataSize, uint64_t &startOffset,
+                         uint64_t &endOffset) const
+{
+    if (numFrames == 0 || !findSync(firstSync, startOffset)) {
+        return false;
+    }
+    uint64_t endSync = firstSync + std::min(numFrames, m_syncOffsets.size() - firstSync);
+    if (!findSync(endSync, endOffset)) {
+        endOffset = dataSize;
+    }
+    startOffset = std::min(startOffset, dataSize);
+    endOffset = std::max(std::min(endOffset, dataSize), startOffset);
+    return true;
+}
+
+uint64_t SyncIndex::countCrcErrors(uint64_t firstSync, uint64_t numFrames) const
+{
+    uint64_t startOffset = 0;
+    if (numFrames == 0 || !findSync(firstSync, startOffset)) {
+        return 0;
+    }
+    std::vector<uint64_t>::const_iterator first = std::lower_bound(m_crcErrorOffsets.begin(),
+                                                                   m_crcErrorOffsets.end(), startOffset);
+    std::vector<uint64_t>::const_iterator last = m_crcErrorOffsets.end();
+    uint64_t endOffset = 0;
+    if (numFrames <= m_syncOffsets.size() - firstSync && findSync(firstSync + numFrames, endOffset)) {
+        last = std::lower_bound(first, m_crcErrorOffsets.end(), endOffset);
+    }
+    return static_cast<uint64_t>(last - first);
+}
+
+int SyncIndex::write(uint64_t startOffset, uint64_t endOffset, FILE *file, uint64_t &numEntries) const
+{
+    numEntries = 0;
+    std::vector<uint64_t>::const_iterator sync = std::lower_bound(m_syncOffsets.begin(), m_syncOffsets.end(),
+                                                                  startOffset);
+    std::vector<uint64_t>::const_iterator crcError = std::lower_bound(m_crcErrorOffsets.begin(),
+                                                                      m_crcErrorOffsets.end(), startOffset);
+    GEC_IndexEntry entry;
+    entry.reserved = 0;
+    for (;;) {
+        bool hasSync = (sync != m_syncOffsets.end() && *sync < endOffset);
+        bool hasCrcError = (crcError != m_crcErrorOffsets.end() && *crcError < endOffset);
+        if (!hasSync && !hasCrcError) {
+            return GE_OK;
+        }
+        // A CRC error follows the SYNC of its frame
+        if (hasSync && (!hasCrcError || *sync <= *crcError)) {
+            entry.dataOffset = *sync++ - startOffset;
+            entry.event = GEC_INDEX_EVENT_SYNC;
+        } else {
+            entry.dataOffset = *crcError++ - startOffset;
+            entry.event = GEC_INDEX_EVENT_CRC_ERROR;
+        }
+        if (fwrite(&entry, sizeof(entry), 1, file) != 1) {
+            return GE_ERROR;
+        }
+        ++numEntries;
+    }
+}
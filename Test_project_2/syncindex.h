@@ -0,0 +1,72 @@
+#ifndef SYNCINDEX_H
+#define SYNCINDEX_H
+
+#include <stdint.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+  Finds the data of a SYNC frame of a recording from its .idx file
+
+  load() reads the index once, through a MappedFile, and keeps the .dat
+  offsets of its SYNC events, and separately those of its CRC errors,
+  in sorted arrays of 8 bytes per event. SYNCs are numbered from 0 in
+  the order of their offsets, so the offset of a SYNC is an array
+  lookup, and the SYNC at or before a data offset a binary search.
+
+  Frame n is the data from SYNC n up to SYNC n + 1, or the end of the
+  data for the last SYNC. A CRC error belongs to the frame its offset
+  lies in. The byte range of frames is read from the .dat file with a
+  RecordingDataReader, e.g. by RecordingDataReader::write().
+*/
+class SyncIndex
+{
+public:
+    SyncIndex();
+
+    /**
+      Reads the SYNC and CRC error events of the .idx file at @p path.
+      A partial entry at the end, of a recording still being written, is
+      ignored.
+
+      @return GE_OK, GE_NOT_EXISTING, GE_NO_ACCESS, or GE_ERROR
+    */
+    int load(const std::string &path);
+    void clear();
+
+    uint64_t getNumSyncs() const { return m_syncOffsets.size(); }
+    uint64_t getNumCrcErrors() const { return m_crcErrorOffsets.size(); }
+
+    /** @return false if there is no SYNC @p syncNumber */
+    bool findSync(uint64_t syncNumber, uint64_t &dataOffset) const;
+    /** Finds the SYNC of the frame @p dataOffset lies in. @return false if it lies before the first SYNC */
+    bool findSyncAt(uint64_t dataOffset, uint64_t &syncNumber) const;
+
+    /**
+      Byte range of the @p numFrames frames from SYNC @p firstSync on, in
+      a .dat file of @p dataSize bytes
+
+      @return false if there is no SYNC @p firstSync or @p numFrames is 0;
+      fewer frames are returned at the end of the recording
+    */
+    bool getRange(uint64_t firstSync, uint64_t numFrames, uint64_t dataSize, uint64_t &startOffset,
+                  uint64_t &endOffset) const;
+    /** Number of CRC errors in the frames from SYNC @p firstSync to SYNC @p firstSync + @p numFrames */
+    uint64_t countCrcErrors(uint64_t firstSync, uint64_t numFrames) const;
+
+    /**
+      Writes the events of the bytes from @p startOffset to @p endOffset
+      to @p file as .idx entries, with offsets from @p startOffset, in the
+      order the recorder writes them
+
+      @return GE_OK, or GE_ERROR if writing failed
+    */
+    int write(uint64_t startOffset, uint64_t endOffset, FILE *file, uint64_t &numEntries) const;
+
+private:
+    std::vector<uint64_t> m_syncOffsets;
+    std::vector<uint64_t> m_crcErrorOffsets;
+};
+
+#endif // SYNCINDEX_H
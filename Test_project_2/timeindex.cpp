@@ -0,0 +1,199 @@
+#include "timeindex.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "inc/GE_Defines.h"
+#include "mappedfile.h"
+
+namespace
+{
+
+bool isBefore(const GEC_MetaRecord &record, uint64_t dataOffset)
+{
+    return record.dataOffset < dataOffset;
+}
+
+bool isAfter(uint64_t dataOffset, const GEC_MetaRecord &record)
+{
+    return dataOffset < record.dataOffset;
+}
+
+bool hasLowerOffset(const GEC_MetaRecord &a, const GEC_MetaRecord &b)
+{
+    return a.dataOffset < b.dataOffset;
+}
+
+// Linear interpolation of y at x between (x0, y0) and (x1, y1), for x0 <= x < x1
+double interpolate(uint64_t x, uint64_t x0, uint64_t x1, uint64_t y0, uint64_t y1)
+{
+    return static_cast<double>(y0)
+        + static_cast<double>(y1 - y0) * static_cast<double>(x - x0) / static_cast<double>(x1 - x0);
+}
+
+}
+
+TimeIndex::TimeIndex()
+{
+    clear();
+}
+
+int TimeIndex::load(const std::string &path)
+{
+    clear();
+    MappedFile file;
+    file.setAccess(MappedFile::SEQUENTIAL_ACCESS);
+    int rc = file.open(path);
+    if (rc != GE_OK) {
+        return rc;
+    }
+
+    uint64_t numMapped = 0;
+    const uint8_t *bytes = file.map(0, sizeof(GEC_MetaHeader), numMapped);
+    if (bytes == NULL || numMapped < sizeof(GEC_MetaHeader)) {
+        return GE_ERROR;
+    }
+    GEC_MetaHeader header;
+    memcpy(&header, bytes, sizeof(header));
+    if (header.magic != GEC_META_MAGIC || header.version != GEC_META_VERSION) {
+        return GE_ERROR;
+    }
+
+    uint64_t numRecords = (file.getSize() - sizeof(GEC_MetaHeader)) / sizeof(GEC_MetaRecord);
+    m_records.resize(static_cast<size_t>(numRecords));
+    uint64_t offset = sizeof(GEC_MetaHeader);
+    uint64_t numCopied = 0;
+    while (numCopied < numRecords) {
+        uint64_t numBytes = (numRecords - numCopied) * sizeof(GEC_MetaRecord);
+        bytes = file.map(offset, numBytes, numMapped);
+        if (bytes == NULL) {
+            clear();
+            return GE_ERROR;
+        }
+        uint64_t count = std::min(numMapped, numBytes) / sizeof(GEC_MetaRecord);
+        memcpy(&m_records[static_cast<size_t>(numCopied)], bytes, static_cast<size_t>(count * sizeof(GEC_MetaRecord)));
+        numCopied += count;
+        offset += count * sizeof(GEC_MetaRecord);
+    }
+
+    // The recorder writes the records in order, so this only costs a pass over them
+    if (!std::is_sorted(m_records.begin(), m_records.end(), hasLowerOffset)) {
+        std::stable_sort(m_records.begin(), m_records.end(), hasLowerOffset);
+    }
+    m_header = header;
+    m_timesInNs.resize(m_records.size());
+    for (size_t i = 0; i < m_records.size(); ++i) {
+        m_timesInNs[i] = GEC_metaTicksToTimeInNs(m_header, m_records[i].timerTicks);
+        // A timer that stepped back must not break the binary search
+        if (i > 0 && m_timesInNs[i] < m_timesInNs[i - 1]) {
+            m_timesInNs[i] = m_timesInNs[i - 1];
+        }
+    }
+    return GE_OK;
+}
+
+void TimeIndex::clear()
+{
+    memset(&m_header, 0, sizeof(m_header));
+    std::vector<GEC_MetaRecord>().swap(m_records);
+    std::vector<uint64_t>().swap(m_timesInNs);
+}
+
+uint64_t TimeIndex::findOffset(uint64_t timeInNs, bool interpolate, bool roundUp, uint64_t dataSize) const
+{
+    uint64_t endOffset = dataSize - dataSize % GEC_RECORDING_WORD_SIZE;
+    if (m_records.empty()) {
+        return roundUp ? endOffset : 0;
+    }
+
+    // The first record after the time, and the one the time falls into before it
+    size_t next = std::upper_bound(m_timesInNs.begin(), m_timesInNs.end(), timeInNs) - m_timesInNs.begin();
+    if (next == 0) {
+        return std::min(m_records.front().dataOffset, endOffset);
+    }
+    size_t previous = next - 1;
+    if (next == m_records.size()) {
+        return roundUp ? endOffset : std::min(m_records.back().dataOffset, endOffset);
+    }
+
+    uint64_t offset = roundUp ? m_records[next].dataOffset : m_records[previous].dataOffset;
+    if (interpolate && m_timesInNs[next] > m_timesInNs[previous]) {
+        double position = ::interpolate(timeInNs, m_timesInNs[previous], m_timesInNs[next],
+                                        m_records[previous].dataOffset, m_records[next].dataOffset);
+        offset = static_cast<uint64_t>(position);
+        offset -= offset % GEC_RECORDING_WORD_SIZE;
+        if (roundUp) {
+            offset += GEC_RECORDING_WORD_SIZE;
+        }
+    }
+    return std::min(offset, endOffset);
+}
+
+uint64_t TimeIndex::findTimeInNs(uint64_t dataOffset) const
+{
+    return GEC_metaTicksToTimeInNs(m_header, findTicks(dataOffset));
+}
+
+bool TimeIndex::getRange(uint64_t startTimeInNs, uint64_t endTimeInNs, bool interpolate, uint64_t dataSize,
+                         uint64_t &startOffset, uint64_t &endOffset) const
+{
+    if (m_records.empty() || endTimeInNs <= startTimeInNs) {
+        return false;
+    }
+    startOffset = findOffset(startTimeInNs, interpolate, false, dataSize);
+    endOffset = findOffset(endTimeInNs, interpolate, true, dataSize);
+    return endOffset > startOffset;
+}
+
+int TimeIndex::write(uint64_t startOffset, uint64_t endOffset, FILE *file, uint64_t &numRecords) const
+{
+    numRecords = 0;
+    if (m_records.empty()) {
+        return GE_INVALID_PARAMETER;
+    }
+    if (fwrite(&m_header, sizeof(m_header), 1, file) != 1) {
+        return GE_ERROR;
+    }
+
+    // Playback paces the data from the first record on, so the extract starts with one
+    GEC_MetaRecord record;
+    record.timerTicks = findTicks(startOffset);
+    record.dataOffset = 0;
+    if (fwrite(&record, sizeof(record), 1, file) != 1) {
+        return GE_ERROR;
+    }
+    ++numRecords;
+
+    std::vector<GEC_MetaRecord>::const_iterator it = std::upper_bound(m_records.begin(), m_records.end(),
+                                                                      startOffset, isAfter);
+    for (; it != m_records.end() && it->dataOffset < endOffset; ++it) {
+        record.timerTicks = it->timerTicks;
+        record.dataOffset = it->dataOffset - startOffset;
+        if (fwrite(&record, sizeof(record), 1, file) != 1) {
+            return GE_ERROR;
+        }
+        ++numRecords;
+    }
+    return GE_OK;
+}
+
+uint64_t TimeIndex::findTicks(uint64_t dataOffset) const
+{
+    if (m_records.empty()) {
+        return 0;
+    }
+    std::vector<GEC_MetaRecord>::const_iterator next = std::lower_bound(m_records.begin(), m_records.end(),
+                                                                        dataOffset, isBefore);
+    if (next == m_records.end()) {
+        return m_records.back().timerTicks;
+    }
+    if (next == m_records.begin() || next->dataOffset == dataOffset) {
+        return next->timerTicks;
+    }
+    std::vector<GEC_MetaRecord>::const_iterator previous = next - 1;
+    if (next->timerTicks < previous->timerTicks) {
+        return previous->timerTicks;
+    }
+    return static_cast<uint64_t>(::interpolate(dataOffset, previous->dataOffset, next->dataOffset,
+                                               previous->timerTicks, next->timerTicks));
+}
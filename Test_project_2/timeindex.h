@@ -0,0 +1,94 @@
+#ifndef TIMEINDEX_H
+#define TIMEINDEX_H
+
+#include <stdint.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "GEC_RecordingFormat.h"
+
+/**
+  Finds the data of a wall-clock time window of a recording from its
+  .meta file
+
+  load() reads the meta data once, through a MappedFile, and keeps its
+  timing records together with their times in ns since 1970, converted
+  from the HW timer ticks up front. A time is then found with a binary
+  search over the times, and an offset with one over the offsets.
+
+  A record is taken when a block of data arrives, so without
+  interpolation a time is rounded to the block it falls into: a start
+  time down to the first word of its block, an end time up to the word
+  after it. With interpolation the offset is placed linearly between
+  the two records around the time, assuming the link rate was constant
+  in between, and rounded to whole words. Times after the last record
+  lie in the last block, which ends at the end of the data.
+
+  write() writes the meta data of a byte range as the .meta file of an
+  extracted recording, so it can be played back with its original
+  timing.
+*/
+class TimeIndex
+{
+public:
+    TimeIndex();
+
+    /**
+      Reads the timing records of the .meta file at @p path. A partial
+      record at the end, of a recording still being written, is ignored.
+
+      @return GE_OK, GE_NOT_EXISTING, GE_NO_ACCESS, or GE_ERROR if the
+      file is not a .meta file or could not be mapped
+    */
+    int load(const std::string &path);
+    void clear();
+
+    const GEC_MetaHeader &getHeader() const { return m_header; }
+    uint64_t getNumRecords() const { return m_records.size(); }
+    /** Times of the first and the last record, 0 without records */
+    uint64_t getStartTimeInNs() const { return m_timesInNs.empty() ? 0 : m_timesInNs.front(); }
+    uint64_t getEndTimeInNs() const { return m_timesInNs.empty() ? 0 : m_timesInNs.back(); }
+
+    /**
+      Offset of the word received at @p timeInNs, in a .dat file of
+      @p dataSize bytes
+
+      @param roundUp Round to the end of the block, or of the word, the
+      time falls into rather than to its start
+    */
+    uint64_t findOffset(uint64_t timeInNs, bool interpolate, bool roundUp, uint64_t dataSize) const;
+    /** Time at which the word at @p dataOffset was received, interpolated between records */
+    uint64_t findTimeInNs(uint64_t dataOffset) const;
+
+    /**
+      Byte range of the data received from @p startTimeInNs to
+      @p endTimeInNs
+
+      @return false if there are no records, or the window is empty or
+      ends before the recording; a window after the last record gets
+      the last block
+    */
+    bool getRange(uint64_t startTimeInNs, uint64_t endTimeInNs, bool interpolate, uint64_t dataSize,
+                  uint64_t &startOffset, uint64_t &endOffset) const;
+
+    /**
+      Writes the header and the records of the bytes from @p startOffset
+      to @p endOffset to @p file, with offsets from @p startOffset. A
+      record for the first byte is added if there is none, with its
+      ticks interpolated.
+
+      @return GE_OK, GE_INVALID_PARAMETER without records, or GE_ERROR if
+      writing failed
+    */
+    int write(uint64_t startOffset, uint64_t endOffset, FILE *file, uint64_t &numRecords) const;
+
+private:
+    uint64_t findTicks(uint64_t dataOffset) const;
+
+    GEC_MetaHeader m_header;
+    std::vector<GEC_MetaRecord> m_records;
+    std::vector<uint64_t> m_timesInNs;   // Of m_records, for the binary search
+};
+
+#endif // TIMEINDEX_H
@@ -0,0 +1,184 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "inc/GE_Defines.h"
+#include "profileengine.h"
+#include "recorderprotocol.h"
+#include "sessionprofiles.h"
+#include "socketrecorder.h"
+
+/*
+  Arms sessions of a recorder from named profiles, as the application
+  does before a recording
+
+  Each --session assigns a profile to a port. All sessions are armed in
+  one batch, pipelined unless --sequential is given; --compare arms the
+  same batch both ways and prints both times. Unless --start is given,
+  the sessions are destroyed again afterwards.
+*/
+
+static void printUsage()
+{
+    fprintf(stderr,
+            "Usage: sfpdp-arm --profiles <file> --session <profile>@<device>:<port> [...] [options]\n"
+            "\n"
+            "Arms sessions of a running sfpdp-sim-server from the profiles in a file.\n"
+            "\n"
+            "Options:\n"
+            "  --socket <path>      Unix socket of the server (default %s)\n"
+            "  --tcp <host>[:port]  TCP address of the server instead of the Unix socket\n"
+            "  --path <dir>         Directory of the recordings (default /arm)\n"
+            "  --sequential         One call per round trip instead of pipelined calls\n"
+            "  --compare            Arm the sessions pipelined and sequentially, and compare\n"
+            "  --start              Start the armed sessions and leave them running\n"
+            "  --list               Print the profiles of the file and exit\n",
+            GEC_SFPDP_RECORDER_SERVER_UNIX_SOCKET_FILE);
+}
+
+static void printReport(const char *title, const std::vector<ProfileEngine::Assignment> &assignments,
+                        const ProfileEngine::Report &report)
+{
+    printf("%s: %zu sessions, %zu calls, %zu setters skipped, %zu round trips, %.3f ms\n", title,
+           report.sessions.size(), report.numCalls, report.numSkipped, report.numRoundTrips,
+           1e3 * report.armTimeInS);
+    for (size_t i = 0; i < report.sessions.size(); ++i) {
+        const ProfileEngine::SessionResult &result = report.sessions[i];
+        if (result.rc != GE_OK) {
+            printf("  %s on %s: error %d in %s\n", assignments[i].profile.c_str(), assignments[i].name.c_str(),
+                   result.rc, RecorderProtocol::getMethodName(result.failedMethod));
+        }
+    }
+}
+
+static void destroyAll(GEC_ISfpdpRecorder *recorder, const ProfileEngine::Report &report)
+{
+    for (size_t i = 0; i < report.sessions.size(); ++i) {
+        if (report.sessions[i].rc == GE_OK) {
+            recorder->destroy(report.sessions[i].id);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string profilesPath;
+    std::string socketPath = GEC_SFPDP_RECORDER_SERVER_UNIX_SOCKET_FILE;
+    std::string host;
+    int port = GEC_SFPDP_RECORDER_SERVER_TCP_PORT;
+    std::string path = "/arm";
+    std::vector<ProfileEngine::Assignment> assignments;
+    bool sequential = false;
+    bool compare = false;
+    bool start = false;
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--profiles" && hasValue) {
+            profilesPath = argv[++i];
+        } else if (arg == "--session" && hasValue) {
+            ProfileEngine::Assignment assignment;
+            if (!ProfileEngine::parseAssignment(argv[++i], assignment)) {
+                printUsage();
+                return 1;
+            }
+            assignments.push_back(assignment);
+        } else if (arg == "--socket" && hasValue) {
+            socketPath = argv[++i];
+        } else if (arg == "--tcp" && hasValue) {
+            std::string address = argv[++i];
+            size_t colon = address.rfind(':');
+            host = address.substr(0, colon);
+            if (colon != std::string::npos) {
+                port = atoi(address.c_str() + colon + 1);
+            }
+        } else if (arg == "--path" && hasValue) {
+            path = argv[++i];
+        } else if (arg == "--sequential") {
+            sequential = true;
+        } else if (arg == "--compare") {
+            compare = true;
+        } else if (arg == "--start") {
+            start = true;
+        } else if (arg == "--list") {
+            list = true;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (profilesPath.empty() || (assignments.empty() && !list) || port <= 0 || port > 65535 || (compare && start)) {
+        printUsage();
+        return 1;
+    }
+
+    SessionProfiles profiles;
+    if (profiles.load(profilesPath) != GE_OK) {
+        fprintf(stderr, "%s: %s\n", profilesPath.c_str(), profiles.getError().c_str());
+        return 1;
+    }
+    if (list) {
+        std::vector<std::string> names = profiles.getNames();
+        for (size_t i = 0; i < names.size(); ++i) {
+            printf("%s\n", names[i].c_str());
+        }
+        return 0;
+    }
+    for (size_t i = 0; i < assignments.size(); ++i) {
+        assignments[i].path = path;
+        if (profiles.find(assignments[i].profile) == NULL) {
+            fprintf(stderr, "No profile %s in %s\n", assignments[i].profile.c_str(), profilesPath.c_str());
+            return 1;
+        }
+    }
+
+    SocketRecorder unixRecorder(socketPath);
+    SocketRecorder tcpRecorder(host, static_cast<uint16_t>(port));
+    SocketRecorder &recorder = host.empty() ? unixRecorder : tcpRecorder;
+    if (recorder.connect() != GE_OK) {
+        fprintf(stderr, "Cannot connect to %s\n", host.empty() ? socketPath.c_str() : host.c_str());
+        return 1;
+    }
+
+    ProfileEngine engine(profiles);
+    ProfileEngine::Report report;
+    int rc = GE_OK;
+    if (compare) {
+        ProfileEngine::Report sequentialReport;
+        engine.setPipelining(false);
+        rc = engine.arm(&recorder, assignments, sequentialReport);
+        printReport("sequential", assignments, sequentialReport);
+        destroyAll(&recorder, sequentialReport);
+        if (rc == GE_OK) {
+            engine.setPipelining(true);
+            rc = engine.arm(&recorder, assignments, report);
+            printReport("pipelined ", assignments, report);
+            destroyAll(&recorder, report);
+            if (report.armTimeInS > 0) {
+                printf("\nPipelining arms the sessions %.1f times as fast\n",
+                       sequentialReport.armTimeInS / report.armTimeInS);
+            }
+        }
+        return (rc == GE_OK) ? 0 : 1;
+    }
+
+    engine.setPipelining(!sequential);
+    rc = engine.arm(&recorder, assignments, report);
+    printReport(sequential ? "sequential" : "pipelined", assignments, report);
+    if (rc == GE_OK && start) {
+        rc = recorder.startAll();
+        if (rc != GE_OK) {
+            fprintf(stderr, "startAll() failed with error %d\n", rc);
+        }
+    }
+    if (!start || rc != GE_OK) {
+        destroyAll(&recorder, report);
+    }
+    return (rc == GE_OK) ? 0 : 1;
+}
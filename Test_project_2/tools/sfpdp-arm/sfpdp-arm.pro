@@ -0,0 +1,27 @@
+# Arms sessions of a running sfpdp-sim-server from a profile file, pipelined or one call at a time
+TEMPLATE = app
+CONFIG += console c++11 thread
+CONFIG -= app_bundle qt
+
+APP = $$PWD/../..
+SDK = $$APP/gec-sfpdp-recorder-api-win-3.5.0
+SSH_COMMON = $$APP/gec-ssh-win-3.0.0/examples/ssh-common
+
+SOURCES += \
+    sfpdp-arm.cpp \
+    $$APP/instrumentedrecorder.cpp \
+    $$APP/profileengine.cpp \
+    $$APP/recorderprotocol.cpp \
+    $$APP/sessionprofiles.cpp \
+    $$APP/socketrecorder.cpp
+
+HEADERS += \
+    $$APP/instrumentedrecorder.h \
+    $$APP/profileengine.h \
+    $$APP/recorderprotocol.h \
+    $$APP/sessionprofiles.h \
+    $$APP/socketrecorder.h
+
+OTHER_FILES += profiles.ini
+
+INCLUDEPATH += $$APP $$SDK $$SSH_COMMON
@@ -0,0 +1,236 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "inc/GE_Defines.h"
+#include "instrumentedrecorder.h"
+#include "simulatedrecorder.h"
+#include "socketrecorder.h"
+
+/*
+  Round trip time of single recorder calls over TCP loopback and over the
+  Unix socket of the same server
+
+  Both transports use the same client code and talk to the same server
+  process, so the difference is the transport. The calls are made in
+  rounds that alternate between the transports, so a change of machine
+  load affects both alike. An in-process simulator can be timed as well,
+  as the cost of the call without any transport, and the same simulator
+  inside an InstrumentedRecorder, as the cost of the telemetry.
+*/
+
+struct Transport
+{
+    const char *name;
+    GEC_ISfpdpRecorder *recorder;
+    uint32_t id;
+    std::vector<double> latenciesInUs;
+    uint64_t numFailed;
+};
+
+static int callOnce(GEC_ISfpdpRecorder *recorder, const std::string &method, uint32_t id)
+{
+    if (method == "setSwapping") {
+        return recorder->setSwapping(id, false, false);
+    } else if (method == "checkForOverflow") {
+        bool detected = false;
+        return recorder->checkForOverflow(id, detected, false);
+    }
+    uint64_t numBytes = 0;
+    std::string state;
+    return recorder->getStatus(id, numBytes, state);
+}
+
+static double getPercentile(const std::vector<double> &sorted, double fraction)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    return sorted[static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5)];
+}
+
+static void printUsage()
+{
+    fprintf(stderr,
+            "Usage: sfpdp-latency [options]\n"
+            "\n"
+            "Compares the round trip time of recorder calls over TCP loopback and over the\n"
+            "Unix socket of a running sfpdp-sim-server.\n"
+            "\n"
+            "Options:\n"
+            "  --socket <path>      Unix socket of the server (default %s)\n"
+            "  --tcp <host>[:port]  TCP address of the same server (default 127.0.0.1:%d)\n"
+            "  --calls <n>          Calls per transport (default 100000)\n"
+            "  --round <n>          Calls per transport before switching to the next (default 1000)\n"
+            "  --method <name>      getStatus, checkForOverflow, or setSwapping (default getStatus)\n"
+            "  --in-process         Also time an in-process simulator, without a transport\n"
+            "  --instrumented       Also time the in-process simulator inside an InstrumentedRecorder,\n"
+            "                       and print its statistics\n",
+            GEC_SFPDP_RECORDER_SERVER_UNIX_SOCKET_FILE, GEC_SFPDP_RECORDER_SERVER_TCP_PORT);
+}
+
+int main(int argc, char *argv[])
+{
+    std::string socketPath = GEC_SFPDP_RECORDER_SERVER_UNIX_SOCKET_FILE;
+    std::string host = "127.0.0.1";
+    int port = GEC_SFPDP_RECORDER_SERVER_TCP_PORT;
+    long numCalls = 100000;
+    long roundSize = 1000;
+    std::string method = "getStatus";
+    bool inProcess = false;
+    bool instrumented = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--socket" && hasValue) {
+            socketPath = argv[++i];
+        } else if (arg == "--tcp" && hasValue) {
+            std::string address = argv[++i];
+            size_t colon = address.rfind(':');
+            host = address.substr(0, colon);
+            if (colon != std::string::npos) {
+                port = atoi(address.c_str() + colon + 1);
+            }
+        } else if (arg == "--calls" && hasValue) {
+            numCalls = atol(argv[++i]);
+        } else if (arg == "--round" && hasValue) {
+            roundSize = atol(argv[++i]);
+        } else if (arg == "--method" && hasValue) {
+            method = argv[++i];
+        } else if (arg == "--in-process") {
+            inProcess = true;
+        } else if (arg == "--instrumented") {
+            inProcess = true;
+            instrumented = true;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (numCalls < 1 || roundSize < 1 || port <= 0 || port > 65535
+        || (method != "getStatus" && method != "checkForOverflow" && method != "setSwapping")) {
+        printUsage();
+        return 1;
+    }
+
+    SocketRecorder unixRecorder(socketPath);
+    SocketRecorder tcpRecorder(host, static_cast<uint16_t>(port));
+    SimulatedRecorder::Config config;
+    config.rootDirectory = "/tmp/sfpdp-latency";
+    SimulatedRecorder *simulated = inProcess ? new SimulatedRecorder(config) : NULL;
+    InstrumentedRecorder *telemetry = instrumented ? new InstrumentedRecorder(simulated) : NULL;
+
+    std::vector<Transport> transports;
+    Transport transport;
+    transport.numFailed = 0;
+    transport.name = "unix";
+    transport.recorder = &unixRecorder;
+    transports.push_back(transport);
+    transport.name = "tcp";
+    transport.recorder = &tcpRecorder;
+    transports.push_back(transport);
+    if (simulated != NULL) {
+        transport.name = "in-process";
+        transport.recorder = simulated;
+        transports.push_back(transport);
+    }
+    if (telemetry != NULL) {
+        transport.name = "instrumented";
+        transport.recorder = telemetry;
+        transports.push_back(transport);
+    }
+
+    // The session the calls refer to; the two socket clients share the one made on the server
+    uint32_t id = 0;
+    int rc = unixRecorder.create("/latency", "session", 0, 0, id);
+    if (rc != GE_OK) {
+        fprintf(stderr, "create() over %s failed with error %d\n", socketPath.c_str(), rc);
+        delete telemetry;
+        delete simulated;
+        return 1;
+    }
+    transports[0].id = id;
+    transports[1].id = id;
+    if (simulated != NULL && simulated->create("/latency", "session", 0, 0, transports[2].id) != GE_OK) {
+        fprintf(stderr, "create() in process failed\n");
+        unixRecorder.destroy(id);
+        delete telemetry;
+        delete simulated;
+        return 1;
+    }
+    if (telemetry != NULL) {
+        transports[3].id = transports[2].id;
+    }
+    if (tcpRecorder.connect() != GE_OK) {
+        fprintf(stderr, "Cannot connect to %s:%d\n", host.c_str(), port);
+        unixRecorder.destroy(id);
+        delete telemetry;
+        delete simulated;
+        return 1;
+    }
+
+    // A round of each before timing, so connections and caches are warm
+    for (size_t t = 0; t < transports.size(); ++t) {
+        for (long i = 0; i < roundSize; ++i) {
+            callOnce(transports[t].recorder, method, transports[t].id);
+        }
+        transports[t].latenciesInUs.reserve(numCalls);
+    }
+
+    for (long done = 0; done < numCalls; done += roundSize) {
+        long count = std::min(roundSize, numCalls - done);
+        for (size_t t = 0; t < transports.size(); ++t) {
+            Transport &current = transports[t];
+            for (long i = 0; i < count; ++i) {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                rc = callOnce(current.recorder, method, current.id);
+                std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+                current.latenciesInUs.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+                if (rc != GE_OK) {
+                    ++current.numFailed;
+                }
+            }
+        }
+    }
+
+    unixRecorder.destroy(id);
+    std::string statistics = (telemetry != NULL) ? telemetry->format() : std::string();
+    if (simulated != NULL) {
+        simulated->destroy(transports[2].id);
+        delete telemetry;
+        delete simulated;
+    }
+
+    printf("%s, %ld calls per transport\n\n", method.c_str(), numCalls);
+    printf("%-12s %9s %9s %9s %9s %9s %9s %10s %7s\n", "transport", "mean us", "min us", "p50 us", "p90 us",
+           "p99 us", "max us", "calls/s", "failed");
+    for (size_t t = 0; t < transports.size(); ++t) {
+        std::vector<double> &latencies = transports[t].latenciesInUs;
+        std::sort(latencies.begin(), latencies.end());
+        double sum = 0;
+        for (size_t i = 0; i < latencies.size(); ++i) {
+            sum += latencies[i];
+        }
+        double mean = sum / latencies.size();
+        printf("%-12s %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f %10.0f %7llu\n", transports[t].name, mean, latencies.front(),
+               getPercentile(latencies, 0.5), getPercentile(latencies, 0.9), getPercentile(latencies, 0.99),
+               latencies.back(), 1e6 / mean, static_cast<unsigned long long>(transports[t].numFailed));
+    }
+
+    double unixMedian = getPercentile(transports[0].latenciesInUs, 0.5);
+    double tcpMedian = getPercentile(transports[1].latenciesInUs, 0.5);
+    printf("\nThe Unix socket takes %.0f%% of the TCP loopback round trip (median)\n",
+           tcpMedian > 0 ? 100 * unixMedian / tcpMedian : 0.0);
+    if (!statistics.empty()) {
+        printf("\nAs counted by the InstrumentedRecorder:\n%s", statistics.c_str());
+    }
+    return (transports[0].numFailed == 0 && transports[1].numFailed == 0) ? 0 : 1;
+}
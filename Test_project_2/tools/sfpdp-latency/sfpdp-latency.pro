@@ -0,0 +1,23 @@
+# Benchmark comparing recorder call round trips over TCP loopback and a Unix socket
+TEMPLATE = app
+CONFIG += console c++11 thread
+CONFIG -= app_bundle qt
+
+APP = $$PWD/../..
+SDK = $$APP/gec-sfpdp-recorder-api-win-3.5.0
+SSH_COMMON = $$APP/gec-ssh-win-3.0.0/examples/ssh-common
+
+SOURCES += \
+    sfpdp-latency.cpp \
+    $$APP/instrumentedrecorder.cpp \
+    $$APP/recorderprotocol.cpp \
+    $$APP/simulatedrecorder.cpp \
+    $$APP/socketrecorder.cpp
+
+HEADERS += \
+    $$APP/instrumentedrecorder.h \
+    $$APP/recorderprotocol.h \
+    $$APP/simulatedrecorder.h \
+    $$APP/socketrecorder.h
+
+INCLUDEPATH += $$APP $$SDK $$SSH_COMMON
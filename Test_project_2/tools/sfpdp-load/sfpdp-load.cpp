@@ -0,0 +1,411 @@
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "inc/GE_Defines.h"
+#include "GEC_SfpdpLinkRate.h"
+#include "recorderprotocol.h"
+
+/*
+  Load generator for the recorder server
+
+  Every client is a thread with a connection of its own that sends a
+  random mix of control calls, one at a time, and records the round trip
+  time of each. Before the clients start, recording sessions are created
+  and started on the first ports, so the status calls have something to
+  report. The last port is left free for create/destroy pairs.
+*/
+
+enum Operation
+{
+    OP_GET_STATUS,
+    OP_CHECK_FOR_OVERFLOW,
+    OP_SET_SWAPPING,
+    OP_SET_MAX_SIZE,
+    OP_CREATE_DESTROY,
+    NUM_OPERATIONS
+};
+
+static const char *operationNames[NUM_OPERATIONS] = {
+    "getStatus", "checkForOverflow", "setSwapping", "setMaxSize", "create+destroy"
+};
+
+struct Options
+{
+    Options() : port(0), numClients(16), durationInS(10), numSessions(4), seed(1)
+    {
+        weights[OP_GET_STATUS] = 70;
+        weights[OP_CHECK_FOR_OVERFLOW] = 15;
+        weights[OP_SET_SWAPPING] = 5;
+        weights[OP_SET_MAX_SIZE] = 5;
+        weights[OP_CREATE_DESTROY] = 5;
+    }
+
+    std::string socketPath;              // Unix socket, or empty for TCP
+    std::string host;
+    int port;
+    int numClients;
+    double durationInS;
+    int numSessions;
+    unsigned seed;
+    double weights[NUM_OPERATIONS];
+};
+
+struct ClientResult
+{
+    ClientResult() : numFailed(0), numErrors(0) {}
+
+    std::vector<double> latenciesInUs[NUM_OPERATIONS];
+    uint64_t numFailed;                  // Calls with rc != GE_OK
+    uint64_t numErrors;                  // Connection or protocol errors; the client stops at the first
+};
+
+static int connectToServer(const Options &options)
+{
+    if (!options.socketPath.empty()) {
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, options.socketPath.c_str(), sizeof(address.sun_path) - 1);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+            close(fd);
+            fd = -1;
+        }
+        return fd;
+    }
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *addresses = NULL;
+    std::string port = std::to_string(options.port);
+    if (getaddrinfo(options.host.c_str(), port.c_str(), &hints, &addresses) != 0) {
+        return -1;
+    }
+    int fd = -1;
+    for (addrinfo *address = addresses; address != NULL && fd < 0; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd >= 0 && connect(fd, address->ai_addr, address->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    if (fd >= 0) {
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    return fd;
+}
+
+/** Sends one request frame and reads its response. @return false on a connection or protocol error */
+static bool call(int fd, const std::string &request, std::string &response)
+{
+    size_t offset = 0;
+    while (offset < request.size()) {
+        ssize_t numSent = send(fd, request.data() + offset, request.size() - offset, MSG_NOSIGNAL);
+        if (numSent <= 0) {
+            return false;
+        }
+        offset += numSent;
+    }
+
+    response.clear();
+    char buffer[4096];
+    for (;;) {
+        int64_t frameSize = RecorderProtocol::getFrameSize(response.data(), response.size());
+        if (frameSize < 0) {
+            return false;
+        }
+        if (frameSize > 0 && response.size() >= static_cast<size_t>(frameSize)) {
+            return response.size() == static_cast<size_t>(frameSize);
+        }
+        ssize_t numRead = recv(fd, buffer, sizeof(buffer), 0);
+        if (numRead <= 0) {
+            return false;
+        }
+        response.append(buffer, numRead);
+    }
+}
+
+static int callForRc(int fd, const std::string &request, std::string &response)
+{
+    if (!call(fd, request, response)) {
+        return GE_COMMFAIL;
+    }
+    RecorderProtocol::Reader reader(response.data(), response.size());
+    return reader.isValid() ? reader.getMethodOrRc() : GE_COMMFAIL;
+}
+
+static void runClient(const Options &options, int index, const std::vector<uint32_t> &sessions,
+                      std::atomic<bool> &isStopping, ClientResult &result)
+{
+    int fd = connectToServer(options);
+    if (fd < 0) {
+        ++result.numErrors;
+        return;
+    }
+
+    std::minstd_rand random(options.seed + index);
+    std::discrete_distribution<int> pick(options.weights, options.weights + NUM_OPERATIONS);
+    std::string response;
+    uint32_t sequence = 0;
+    uint64_t numCreated = 0;
+    while (!isStopping) {
+        int operation = pick(random);
+        uint32_t id = sessions.empty() ? 0 : sessions[random() % sessions.size()];
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int rc = GE_OK;
+        if (operation == OP_GET_STATUS) {
+            RecorderProtocol::Writer request(++sequence, RecorderProtocol::GET_STATUS);
+            request.putU32(id);
+            rc = callForRc(fd, request.finish(), response);
+        } else if (operation == OP_CHECK_FOR_OVERFLOW) {
+            RecorderProtocol::Writer request(++sequence, RecorderProtocol::CHECK_FOR_OVERFLOW);
+            request.putU32(id);
+            request.putBool(false);
+            rc = callForRc(fd, request.finish(), response);
+        } else if (operation == OP_SET_SWAPPING) {
+            RecorderProtocol::Writer request(++sequence, RecorderProtocol::SET_SWAPPING);
+            request.putU32(id);
+            request.putBool(false);
+            request.putBool(false);
+            rc = callForRc(fd, request.finish(), response);
+        } else if (operation == OP_SET_MAX_SIZE) {
+            RecorderProtocol::Writer request(++sequence, RecorderProtocol::SET_MAX_SIZE);
+            request.putU32(id);
+            request.putU64(0);
+            rc = callForRc(fd, request.finish(), response);
+        } else {
+            // Clients race for the free port, so GE_BUSY is an expected answer
+            std::ostringstream name;
+            name << "load_" << index << "_" << numCreated++;
+            RecorderProtocol::Writer create(++sequence, RecorderProtocol::CREATE);
+            create.putString("/load");
+            create.putString(name.str());
+            create.putU32(0);
+            create.putU32(GEC_SFPDP_MAX_PORTS - 1);
+            rc = callForRc(fd, create.finish(), response);
+            if (rc == GE_OK) {
+                RecorderProtocol::Reader reader(response.data(), response.size());
+                RecorderProtocol::Writer destroy(++sequence, RecorderProtocol::DESTROY);
+                destroy.putU32(reader.getU32());
+                rc = callForRc(fd, destroy.finish(), response);
+            } else if (rc == GE_BUSY || rc == GE_FILE_IN_USE) {
+                rc = GE_OK;
+            }
+        }
+        double latencyInUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        if (rc == GE_COMMFAIL) {
+            ++result.numErrors;
+            break;
+        }
+        if (rc != GE_OK) {
+            ++result.numFailed;
+        }
+        result.latenciesInUs[operation].push_back(latencyInUs);
+    }
+    close(fd);
+}
+
+static double getPercentile(const std::vector<double> &sorted, double fraction)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+static void printLatencies(const char *name, std::vector<double> &latencies, double durationInS)
+{
+    std::sort(latencies.begin(), latencies.end());
+    printf("%-18s %10zu %10.0f %9.1f %9.1f %9.1f %9.1f %9.1f\n", name, latencies.size(), latencies.size() / durationInS,
+           getPercentile(latencies, 0.5), getPercentile(latencies, 0.9), getPercentile(latencies, 0.99),
+           getPercentile(latencies, 0.999), latencies.empty() ? 0.0 : latencies.back());
+}
+
+static bool parseMix(const std::string &mix, double weights[NUM_OPERATIONS])
+{
+    std::fill(weights, weights + NUM_OPERATIONS, 0.0);
+    std::istringstream items(mix);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        size_t equals = item.find('=');
+        if (equals == std::string::npos) {
+            return false;
+        }
+        std::string name = item.substr(0, equals);
+        int operation = 0;
+        while (operation < NUM_OPERATIONS && name != operationNames[operation]) {
+            ++operation;
+        }
+        if (operation == NUM_OPERATIONS) {
+            return false;
+        }
+        weights[operation] = atof(item.c_str() + equals + 1);
+    }
+    double sum = 0;
+    for (int i = 0; i < NUM_OPERATIONS; ++i) {
+        sum += (weights[i] > 0) ? weights[i] : 0;
+    }
+    return sum > 0;
+}
+
+static void printUsage()
+{
+    fprintf(stderr,
+            "Usage: sfpdp-load [options]\n"
+            "\n"
+            "Measures the control call latency of a recorder server under load.\n"
+            "\n"
+            "Options:\n"
+            "  --socket <path>      Connect to a Unix socket (default %s)\n"
+            "  --tcp <host>[:port]  Connect over TCP instead (default port %d)\n"
+            "  --clients <n>        Concurrent clients (default 16)\n"
+            "  --duration <s>       Length of the run (default 10)\n"
+            "  --sessions <n>       Recording sessions to create first, at most %d (default 4)\n"
+            "  --mix <op>=<weight>,...\n"
+            "                       Relative frequency of getStatus, checkForOverflow, setSwapping,\n"
+            "                       setMaxSize, create+destroy (default 70,15,5,5,5)\n"
+            "  --seed <n>           Seed of the random mix (default 1)\n",
+            GEC_SFPDP_RECORDER_SERVER_UNIX_SOCKET_FILE, GEC_SFPDP_RECORDER_SERVER_TCP_PORT, GEC_SFPDP_MAX_PORTS - 1);
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    options.socketPath = GEC_SFPDP_RECORDER_SERVER_UNIX_SOCKET_FILE;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--socket" && hasValue) {
+            options.socketPath = argv[++i];
+        } else if (arg == "--tcp" && hasValue) {
+            std::string address = argv[++i];
+            size_t colon = address.rfind(':');
+            options.host = address.substr(0, colon);
+            options.port = (colon == std::string::npos) ? GEC_SFPDP_RECORDER_SERVER_TCP_PORT
+                                                        : atoi(address.c_str() + colon + 1);
+            options.socketPath.clear();
+        } else if (arg == "--clients" && hasValue) {
+            options.numClients = atoi(argv[++i]);
+        } else if (arg == "--duration" && hasValue) {
+            options.durationInS = atof(argv[++i]);
+        } else if (arg == "--sessions" && hasValue) {
+            options.numSessions = atoi(argv[++i]);
+        } else if (arg == "--mix" && hasValue) {
+            if (!parseMix(argv[++i], options.weights)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = static_cast<unsigned>(atoi(argv[++i]));
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (options.numClients < 1 || options.durationInS <= 0 || options.numSessions < 0
+        || options.numSessions > GEC_SFPDP_MAX_PORTS - 1) {
+        printUsage();
+        return 1;
+    }
+
+    int control = connectToServer(options);
+    if (control < 0) {
+        fprintf(stderr, "Cannot connect to the server: %s\n", strerror(errno));
+        return 1;
+    }
+
+    // The sessions the clients poll
+    std::string response;
+    std::vector<uint32_t> sessions;
+    uint32_t sequence = 0;
+    for (int port = 0; port < options.numSessions; ++port) {
+        RecorderProtocol::Writer create(++sequence, RecorderProtocol::CREATE);
+        create.putString("/load");
+        create.putString("session_" + std::to_string(port));
+        create.putU32(0);
+        create.putU32(port);
+        int rc = callForRc(control, create.finish(), response);
+        if (rc != GE_OK) {
+            fprintf(stderr, "create() on port %d failed with error %d\n", port, rc);
+            continue;
+        }
+        RecorderProtocol::Reader reader(response.data(), response.size());
+        sessions.push_back(reader.getU32());
+    }
+    callForRc(control, RecorderProtocol::Writer(++sequence, RecorderProtocol::START_ALL).finish(), response);
+
+    std::atomic<bool> isStopping(false);
+    std::vector<ClientResult> results(options.numClients);
+    std::vector<std::thread> clients;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < options.numClients; ++i) {
+        clients.push_back(std::thread(runClient, std::cref(options), i, std::cref(sessions),
+                                      std::ref(isStopping), std::ref(results[i])));
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.durationInS));
+    isStopping = true;
+    for (size_t i = 0; i < clients.size(); ++i) {
+        clients[i].join();
+    }
+    double durationInS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    callForRc(control, RecorderProtocol::Writer(++sequence, RecorderProtocol::STOP_ALL).finish(), response);
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        RecorderProtocol::Writer destroy(++sequence, RecorderProtocol::DESTROY);
+        destroy.putU32(sessions[i]);
+        callForRc(control, destroy.finish(), response);
+    }
+    close(control);
+
+    uint64_t numFailed = 0;
+    uint64_t numErrors = 0;
+    std::vector<double> all;
+    printf("%-18s %10s %10s %9s %9s %9s %9s %9s\n", "call", "count", "per s", "p50 us", "p90 us", "p99 us",
+           "p99.9 us", "max us");
+    for (int operation = 0; operation < NUM_OPERATIONS; ++operation) {
+        std::vector<double> latencies;
+        for (size_t i = 0; i < results.size(); ++i) {
+            latencies.insert(latencies.end(), results[i].latenciesInUs[operation].begin(),
+                             results[i].latenciesInUs[operation].end());
+        }
+        all.insert(all.end(), latencies.begin(), latencies.end());
+        if (!latencies.empty()) {
+            printLatencies(operationNames[operation], latencies, durationInS);
+        }
+    }
+    printLatencies("all", all, durationInS);
+    for (size_t i = 0; i < results.size(); ++i) {
+        numFailed += results[i].numFailed;
+        numErrors += results[i].numErrors;
+    }
+    printf("%d clients, %.1f s, %llu calls failed, %llu clients lost their connection\n", options.numClients,
+           durationInS, static_cast<unsigned long long>(numFailed), static_cast<unsigned long long>(numErrors));
+    return (numErrors == 0) ? 0 : 1;
+}
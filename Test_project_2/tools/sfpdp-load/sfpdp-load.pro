@@ -0,0 +1,17 @@
+# Load generator measuring the control call latency of a recorder server
+TEMPLATE = app
+CONFIG += console c++11 thread
+CONFIG -= app_bundle qt
+
+APP = $$PWD/../..
+SDK = $$APP/gec-sfpdp-recorder-api-win-3.5.0
+SSH_COMMON = $$APP/gec-ssh-win-3.0.0/examples/ssh-common
+
+SOURCES += \
+    sfpdp-load.cpp \
+    $$APP/recorderprotocol.cpp
+
+HEADERS += \
+    $$APP/recorderprotocol.h
+
+INCLUDEPATH += $$APP $$SDK $$SSH_COMMON
@@ -0,0 +1,383 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "GEC_RecordingFormat.h"
+#include "inc/GE_Defines.h"
+#include "recordingdatareader.h"
+#include "recordingextractor.h"
+#include "syncindex.h"
+
+/*
+  Reads the words of a recorded .dat file through a RecordingDataReader
+
+  Without a mode the words from an offset are printed. --scan reads
+  every word in order and times it; with --compare-fread the same pass
+  is made with fread() into a buffer, which is what the reader saves.
+  --random reads single words at random offsets, which is what an
+  analysis jumping through a recording does. --sync selects frames by
+  their SYNC numbers in the .idx file next to the .dat file, through a
+  SyncIndex, and --time selects a time window from the .meta file,
+  through a TimeIndex. --output writes the selected words to a file,
+  and --extract writes them as a recording that can be played back.
+*/
+
+static double getTimeInS()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void printUsage()
+{
+    fprintf(stderr,
+            "Usage: sfpdp-read <file.dat> [options]\n"
+            "\n"
+            "Prints or times the 32-bit words of a recording, read from a memory mapping.\n"
+            "\n"
+            "Options:\n"
+            "  --offset <word>     First word to print (default 0)\n"
+            "  --count <n>         Number of words to print (default 64)\n"
+            "  --sync <n>[-<m>]    Print the frames from SYNC <n> to SYNC <m>, both included,\n"
+            "                      found in the .idx file of the recording\n"
+            "  --time <s>[-<s>]    Print the words received in a time window, in seconds from the\n"
+            "                      first record of the .meta file of the recording, by default\n"
+            "                      to its end\n"
+            "  --interpolate       With --time, interpolate between the timing records rather\n"
+            "                      than round to the blocks they were taken for\n"
+            "  --output <file>     Write the selected words to <file> instead of printing them\n"
+            "  --extract <file>    Write the selected words as a recording, <file> and its .idx\n"
+            "                      and .meta files, which can be played back\n"
+            "  --align-syncs       With --extract, widen the selection to whole SYNC frames\n"
+            "  --scan              Read all words in order, and print their checksum and the rate\n"
+            "  --check-counter     With --scan, count the words that do not continue the counter\n"
+            "                      in the low 28 bits, as the simulator writes them\n"
+            "  --compare-fread     With --scan, make the same pass with fread() as well\n"
+            "  --random <n>        Read <n> words at random offsets, and print the time per word\n"
+            "  --window <MiB>      Size of the mapping window (default the whole file)\n"
+            "  --huge-pages        Ask for huge pages\n");
+}
+
+struct ScanResult
+{
+    ScanResult() : checksum(0), numJumps(0), numWords(0), timeInS(0) {}
+
+    uint32_t checksum;                   // XOR of all words
+    uint64_t numJumps;
+    uint64_t numWords;
+    double timeInS;
+};
+
+static void scanWords(const uint32_t *words, uint64_t numWords, bool checkCounter, uint32_t &previous,
+                      ScanResult &result)
+{
+    uint32_t checksum = 0;
+    for (uint64_t i = 0; i < numWords; ++i) {
+        checksum ^= words[i];
+    }
+    result.checksum ^= checksum;
+    if (checkCounter) {
+        for (uint64_t i = 0; i < numWords; ++i) {
+            if (result.numWords + i > 0 && (words[i] & 0x0fffffff) != ((previous + 1) & 0x0fffffff)) {
+                ++result.numJumps;
+            }
+            previous = words[i];
+        }
+    }
+    result.numWords += numWords;
+}
+
+static int scanMapped(RecordingDataReader &reader, bool checkCounter, ScanResult &result)
+{
+    reader.getFile().setAccess(MappedFile::SEQUENTIAL_ACCESS);
+    uint32_t previous = 0;
+    double startInS = getTimeInS();
+    uint64_t offset = 0;
+    while (offset < reader.getNumWords()) {
+        RecordingDataReader::Span span;
+        int rc = reader.getSpan(offset, reader.getNumWords() - offset, span);
+        if (rc != GE_OK) {
+            return rc;
+        }
+        scanWords(span.words, span.numWords, checkCounter, previous, result);
+        offset += span.numWords;
+    }
+    result.timeInS = getTimeInS() - startInS;
+    return GE_OK;
+}
+
+static int scanRead(const std::string &path, bool checkCounter, ScanResult &result)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == NULL) {
+        return GE_NO_ACCESS;
+    }
+    std::vector<uint32_t> buffer(256 * 1024);
+    uint32_t previous = 0;
+    double startInS = getTimeInS();
+    size_t numRead = 0;
+    while ((numRead = fread(&buffer[0], GEC_RECORDING_WORD_SIZE, buffer.size(), file)) > 0) {
+        scanWords(&buffer[0], numRead, checkCounter, previous, result);
+    }
+    result.timeInS = getTimeInS() - startInS;
+    fclose(file);
+    return GE_OK;
+}
+
+static void printScan(const char *name, const ScanResult &result, bool checkCounter)
+{
+    double numBytes = static_cast<double>(result.numWords) * GEC_RECORDING_WORD_SIZE;
+    printf("%-8s %llu words, checksum %08x, %.3f s, %.2f GB/s", name, static_cast<unsigned long long>(result.numWords),
+           result.checksum, result.timeInS, (result.timeInS > 0) ? numBytes / result.timeInS / 1e9 : 0.0);
+    if (checkCounter) {
+        printf(", %llu counter jumps", static_cast<unsigned long long>(result.numJumps));
+    }
+    printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || argv[1][0] == '-') {
+        printUsage();
+        return 1;
+    }
+    std::string path = argv[1];
+    uint64_t offset = 0;
+    uint64_t count = 64;
+    bool scan = false;
+    bool checkCounter = false;
+    bool compareFread = false;
+    long numRandom = 0;
+    double windowInMiB = 0;
+    bool hugePages = false;
+    std::string syncs;
+    std::string outputPath;
+    std::string times;
+    bool interpolate = false;
+    std::string extractPath;
+    bool alignSyncs = false;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--offset" && hasValue) {
+            offset = strtoull(argv[++i], NULL, 0);
+        } else if (arg == "--count" && hasValue) {
+            count = strtoull(argv[++i], NULL, 0);
+        } else if (arg == "--scan") {
+            scan = true;
+        } else if (arg == "--check-counter") {
+            checkCounter = true;
+        } else if (arg == "--compare-fread") {
+            compareFread = true;
+        } else if (arg == "--random" && hasValue) {
+            numRandom = atol(argv[++i]);
+        } else if (arg == "--window" && hasValue) {
+            windowInMiB = atof(argv[++i]);
+        } else if (arg == "--huge-pages") {
+            hugePages = true;
+        } else if (arg == "--sync" && hasValue) {
+            syncs = argv[++i];
+        } else if (arg == "--output" && hasValue) {
+            outputPath = argv[++i];
+        } else if (arg == "--time" && hasValue) {
+            times = argv[++i];
+        } else if (arg == "--interpolate") {
+            interpolate = true;
+        } else if (arg == "--extract" && hasValue) {
+            extractPath = argv[++i];
+        } else if (arg == "--align-syncs") {
+            alignSyncs = true;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (numRandom < 0 || windowInMiB < 0) {
+        printUsage();
+        return 1;
+    }
+
+    RecordingDataReader reader;
+    MappedFile &file = reader.getFile();
+    file.setWindowSize(static_cast<uint64_t>(windowInMiB * (1 << 20)));
+    file.setHugePages(hugePages);
+    int rc = reader.open(path);
+    if (rc != GE_OK) {
+        fprintf(stderr, "%s: cannot be opened, error %d\n", path.c_str(), rc);
+        return 1;
+    }
+    printf("%s: %llu words, window %.1f MiB\n", path.c_str(), static_cast<unsigned long long>(reader.getNumWords()),
+           file.getWindowSize() / 1048576.0);
+
+    if (scan) {
+        ScanResult mapped;
+        rc = scanMapped(reader, checkCounter, mapped);
+        if (rc != GE_OK) {
+            fprintf(stderr, "Mapping failed with error %d\n", rc);
+            return 1;
+        }
+        printScan("mapped", mapped, checkCounter);
+        printf("         %llu windows mapped, huge pages %s\n", static_cast<unsigned long long>(file.getNumMappings()),
+               file.isUsingHugePages() ? "accepted" : (hugePages ? "refused" : "not asked for"));
+        if (compareFread) {
+            ScanResult read;
+            if (scanRead(path, checkCounter, read) == GE_OK) {
+                printScan("fread", read, checkCounter);
+            }
+        }
+    }
+
+    if (numRandom > 0 && reader.getNumWords() > 0) {
+        file.setAccess(MappedFile::RANDOM_ACCESS);
+        std::mt19937_64 random(1);
+        std::uniform_int_distribution<uint64_t> offsets(0, reader.getNumWords() - 1);
+        uint32_t checksum = 0;
+        uint64_t numMappings = file.getNumMappings();
+        double startInS = getTimeInS();
+        for (long i = 0; i < numRandom; ++i) {
+            checksum ^= reader.getWord(offsets(random));
+        }
+        double timeInS = getTimeInS() - startInS;
+        printf("random   %ld words, checksum %08x, %.1f ns per word, %llu windows mapped\n", numRandom, checksum,
+               1e9 * timeInS / numRandom, static_cast<unsigned long long>(file.getNumMappings() - numMappings));
+    }
+
+    if (!syncs.empty()) {
+        uint64_t firstSync = strtoull(syncs.c_str(), NULL, 0);
+        size_t dash = syncs.find('-');
+        uint64_t lastSync = (dash == std::string::npos) ? firstSync : strtoull(syncs.c_str() + dash + 1, NULL, 0);
+        std::string indexPath = RecordingDataReader::replaceExtension(path, GEC_RECORDING_INDEX_EXTENSION);
+        SyncIndex index;
+        double startInS = getTimeInS();
+        rc = index.load(indexPath);
+        double loadInS = getTimeInS() - startInS;
+        if (rc != GE_OK) {
+            fprintf(stderr, "%s: cannot be read, error %d\n", indexPath.c_str(), rc);
+            return 1;
+        }
+        uint64_t startOffset = 0;
+        uint64_t endOffset = 0;
+        startInS = getTimeInS();
+        bool isFound = (lastSync >= firstSync)
+            && index.getRange(firstSync, lastSync - firstSync + 1, file.getSize(), startOffset, endOffset);
+        double lookupInS = getTimeInS() - startInS;
+        printf("%s: %llu SYNCs, %llu CRC errors, read in %.3f ms\n", indexPath.c_str(),
+               static_cast<unsigned long long>(index.getNumSyncs()),
+               static_cast<unsigned long long>(index.getNumCrcErrors()), 1e3 * loadInS);
+        if (!isFound) {
+            fprintf(stderr, "There is no SYNC %llu\n", static_cast<unsigned long long>(firstSync));
+            return 1;
+        }
+        printf("SYNC %s: bytes %llu to %llu, %llu CRC errors, found in %.1f us\n", syncs.c_str(),
+               static_cast<unsigned long long>(startOffset), static_cast<unsigned long long>(endOffset),
+               static_cast<unsigned long long>(index.countCrcErrors(firstSync, lastSync - firstSync + 1)),
+               1e6 * lookupInS);
+        offset = startOffset / GEC_RECORDING_WORD_SIZE;
+        count = endOffset / GEC_RECORDING_WORD_SIZE - offset;
+    }
+
+    // The .idx and .meta files are only needed to select by time, or to extract
+    RecordingExtractor extractor;
+    if (!times.empty() || !extractPath.empty()) {
+        double startInS = getTimeInS();
+        rc = extractor.open(path);
+        double openInS = getTimeInS() - startInS;
+        if (rc != GE_OK) {
+            fprintf(stderr, "%s: the .idx or .meta file cannot be read, error %d\n", path.c_str(), rc);
+            return 1;
+        }
+        const TimeIndex &timeIndex = extractor.getTimeIndex();
+        printf("%s: %llu timing records over %.3f s, read in %.3f ms\n",
+               RecordingDataReader::replaceExtension(path, GEC_RECORDING_META_EXTENSION).c_str(),
+               static_cast<unsigned long long>(timeIndex.getNumRecords()),
+               (timeIndex.getEndTimeInNs() - timeIndex.getStartTimeInNs()) / 1e9, 1e3 * openInS);
+    }
+
+    if (!times.empty()) {
+        const TimeIndex &timeIndex = extractor.getTimeIndex();
+        size_t dash = times.find('-', 1);
+        double startTimeInS = atof(times.c_str());
+        double endTimeInS = (dash == std::string::npos) ? 0 : atof(times.c_str() + dash + 1);
+        uint64_t firstTimeInNs = timeIndex.getStartTimeInNs();
+        uint64_t startTimeInNs = firstTimeInNs + static_cast<uint64_t>(std::max(startTimeInS, 0.0) * 1e9);
+        uint64_t endTimeInNs = (dash == std::string::npos) ? UINT64_MAX
+            : firstTimeInNs + static_cast<uint64_t>(std::max(endTimeInS, 0.0) * 1e9);
+        uint64_t startOffset = 0;
+        uint64_t endOffset = 0;
+        double startInS = getTimeInS();
+        bool isFound = timeIndex.getRange(startTimeInNs, endTimeInNs, interpolate, extractor.getDataSize(),
+                                          startOffset, endOffset);
+        double lookupInS = getTimeInS() - startInS;
+        if (!isFound) {
+            fprintf(stderr, "There is no data from %s s\n", times.c_str());
+            return 1;
+        }
+        printf("Time %s s: bytes %llu to %llu, found in %.1f us\n", times.c_str(),
+               static_cast<unsigned long long>(startOffset), static_cast<unsigned long long>(endOffset),
+               1e6 * lookupInS);
+        offset = startOffset / GEC_RECORDING_WORD_SIZE;
+        count = endOffset / GEC_RECORDING_WORD_SIZE - offset;
+    }
+
+    if (!extractPath.empty()) {
+        count = (offset < reader.getNumWords()) ? std::min(count, reader.getNumWords() - offset) : 0;
+        uint64_t startOffset = offset * GEC_RECORDING_WORD_SIZE;
+        uint64_t endOffset = startOffset + count * GEC_RECORDING_WORD_SIZE;
+        if (alignSyncs) {
+            extractor.alignToSyncs(startOffset, endOffset);
+        }
+        RecordingExtractor::Extract extract;
+        double startInS = getTimeInS();
+        rc = extractor.extract(startOffset, endOffset, extractPath, extract);
+        double extractInS = getTimeInS() - startInS;
+        if (rc != GE_OK) {
+            fprintf(stderr, "%s: extracting failed with error %d\n", extractPath.c_str(), rc);
+            return 1;
+        }
+        printf("Bytes %llu to %llu extracted to %s in %.3f s: %llu index entries, %llu timing records\n",
+               static_cast<unsigned long long>(extract.startOffset),
+               static_cast<unsigned long long>(extract.endOffset), extractPath.c_str(), extractInS,
+               static_cast<unsigned long long>(extract.numIndexEntries),
+               static_cast<unsigned long long>(extract.numMetaRecords));
+    } else if (!outputPath.empty()) {
+        FILE *output = fopen(outputPath.c_str(), "wb");
+        if (output == NULL) {
+            fprintf(stderr, "%s: cannot be created\n", outputPath.c_str());
+            return 1;
+        }
+        count = (offset < reader.getNumWords()) ? std::min(count, reader.getNumWords() - offset) : 0;
+        rc = reader.write(offset, count, output);
+        if (fclose(output) != 0 && rc == GE_OK) {
+            rc = GE_ERROR;
+        }
+        if (rc != GE_OK) {
+            fprintf(stderr, "%s: writing failed with error %d\n", outputPath.c_str(), rc);
+            return 1;
+        }
+        printf("%llu words written to %s\n", static_cast<unsigned long long>(count), outputPath.c_str());
+    } else if (!scan && numRandom == 0) {
+        RecordingDataReader::Span span;
+        uint64_t end = offset + count;
+        uint64_t numPrinted = 0;
+        while (offset < end && reader.getSpan(offset, end - offset, span) == GE_OK) {
+            for (uint64_t i = 0; i < span.numWords; ++i, ++numPrinted) {
+                if (numPrinted % 8 == 0) {
+                    printf("%s%012llx:", (numPrinted > 0) ? "\n" : "",
+                           static_cast<unsigned long long>(span.firstWord + i));
+                }
+                printf(" %08x", span.words[i]);
+            }
+            offset += span.numWords;
+        }
+        if (numPrinted > 0) {
+            printf("\n");
+        }
+    }
+    return 0;
+}
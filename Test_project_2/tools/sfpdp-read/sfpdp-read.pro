@@ -0,0 +1,25 @@
+# Reads and times the words of a recorded .dat file through a memory mapping, by offset, SYNC number, or time
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+APP = $$PWD/../..
+SDK = $$APP/gec-sfpdp-recorder-api-win-3.5.0
+SSH_COMMON = $$APP/gec-ssh-win-3.0.0/examples/ssh-common
+
+SOURCES += \
+    sfpdp-read.cpp \
+    $$APP/mappedfile.cpp \
+    $$APP/recordingdatareader.cpp \
+    $$APP/recordingextractor.cpp \
+    $$APP/syncindex.cpp \
+    $$APP/timeindex.cpp
+
+HEADERS += \
+    $$APP/mappedfile.h \
+    $$APP/recordingdatareader.h \
+    $$APP/recordingextractor.h \
+    $$APP/syncindex.h \
+    $$APP/timeindex.h
+
+INCLUDEPATH += $$APP $$SDK $$SSH_COMMON
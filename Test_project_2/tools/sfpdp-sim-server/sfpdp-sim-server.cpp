@@ -0,0 +1,114 @@
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "simulatedrecorder.h"
+#include "simulatorserver.h"
+
+static void printUsage()
+{
+    fprintf(stderr,
+            "Usage: sfpdp-sim-server [options] [sim:<directory>[?rate=<MB/s>&disk=<MB/s>&fifo=<MiB>]]\n"
+            "\n"
+            "Serves a simulated SFPDP recorder to control clients, until SIGINT or SIGTERM.\n"
+            "Recordings are written below <directory> (default /tmp/sfpdp-sim).\n"
+            "\n"
+            "Options:\n"
+            "  --socket <path>   Unix socket to listen on (default %s, \"\" for none)\n"
+            "  --port <port>     TCP port to listen on (default %d, 0 for none)\n"
+            "  --bind <address>  IPv4 address for the TCP port (default 127.0.0.1)\n"
+            "  --devices <n>     Number of simulated devices (default 1)\n",
+            GEC_SFPDP_RECORDER_SERVER_UNIX_SOCKET_FILE, GEC_SFPDP_RECORDER_SERVER_TCP_PORT);
+}
+
+int main(int argc, char *argv[])
+{
+    std::string socketPath = GEC_SFPDP_RECORDER_SERVER_UNIX_SOCKET_FILE;
+    int port = GEC_SFPDP_RECORDER_SERVER_TCP_PORT;
+    std::string bindAddress = "127.0.0.1";
+    std::string simulatorAddress = "sim:/tmp/sfpdp-sim";
+    int numDevices = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--socket" && hasValue) {
+            socketPath = argv[++i];
+        } else if (arg == "--port" && hasValue) {
+            port = atoi(argv[++i]);
+        } else if (arg == "--bind" && hasValue) {
+            bindAddress = argv[++i];
+        } else if (arg == "--devices" && hasValue) {
+            numDevices = atoi(argv[++i]);
+        } else if (arg.compare(0, 4, "sim:") == 0) {
+            simulatorAddress = arg;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    SimulatedRecorder::Config config;
+    if (!SimulatedRecorder::parseAddress(simulatorAddress, config) || port < 0 || port > 65535 || numDevices < 1) {
+        printUsage();
+        return 1;
+    }
+    config.numDevices = numDevices;
+
+    // SIGINT and SIGTERM are taken by a thread of their own, so the epoll loop never sees EINTR for them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    SimulatedRecorder recorder(config);
+    SimulatorServer server(&recorder);
+    if (!socketPath.empty() && !server.listenUnix(socketPath)) {
+        fprintf(stderr, "Cannot listen on %s: %s\n", socketPath.c_str(), strerror(errno));
+        return 1;
+    }
+    if (port != 0 && !server.listenTcp(bindAddress, static_cast<uint16_t>(port))) {
+        fprintf(stderr, "Cannot listen on %s:%d: %s\n", bindAddress.c_str(), port, strerror(errno));
+        return 1;
+    }
+    if (socketPath.empty() && port == 0) {
+        printUsage();
+        return 1;
+    }
+    printf("Serving %s", simulatorAddress.c_str());
+    if (!socketPath.empty()) {
+        printf(" on %s", socketPath.c_str());
+    }
+    if (port != 0) {
+        printf(" on %s:%d", bindAddress.c_str(), port);
+    }
+    printf("\n");
+    fflush(stdout);
+
+    std::thread signalThread([&server, &signals]() {
+        int signal = 0;
+        sigwait(&signals, &signal);
+        server.stop();
+    });
+
+    bool ok = server.run();
+    if (!ok) {
+        fprintf(stderr, "epoll_wait failed: %s\n", strerror(errno));
+        pthread_kill(signalThread.native_handle(), SIGTERM);
+    }
+    signalThread.join();
+
+    SimulatorServer::Statistics statistics = server.getStatistics();
+    printf("%llu connections, %llu requests, %llu protocol errors\n",
+           static_cast<unsigned long long>(statistics.numConnections),
+           static_cast<unsigned long long>(statistics.numRequests),
+           static_cast<unsigned long long>(statistics.numProtocolErrors));
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,21 @@
+# Stand-in recorder server backed by the simulator, for clients speaking RecorderProtocol
+TEMPLATE = app
+CONFIG += console c++11 thread
+CONFIG -= app_bundle qt
+
+APP = $$PWD/../..
+SDK = $$APP/gec-sfpdp-recorder-api-win-3.5.0
+SSH_COMMON = $$APP/gec-ssh-win-3.0.0/examples/ssh-common
+
+SOURCES += \
+    sfpdp-sim-server.cpp \
+    simulatorserver.cpp \
+    $$APP/recorderprotocol.cpp \
+    $$APP/simulatedrecorder.cpp
+
+HEADERS += \
+    simulatorserver.h \
+    $$APP/recorderprotocol.h \
+    $$APP/simulatedrecorder.h
+
+INCLUDEPATH += $$APP $$SDK $$SSH_COMMON
@@ -0,0 +1,283 @@
+#include "simulatorserver.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "recorderprotocol.h"
+
+// Clients with this many unsent response bytes are not read from until they catch up
+static const size_t maxPendingOutput = 1024 * 1024;
+
+static bool setNonBlocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+SimulatorServer::SimulatorServer(GEC_ISfpdpRecorder *recorder)
+    : m_recorder(recorder)
+    , m_epoll(epoll_create1(EPOLL_CLOEXEC))
+    , m_stopEvent(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = m_stopEvent;
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_stopEvent, &event);
+}
+
+SimulatorServer::~SimulatorServer()
+{
+    while (!m_connections.empty()) {
+        close(m_connections.begin()->first);
+    }
+    std::map<int, bool>::const_iterator it;
+    for (it = m_listeners.begin(); it != m_listeners.end(); ++it) {
+        ::close(it->first);
+    }
+    if (!m_unixPath.empty()) {
+        unlink(m_unixPath.c_str());
+    }
+    ::close(m_stopEvent);
+    ::close(m_epoll);
+}
+
+bool SimulatorServer::listenUnix(const std::string &path)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    strcpy(address.sun_path, path.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    // A server that did not shut down cleanly leaves its socket file behind
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0
+        || !addListener(fd)) {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        return false;
+    }
+    m_listeners[fd] = false;
+    m_unixPath = path;
+    return true;
+}
+
+bool SimulatorServer::listenTcp(const std::string &address, uint16_t port)
+{
+    sockaddr_in socketAddress;
+    memset(&socketAddress, 0, sizeof(socketAddress));
+    socketAddress.sin_family = AF_INET;
+    socketAddress.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &socketAddress.sin_addr) != 1) {
+        errno = EINVAL;
+        return false;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (bind(fd, reinterpret_cast<sockaddr *>(&socketAddress), sizeof(socketAddress)) != 0
+        || listen(fd, SOMAXCONN) != 0 || !addListener(fd)) {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        return false;
+    }
+    m_listeners[fd] = true;
+    return true;
+}
+
+bool SimulatorServer::addListener(int fd)
+{
+    if (!setNonBlocking(fd)) {
+        return false;
+    }
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    return epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+void SimulatorServer::stop()
+{
+    uint64_t one = 1;
+    ssize_t written = write(m_stopEvent, &one, sizeof(one));
+    (void)written;
+}
+
+bool SimulatorServer::run()
+{
+    epoll_event events[64];
+    for (;;) {
+        int numEvents = epoll_wait(m_epoll, events, 64, -1);
+        if (numEvents < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        for (int i = 0; i < numEvents; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == m_stopEvent) {
+                uint64_t count;
+                ssize_t numRead = read(m_stopEvent, &count, sizeof(count));
+                (void)numRead;
+                return true;
+            }
+            if (m_listeners.count(fd) != 0) {
+                accept(fd);
+                continue;
+            }
+
+            std::map<int, Connection>::iterator it = m_connections.find(fd);
+            if (it == m_connections.end()) {
+                continue;   // Closed while handling an earlier event of this batch
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                close(fd);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                send(fd, it->second);
+            }
+            if (events[i].events & EPOLLIN) {
+                it = m_connections.find(fd);   // send() may have closed it
+                if (it != m_connections.end()) {
+                    receive(fd, it->second);
+                }
+            }
+        }
+    }
+}
+
+void SimulatorServer::accept(int listener)
+{
+    bool isTcp = m_listeners[listener];
+    for (;;) {
+        int fd = accept4(listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;   // EAGAIN when all pending connections are accepted
+        }
+        if (isTcp) {
+            // Every request is one small frame that must go out at once
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        }
+
+        Connection &connection = m_connections[fd];
+        connection.outputOffset = 0;
+        connection.events = EPOLLIN;
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+            m_connections.erase(fd);
+            ::close(fd);
+            continue;
+        }
+        ++m_statistics.numConnections;
+    }
+}
+
+void SimulatorServer::receive(int fd, Connection &connection)
+{
+    char buffer[65536];
+    ssize_t numRead = recv(fd, buffer, sizeof(buffer), 0);
+    if (numRead == 0 || (numRead < 0 && errno != EAGAIN && errno != EINTR)) {
+        close(fd);
+        return;
+    }
+    if (numRead < 0) {
+        return;
+    }
+    connection.input.append(buffer, numRead);
+
+    // All complete frames are answered; a partial one waits for the rest
+    size_t offset = 0;
+    for (;;) {
+        int64_t frameSize = RecorderProtocol::getFrameSize(connection.input.data() + offset,
+                                                           connection.input.size() - offset);
+        if (frameSize < 0) {
+            ++m_statistics.numProtocolErrors;
+            close(fd);
+            return;
+        }
+        if (frameSize == 0 || offset + frameSize > connection.input.size()) {
+            break;
+        }
+        connection.output += RecorderProtocol::dispatch(m_recorder, connection.input.data() + offset,
+                                                        static_cast<size_t>(frameSize));
+        offset += static_cast<size_t>(frameSize);
+        ++m_statistics.numRequests;
+    }
+    connection.input.erase(0, offset);
+
+    send(fd, connection);
+}
+
+void SimulatorServer::send(int fd, Connection &connection)
+{
+    while (connection.outputOffset < connection.output.size()) {
+        ssize_t numSent = ::send(fd, connection.output.data() + connection.outputOffset,
+                                 connection.output.size() - connection.outputOffset, MSG_NOSIGNAL);
+        if (numSent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN) {
+                close(fd);
+                return;
+            }
+            break;
+        }
+        connection.outputOffset += numSent;
+    }
+    if (connection.outputOffset == connection.output.size()) {
+        connection.output.clear();
+        connection.outputOffset = 0;
+    }
+    updateEvents(fd, connection);
+}
+
+void SimulatorServer::updateEvents(int fd, Connection &connection)
+{
+    bool isWriting = !connection.output.empty();
+    bool isReading = connection.output.size() - connection.outputOffset < maxPendingOutput;
+    uint32_t events = (isReading ? static_cast<uint32_t>(EPOLLIN) : 0) | (isWriting ? static_cast<uint32_t>(EPOLLOUT) : 0);
+    // Most requests are answered at once, so the events rarely change
+    if (events != connection.events) {
+        epoll_event event;
+        event.events = events;
+        event.data.fd = fd;
+        epoll_ctl(m_epoll, EPOLL_CTL_MOD, fd, &event);
+        connection.events = events;
+    }
+}
+
+void SimulatorServer::close(int fd)
+{
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, NULL);
+    ::close(fd);
+    m_connections.erase(fd);
+}
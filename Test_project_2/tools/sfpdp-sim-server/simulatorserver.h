@@ -0,0 +1,80 @@
+#ifndef SIMULATORSERVER_H
+#define SIMULATORSERVER_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+
+class GEC_ISfpdpRecorder;
+
+/**
+  Serves one recorder to any number of control clients over TCP and a
+  Unix socket, speaking RecorderProtocol
+
+  One thread runs an epoll loop over the listening sockets and all
+  client connections. Requests are complete frames; each is dispatched
+  to the recorder as soon as it has arrived and its response is queued
+  on the connection. All clients share the recorder, like the clients of
+  a real recorder server share its sessions.
+
+  A client that does not read its responses is not read from either once
+  a megabyte of responses waits for it, so it cannot make the server
+  buffer without limit.
+
+  Linux only.
+*/
+class SimulatorServer
+{
+public:
+    struct Statistics
+    {
+        Statistics() : numConnections(0), numRequests(0), numProtocolErrors(0) {}
+
+        uint64_t numConnections;         // Accepted since the start
+        uint64_t numRequests;
+        uint64_t numProtocolErrors;      // Connections closed for a malformed frame
+    };
+
+    explicit SimulatorServer(GEC_ISfpdpRecorder *recorder);
+    ~SimulatorServer();
+
+    /** Removes a stale socket file at @p path first. @return false on error, with errno set */
+    bool listenUnix(const std::string &path);
+    bool listenTcp(const std::string &address, uint16_t port);
+
+    /** Serves until stop() is called. @return false if epoll failed */
+    bool run();
+    /** May be called from any thread */
+    void stop();
+
+    Statistics getStatistics() const { return m_statistics; }
+
+private:
+    SimulatorServer(const SimulatorServer &);
+    SimulatorServer &operator=(const SimulatorServer &);
+
+    struct Connection
+    {
+        std::string input;
+        std::string output;
+        size_t outputOffset;             // Already sent part of output
+        uint32_t events;                 // Registered with epoll
+    };
+
+    bool addListener(int fd);
+    void accept(int listener);
+    void receive(int fd, Connection &connection);
+    void send(int fd, Connection &connection);
+    void updateEvents(int fd, Connection &connection);
+    void close(int fd);
+
+    GEC_ISfpdpRecorder *m_recorder;
+    int m_epoll;
+    int m_stopEvent;
+    std::map<int, bool> m_listeners;     // Whether the listener is a TCP socket
+    std::map<int, Connection> m_connections;
+    std::string m_unixPath;
+    Statistics m_statistics;
+};
+
+#endif // SIMULATORSERVER_H
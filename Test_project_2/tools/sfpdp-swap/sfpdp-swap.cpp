@@ -0,0 +1,263 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GEC_RecordingFormat.h"
+#include "inc/GE_Defines.h"
+#include "recordingdatareader.h"
+#include "wordswapper.h"
+
+/*
+  Swaps the bytes of the words of a recording, to fix one made with the
+  wrong setSwapping() setting
+
+  The .dat file is converted by a WordSwapper; the .idx and .meta files
+  hold byte offsets only, so they are copied unchanged next to the new
+  .dat file. --benchmark times every kernel the CPU has on a buffer in
+  memory, for each kind of swapping, and checks that they all give the
+  result of the scalar kernel.
+*/
+
+static double getTimeInS()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void printUsage()
+{
+    fprintf(stderr,
+            "Usage: sfpdp-swap <input.dat> <output.dat> [options]\n"
+            "       sfpdp-swap --benchmark [options]\n"
+            "\n"
+            "Swaps the bytes of the 32-bit words of a recording, as setSwapping() does on the\n"
+            "module. The .idx and .meta files are copied next to the output.\n"
+            "\n"
+            "Options:\n"
+            "  --8in16             Swap the bytes in each 16 bit half: 0x12345678 -> 0x34127856\n"
+            "  --16in32            Swap the 16 bit halves: 0x12345678 -> 0x56781234\n"
+            "  --reverse           Both, reversing the endianness: 0x12345678 -> 0x78563412\n"
+            "  --kernel <name>     scalar, ssse3, or avx2 (default the fastest the CPU has)\n"
+            "  --threads <n>       Threads (default one per hardware thread)\n"
+            "  --benchmark         Time the kernels on a buffer in memory instead\n"
+            "  --size <MiB>        Size of the benchmark buffer (default 256)\n");
+}
+
+// Like WordSwapper::convert(), through a temporary file, so a failed copy does not destroy an existing output
+static int copyFile(const std::string &inputPath, const std::string &outputPath)
+{
+    FILE *input = fopen(inputPath.c_str(), "rb");
+    if (input == NULL) {
+        return GE_NOT_EXISTING;
+    }
+    std::string tempPath = outputPath + ".tmp";
+    FILE *output = fopen(tempPath.c_str(), "wb");
+    if (output == NULL) {
+        fclose(input);
+        return GE_NO_ACCESS;
+    }
+    int rc = GE_OK;
+    std::vector<char> buffer(1 << 20);
+    size_t numRead = 0;
+    while ((numRead = fread(&buffer[0], 1, buffer.size(), input)) > 0) {
+        if (fwrite(&buffer[0], 1, numRead, output) != numRead) {
+            rc = GE_ERROR;
+            break;
+        }
+    }
+    fclose(input);
+    if (fclose(output) != 0 && rc == GE_OK) {
+        rc = GE_ERROR;
+    }
+    if (rc == GE_OK) {
+        rc = RecordingDataReader::replaceFile(tempPath, outputPath);
+    }
+    if (rc != GE_OK) {
+        remove(tempPath.c_str());
+    }
+    return rc;
+}
+
+// Best time of a few passes over the buffer, split between the threads
+static double timeSwap(const WordSwapper &swapper, const std::vector<uint32_t> &words, std::vector<uint32_t> &swapped,
+                       unsigned numThreads)
+{
+    double bestInS = 0;
+    size_t sliceSize = (words.size() + numThreads - 1) / numThreads;
+    for (int pass = 0; pass < 5; ++pass) {
+        double startInS = getTimeInS();
+        std::vector<std::thread> threads;
+        for (unsigned i = 1; i < numThreads; ++i) {
+            size_t first = std::min(i * sliceSize, words.size());
+            size_t count = std::min(sliceSize, words.size() - first);
+            threads.push_back(std::thread([&swapper, &words, &swapped, first, count]() {
+                swapper.swap(&words[first], &swapped[first], count);
+            }));
+        }
+        swapper.swap(&words[0], &swapped[0], std::min(sliceSize, words.size()));
+        for (size_t i = 0; i < threads.size(); ++i) {
+            threads[i].join();
+        }
+        double timeInS = getTimeInS() - startInS;
+        bestInS = (pass == 0) ? timeInS : std::min(bestInS, timeInS);
+    }
+    return bestInS;
+}
+
+static int runBenchmark(double sizeInMiB, unsigned numThreads)
+{
+    size_t numWords = static_cast<size_t>(sizeInMiB * (1 << 20) / GEC_RECORDING_WORD_SIZE);
+    std::vector<uint32_t> words(numWords);
+    for (size_t i = 0; i < numWords; ++i) {
+        words[i] = static_cast<uint32_t>(i * 2654435761u);
+    }
+    std::vector<uint32_t> expected(numWords);
+    std::vector<uint32_t> swapped(numWords);
+    double numBytes = static_cast<double>(numWords) * GEC_RECORDING_WORD_SIZE;
+    printf("%g MiB, fastest kernel %s, %u threads for the second column\n", sizeInMiB,
+           WordSwapper::getName(WordSwapper::getFastestKernel()), numThreads);
+
+    static const char *modeNames[] = {"8in16", "16in32", "reverse"};
+    WordSwapper::Kernel kernels[] = {WordSwapper::SCALAR_KERNEL, WordSwapper::SSSE3_KERNEL, WordSwapper::AVX2_KERNEL};
+    int rc = 0;
+    for (int mode = 0; mode < 3; ++mode) {
+        WordSwapper swapper;
+        swapper.setSwapping(mode != 1, mode != 0);
+        swapper.setKernel(WordSwapper::SCALAR_KERNEL);
+        swapper.swap(&words[0], &expected[0], numWords);
+        for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k) {
+            if (!swapper.setKernel(kernels[k])) {
+                printf("%-8s %-7s not supported by this CPU\n", modeNames[mode], WordSwapper::getName(kernels[k]));
+                continue;
+            }
+            double singleInS = timeSwap(swapper, words, swapped, 1);
+            bool isCorrect = (swapped == expected);
+            double multiInS = timeSwap(swapper, words, swapped, numThreads);
+            isCorrect = isCorrect && (swapped == expected);
+            printf("%-8s %-7s %6.2f GB/s %6.2f GB/s%s\n", modeNames[mode], WordSwapper::getName(kernels[k]),
+                   numBytes / singleInS / 1e9, numBytes / multiInS / 1e9, isCorrect ? "" : "  WRONG RESULT");
+            if (!isCorrect) {
+                rc = 1;
+            }
+        }
+    }
+    return rc;
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> paths;
+    bool enable8in16 = false;
+    bool enable16in32 = false;
+    std::string kernelName;
+    unsigned numThreads = 0;
+    bool benchmark = false;
+    double sizeInMiB = 256;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--8in16") {
+            enable8in16 = true;
+        } else if (arg == "--16in32") {
+            enable16in32 = true;
+        } else if (arg == "--reverse") {
+            enable8in16 = true;
+            enable16in32 = true;
+        } else if (arg == "--kernel" && hasValue) {
+            kernelName = argv[++i];
+        } else if (arg == "--threads" && hasValue) {
+            numThreads = static_cast<unsigned>(atoi(argv[++i]));
+        } else if (arg == "--benchmark") {
+            benchmark = true;
+        } else if (arg == "--size" && hasValue) {
+            sizeInMiB = atof(argv[++i]);
+        } else if (arg[0] != '-') {
+            paths.push_back(arg);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (benchmark) {
+        if (sizeInMiB <= 0) {
+            printUsage();
+            return 1;
+        }
+        if (numThreads == 0) {
+            numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        return runBenchmark(sizeInMiB, numThreads);
+    }
+    if (paths.size() != 2 || (!enable8in16 && !enable16in32)) {
+        printUsage();
+        return 1;
+    }
+
+    WordSwapper swapper;
+    swapper.setSwapping(enable8in16, enable16in32);
+    swapper.setNumThreads(numThreads);
+    if (!kernelName.empty()) {
+        WordSwapper::Kernel kernel = WordSwapper::SCALAR_KERNEL;
+        if (kernelName == "ssse3") {
+            kernel = WordSwapper::SSSE3_KERNEL;
+        } else if (kernelName == "avx2") {
+            kernel = WordSwapper::AVX2_KERNEL;
+        } else if (kernelName != "scalar") {
+            printUsage();
+            return 1;
+        }
+        if (!swapper.setKernel(kernel)) {
+            fprintf(stderr, "The %s kernel is not supported by this CPU\n", WordSwapper::getName(kernel));
+            return 1;
+        }
+    }
+
+    // Offsets into the data do not change, so the index and the timing are copied. No output may be any of the
+    // input files, however it is spelled, or it would be truncated before it is read.
+    const char *extensions[] = {GEC_RECORDING_DATA_EXTENSION, GEC_RECORDING_INDEX_EXTENSION,
+                                GEC_RECORDING_META_EXTENSION};
+    const size_t numExtensions = sizeof(extensions) / sizeof(extensions[0]);
+    std::vector<std::string> inputPaths;
+    std::vector<std::string> outputPaths;
+    for (size_t i = 0; i < numExtensions; ++i) {
+        // The .dat paths are used as given, whatever their extension
+        inputPaths.push_back((i == 0) ? paths[0] : RecordingDataReader::replaceExtension(paths[0], extensions[i]));
+        outputPaths.push_back((i == 0) ? paths[1] : RecordingDataReader::replaceExtension(paths[1], extensions[i]));
+    }
+    for (size_t i = 0; i < numExtensions; ++i) {
+        for (size_t j = 0; j < numExtensions; ++j) {
+            if (RecordingDataReader::isSameFile(outputPaths[i], inputPaths[j])) {
+                fprintf(stderr, "%s: is the input file %s\n", outputPaths[i].c_str(), inputPaths[j].c_str());
+                return 1;
+            }
+        }
+    }
+
+    WordSwapper::Result result;
+    int rc = swapper.convert(paths[0], paths[1], result);
+    if (rc != GE_OK) {
+        fprintf(stderr, "%s: converting to %s failed with error %d\n", paths[0].c_str(), paths[1].c_str(), rc);
+        return 1;
+    }
+    printf("%s: %llu bytes swapped with the %s kernel on %u threads in %.3f s, %.2f GB/s\n", paths[1].c_str(),
+           static_cast<unsigned long long>(result.numBytes), WordSwapper::getName(swapper.getKernel()),
+           result.numThreads, result.timeInS, (result.timeInS > 0) ? result.numBytes / result.timeInS / 1e9 : 0.0);
+
+    for (size_t i = 1; i < numExtensions; ++i) {
+        rc = copyFile(inputPaths[i], outputPaths[i]);
+        if (rc == GE_OK) {
+            printf("%s: copied from %s\n", outputPaths[i].c_str(), inputPaths[i].c_str());
+        } else if (rc != GE_NOT_EXISTING) {
+            fprintf(stderr, "%s: copying failed with error %d\n", outputPaths[i].c_str(), rc);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,21 @@
+# Swaps the bytes of the words of a recording, and benchmarks the swap kernels
+TEMPLATE = app
+CONFIG += console c++11 thread
+CONFIG -= app_bundle qt
+
+APP = $$PWD/../..
+SDK = $$APP/gec-sfpdp-recorder-api-win-3.5.0
+SSH_COMMON = $$APP/gec-ssh-win-3.0.0/examples/ssh-common
+
+SOURCES += \
+    sfpdp-swap.cpp \
+    $$APP/mappedfile.cpp \
+    $$APP/recordingdatareader.cpp \
+    $$APP/wordswapper.cpp
+
+HEADERS += \
+    $$APP/mappedfile.h \
+    $$APP/recordingdatareader.h \
+    $$APP/wordswapper.h
+
+INCLUDEPATH += $$APP $$SDK $$SSH_COMMON
@@ -0,0 +1,193 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "inc/GEC_ISfpdpRecorder.h"
+#include "inc/GE_Defines.h"
+#include "profileengine.h"
+#include "sessionprofiles.h"
+#include "socketrecorder.h"
+#include "startorchestrator.h"
+
+/*
+  Starts the same sessions on several recorders at once with a
+  StartOrchestrator, and prints how far apart the starts were
+
+  With --compare the recorders are started twice, first one after the
+  other as before, then from the barrier, so the two skews can be
+  compared on the same machines.
+*/
+
+static void printUsage()
+{
+    fprintf(stderr,
+            "Usage: sfpdp-sync-start --recorder <address> [...] --profiles <file>\n"
+            "                        --session <profile>@<device>:<port> [...] [options]\n"
+            "\n"
+            "Arms the sessions on every recorder, starts all recorders at once, and\n"
+            "reports the start skew between them.\n"
+            "\n"
+            "Addresses are unix:<path> for a Unix socket, or <host>:<port> for TCP, of\n"
+            "a running sfpdp-sim-server.\n"
+            "\n"
+            "Options:\n"
+            "  --path <dir>          Directory of the recordings (default /sync-start)\n"
+            "  --sequential          Call startAll() on one recorder after the other\n"
+            "  --compare             Start sequentially, then concurrently, and compare\n"
+            "  --manual-sync <mask>  Start the internal sync masters in <mask> (1 to 15) from\n"
+            "                        a second barrier, after all recorders were started\n"
+            "  --warm-up <n>         getStatus() calls per recorder before the start (default 5)\n"
+            "  --duration <s>        Time to record before stopping (default 1)\n");
+}
+
+static void printReport(const char *title, const StartOrchestrator::Report &report)
+{
+    printf("%s start of %zu recorders:\n", title, report.recorders.size());
+    printf("  %-28s %8s %12s %12s %10s\n", "recorder", "rc", "rtt us", "start us", "call us");
+    double firstStartInS = report.recorders.empty() ? 0 : report.recorders.front().startInS;
+    for (size_t i = 0; i < report.recorders.size(); ++i) {
+        firstStartInS = std::min(firstStartInS, report.recorders[i].startInS);
+    }
+    for (size_t i = 0; i < report.recorders.size(); ++i) {
+        const StartOrchestrator::RecorderResult &result = report.recorders[i];
+        printf("  %-28s %8d %12.1f %12.1f %10.1f\n", result.name.c_str(), result.rc, result.roundTripInUs,
+               1e6 * (result.startInS - firstStartInS), 1e6 * (result.returnInS - result.sendInS));
+    }
+    printf("  release skew %.1f us, estimated start skew %.1f us, longest startAll() %.1f us\n",
+           report.releaseSkewInUs, report.startSkewInUs, report.longestCallInUs);
+    if (report.isManualSync) {
+        printf("  estimated sync master skew %.1f us\n", report.syncSkewInUs);
+    }
+}
+
+static int runOnce(StartOrchestrator &orchestrator, bool concurrent, double durationInS,
+                   StartOrchestrator::Report &report)
+{
+    orchestrator.setConcurrent(concurrent);
+    int rc = orchestrator.arm(report);
+    if (rc != GE_OK) {
+        for (size_t i = 0; i < report.recorders.size(); ++i) {
+            if (report.recorders[i].rc != GE_OK) {
+                fprintf(stderr, "Arming %s failed with error %d\n", report.recorders[i].name.c_str(),
+                        report.recorders[i].rc);
+            }
+        }
+        return rc;
+    }
+    rc = orchestrator.start(report);
+    printReport(concurrent ? "Concurrent" : "Sequential", report);
+    std::this_thread::sleep_for(std::chrono::duration<double>(durationInS));
+    StartOrchestrator::Report stopReport;
+    orchestrator.stop(stopReport);
+    return rc;
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> addresses;
+    std::string profilesPath;
+    std::vector<ProfileEngine::Assignment> assignments;
+    std::string path = "/sync-start";
+    bool sequential = false;
+    bool compare = false;
+    int masterMask = 0;
+    int numWarmUpCalls = 5;
+    double durationInS = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--recorder" && hasValue) {
+            addresses.push_back(argv[++i]);
+        } else if (arg == "--profiles" && hasValue) {
+            profilesPath = argv[++i];
+        } else if (arg == "--session" && hasValue) {
+            ProfileEngine::Assignment assignment;
+            if (!ProfileEngine::parseAssignment(argv[++i], assignment)) {
+                printUsage();
+                return 1;
+            }
+            assignments.push_back(assignment);
+        } else if (arg == "--path" && hasValue) {
+            path = argv[++i];
+        } else if (arg == "--sequential") {
+            sequential = true;
+        } else if (arg == "--compare") {
+            compare = true;
+        } else if (arg == "--manual-sync" && hasValue) {
+            masterMask = atoi(argv[++i]);
+        } else if (arg == "--warm-up" && hasValue) {
+            numWarmUpCalls = atoi(argv[++i]);
+        } else if (arg == "--duration" && hasValue) {
+            durationInS = atof(argv[++i]);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (addresses.empty() || profilesPath.empty() || assignments.empty() || masterMask < 0 || masterMask > 15
+        || numWarmUpCalls < 0 || durationInS < 0) {
+        printUsage();
+        return 1;
+    }
+
+    SessionProfiles profiles;
+    if (profiles.load(profilesPath) != GE_OK) {
+        fprintf(stderr, "%s: %s\n", profilesPath.c_str(), profiles.getError().c_str());
+        return 1;
+    }
+    for (size_t i = 0; i < assignments.size(); ++i) {
+        assignments[i].path = path;
+    }
+
+    std::vector<SocketRecorder *> recorders;
+    StartOrchestrator orchestrator(profiles);
+    for (size_t i = 0; i < addresses.size(); ++i) {
+        const std::string &address = addresses[i];
+        size_t colon = address.rfind(':');
+        if (address.compare(0, 5, "unix:") == 0) {
+            recorders.push_back(new SocketRecorder(address.substr(5)));
+        } else if (colon != std::string::npos) {
+            recorders.push_back(new SocketRecorder(address.substr(0, colon),
+                                                   static_cast<uint16_t>(atoi(address.c_str() + colon + 1))));
+        } else {
+            fprintf(stderr, "Invalid address %s\n", address.c_str());
+            for (size_t k = 0; k < recorders.size(); ++k) {
+                delete recorders[k];
+            }
+            return 1;
+        }
+        orchestrator.addRecorder(address, recorders.back(), assignments);
+    }
+    orchestrator.setManualSync(masterMask != 0, masterMask);
+    orchestrator.setNumWarmUpCalls(numWarmUpCalls);
+
+    int rc = GE_OK;
+    if (compare) {
+        StartOrchestrator::Report sequentialReport;
+        StartOrchestrator::Report concurrentReport;
+        rc = runOnce(orchestrator, false, durationInS, sequentialReport);
+        if (rc == GE_OK) {
+            printf("\n");
+            rc = runOnce(orchestrator, true, durationInS, concurrentReport);
+        }
+        if (rc == GE_OK) {
+            printf("\nEstimated start skew: %.1f us sequential, %.1f us concurrent\n",
+                   sequentialReport.startSkewInUs, concurrentReport.startSkewInUs);
+        }
+    } else {
+        StartOrchestrator::Report report;
+        rc = runOnce(orchestrator, !sequential, durationInS, report);
+    }
+
+    for (size_t i = 0; i < recorders.size(); ++i) {
+        delete recorders[i];
+    }
+    return (rc == GE_OK) ? 0 : 1;
+}
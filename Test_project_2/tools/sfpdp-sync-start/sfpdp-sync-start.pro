@@ -0,0 +1,27 @@
+# Starts several recorders at once from a barrier and reports the start skew between them
+TEMPLATE = app
+CONFIG += console c++11 thread
+CONFIG -= app_bundle qt
+
+APP = $$PWD/../..
+SDK = $$APP/gec-sfpdp-recorder-api-win-3.5.0
+SSH_COMMON = $$APP/gec-ssh-win-3.0.0/examples/ssh-common
+
+SOURCES += \
+    sfpdp-sync-start.cpp \
+    $$APP/instrumentedrecorder.cpp \
+    $$APP/profileengine.cpp \
+    $$APP/recorderprotocol.cpp \
+    $$APP/sessionprofiles.cpp \
+    $$APP/socketrecorder.cpp \
+    $$APP/startorchestrator.cpp
+
+HEADERS += \
+    $$APP/instrumentedrecorder.h \
+    $$APP/profileengine.h \
+    $$APP/recorderprotocol.h \
+    $$APP/sessionprofiles.h \
+    $$APP/socketrecorder.h \
+    $$APP/startorchestrator.h
+
+INCLUDEPATH += $$APP $$SDK $$SSH_COMMON
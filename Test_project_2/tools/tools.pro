@@ -0,0 +1,11 @@
+# Command line tools for running the application against a simulated recorder (Linux only)
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    sfpdp-arm \
+    sfpdp-latency \
+    sfpdp-load \
+    sfpdp-read \
+    sfpdp-sim-server \
+    sfpdp-swap \
+    sfpdp-sync-start
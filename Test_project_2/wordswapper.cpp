@@ -0,0 +1,403 @@
+#include "wordswapper.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define WORDSWAPPER_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "GEC_RecordingFormat.h"
+#include "inc/GE_Defines.h"
+#include "mappedfile.h"
+#include "recordingdatareader.h"
+
+// GCC and Clang compile the intrinsics of a function only for the instruction set it is marked with
+#if defined(WORDSWAPPER_X86) && defined(__GNUC__)
+#define WORDSWAPPER_TARGET(name) __attribute__((target(name)))
+#else
+#define WORDSWAPPER_TARGET(name)
+#endif
+
+namespace
+{
+
+// Words are swapped and written through a buffer of this size per thread
+const size_t bufferSizeInWords = 256 * 1024;
+
+// Appended to the output path while it is written
+const char *tempExtension = ".tmp";
+
+double getTimeInS()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int seekFile(FILE *file, uint64_t offset)
+{
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET);
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET);
+#endif
+}
+
+// Source byte, within its word, of each byte of a swapped word in memory, which is little endian
+void getByteOrder(bool enable8in16, bool enable16in32, uint8_t order[4])
+{
+    for (uint8_t i = 0; i < 4; ++i) {
+        order[i] = i;
+        if (enable8in16) {
+            order[i] ^= 1;
+        }
+        if (enable16in32) {
+            order[i] ^= 2;
+        }
+    }
+}
+
+void swapScalar(const uint32_t *words, uint32_t *swapped, size_t numWords, bool enable8in16, bool enable16in32)
+{
+    if (enable8in16 && enable16in32) {
+        for (size_t i = 0; i < numWords; ++i) {
+            uint32_t word = words[i];
+            swapped[i] = (word << 24) | ((word & 0x0000FF00) << 8) | ((word >> 8) & 0x0000FF00) | (word >> 24);
+        }
+    } else if (enable8in16) {
+        for (size_t i = 0; i < numWords; ++i) {
+            uint32_t word = words[i];
+            swapped[i] = ((word & 0x00FF00FF) << 8) | ((word >> 8) & 0x00FF00FF);
+        }
+    } else if (enable16in32) {
+        for (size_t i = 0; i < numWords; ++i) {
+            uint32_t word = words[i];
+            swapped[i] = (word << 16) | (word >> 16);
+        }
+    } else if (swapped != words) {
+        memmove(swapped, words, numWords * sizeof(uint32_t));
+    }
+}
+
+#ifdef WORDSWAPPER_X86
+
+struct CpuFeatures
+{
+    bool hasSsse3;
+    bool hasAvx2;
+};
+
+CpuFeatures getCpuFeatures()
+{
+    CpuFeatures features;
+    unsigned int registers[4] = {0, 0, 0, 0};
+    unsigned int maxLeaf = 0;
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    maxLeaf = static_cast<unsigned int>(info[0]);
+    __cpuid(info, 1);
+    for (int i = 0; i < 4; ++i) {
+        registers[i] = static_cast<unsigned int>(info[i]);
+    }
+#else
+    maxLeaf = __get_cpuid_max(0, NULL);
+    __get_cpuid(1, &registers[0], &registers[1], &registers[2], &registers[3]);
+#endif
+    features.hasSsse3 = (registers[2] & (1u << 9)) != 0;
+
+    // AVX2 also needs the OS to save the YMM registers, which OSXSAVE and XCR0 tell
+    features.hasAvx2 = false;
+    bool hasOsxsave = (registers[2] & (1u << 27)) != 0;
+    if (maxLeaf >= 7 && hasOsxsave) {
+#ifdef _MSC_VER
+        uint64_t xcr0 = _xgetbv(0);
+        __cpuidex(info, 7, 0);
+        unsigned int leaf7Ebx = static_cast<unsigned int>(info[1]);
+#else
+        unsigned int xcr0Low = 0;
+        unsigned int xcr0High = 0;
+        __asm__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+        uint64_t xcr0 = (static_cast<uint64_t>(xcr0High) << 32) | xcr0Low;
+        unsigned int leaf7Eax = 0;
+        unsigned int leaf7Ebx = 0;
+        unsigned int leaf7Ecx = 0;
+        unsigned int leaf7Edx = 0;
+        __cpuid_count(7, 0, leaf7Eax, leaf7Ebx, leaf7Ecx, leaf7Edx);
+#endif
+        features.hasAvx2 = (xcr0 & 0x6) == 0x6 && (leaf7Ebx & (1u << 5)) != 0;
+    }
+    return features;
+}
+
+WORDSWAPPER_TARGET("ssse3")
+void swapSsse3(const uint32_t *words, uint32_t *swapped, size_t numWords, bool enable8in16, bool enable16in32)
+{
+    uint8_t order[4];
+    getByteOrder(enable8in16, enable16in32, order);
+    const __m128i mask = _mm_setr_epi8(order[0], order[1], order[2], order[3],
+                                       4 + order[0], 4 + order[1], 4 + order[2], 4 + order[3],
+                                       8 + order[0], 8 + order[1], 8 + order[2], 8 + order[3],
+                                       12 + order[0], 12 + order[1], 12 + order[2], 12 + order[3]);
+    size_t i = 0;
+    for (; i < numWords && (reinterpret_cast<uintptr_t>(swapped + i) & 15) != 0; ++i) {
+        swapScalar(words + i, swapped + i, 1, enable8in16, enable16in32);
+    }
+    // Four vectors per iteration keep enough loads in flight to run at memory speed
+    for (; i + 16 <= numWords; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(words + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(words + i + 4));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(words + i + 8));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(words + i + 12));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(swapped + i), _mm_shuffle_epi8(a, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(swapped + i + 4), _mm_shuffle_epi8(b, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(swapped + i + 8), _mm_shuffle_epi8(c, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(swapped + i + 12), _mm_shuffle_epi8(d, mask));
+    }
+    for (; i + 4 <= numWords; i += 4) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(words + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(swapped + i), _mm_shuffle_epi8(a, mask));
+    }
+    swapScalar(words + i, swapped + i, numWords - i, enable8in16, enable16in32);
+}
+
+WORDSWAPPER_TARGET("avx2")
+void swapAvx2(const uint32_t *words, uint32_t *swapped, size_t numWords, bool enable8in16, bool enable16in32)
+{
+    uint8_t order[4];
+    getByteOrder(enable8in16, enable16in32, order);
+    // The shuffle works within each 128-bit lane, so the mask is the same in both
+    const __m256i mask = _mm256_setr_epi8(order[0], order[1], order[2], order[3],
+                                          4 + order[0], 4 + order[1], 4 + order[2], 4 + order[3],
+                                          8 + order[0], 8 + order[1], 8 + order[2], 8 + order[3],
+                                          12 + order[0], 12 + order[1], 12 + order[2], 12 + order[3],
+                                          order[0], order[1], order[2], order[3],
+                                          4 + order[0], 4 + order[1], 4 + order[2], 4 + order[3],
+                                          8 + order[0], 8 + order[1], 8 + order[2], 8 + order[3],
+                                          12 + order[0], 12 + order[1], 12 + order[2], 12 + order[3]);
+    // Stores that cross a cache line cost twice, and every other 32-byte one does on a 16-byte aligned buffer
+    size_t i = 0;
+    for (; i < numWords && (reinterpret_cast<uintptr_t>(swapped + i) & 31) != 0; ++i) {
+        swapScalar(words + i, swapped + i, 1, enable8in16, enable16in32);
+    }
+    for (; i + 32 <= numWords; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i + 8));
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i + 16));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i + 24));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(swapped + i), _mm256_shuffle_epi8(a, mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(swapped + i + 8), _mm256_shuffle_epi8(b, mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(swapped + i + 16), _mm256_shuffle_epi8(c, mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(swapped + i + 24), _mm256_shuffle_epi8(d, mask));
+    }
+    for (; i + 8 <= numWords; i += 8) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(swapped + i), _mm256_shuffle_epi8(a, mask));
+    }
+    swapScalar(words + i, swapped + i, numWords - i, enable8in16, enable16in32);
+}
+
+#endif
+
+}
+
+WordSwapper::WordSwapper()
+    : m_enable8in16(false)
+    , m_enable16in32(false)
+    , m_kernel(getFastestKernel())
+    , m_numThreads(0)
+{
+}
+
+void WordSwapper::setSwapping(bool enable8in16, bool enable16in32)
+{
+    m_enable8in16 = enable8in16;
+    m_enable16in32 = enable16in32;
+}
+
+bool WordSwapper::isSupported(Kernel kernel)
+{
+    if (kernel == SCALAR_KERNEL) {
+        return true;
+    }
+#ifdef WORDSWAPPER_X86
+    // Asked once; the answer does not change while the process runs
+    static const CpuFeatures features = getCpuFeatures();
+    return (kernel == SSSE3_KERNEL) ? features.hasSsse3 : (kernel == AVX2_KERNEL && features.hasAvx2);
+#else
+    return false;
+#endif
+}
+
+WordSwapper::Kernel WordSwapper::getFastestKernel()
+{
+    if (isSupported(AVX2_KERNEL)) {
+        return AVX2_KERNEL;
+    }
+    return isSupported(SSSE3_KERNEL) ? SSSE3_KERNEL : SCALAR_KERNEL;
+}
+
+const char *WordSwapper::getName(Kernel kernel)
+{
+    switch (kernel) {
+    case SSSE3_KERNEL:
+        return "SSSE3";
+    case AVX2_KERNEL:
+        return "AVX2";
+    default:
+        return "scalar";
+    }
+}
+
+bool WordSwapper::setKernel(Kernel kernel)
+{
+    if (!isSupported(kernel)) {
+        return false;
+    }
+    m_kernel = kernel;
+    return true;
+}
+
+void WordSwapper::setNumThreads(unsigned numThreads)
+{
+    m_numThreads = numThreads;
+}
+
+void WordSwapper::swap(const uint32_t *words, uint32_t *swapped, size_t numWords) const
+{
+#ifdef WORDSWAPPER_X86
+    if (isSwapping() && m_kernel == AVX2_KERNEL) {
+        swapAvx2(words, swapped, numWords, m_enable8in16, m_enable16in32);
+        return;
+    }
+    if (isSwapping() && m_kernel == SSSE3_KERNEL) {
+        swapSsse3(words, swapped, numWords, m_enable8in16, m_enable16in32);
+        return;
+    }
+#endif
+    swapScalar(words, swapped, numWords, m_enable8in16, m_enable16in32);
+}
+
+int WordSwapper::convert(const std::string &inputPath, const std::string &outputPath, Result &result) const
+{
+    result = Result();
+    if (RecordingDataReader::isSameFile(inputPath, outputPath)) {
+        return GE_INVALID_PARAMETER;
+    }
+    MappedFile input;
+    int rc = input.open(inputPath);
+    if (rc != GE_OK) {
+        return rc;
+    }
+    uint64_t size = input.getSize();
+    input.close();
+
+    // The threads write into the file made here, each at the offsets of its slice. It gets its name when they
+    // are all done, so a failed conversion leaves an existing output as it was.
+    std::string tempPath = outputPath + tempExtension;
+    FILE *output = fopen(tempPath.c_str(), "wb");
+    if (output == NULL) {
+        return GE_NO_ACCESS;
+    }
+    if (fclose(output) != 0) {
+        return GE_ERROR;
+    }
+
+    unsigned numThreads = (m_numThreads > 0) ? m_numThreads : std::max(std::thread::hardware_concurrency(), 1u);
+    // Slices of whole buffers, so no thread gets too little to be worth starting
+    uint64_t sliceUnit = bufferSizeInWords * GEC_RECORDING_WORD_SIZE;
+    uint64_t numUnits = (size + sliceUnit - 1) / sliceUnit;
+    numThreads = static_cast<unsigned>(std::max<uint64_t>(std::min<uint64_t>(numThreads, numUnits), 1));
+    uint64_t sliceSize = (numUnits + numThreads - 1) / numThreads * sliceUnit;
+
+    double startInS = getTimeInS();
+    std::vector<int> rcs(numThreads, GE_OK);
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < numThreads; ++i) {
+        uint64_t startOffset = std::min(i * sliceSize, size);
+        uint64_t endOffset = std::min(startOffset + sliceSize, size);
+        threads.push_back(std::thread([this, &rcs, &inputPath, &tempPath, i, startOffset, endOffset]() {
+            rcs[i] = convertSlice(inputPath, tempPath, startOffset, endOffset);
+        }));
+    }
+    rcs[0] = convertSlice(inputPath, tempPath, 0, std::min(sliceSize, size));
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+    result.timeInS = getTimeInS() - startInS;
+    result.numThreads = numThreads;
+
+    for (unsigned i = 0; i < numThreads; ++i) {
+        rc = (rc == GE_OK) ? rcs[i] : rc;
+    }
+    if (rc == GE_OK) {
+        rc = RecordingDataReader::replaceFile(tempPath, outputPath);
+    }
+    if (rc != GE_OK) {
+        remove(tempPath.c_str());
+        return rc;
+    }
+    result.numBytes = size;
+    return GE_OK;
+}
+
+int WordSwapper::convertSlice(const std::string &inputPath, const std::string &outputPath, uint64_t startOffset,
+                              uint64_t endOffset) const
+{
+    if (startOffset >= endOffset) {
+        return GE_OK;
+    }
+    MappedFile input;
+    input.setAccess(MappedFile::SEQUENTIAL_ACCESS);
+    int rc = input.open(inputPath);
+    if (rc != GE_OK) {
+        return rc;
+    }
+    FILE *output = fopen(outputPath.c_str(), "r+b");
+    if (output == NULL) {
+        return GE_NO_ACCESS;
+    }
+    if (seekFile(output, startOffset) != 0) {
+        fclose(output);
+        return GE_ERROR;
+    }
+
+    std::vector<uint32_t> buffer(bufferSizeInWords);
+    uint64_t offset = startOffset;
+    while (offset < endOffset && rc == GE_OK) {
+        uint64_t numMapped = 0;
+        const uint8_t *bytes = input.map(offset, endOffset - offset, numMapped);
+        if (bytes == NULL) {
+            rc = GE_ERROR;
+            break;
+        }
+        size_t numBytes = static_cast<size_t>(std::min(std::min(numMapped, endOffset - offset),
+                                                       static_cast<uint64_t>(buffer.size() * sizeof(uint32_t))));
+        size_t numWords = numBytes / GEC_RECORDING_WORD_SIZE;
+        const void *data = bytes;
+        if (numWords > 0) {
+            // Windows start at page boundaries and slices at whole buffers, so the words are aligned
+            swap(reinterpret_cast<const uint32_t *>(bytes), &buffer[0], numWords);
+            numBytes = numWords * GEC_RECORDING_WORD_SIZE;
+            data = &buffer[0];
+        }
+        // Otherwise these are the bytes after the last whole word, at the end of the file
+        if (fwrite(data, 1, numBytes, output) != numBytes) {
+            rc = GE_ERROR;
+        }
+        offset += numBytes;
+    }
+    if (fclose(output) != 0 && rc == GE_OK) {
+        rc = GE_ERROR;
+    }
+    return rc;
+}
@@ -0,0 +1,91 @@
+#ifndef WORDSWAPPER_H
+#define WORDSWAPPER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/**
+  Swaps the bytes of the 32-bit words of a recording, as
+  GEC_ISfpdpRecorder::setSwapping() does on the module
+
+  8 bit swapping inside 16 bit turns 0x12345678 into 0x34127856, 16 bit
+  swapping inside 32 bit into 0x56781234, and both together reverse the
+  endianness, into 0x78563412. A recording made with the wrong setting
+  is fixed by converting it with the swapping that was missing, since
+  each kind of swapping undoes itself.
+
+  The words are swapped by a kernel chosen when the swapper is made: a
+  byte shuffle of 32 bytes at a time with AVX2, of 16 bytes with SSSE3,
+  or shifts and masks one word at a time where neither is there. The
+  instruction sets are asked of the CPU at run time, so one build runs
+  on any x86 machine; on other CPUs only the scalar kernel exists. All
+  kernels give the same result, which setKernel() allows to check.
+
+  convert() swaps a .dat file into a new one. The input is split into
+  one slice per thread, and each thread maps its slice with a
+  MappedFile of its own and writes the swapped words at the same offset
+  of the output. Bytes after the last whole word are copied unchanged.
+*/
+class WordSwapper
+{
+public:
+    enum Kernel
+    {
+        SCALAR_KERNEL,
+        SSSE3_KERNEL,
+        AVX2_KERNEL
+    };
+
+    struct Result
+    {
+        Result() : numBytes(0), numThreads(0), timeInS(0) {}
+
+        uint64_t numBytes;
+        unsigned numThreads;
+        double timeInS;
+    };
+
+    /** Neither kind of swapping, with the fastest kernel of the CPU */
+    WordSwapper();
+
+    void setSwapping(bool enable8in16, bool enable16in32);
+    bool isSwapping() const { return m_enable8in16 || m_enable16in32; }
+
+    static bool isSupported(Kernel kernel);
+    static Kernel getFastestKernel();
+    static const char *getName(Kernel kernel);
+    /** @return false, keeping the kernel, if the CPU does not support @p kernel */
+    bool setKernel(Kernel kernel);
+    Kernel getKernel() const { return m_kernel; }
+
+    /** 0, the default, for one thread per hardware thread */
+    void setNumThreads(unsigned numThreads);
+
+    /** Swaps @p numWords words from @p words into @p swapped, which may be @p words itself */
+    void swap(const uint32_t *words, uint32_t *swapped, size_t numWords) const;
+
+    /**
+      Writes the words of the file at @p inputPath, swapped, to a new file
+      at @p outputPath. The file is written as @p outputPath with ".tmp"
+      appended and renamed when all of it is, so a file already at
+      @p outputPath is only replaced by a complete one.
+
+      @return GE_OK, GE_INVALID_PARAMETER if both paths are the same
+      file, GE_NOT_EXISTING or GE_NO_ACCESS for the input, GE_NO_ACCESS
+      if the output could not be created, or GE_ERROR if reading,
+      writing, or renaming failed
+    */
+    int convert(const std::string &inputPath, const std::string &outputPath, Result &result) const;
+
+private:
+    int convertSlice(const std::string &inputPath, const std::string &outputPath, uint64_t startOffset,
+                     uint64_t endOffset) const;
+
+    bool m_enable8in16;
+    bool m_enable16in32;
+    Kernel m_kernel;
+    unsigned m_numThreads;
+};
+
+#endif // WORDSWAPPER_H